@@ -0,0 +1,81 @@
+/**
+ * @file binary_file_source.cpp
+ *
+ * Implementation of BinaryFileSource.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "binary_file_source.hpp"
+
+namespace mlpack {
+namespace data {
+
+BinaryFileSource::BinaryFileSource(const std::string& filename,
+                                   const bool hasLabels) :
+    filename(filename),
+    stream(filename.c_str(), std::ios::binary),
+    hasLabels(hasLabels),
+    numRows(0),
+    numPoints(0),
+    dataOffset(0)
+{
+  if (!stream.is_open())
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  // The header is the matrix type, then the number of rows and columns, each
+  // followed by whitespace; the elements start after the last newline.
+  std::string header;
+  stream >> header >> numRows >> numPoints;
+  stream.get();
+  if (!stream.good() || header != "ARMA_MAT_BIN_FN008")
+  {
+    throw std::runtime_error("'" + filename + "' is not an Armadillo binary "
+        "file holding a double-precision matrix");
+  }
+
+  if (hasLabels && numRows == 0)
+    throw std::runtime_error("'" + filename + "' has no row of labels");
+
+  dataOffset = stream.tellg();
+}
+
+void BinaryFileSource::Read(const size_t begin,
+                            const size_t count,
+                            arma::mat& data,
+                            arma::Row<size_t>& labels)
+{
+  if (begin + count > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "BinaryFileSource::Read(): cannot read points " << begin << " to "
+        << (begin + count) << " of '" << filename << "', which has "
+        << numPoints << " points";
+    throw std::runtime_error(oss.str());
+  }
+
+  // The points are stored column by column, so the range is contiguous.
+  arma::mat points(numRows, count);
+  stream.clear();
+  stream.seekg(dataOffset + std::streamoff(sizeof(double) * numRows * begin));
+  stream.read((char*) points.memptr(), sizeof(double) * points.n_elem);
+  if (!stream.good())
+    throw std::runtime_error("cannot read from file '" + filename + "'");
+
+  if (hasLabels)
+  {
+    labels = arma::conv_to<arma::Row<size_t>>::from(points.row(numRows - 1));
+    points.shed_row(numRows - 1);
+  }
+  else
+  {
+    labels.clear();
+  }
+
+  data = std::move(points);
+}
+
+} // namespace data
+} // namespace mlpack
@@ -0,0 +1,90 @@
+/**
+ * @file binary_file_source.hpp
+ *
+ * A data source that reads ranges of points from an Armadillo binary file
+ * (as written by data::Save() for a .bin file), so that datasets that don't
+ * fit in memory can be streamed.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BINARY_FILE_SOURCE_HPP
+#define MLPACK_CORE_DATA_BINARY_FILE_SOURCE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * BinaryFileSource gives access to the points of a dense double-precision
+ * matrix stored in an Armadillo binary file (arma::arma_binary), without
+ * loading the whole file.  Each call to Read() seeks to the requested points
+ * and reads only those, so the file can be much larger than the available
+ * memory.
+ *
+ * If the file holds labelled points, the labels can be stored in the last row
+ * of the matrix; they are then returned separately by Read().
+ *
+ * A BinaryFileSource can be used as the SourceType of a StreamingFunction, so
+ * that an optimizer such as SGD or Adam can iterate over the file in
+ * mini-batches.  Read() must not be called from several threads at once.
+ */
+class BinaryFileSource
+{
+ public:
+  /**
+   * Open the given Armadillo binary file.  A std::runtime_error is thrown if
+   * the file can't be opened or doesn't hold a double-precision matrix.
+   *
+   * @param filename Name of the file to read.
+   * @param hasLabels If true, the last row of the matrix holds the label of
+   *     each point.
+   */
+  BinaryFileSource(const std::string& filename, const bool hasLabels = false);
+
+  /**
+   * Read the given range of points.  A std::runtime_error is thrown if the
+   * points can't be read.
+   *
+   * @param begin Index of the first point to read.
+   * @param count Number of points to read.
+   * @param data Matrix to store the points in.
+   * @param labels Row to store the labels of the points in; it is emptied if
+   *     the file has no labels.
+   */
+  void Read(const size_t begin,
+            const size_t count,
+            arma::mat& data,
+            arma::Row<size_t>& labels);
+
+  //! Get the number of points in the file.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the dimensionality of the points (not counting the labels).
+  size_t Dimensionality() const { return hasLabels ? numRows - 1 : numRows; }
+  //! Get whether the last row of the file holds labels.
+  bool HasLabels() const { return hasLabels; }
+  //! Get the name of the file.
+  const std::string& Filename() const { return filename; }
+
+ private:
+  //! The name of the file.
+  std::string filename;
+  //! The open file.
+  std::ifstream stream;
+  //! Whether the last row of the matrix holds labels.
+  bool hasLabels;
+  //! The number of rows of the matrix in the file.
+  size_t numRows;
+  //! The number of points (columns) in the file.
+  size_t numPoints;
+  //! The position of the first element of the matrix in the file.
+  std::streamoff dataOffset;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
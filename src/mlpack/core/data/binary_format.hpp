@@ -0,0 +1,101 @@
+/**
+ * @file binary_format.hpp
+ *
+ * Functions to save and load matrices in mlpack's own binary format (.mlbin),
+ * a chunked columnar format with typed, optionally compressed blocks, which can
+ * also hold the DatasetMapper of the matrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BINARY_FORMAT_HPP
+#define MLPACK_CORE_DATA_BINARY_FORMAT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "dataset_mapper.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Save a matrix to a file in mlpack's binary format.  This is what data::Save()
+ * does for files with the .mlbin extension.
+ *
+ * The matrix is stored as it is held in memory, with one point per column.
+ * The points are split into chunks of a few megabytes, and each chunk holds one
+ * block per dimension, so that the values of a block are similar to each
+ * other.  Each block is stored with the narrowest type that holds its values
+ * exactly (so that, for instance, categorical dimensions and other small
+ * integers take one or two bytes per value even in a double-precision matrix),
+ * and, if compression is enabled, its bytes are shuffled and compressed with
+ * an LZ4-style compressor when that makes the block smaller.  Chunks are
+ * encoded in parallel when OpenMP is available.
+ *
+ * Numbers are stored in the byte order of the host, which is recorded in the
+ * file; a file can only be loaded on a host with the same byte order.
+ *
+ * A std::runtime_error is thrown if the file can't be written.
+ *
+ * @param filename Name of the file to save to.
+ * @param matrix Matrix to save.
+ * @param compress Whether to compress the blocks.
+ */
+template<typename eT>
+void SaveBinary(const std::string& filename,
+                const arma::Mat<eT>& matrix,
+                const bool compress = true);
+
+/**
+ * Save a matrix and its DatasetMapper to a file in mlpack's binary format.  The
+ * mapper must have one dimension per row of the matrix.  See the other
+ * overload for details.
+ *
+ * @param filename Name of the file to save to.
+ * @param matrix Matrix to save.
+ * @param info DatasetMapper of the matrix.
+ * @param compress Whether to compress the blocks.
+ */
+template<typename eT, typename PolicyType>
+void SaveBinary(const std::string& filename,
+                const arma::Mat<eT>& matrix,
+                const DatasetMapper<PolicyType>& info,
+                const bool compress = true);
+
+/**
+ * Load a matrix from a file in mlpack's binary format.  The file is mapped
+ * into memory and its chunks are decoded in parallel, straight into the
+ * matrix.  The matrix may have a different element type than the one it was
+ * saved with; the values are then converted.  A std::runtime_error is thrown
+ * if the file can't be read, is corrupt, or was written on a host with another
+ * byte order.
+ *
+ * @param filename Name of the file to load.
+ * @param matrix Matrix to load the file into.
+ */
+template<typename eT>
+void LoadBinary(const std::string& filename, arma::Mat<eT>& matrix);
+
+/**
+ * Load a matrix and its DatasetMapper from a file in mlpack's binary format.
+ * The policy of the mapper is kept.  If the file holds no mapper, the mapper
+ * is reset to one with all dimensions numeric.
+ *
+ * @param filename Name of the file to load.
+ * @param matrix Matrix to load the file into.
+ * @param info DatasetMapper to load the mappings of the file into.
+ */
+template<typename eT, typename PolicyType>
+void LoadBinary(const std::string& filename,
+                arma::Mat<eT>& matrix,
+                DatasetMapper<PolicyType>& info);
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "binary_format_impl.hpp"
+
+#endif
@@ -0,0 +1,568 @@
+/**
+ * @file binary_format_impl.hpp
+ *
+ * Implementation of the functions that save and load mlpack binary matrix
+ * files.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BINARY_FORMAT_IMPL_HPP
+#define MLPACK_CORE_DATA_BINARY_FORMAT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "binary_format.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "lz_codec.hpp"
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+namespace details {
+
+/**
+ * The layout of an mlpack binary matrix file is:
+ *
+ *  - the magic string "MLPKBIN\0";
+ *  - the version of the format, as a uint32_t;
+ *  - the BinaryType of the elements of the saved matrix and the ByteOrder of
+ *    the host that saved it, as uint8_t, followed by two bytes of padding;
+ *  - the number of rows, the number of columns, the number of columns in each
+ *    chunk and the size in bytes of the serialized DatasetMapper (0 if there
+ *    is none), as uint64_t;
+ *  - the serialized DatasetMapper (a Boost binary archive);
+ *  - the chunks, each of which is its size in bytes (as a uint64_t) followed by
+ *    one block per row.  A block is its BinaryType (uint8_t), its
+ *    BinaryEncoding (uint8_t) and its size in bytes (uint64_t), followed by the
+ *    values of the row in the columns of the chunk.
+ *
+ * Everything is stored in the byte order of the host that saved the file.
+ * (Files saved before the byte order was recorded hold 0 there, and almost all
+ * of them were saved on little-endian hosts.)
+ */
+const char binaryMagic[8] = { 'M', 'L', 'P', 'K', 'B', 'I', 'N', '\0' };
+const uint32_t binaryVersion = 1;
+
+//! The byte orders in which a file can be stored.
+enum ByteOrder : unsigned char
+{
+  binaryLittleEndian,
+  binaryBigEndian
+};
+
+//! Get the byte order of this host.
+inline ByteOrder HostByteOrder()
+{
+  const uint16_t one = 1;
+  unsigned char firstByte;
+  std::memcpy(&firstByte, &one, 1);
+  return (firstByte == 1) ? binaryLittleEndian : binaryBigEndian;
+}
+
+//! The types of the values of a block.
+enum BinaryType : unsigned char
+{
+  binaryU8, binaryU16, binaryU32, binaryU64,
+  binaryS8, binaryS16, binaryS32, binaryS64,
+  binaryF32, binaryF64,
+  binaryNumTypes
+};
+
+//! The ways in which the values of a block can be stored.
+enum BinaryEncoding : unsigned char
+{
+  //! The values are stored as they are.
+  binaryRaw,
+  //! The bytes of the values are shuffled (see ByteShuffle()), then
+  //! compressed with LZCompress().
+  binaryShuffledLZ
+};
+
+//! Get the size in bytes of a value of the given type.
+inline size_t BinaryTypeWidth(const BinaryType type)
+{
+  static const size_t widths[] = { 1, 2, 4, 8, 1, 2, 4, 8, 4, 8 };
+  return widths[type];
+}
+
+//! Get the BinaryType that stores the given element type.
+template<typename eT>
+BinaryType BinaryTypeOf()
+{
+  static_assert(std::is_arithmetic<eT>::value && sizeof(eT) <= 8 &&
+      (!std::is_floating_point<eT>::value || sizeof(eT) >= 4),
+      "mlpack binary files can only hold integers and float or double "
+      "values");
+
+  const size_t index = (sizeof(eT) == 1) ? 0 : (sizeof(eT) == 2) ? 1 :
+      (sizeof(eT) == 4) ? 2 : 3;
+  if (std::is_floating_point<eT>::value)
+    return (sizeof(eT) == 4) ? binaryF32 : binaryF64;
+  else if (std::is_signed<eT>::value)
+    return BinaryType(binaryS8 + index);
+  else
+    return BinaryType(binaryU8 + index);
+}
+
+//! Append a value to a buffer.
+template<typename T>
+void PutValue(std::vector<unsigned char>& buffer, const T value)
+{
+  const size_t size = buffer.size();
+  buffer.resize(size + sizeof(T));
+  std::memcpy(buffer.data() + size, &value, sizeof(T));
+}
+
+//! Read a value from a buffer, if it isn't too short.
+template<typename T>
+bool GetValue(const unsigned char*& position,
+              const unsigned char* end,
+              T& value)
+{
+  if (size_t(end - position) < sizeof(T))
+    return false;
+
+  std::memcpy(&value, position, sizeof(T));
+  position += sizeof(T);
+  return true;
+}
+
+/**
+ * Find the narrowest type that holds all the given values exactly: an unsigned
+ * integer type if they are all small enough non-negative integers, and the
+ * type of the elements otherwise.
+ */
+template<typename eT>
+BinaryType NarrowestBinaryType(const std::vector<eT>& values)
+{
+  const BinaryType nativeType = BinaryTypeOf<eT>();
+
+  double maximum = 0.0;
+  for (const eT value : values)
+  {
+    if (!(value >= eT(0) && double(value) <= 4294967295.0) ||
+        eT(uint32_t(value)) != value || std::signbit(double(value)))
+      return nativeType;
+
+    maximum = std::max(maximum, double(value));
+  }
+
+  const BinaryType type = (maximum <= 255.0) ? binaryU8 :
+      (maximum <= 65535.0) ? binaryU16 : binaryU32;
+  return (BinaryTypeWidth(nativeType) <= BinaryTypeWidth(type)) ? nativeType :
+      type;
+}
+
+//! Store the values as the given type.
+template<typename T, typename eT>
+void StoreValues(const std::vector<eT>& values, unsigned char* bytes)
+{
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    const T value = T(values[i]);
+    std::memcpy(bytes + i * sizeof(T), &value, sizeof(T));
+  }
+}
+
+//! Store the values as the given BinaryType.
+template<typename eT>
+void StoreValues(const std::vector<eT>& values,
+                 const BinaryType type,
+                 unsigned char* bytes)
+{
+  switch (type)
+  {
+    case binaryU8:  StoreValues<uint8_t>(values, bytes); break;
+    case binaryU16: StoreValues<uint16_t>(values, bytes); break;
+    case binaryU32: StoreValues<uint32_t>(values, bytes); break;
+    case binaryU64: StoreValues<uint64_t>(values, bytes); break;
+    case binaryS8:  StoreValues<int8_t>(values, bytes); break;
+    case binaryS16: StoreValues<int16_t>(values, bytes); break;
+    case binaryS32: StoreValues<int32_t>(values, bytes); break;
+    case binaryS64: StoreValues<int64_t>(values, bytes); break;
+    case binaryF32: StoreValues<float>(values, bytes); break;
+    default:        StoreValues<double>(values, bytes); break;
+  }
+}
+
+//! Read values of the given type into a row of a matrix.
+template<typename T, typename eT>
+void ReadValues(const unsigned char* bytes,
+                const size_t count,
+                eT* row,
+                const size_t stride)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    T value;
+    std::memcpy(&value, bytes + i * sizeof(T), sizeof(T));
+    row[i * stride] = eT(value);
+  }
+}
+
+//! Read values of the given BinaryType into a row of a matrix.
+template<typename eT>
+void ReadValues(const unsigned char* bytes,
+                const BinaryType type,
+                const size_t count,
+                eT* row,
+                const size_t stride)
+{
+  switch (type)
+  {
+    case binaryU8:  ReadValues<uint8_t>(bytes, count, row, stride); break;
+    case binaryU16: ReadValues<uint16_t>(bytes, count, row, stride); break;
+    case binaryU32: ReadValues<uint32_t>(bytes, count, row, stride); break;
+    case binaryU64: ReadValues<uint64_t>(bytes, count, row, stride); break;
+    case binaryS8:  ReadValues<int8_t>(bytes, count, row, stride); break;
+    case binaryS16: ReadValues<int16_t>(bytes, count, row, stride); break;
+    case binaryS32: ReadValues<int32_t>(bytes, count, row, stride); break;
+    case binaryS64: ReadValues<int64_t>(bytes, count, row, stride); break;
+    case binaryF32: ReadValues<float>(bytes, count, row, stride); break;
+    default:        ReadValues<double>(bytes, count, row, stride); break;
+  }
+}
+
+//! Encode the given columns of the matrix as a chunk.
+template<typename eT>
+void EncodeChunk(const arma::Mat<eT>& matrix,
+                 const size_t begin,
+                 const size_t count,
+                 const bool compress,
+                 std::vector<unsigned char>& chunk)
+{
+  chunk.clear();
+  std::vector<eT> values(count);
+  std::vector<unsigned char> raw, shuffled, compressed;
+  for (size_t r = 0; r < matrix.n_rows; ++r)
+  {
+    for (size_t i = 0; i < count; ++i)
+      values[i] = matrix(r, begin + i);
+
+    const BinaryType type = NarrowestBinaryType(values);
+    const size_t width = BinaryTypeWidth(type);
+    raw.resize(count * width);
+    StoreValues(values, type, raw.data());
+
+    BinaryEncoding encoding = binaryRaw;
+    if (compress)
+    {
+      const unsigned char* input = raw.data();
+      if (width > 1)
+      {
+        shuffled.resize(raw.size());
+        ByteShuffle(raw.data(), count, width, shuffled.data());
+        input = shuffled.data();
+      }
+
+      LZCompress(input, raw.size(), compressed);
+      if (compressed.size() < raw.size())
+        encoding = binaryShuffledLZ;
+    }
+
+    const std::vector<unsigned char>& block = (encoding == binaryRaw) ? raw :
+        compressed;
+    PutValue(chunk, (unsigned char) type);
+    PutValue(chunk, (unsigned char) encoding);
+    PutValue(chunk, (uint64_t) block.size());
+    chunk.insert(chunk.end(), block.begin(), block.end());
+  }
+}
+
+//! Decode a chunk into the given columns of the matrix.  If the chunk is
+//! corrupt, false is returned.
+template<typename eT>
+bool DecodeChunk(const unsigned char* position,
+                 const unsigned char* end,
+                 const size_t begin,
+                 const size_t count,
+                 arma::Mat<eT>& matrix)
+{
+  std::vector<unsigned char> buffer, unshuffled;
+  for (size_t r = 0; r < matrix.n_rows; ++r)
+  {
+    unsigned char type, encoding;
+    uint64_t size;
+    if (!GetValue(position, end, type) || !GetValue(position, end, encoding) ||
+        !GetValue(position, end, size) || type >= binaryNumTypes ||
+        size > uint64_t(end - position))
+      return false;
+
+    const size_t width = BinaryTypeWidth(BinaryType(type));
+    const unsigned char* bytes = position;
+    position += size;
+    if (encoding == binaryRaw)
+    {
+      if (size != count * width)
+        return false;
+    }
+    else if (encoding == binaryShuffledLZ)
+    {
+      buffer.resize(count * width);
+      if (!LZDecompress(bytes, size, buffer.data(), buffer.size()))
+        return false;
+
+      bytes = buffer.data();
+      if (width > 1)
+      {
+        unshuffled.resize(buffer.size());
+        ByteUnshuffle(buffer.data(), count, width, unshuffled.data());
+        bytes = unshuffled.data();
+      }
+    }
+    else
+    {
+      return false;
+    }
+
+    ReadValues(bytes, BinaryType(type), count, matrix.colptr(begin) + r,
+        matrix.n_rows);
+  }
+
+  return (position == end);
+}
+
+//! Save the matrix with the given serialized DatasetMapper (which may be
+//! empty).
+template<typename eT>
+void WriteBinary(const std::string& filename,
+                 const arma::Mat<eT>& matrix,
+                 const std::string& mappings,
+                 const bool compress)
+{
+  std::ofstream stream(filename.c_str(), std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("cannot open file '" + filename + "' for "
+        "writing");
+
+  // Chunks of a few megabytes are large enough to compress well and small
+  // enough to be encoded in parallel without using much memory.
+  const size_t columnBytes = std::max(size_t(1), size_t(matrix.n_rows)) *
+      sizeof(eT);
+  const size_t chunkColumns = std::max(size_t(1),
+      std::min(size_t(65536), (size_t(1) << 22) / columnBytes));
+  const size_t numChunks = (matrix.n_cols + chunkColumns - 1) / chunkColumns;
+
+  std::vector<unsigned char> header(binaryMagic,
+      binaryMagic + sizeof(binaryMagic));
+  PutValue(header, binaryVersion);
+  PutValue(header, (unsigned char) BinaryTypeOf<eT>());
+  PutValue(header, (unsigned char) HostByteOrder());
+  header.resize(header.size() + 2, 0);
+  PutValue(header, (uint64_t) matrix.n_rows);
+  PutValue(header, (uint64_t) matrix.n_cols);
+  PutValue(header, (uint64_t) chunkColumns);
+  PutValue(header, (uint64_t) mappings.size());
+  stream.write((const char*) header.data(), header.size());
+  stream.write(mappings.data(), mappings.size());
+
+  // Encode a batch of chunks in parallel, then write them in order.
+  const size_t batchSize = 64;
+  std::vector<std::vector<unsigned char>> chunks(std::min(batchSize,
+      numChunks));
+  for (size_t batch = 0; batch < numChunks; batch += batchSize)
+  {
+    const size_t batchEnd = std::min(batch + batchSize, numChunks);
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t c = (omp_size_t) batch; c < (omp_size_t) batchEnd; ++c)
+    {
+      const size_t begin = c * chunkColumns;
+      EncodeChunk(matrix, begin, std::min(chunkColumns, matrix.n_cols - begin),
+          compress, chunks[c - batch]);
+    }
+
+    for (size_t c = batch; c < batchEnd; ++c)
+    {
+      const uint64_t size = chunks[c - batch].size();
+      stream.write((const char*) &size, sizeof(size));
+      stream.write((const char*) chunks[c - batch].data(), size);
+    }
+  }
+
+  if (!stream.good())
+    throw std::runtime_error("cannot write to file '" + filename + "'");
+}
+
+/**
+ * Check that the given number of bytes (the rest of a file, after the header
+ * and the mappings) can hold a matrix of the given size, so that a corrupt
+ * header can't make ReadBinary() allocate an enormous matrix.  Every chunk
+ * starts with its size and holds one block per row, a block holds at least one
+ * byte per value, and LZCompress() can't shrink anything by more than 255
+ * times.  The products are never computed, so they can't overflow.
+ */
+template<typename eT>
+bool PlausibleSize(const uint64_t numRows,
+                   const uint64_t numCols,
+                   const uint64_t chunkColumns,
+                   const uint64_t remaining)
+{
+  const uint64_t numChunks = numCols / chunkColumns +
+      ((numCols % chunkColumns) != 0);
+  if (numChunks > remaining / sizeof(uint64_t))
+    return false;
+  if (numRows == 0 || numCols == 0)
+    return true;
+
+  const uint64_t blockHeaderSize = 2 + sizeof(uint64_t);
+  const uint64_t maxCompression = 256;
+  return (numRows <= remaining / blockHeaderSize / numChunks) &&
+      (numCols / maxCompression <= remaining / numRows) &&
+      (numCols <= std::numeric_limits<size_t>::max() / sizeof(eT) / numRows);
+}
+
+//! Load the matrix and the serialized DatasetMapper (which may be empty).
+template<typename eT>
+void ReadBinary(const std::string& filename,
+                arma::Mat<eT>& matrix,
+                std::string& mappings)
+{
+  const MappedFile file(filename);
+  const unsigned char* position = (const unsigned char*) file.Data();
+  const unsigned char* end = position + file.Size();
+  const std::runtime_error corrupt("'" + filename + "' is not a valid mlpack "
+      "binary file");
+
+  char magic[sizeof(binaryMagic)];
+  uint32_t version;
+  unsigned char type, byteOrder, padding[2];
+  uint64_t numRows, numCols, chunkColumns, mappingsSize;
+  if (!GetValue(position, end, magic) ||
+      std::memcmp(magic, binaryMagic, sizeof(binaryMagic)) != 0 ||
+      !GetValue(position, end, version) || !GetValue(position, end, type) ||
+      !GetValue(position, end, byteOrder) || !GetValue(position, end, padding) ||
+      byteOrder > binaryBigEndian)
+    throw corrupt;
+
+  // The numbers are stored as they were held in memory by the host that saved
+  // the file (and so is the version).
+  if (byteOrder != HostByteOrder())
+    throw std::runtime_error("'" + filename + "' was saved on a host with "
+        "another byte order");
+
+  if (version != binaryVersion)
+  {
+    std::ostringstream oss;
+    oss << "'" << filename << "' has version " << version << " of the mlpack "
+        << "binary format; only version " << binaryVersion << " is supported";
+    throw std::runtime_error(oss.str());
+  }
+
+  if (!GetValue(position, end, numRows) || !GetValue(position, end, numCols) ||
+      !GetValue(position, end, chunkColumns) ||
+      !GetValue(position, end, mappingsSize) || type >= binaryNumTypes ||
+      chunkColumns == 0 || mappingsSize > uint64_t(end - position))
+    throw corrupt;
+
+  mappings.assign((const char*) position, mappingsSize);
+  position += mappingsSize;
+  if (!PlausibleSize<eT>(numRows, numCols, chunkColumns,
+      uint64_t(end - position)))
+    throw corrupt;
+
+  // Find the chunks, so that they can be decoded in parallel.
+  const size_t numChunks = (numCols + chunkColumns - 1) / chunkColumns;
+  std::vector<const unsigned char*> chunkBegins(numChunks);
+  std::vector<const unsigned char*> chunkEnds(numChunks);
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    uint64_t size;
+    if (!GetValue(position, end, size) || size > uint64_t(end - position))
+      throw corrupt;
+
+    chunkBegins[c] = position;
+    position += size;
+    chunkEnds[c] = position;
+  }
+  if (position != end)
+    throw corrupt;
+
+  matrix.set_size(numRows, numCols);
+  std::vector<char> valid(numChunks, 1);
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
+  {
+    const size_t begin = c * chunkColumns;
+    valid[c] = DecodeChunk(chunkBegins[c], chunkEnds[c], begin,
+        std::min(size_t(chunkColumns), size_t(numCols) - begin), matrix);
+  }
+
+  if (std::find(valid.begin(), valid.end(), 0) != valid.end())
+    throw corrupt;
+}
+
+} // namespace details
+
+template<typename eT>
+void SaveBinary(const std::string& filename,
+                const arma::Mat<eT>& matrix,
+                const bool compress)
+{
+  details::WriteBinary(filename, matrix, std::string(), compress);
+}
+
+template<typename eT, typename PolicyType>
+void SaveBinary(const std::string& filename,
+                const arma::Mat<eT>& matrix,
+                const DatasetMapper<PolicyType>& info,
+                const bool compress)
+{
+  if (info.Dimensionality() != matrix.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "SaveBinary(): the DatasetMapper has " << info.Dimensionality()
+        << " dimensions, but the matrix has " << matrix.n_rows << " rows";
+    throw std::invalid_argument(oss.str());
+  }
+
+  std::ostringstream oss(std::ios::binary);
+  {
+    boost::archive::binary_oarchive ar(oss);
+    ar << info;
+  }
+
+  details::WriteBinary(filename, matrix, oss.str(), compress);
+}
+
+template<typename eT>
+void LoadBinary(const std::string& filename, arma::Mat<eT>& matrix)
+{
+  std::string mappings;
+  details::ReadBinary(filename, matrix, mappings);
+}
+
+template<typename eT, typename PolicyType>
+void LoadBinary(const std::string& filename,
+                arma::Mat<eT>& matrix,
+                DatasetMapper<PolicyType>& info)
+{
+  std::string mappings;
+  details::ReadBinary(filename, matrix, mappings);
+
+  if (mappings.empty())
+  {
+    info = DatasetMapper<PolicyType>(info.Policy(), matrix.n_rows);
+  }
+  else
+  {
+    std::istringstream iss(mappings, std::ios::binary);
+    boost::archive::binary_iarchive ar(iss);
+    ar >> info;
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -1,5 +1,11 @@
 #include "load_csv.hpp"
 
+#include <cstring>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace boost::spirit;
 
 namespace mlpack {
@@ -16,17 +22,20 @@ LoadCSV::LoadCSV(const std::string& file) :
   // Set rules.
   if (extension == "csv" || extension == "txt")
   {
+    stopChar = ',';
     // Match all characters that are not ',', '\r', or '\n'.
     stringRule = qi::raw[*~qi::char_(" ,\r\n")];
   }
   else
   {
+    stopChar = '\t';
     // Match all characters that are not '\t', '\r', or '\n'.
     stringRule = qi::raw[*~qi::char_(" \t\r\n")];
   }
 
   if (extension == "csv")
   {
+    delimiter = ',';
     // Extract a single comma as the delimiter, catching whitespace on either
     // side.
     delimiterRule = qi::raw[(*qi::char_(" ") >> qi::char_(",") >>
@@ -34,12 +43,14 @@ LoadCSV::LoadCSV(const std::string& file) :
   }
   else if (extension == "txt")
   {
+    delimiter = ' ';
     // This one is a little more difficult, we need to catch any number of
     // spaces more than one.
     delimiterRule = qi::raw[+qi::char_(" ")];
   }
   else // TSV.
   {
+    delimiter = '\t';
     // Catch a tab character, possibly with whitespace on either side.
     delimiterRule = qi::raw[(*qi::char_(" ") >> qi::char_("\t") >>
         *qi::char_(" "))];
@@ -58,5 +69,57 @@ void LoadCSV::CheckOpen()
   inFile.unsetf(std::ios::skipws);
 }
 
+void LoadCSV::SplitChunks(const char* data,
+                          const size_t size,
+                          std::vector<Chunk>& chunks)
+{
+  // Use a few chunks per thread, so that threads that get short lines don't
+  // wait for the others, but don't bother splitting small files.
+  size_t numThreads = 1;
+  #ifdef HAS_OPENMP
+    numThreads = omp_get_max_threads();
+  #endif
+  const size_t minChunkSize = 1 << 20;
+  const size_t numChunks = std::max(size_t(1),
+      std::min(size / minChunkSize, 4 * numThreads));
+
+  // Move each boundary to the start of the next line.
+  chunks.resize(numChunks);
+  size_t begin = 0;
+  for (size_t i = 0; i < numChunks; ++i)
+  {
+    size_t end = size;
+    if (i + 1 < numChunks)
+    {
+      end = std::max(begin, size * (i + 1) / numChunks);
+      const char* newline = (const char*) std::memchr(data + end, '\n',
+          size - end);
+      end = (newline == NULL) ? size : (newline - data) + 1;
+    }
+
+    chunks[i].begin = begin;
+    chunks[i].end = end;
+    begin = end;
+  }
+
+  // Count the lines of each chunk.  Like std::getline(), a last line without
+  // a newline is still a line.
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) numChunks; ++i)
+  {
+    chunks[i].numLines = std::count(data + chunks[i].begin,
+        data + chunks[i].end, '\n');
+    if (chunks[i].end > chunks[i].begin && data[chunks[i].end - 1] != '\n')
+      ++chunks[i].numLines;
+  }
+
+  size_t firstLine = 0;
+  for (size_t i = 0; i < numChunks; ++i)
+  {
+    chunks[i].firstLine = firstLine;
+    firstLine += chunks[i].numLines;
+  }
+}
+
 } // namespace data
 } // namespace mlpack
@@ -32,6 +32,9 @@ namespace data {
  *Load the csv file.This class use boost::spirit
  *to implement the parser, please refer to following link
  *http://theboostcpplibraries.com/boost.spirit for quick review.
+ *
+ * Load() itself reads the memory-mapped file in one parallel pass, with a
+ * hand-written tokenizer that follows the same rules.
  */
 class LoadCSV
 {
@@ -46,6 +49,15 @@ class LoadCSV
    * Load the file into the given matrix with the given DatasetMapper object.
    * Throws exceptions on errors.
    *
+   * The file is mapped into memory and split into chunks of whole lines that
+   * are parsed in parallel (when OpenMP is available), straight into the
+   * output matrix.  Tokens that can be read as numbers are converted
+   * directly; the DatasetMapper is only used for the dimensions that hold
+   * some other token (or for every dimension, if the policy may also map
+   * numbers).  The strings of those dimensions are gathered from all chunks
+   * and passed to the DatasetMapper in the order in which they appear in the
+   * file, so the mappings are the same as with a sequential load.
+   *
    * @param inout Matrix to load into.
    * @param infoSet DatasetMapper to use while loading.
    * @param transpose If true, the matrix should be transposed on loading
@@ -54,15 +66,7 @@ class LoadCSV
   template<typename T, typename PolicyType>
   void Load(arma::Mat<T> &inout,
             DatasetMapper<PolicyType> &infoSet,
-            const bool transpose = true)
-  {
-    CheckOpen();
-
-    if (transpose)
-      TransposeParse(inout, infoSet);
-    else
-      NonTransposeParse(inout, infoSet);
-  }
+            const bool transpose = true);
 
   /**
    * Peek at the file to determine the number of rows and columns in the matrix,
@@ -214,148 +218,67 @@ class LoadCSV
   void CheckOpen();
 
   /**
-   * Parse a non-transposed matrix.
-   *
-   * @param inout Matrix to load into.
-   * @param infoSet DatasetMapper object to load with.
+   * A range of the mapped file that holds whole lines.
    */
-  template<typename T, typename PolicyType>
-  void NonTransposeParse(arma::Mat<T>& inout,
-                         DatasetMapper<PolicyType>& infoSet)
+  struct Chunk
   {
-    using namespace boost::spirit;
-
-    // Get the size of the matrix.
-    size_t rows, cols;
-    GetMatrixSize<T>(rows, cols, infoSet);
-
-    // Set up output matrix.
-    inout.set_size(rows, cols);
-    size_t row = 0;
-    size_t col = 0;
-
-    // Reset file position.
-    std::string line;
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-
-    auto setCharClass = [&](iter_type const &iter)
-    {
-      std::string str(iter.begin(), iter.end());
-      if (str == "\t")
-      {
-        str.clear();
-      }
-      boost::trim(str);
-
-      inout(row, col++) = infoSet.template MapString<T>(std::move(str), row);
-    };
-
-    while (std::getline(inFile, line))
-    {
-      // Remove whitespace from either side.
-      boost::trim(line);
-
-      // Parse the numbers from a line (ex: 1,2,3,4); if the parser finds a
-      // number it will execute the setNum function.
-      const bool canParse = qi::parse(line.begin(), line.end(),
-          stringRule[setCharClass] % delimiterRule);
-
-      // Make sure we got the right number of rows.
-      if (col != cols)
-      {
-        std::ostringstream oss;
-        oss << "LoadCSV::NonTransposeParse(): wrong number of dimensions ("
-            << col << ") on line " << row << "; should be " << cols
-            << " dimensions.";
-        throw std::runtime_error(oss.str());
-      }
-
-      if (!canParse)
-      {
-        std::ostringstream oss;
-        oss << "LoadCSV::NonTransposeParse(): parsing error on line " << col
-            << "!";
-        throw std::runtime_error(oss.str());
-      }
-
-      ++row; col = 0;
-    }
-  }
+    //! Offset of the first character of the chunk.
+    size_t begin;
+    //! Offset one past the last character of the chunk.
+    size_t end;
+    //! Index of the first line of the chunk in the file.
+    size_t firstLine;
+    //! Number of lines in the chunk.
+    size_t numLines;
+  };
 
   /**
-   * Parse a transposed matrix.
+   * Split the given data into chunks of whole lines, and count the lines of
+   * each chunk.
    *
-   * @param inout Matrix to load into.
-   * @param infoSet DatasetMapper to load with.
+   * @param data Start of the data.
+   * @param size Size of the data in bytes.
+   * @param chunks Vector to store the chunks in.
    */
-  template<typename T, typename PolicyType>
-  void TransposeParse(arma::Mat<T>& inout, DatasetMapper<PolicyType>& infoSet)
-  {
-    using namespace boost::spirit;
-
-    // Get matrix size.  This also initializes infoSet correctly.
-    size_t rows, cols;
-    GetTransposeMatrixSize<T>(rows, cols, infoSet);
-
-    // Set the matrix size.
-    inout.set_size(rows, cols);
-
-    // Initialize auxiliary variables.
-    size_t row = 0;
-    size_t col = 0;
-    std::string line;
-    inFile.clear();
-    inFile.seekg(0, std::ios::beg);
-
-    /**
-     * This is the parse rule for strings.  When we get a string we have to pass
-     * it to the DatasetMapper.
-     */
-    auto parseString = [&](iter_type const &iter)
-    {
-      // All parsed values must be mapped.
-      std::string str(iter.begin(), iter.end());
-      boost::trim(str);
-
-      inout(row, col) = infoSet.template MapString<T>(std::move(str), row);
-      ++row;
-    };
-
-    while (std::getline(inFile, line))
-    {
-      // Remove whitespace from either side.
-      boost::trim(line);
-
-      // Reset the row we are looking at.  (Remember this is transposed.)
-      row = 0;
+  static void SplitChunks(const char* data,
+                          const size_t size,
+                          std::vector<Chunk>& chunks);
 
-      // Now use boost::spirit to parse the characters of the line;
-      // parseString() will be called when a token is detected.
-      const bool canParse = qi::parse(line.begin(), line.end(),
-          stringRule[parseString] % delimiterRule);
+  /**
+   * Split the given line into tokens, with the same rules as the boost::spirit
+   * parser, and call f(tokenBegin, tokenEnd) for each token.  Returns false if
+   * the line does not follow the format of the file.
+   *
+   * @param begin Start of the line.
+   * @param end End of the line (not including the newline).
+   * @param f Function to call for each token.
+   */
+  template<typename FunctionType>
+  bool ParseLine(const char* begin,
+                 const char* end,
+                 FunctionType&& f) const;
 
-      // Make sure we got the right number of rows.
-      if (row != rows)
-      {
-        std::ostringstream oss;
-        oss << "LoadCSV::TransposeParse(): wrong number of dimensions (" << row
-            << ") on line " << col << "; should be " << rows << " dimensions.";
-        throw std::runtime_error(oss.str());
-      }
+  /**
+   * Call f(line, lineBegin, lineEnd) for each line of the given chunk.
+   */
+  template<typename FunctionType>
+  static void ForEachLine(const char* data,
+                          const Chunk& chunk,
+                          FunctionType&& f);
 
-      if (!canParse)
-      {
-        std::ostringstream oss;
-        oss << "LoadCSV::TransposeParse(): parsing error on line " << col
-            << "!";
-        throw std::runtime_error(oss.str());
-      }
+  /**
+   * Convert the given token to a number, if it can be read as one in the same
+   * way as with a stringstream.  This only accepts plain decimal numbers;
+   * anything else is left to the DatasetMapper.  Returns false if the token
+   * was not converted.
+   */
+  template<typename T>
+  static bool ParseNumber(const char* begin, const char* end, T& value);
 
-      // Increment the column index.
-      ++col;
-    }
-  }
+  //! The character (other than ' ', '\r' and '\n') that ends a token.
+  char stopChar;
+  //! The character between tokens, or ' ' if tokens are separated by spaces.
+  char delimiter;
 
   //! Spirit rule for parsing.
   boost::spirit::qi::rule<std::string::iterator, iter_type()> stringRule;
@@ -373,4 +296,7 @@ class LoadCSV
 } // namespace data
 } // namespace mlpack
 
+// Include implementation.
+#include "load_csv_impl.hpp"
+
 #endif
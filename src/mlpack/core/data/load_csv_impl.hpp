@@ -0,0 +1,387 @@
+/**
+ * @file load_csv_impl.hpp
+ *
+ * Implementation of the chunked, parallel parser of LoadCSV.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LOAD_CSV_IMPL_HPP
+#define MLPACK_CORE_DATA_LOAD_CSV_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "load_csv.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <mlpack/core/util/sfinae_utility.hpp>
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+HAS_MEM_FUNC(MapsNumbers, HasMapsNumbers);
+
+//! Ask the policy whether it may map inputs that can be read as numbers.
+template<typename PolicyType>
+bool PolicyMapsNumbers(
+    const PolicyType& policy,
+    const typename std::enable_if<HasMapsNumbers<PolicyType,
+        bool(PolicyType::*)() const>::value>::type* = 0)
+{
+  return policy.MapsNumbers();
+}
+
+//! If the policy can't tell, assume that it may map inputs that can be read as
+//! numbers, so that every input is passed to it.
+template<typename PolicyType>
+bool PolicyMapsNumbers(
+    const PolicyType& /* policy */,
+    const typename std::enable_if<!HasMapsNumbers<PolicyType,
+        bool(PolicyType::*)() const>::value>::type* = 0)
+{
+  return true;
+}
+
+//! Convert a null-terminated string to a floating-point number; the whole
+//! string must be used.
+inline bool ConvertNumber(const char* str, const size_t length, double& value)
+{
+  char* end;
+  errno = 0;
+  value = std::strtod(str, &end);
+  return (end == str + length) && (errno != ERANGE);
+}
+
+inline bool ConvertNumber(const char* str, const size_t length, float& value)
+{
+  char* end;
+  errno = 0;
+  value = std::strtof(str, &end);
+  return (end == str + length) && (errno != ERANGE);
+}
+
+inline bool ConvertNumber(const char* str,
+                          const size_t length,
+                          long double& value)
+{
+  char* end;
+  errno = 0;
+  value = std::strtold(str, &end);
+  return (end == str + length) && (errno != ERANGE);
+}
+
+//! Convert a null-terminated string to an integer; the whole string must be
+//! used, and the number must fit in the type.
+template<typename T>
+bool ConvertNumber(
+    const char* str,
+    const size_t length,
+    T& value,
+    const typename std::enable_if<std::is_integral<T>::value>::type* = 0)
+{
+  char* end;
+  errno = 0;
+  if (std::is_signed<T>::value)
+  {
+    const long long result = std::strtoll(str, &end, 10);
+    if (end != str + length || errno == ERANGE ||
+        result < (long long) std::numeric_limits<T>::min() ||
+        result > (long long) std::numeric_limits<T>::max())
+      return false;
+
+    value = T(result);
+  }
+  else
+  {
+    // strtoull() accepts negative numbers and wraps them around.
+    if (str[0] == '-')
+      return false;
+
+    const unsigned long long result = std::strtoull(str, &end, 10);
+    if (end != str + length || errno == ERANGE ||
+        result > (unsigned long long) std::numeric_limits<T>::max())
+      return false;
+
+    value = T(result);
+  }
+
+  return true;
+}
+
+template<typename T, typename PolicyType>
+void LoadCSV::Load(arma::Mat<T>& inout,
+                   DatasetMapper<PolicyType>& infoSet,
+                   const bool transpose)
+{
+  CheckOpen();
+
+  const MappedFile file(filename);
+  const char* data = file.Data();
+
+  std::vector<Chunk> chunks;
+  SplitChunks(data, file.Size(), chunks);
+  const size_t numLines = chunks.back().firstLine + chunks.back().numLines;
+
+  // The number of tokens on the first line is the number of dimensions (or
+  // the number of points, if the matrix is not transposed).
+  size_t numTokens = 0;
+  if (numLines > 0)
+  {
+    const char* newline = (const char*) std::memchr(data, '\n', file.Size());
+    ParseLine(data, (newline == NULL) ? data + file.Size() : newline,
+        [&numTokens](const char*, const char*) { ++numTokens; });
+  }
+
+  // Each line is a point of a transposed matrix, and a dimension otherwise.
+  const size_t numDimensions = transpose ? numTokens : numLines;
+  infoSet = DatasetMapper<PolicyType>(infoSet.Policy(), numDimensions);
+  if (transpose)
+    inout.set_size(numTokens, numLines);
+  else
+    inout.set_size(numLines, numTokens);
+
+  // The dimensions whose tokens are passed to the DatasetMapper.  If the
+  // policy may map numbers, that has to be done for all dimensions.
+  const bool mapsNumbers = PolicyMapsNumbers(infoSet.Policy());
+  std::vector<char> mapped(numDimensions, mapsNumbers ? 1 : 0);
+
+  // First, parse every chunk, converting the tokens that are plain numbers
+  // and marking the dimensions that hold anything else.
+  std::vector<std::string> errors(chunks.size());
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks.size(); ++c)
+  {
+    ForEachLine(data, chunks[c], [&](const size_t line,
+                                     const char* lineBegin,
+                                     const char* lineEnd)
+    {
+      if (!errors[c].empty())
+        return;
+
+      size_t token = 0;
+      const bool canParse = ParseLine(lineBegin, lineEnd,
+          [&](const char* tokenBegin, const char* tokenEnd)
+      {
+        if (!mapsNumbers && token < numTokens)
+        {
+          T& value = transpose ? inout(token, line) : inout(line, token);
+          if (!ParseNumber(tokenBegin, tokenEnd, value))
+          {
+            const size_t dimension = transpose ? token : line;
+            #pragma omp atomic write
+            mapped[dimension] = 1;
+          }
+        }
+        ++token;
+      });
+
+      // Make sure we got the right number of dimensions.
+      std::ostringstream oss;
+      if (token != numTokens)
+      {
+        oss << "LoadCSV::Load(): wrong number of dimensions (" << token
+            << ") on line " << line << "; should be " << numTokens
+            << " dimensions.";
+        errors[c] = oss.str();
+      }
+      else if (!canParse)
+      {
+        oss << "LoadCSV::Load(): parsing error on line " << line << "!";
+        errors[c] = oss.str();
+      }
+    });
+  }
+
+  // Report the first error in the file.
+  for (size_t c = 0; c < chunks.size(); ++c)
+    if (!errors[c].empty())
+      throw std::runtime_error(errors[c]);
+
+  if (std::find(mapped.begin(), mapped.end(), 1) == mapped.end())
+    return;
+
+  // Collect the distinct strings of each mapped dimension in each chunk, in
+  // the order in which they first appear.
+  typedef std::unordered_map<size_t, std::vector<std::string>> StringLists;
+  std::vector<StringLists> chunkStrings(chunks.size());
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks.size(); ++c)
+  {
+    std::unordered_map<size_t, std::unordered_set<std::string>> seen;
+    ForEachLine(data, chunks[c], [&](const size_t line,
+                                     const char* lineBegin,
+                                     const char* lineEnd)
+    {
+      size_t token = 0;
+      ParseLine(lineBegin, lineEnd,
+          [&](const char* tokenBegin, const char* tokenEnd)
+      {
+        const size_t dimension = transpose ? token++ : line;
+        if (!mapped[dimension])
+          return;
+
+        std::string str(tokenBegin, tokenEnd);
+        if (seen[dimension].insert(str).second)
+          chunkStrings[c][dimension].push_back(std::move(str));
+      });
+    });
+  }
+
+  // Merge the lists in the order of the chunks, so that the DatasetMapper
+  // sees each string in the order in which it first appears in the file, and
+  // gets the same mappings as with a sequential load.
+  std::map<size_t, std::vector<std::string>> strings;
+  std::unordered_map<size_t, std::unordered_map<std::string, T>> values;
+  for (size_t c = 0; c < chunks.size(); ++c)
+  {
+    for (std::pair<const size_t, std::vector<std::string>>& list :
+         chunkStrings[c])
+    {
+      std::unordered_map<std::string, T>& dimensionValues = values[list.first];
+      for (std::string& str : list.second)
+      {
+        if (dimensionValues.insert(std::make_pair(str, T())).second)
+          strings[list.first].push_back(std::move(str));
+      }
+    }
+    chunkStrings[c].clear();
+  }
+
+  if (PolicyType::NeedsFirstPass)
+  {
+    for (const std::pair<const size_t, std::vector<std::string>>& list :
+         strings)
+      for (const std::string& str : list.second)
+        infoSet.template MapFirstPass<T>(str, list.first);
+  }
+
+  for (const std::pair<const size_t, std::vector<std::string>>& list : strings)
+    for (const std::string& str : list.second)
+      values[list.first][str] = infoSet.template MapString<T>(str, list.first);
+
+  // Now fill in the tokens of the mapped dimensions.
+  const std::unordered_map<size_t, std::unordered_map<std::string, T>>&
+      mappedValues = values;
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks.size(); ++c)
+  {
+    ForEachLine(data, chunks[c], [&](const size_t line,
+                                     const char* lineBegin,
+                                     const char* lineEnd)
+    {
+      size_t token = 0;
+      ParseLine(lineBegin, lineEnd,
+          [&](const char* tokenBegin, const char* tokenEnd)
+      {
+        const size_t dimension = transpose ? token : line;
+        if (mapped[dimension])
+        {
+          T& value = transpose ? inout(token, line) : inout(line, token);
+          value = mappedValues.at(dimension).at(std::string(tokenBegin,
+              tokenEnd));
+        }
+        ++token;
+      });
+    });
+  }
+}
+
+template<typename FunctionType>
+bool LoadCSV::ParseLine(const char* begin,
+                        const char* end,
+                        FunctionType&& f) const
+{
+  // Remove whitespace from either side.
+  while (begin < end && std::isspace((unsigned char) *begin))
+    ++begin;
+  while (end > begin && std::isspace((unsigned char) *(end - 1)))
+    --end;
+
+  while (true)
+  {
+    const char* tokenBegin = begin;
+    while (begin < end && *begin != ' ' && *begin != stopChar &&
+        *begin != '\r' && *begin != '\n')
+      ++begin;
+    f(tokenBegin, begin);
+
+    if (begin == end)
+      return true;
+
+    // Match the delimiter, with any spaces on either side of it.
+    const char* next = begin;
+    while (next < end && *next == ' ')
+      ++next;
+    if (delimiter != ' ')
+    {
+      if (next == end || *next != delimiter)
+        return false;
+
+      ++next;
+      while (next < end && *next == ' ')
+        ++next;
+    }
+    else if (next == begin)
+    {
+      return false;
+    }
+
+    begin = next;
+  }
+}
+
+template<typename FunctionType>
+void LoadCSV::ForEachLine(const char* data,
+                          const Chunk& chunk,
+                          FunctionType&& f)
+{
+  const char* position = data + chunk.begin;
+  const char* end = data + chunk.end;
+  for (size_t line = chunk.firstLine; position < end; ++line)
+  {
+    const char* newline = (const char*) std::memchr(position, '\n',
+        end - position);
+    const char* lineEnd = (newline == NULL) ? end : newline;
+    f(line, position, lineEnd);
+    position = lineEnd + 1;
+  }
+}
+
+template<typename T>
+bool LoadCSV::ParseNumber(const char* begin, const char* end, T& value)
+{
+  // strtod() also accepts things like "inf", "nan" and hexadecimal numbers,
+  // which a stringstream does not, so only plain decimal numbers are
+  // converted here.
+  const size_t length = end - begin;
+  char buffer[64];
+  if (length == 0 || length >= sizeof(buffer))
+    return false;
+
+  for (size_t i = 0; i < length; ++i)
+  {
+    const char c = begin[i];
+    if (!std::isdigit((unsigned char) c) && c != '+' && c != '-' && c != '.' &&
+        c != 'e' && c != 'E')
+      return false;
+
+    buffer[i] = c;
+  }
+  buffer[length] = '\0';
+
+  return ConvertNumber(buffer, length, value);
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
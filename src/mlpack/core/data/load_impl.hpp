@@ -27,6 +27,7 @@
 #include <boost/algorithm/string.hpp>
 
 #include "load_arff.hpp"
+#include "binary_format.hpp"
 
 namespace mlpack {
 namespace data {
@@ -107,6 +108,38 @@ bool Load(const std::string& filename,
     return false;
   }
 
+  // mlpack binary files are loaded by us, not by Armadillo.
+  if (extension == "mlbin")
+  {
+    Log::Info << "Loading '" << filename << "' as mlpack binary formatted "
+        << "data.  " << std::flush;
+    try
+    {
+      LoadBinary(filename, matrix);
+    }
+    catch (std::exception& e)
+    {
+      Log::Info << std::endl;
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+
+    Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
+        << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
+
+    // The file holds the matrix as it is stored in memory.
+    if (!transpose)
+      inplace_transpose(matrix);
+
+    Timer::Stop("loading_data");
+    return true;
+  }
+
   bool unknownType = false;
   arma::file_type loadType;
   std::string stringType;
@@ -371,6 +404,29 @@ bool Load(const std::string& filename,
       return false;
     }
   }
+  else if (extension == "mlbin")
+  {
+    Log::Info << "Loading '" << filename << "' as mlpack binary dataset.  "
+        << std::flush;
+    try
+    {
+      LoadBinary(filename, matrix, info);
+
+      // The file holds the matrix as it is stored in memory.
+      if (!transpose)
+        inplace_transpose(matrix);
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+  }
   else
   {
     // The type is unknown.
@@ -0,0 +1,198 @@
+/**
+ * @file lz_codec.cpp
+ *
+ * Implementation of the LZ compressor and of the byte shuffle.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "lz_codec.hpp"
+
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+//! The shortest match that is encoded.
+static const size_t minMatch = 4;
+//! The farthest back a match can be.
+static const size_t maxOffset = 65535;
+//! The number of bits of the hash of four bytes.
+static const size_t hashBits = 14;
+
+//! Append a length that didn't fit in its four bits of the token.
+static void PutLength(std::vector<unsigned char>& output, size_t length)
+{
+  while (length >= 255)
+  {
+    output.push_back(255);
+    length -= 255;
+  }
+  output.push_back((unsigned char) length);
+}
+
+//! Read the rest of a length that didn't fit in its four bits of the token.
+static bool GetLength(const unsigned char*& input,
+                      const unsigned char* end,
+                      size_t& length)
+{
+  unsigned char byte;
+  do
+  {
+    if (input == end)
+      return false;
+
+    byte = *input++;
+    length += byte;
+  } while (byte == 255);
+
+  return true;
+}
+
+/**
+ * Append a sequence: the literals, then the match if there is one (that is,
+ * if matchLength is not 0).
+ */
+static void PutSequence(std::vector<unsigned char>& output,
+                        const unsigned char* literals,
+                        const size_t numLiterals,
+                        const size_t offset,
+                        const size_t matchLength)
+{
+  const size_t matchCode = (matchLength == 0) ? 0 : matchLength - minMatch;
+  output.push_back((unsigned char) ((std::min(numLiterals, size_t(15)) << 4) |
+      std::min(matchCode, size_t(15))));
+  if (numLiterals >= 15)
+    PutLength(output, numLiterals - 15);
+  output.insert(output.end(), literals, literals + numLiterals);
+
+  if (matchLength == 0)
+    return;
+
+  output.push_back((unsigned char) (offset & 0xFF));
+  output.push_back((unsigned char) (offset >> 8));
+  if (matchCode >= 15)
+    PutLength(output, matchCode - 15);
+}
+
+void LZCompress(const unsigned char* input,
+                const size_t size,
+                std::vector<unsigned char>& output)
+{
+  output.clear();
+  output.reserve(size + size / 255 + 16);
+
+  // The last position seen for each hash of four bytes.
+  const size_t none = size_t(-1);
+  std::vector<size_t> table(size_t(1) << hashBits, none);
+
+  size_t anchor = 0;
+  size_t position = 0;
+  while (position + minMatch <= size)
+  {
+    uint32_t bytes;
+    std::memcpy(&bytes, input + position, sizeof(bytes));
+    const size_t hash = (bytes * 2654435761u) >> (32 - hashBits);
+    const size_t candidate = table[hash];
+    table[hash] = position;
+
+    if (candidate == none || position - candidate > maxOffset ||
+        std::memcmp(input + candidate, input + position, minMatch) != 0)
+    {
+      ++position;
+      continue;
+    }
+
+    // Extend the match as far as it goes.
+    size_t length = minMatch;
+    while (position + length < size &&
+        input[candidate + length] == input[position + length])
+      ++length;
+
+    PutSequence(output, input + anchor, position - anchor,
+        position - candidate, length);
+    position += length;
+    anchor = position;
+  }
+
+  // The rest of the input is literals.
+  if (anchor < size)
+    PutSequence(output, input + anchor, size - anchor, 0, 0);
+}
+
+bool LZDecompress(const unsigned char* input,
+                  const size_t inputSize,
+                  unsigned char* output,
+                  const size_t outputSize)
+{
+  const unsigned char* end = input + inputSize;
+  size_t position = 0;
+  while (position < outputSize)
+  {
+    if (input == end)
+      return false;
+
+    const unsigned char token = *input++;
+    size_t numLiterals = token >> 4;
+    if (numLiterals == 15 && !GetLength(input, end, numLiterals))
+      return false;
+
+    if (numLiterals > size_t(end - input) ||
+        numLiterals > outputSize - position)
+      return false;
+
+    std::memcpy(output + position, input, numLiterals);
+    input += numLiterals;
+    position += numLiterals;
+
+    // The last sequence has no match.
+    if (position == outputSize)
+      break;
+
+    if (end - input < 2)
+      return false;
+
+    const size_t offset = size_t(input[0]) | (size_t(input[1]) << 8);
+    input += 2;
+    size_t length = token & 0x0F;
+    if (length == 15 && !GetLength(input, end, length))
+      return false;
+    length += minMatch;
+
+    if (offset == 0 || offset > position || length > outputSize - position)
+      return false;
+
+    // The match may overlap the bytes it produces, so copy byte by byte.
+    const unsigned char* match = output + position - offset;
+    for (size_t i = 0; i < length; ++i)
+      output[position + i] = match[i];
+    position += length;
+  }
+
+  return (input == end);
+}
+
+void ByteShuffle(const unsigned char* input,
+                 const size_t count,
+                 const size_t width,
+                 unsigned char* output)
+{
+  for (size_t i = 0; i < count; ++i)
+    for (size_t b = 0; b < width; ++b)
+      output[b * count + i] = input[i * width + b];
+}
+
+void ByteUnshuffle(const unsigned char* input,
+                   const size_t count,
+                   const size_t width,
+                   unsigned char* output)
+{
+  for (size_t b = 0; b < width; ++b)
+    for (size_t i = 0; i < count; ++i)
+      output[i * width + b] = input[b * count + i];
+}
+
+} // namespace data
+} // namespace mlpack
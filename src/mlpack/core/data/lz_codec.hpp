@@ -0,0 +1,80 @@
+/**
+ * @file lz_codec.hpp
+ *
+ * A small, fast LZ77 byte compressor in the style of LZ4, used to compress the
+ * blocks of mlpack binary matrix files.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LZ_CODEC_HPP
+#define MLPACK_CORE_DATA_LZ_CODEC_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Compress the given bytes.  The compressed stream is a list of sequences,
+ * each of which is a run of literal bytes followed by a match: a copy of
+ * earlier output, given by its offset (up to 65535 bytes back) and its length
+ * (at least 4 bytes).  The last sequence has no match.  The format follows
+ * LZ4: compression is a single greedy pass with a hash table of recent
+ * positions, and decompression is little more than a sequence of copies.
+ *
+ * The size of the input isn't stored, so it has to be given to
+ * LZDecompress().
+ *
+ * @param input Bytes to compress.
+ * @param size Number of bytes to compress.
+ * @param output Vector to store the compressed bytes in.
+ */
+void LZCompress(const unsigned char* input,
+                const size_t size,
+                std::vector<unsigned char>& output);
+
+/**
+ * Decompress bytes compressed with LZCompress().  The input is checked as it
+ * is decoded, so a corrupt input makes this return false instead of reading
+ * or writing out of bounds.
+ *
+ * @param input Compressed bytes.
+ * @param inputSize Number of compressed bytes.
+ * @param output Buffer to store the decompressed bytes in.
+ * @param outputSize Number of decompressed bytes.
+ * @return Whether the input decompressed to exactly outputSize bytes.
+ */
+bool LZDecompress(const unsigned char* input,
+                  const size_t inputSize,
+                  unsigned char* output,
+                  const size_t outputSize);
+
+/**
+ * Group the bytes of the given elements by their position in the element: the
+ * first bytes of all elements come first, then the second bytes, and so on.
+ * The high bytes of numbers that are close to each other are often the same,
+ * so this makes numeric data much easier to compress.
+ *
+ * @param input Elements to shuffle.
+ * @param count Number of elements.
+ * @param width Size of each element in bytes.
+ * @param output Buffer to store the shuffled bytes in (count * width bytes).
+ */
+void ByteShuffle(const unsigned char* input,
+                 const size_t count,
+                 const size_t width,
+                 unsigned char* output);
+
+//! Undo ByteShuffle().
+void ByteUnshuffle(const unsigned char* input,
+                   const size_t count,
+                   const size_t width,
+                   unsigned char* output);
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -42,6 +42,13 @@ class IncrementPolicy
   //! We do need a first pass over the data to set the dimension types right.
   static const bool NeedsFirstPass = true;
 
+  /**
+   * Return whether an input that can be read as a number might still be
+   * mapped, even in a dimension where every input can be read as a number.
+   * This is only the case if all mappings are forced.
+   */
+  bool MapsNumbers() const { return forceAllMappings; }
+
   /**
    * Determine if the dimension is numeric or categorical.
    */
@@ -54,6 +54,26 @@ class MissingPolicy
   //! This doesn't need a first pass over the data to set up.
   static const bool NeedsFirstPass = false;
 
+  /**
+   * Return whether a string that can be read as a number might still be
+   * mapped, even in a dimension where every string can be read as a number.
+   * This is the case if one of the strings in the missingSet is a number.
+   */
+  bool MapsNumbers() const
+  {
+    for (const std::string& missing : missingSet)
+    {
+      std::stringstream token;
+      token.str(missing);
+      double t;
+      token >> t;
+      if (!token.fail() && token.eof())
+        return true;
+    }
+
+    return false;
+  }
+
   /**
    * There is nothing for us to do here, but this is required by the MapPolicy
    * type.
@@ -0,0 +1,100 @@
+/**
+ * @file mapped_file.cpp
+ *
+ * Implementation of MappedFile.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace mlpack {
+namespace data {
+
+MappedFile::MappedFile(const std::string& filename) :
+    filename(filename),
+    data(NULL),
+    size(0)
+{
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    throw std::runtime_error("cannot get the size of file '" + filename + "'");
+  }
+  size = (size_t) fileStat.st_size;
+
+  if (size > 0)
+  {
+    // A private mapping lets the data be modified in memory (for instance by
+    // a tree that reorders its points) without touching the file.
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+        0);
+    if (mapping == MAP_FAILED)
+    {
+      close(fd);
+      throw std::runtime_error("cannot map file '" + filename + "'");
+    }
+    data = (char*) mapping;
+  }
+
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+#else
+  std::ifstream stream(filename.c_str(), std::ios::binary | std::ios::ate);
+  if (!stream.is_open())
+    throw std::runtime_error("cannot open file '" + filename + "'");
+
+  size = (size_t) stream.tellg();
+  stream.seekg(0, std::ios::beg);
+  if (size > 0)
+  {
+    data = new char[size];
+    if (!stream.read(data, size))
+    {
+      delete[] data;
+      throw std::runtime_error("cannot read file '" + filename + "'");
+    }
+  }
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) :
+    filename(std::move(other.filename)),
+    data(other.data),
+    size(other.size)
+{
+  other.data = NULL;
+  other.size = 0;
+}
+
+MappedFile::~MappedFile()
+{
+  if (!data)
+    return;
+
+#ifndef _WIN32
+  munmap(data, size);
+#else
+  delete[] data;
+#endif
+}
+
+} // namespace data
+} // namespace mlpack
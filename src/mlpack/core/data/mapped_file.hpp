@@ -0,0 +1,70 @@
+/**
+ * @file mapped_file.hpp
+ *
+ * A read-only view of a file that is mapped into memory, so that data stored
+ * in the file can be used in place without being read or copied.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_FILE_HPP
+#define MLPACK_CORE_DATA_MAPPED_FILE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * MappedFile maps a whole file into memory.  On POSIX systems the file is
+ * mapped with mmap() as a private copy-on-write mapping: pages are only read
+ * from disk when they are touched, and they stay shared with the page cache
+ * (and so with other processes mapping the same file) unless they are written
+ * to.  On other systems the file is read into memory instead.
+ *
+ * The mapping lives as long as the MappedFile object, so anything that points
+ * into Data() must be destroyed before it.
+ */
+class MappedFile
+{
+ public:
+  /**
+   * Map the given file.  A std::runtime_error is thrown if the file can't be
+   * opened or mapped.
+   *
+   * @param filename Name of the file to map.
+   */
+  MappedFile(const std::string& filename);
+
+  //! Take ownership of the mapping of the other object.
+  MappedFile(MappedFile&& other);
+
+  //! Unmap the file.
+  ~MappedFile();
+
+  //! Get the start of the mapped file.
+  char* Data() const { return data; }
+  //! Get the size of the mapped file in bytes.
+  size_t Size() const { return size; }
+  //! Get the name of the mapped file.
+  const std::string& Filename() const { return filename; }
+
+ private:
+  // A mapping can't be copied.
+  MappedFile(const MappedFile& other);
+  MappedFile& operator=(const MappedFile& other);
+
+  //! The name of the mapped file.
+  std::string filename;
+  //! The start of the mapped file.
+  char* data;
+  //! The size of the mapped file in bytes.
+  size_t size;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -19,6 +19,7 @@
 #include <string>
 
 #include "format.hpp"
+#include "dataset_mapper.hpp"
 
 namespace mlpack {
 namespace data /** Functions to load and save matrices. */ {
@@ -38,6 +39,7 @@ namespace data /** Functions to load and save matrices. */ {
  *  - Raw binary (raw_binary), denoted by .bin
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5 (hdf5_binary), denoted by .hdf5, .hdf, .h5, or .he5
+ *  - mlpack binary (see SaveBinary()), denoted by .mlbin
  *
  * If the file extension is not one of those types, an error will be given.  If
  * the 'fatal' parameter is set to true, a std::runtime_error exception will be
@@ -58,6 +60,33 @@ bool Save(const std::string& filename,
           const bool fatal = false,
           bool transpose = true);
 
+/**
+ * Saves a matrix and the DatasetMapper that describes its dimensions to file.
+ * Only the mlpack binary format (denoted by .mlbin; see SaveBinary()) can hold
+ * the mappings, so they can be loaded back with the matrix by the
+ * corresponding overload of Load(); for any other extension, a warning is
+ * given and only the matrix is saved, as with the other overload of Save().
+ *
+ * The mlpack binary format stores the matrix as it is held in memory, with one
+ * dimension per row, so the DatasetMapper must have one dimension per row of
+ * the matrix.  If the 'transpose' parameter is set to false, the matrix is
+ * transposed before saving (so that it is stored with one point per row), and
+ * the DatasetMapper must then describe its columns.
+ *
+ * @param filename Name of file to save to.
+ * @param matrix Matrix to save into file.
+ * @param info DatasetMapper holding the mappings of the matrix.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @param transpose If false, transpose the matrix before saving.
+ * @return Boolean value indicating success or failure of save.
+ */
+template<typename eT, typename PolicyType>
+bool Save(const std::string& filename,
+          const arma::Mat<eT>& matrix,
+          const DatasetMapper<PolicyType>& info,
+          const bool fatal = false,
+          bool transpose = true);
+
 /**
  * Saves a model to file, guessing the filetype from the extension, or,
  * optionally, saving the specified format.  If automatic extension detection is
@@ -15,6 +15,7 @@
 // In case it hasn't already been included.
 #include "save.hpp"
 #include "extension.hpp"
+#include "binary_format.hpp"
 
 #include <boost/serialization/serialization.hpp>
 #include <boost/archive/xml_oarchive.hpp>
@@ -64,6 +65,34 @@ bool Save(const std::string& filename,
     return false;
   }
 
+  // mlpack binary files are written by us, not by Armadillo.
+  if (extension == "mlbin")
+  {
+    Log::Info << "Saving mlpack binary formatted data to '" << filename
+        << "'." << std::endl;
+    try
+    {
+      // The file holds the matrix as it is stored in memory.
+      if (transpose)
+        SaveBinary(filename, matrix);
+      else
+        SaveBinary(filename, arma::Mat<eT>(trans(matrix)));
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("saving_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+
+    Timer::Stop("saving_data");
+    return true;
+  }
+
   // Catch errors opening the file.
   std::fstream stream;
 #ifdef  _WIN32 // Always open in binary mode on Windows.
@@ -197,6 +226,47 @@ bool Save(const std::string& filename,
   return true;
 }
 
+template<typename eT, typename PolicyType>
+bool Save(const std::string& filename,
+          const arma::Mat<eT>& matrix,
+          const DatasetMapper<PolicyType>& info,
+          const bool fatal,
+          bool transpose)
+{
+  // Only mlpack binary files can hold the mappings.
+  if (Extension(filename) != "mlbin")
+  {
+    Log::Warn << "The mappings of the dataset can't be saved to '" << filename
+        << "'; only .mlbin files can hold them." << std::endl;
+    return Save(filename, matrix, fatal, transpose);
+  }
+
+  Timer::Start("saving_data");
+  Log::Info << "Saving mlpack binary formatted dataset to '" << filename
+      << "'." << std::endl;
+  try
+  {
+    // The file holds the matrix as it is stored in memory.
+    if (transpose)
+      SaveBinary(filename, matrix, info);
+    else
+      SaveBinary(filename, arma::Mat<eT>(trans(matrix)), info);
+  }
+  catch (std::exception& e)
+  {
+    Timer::Stop("saving_data");
+    if (fatal)
+      Log::Fatal << e.what() << std::endl;
+    else
+      Log::Warn << e.what() << std::endl;
+
+    return false;
+  }
+
+  Timer::Stop("saving_data");
+  return true;
+}
+
 //! Save a model to file.
 template<typename T>
 bool Save(const std::string& filename,
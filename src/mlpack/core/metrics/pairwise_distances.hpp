@@ -0,0 +1,221 @@
+/**
+ * @file pairwise_distances.hpp
+ *
+ * Compute the distances between every pair of points taken from two sets of
+ * columns at once.  For the (squared) Euclidean distance this is done with a
+ * single matrix multiplication instead of one Evaluate() call per pair.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_METRICS_PAIRWISE_DISTANCES_HPP
+#define MLPACK_CORE_METRICS_PAIRWISE_DISTANCES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "lmetric.hpp"
+
+#include <mutex>
+
+namespace mlpack {
+namespace metric {
+
+/**
+ * Compute the per-point values that PairwiseDistances() can reuse for every
+ * block taken from the given dataset.  Most metrics don't need anything, so
+ * the norms vector is emptied.
+ *
+ * @param metric Instantiated metric.
+ * @param data Dataset to compute the values for.
+ * @param norms Vector to store the values in.
+ */
+template<typename MetricType, typename MatType>
+void PairwiseDistanceNorms(const MetricType& /* metric */,
+                           const MatType& /* data */,
+                           arma::Col<typename MatType::elem_type>& norms)
+{
+  norms.reset();
+}
+
+/**
+ * For the (squared) Euclidean distance, the squared norm of each point is
+ * needed.
+ */
+template<bool TakeRoot, typename eT>
+void PairwiseDistanceNorms(const LMetric<2, TakeRoot>& /* metric */,
+                           const arma::Mat<eT>& data,
+                           arma::Col<eT>& norms)
+{
+  norms = arma::trans(arma::sum(arma::square(data)));
+}
+
+/**
+ * The PairwiseDistanceNorms() of a query set and a reference set (which may be
+ * the same set), computed the first time they are needed.  Searches that never
+ * compute a block of distances don't pay for them.  Copies of the rules of a
+ * parallel traversal share one cache, so the values are computed exactly once
+ * even if several threads need them at the same time.
+ */
+template<typename ElemType>
+class PairwiseDistanceNormCache
+{
+ public:
+  /**
+   * Compute the values for the given sets, unless that was already done.  The
+   * sets must be the same at every call.
+   *
+   * @param metric Instantiated metric.
+   * @param querySet Query set.
+   * @param referenceSet Reference set.
+   */
+  template<typename MetricType, typename MatType>
+  void Compute(const MetricType& metric,
+               const MatType& querySet,
+               const MatType& referenceSet)
+  {
+    std::call_once(computed, [&]()
+    {
+      sameSet = (&querySet == &referenceSet);
+      PairwiseDistanceNorms(metric, referenceSet, referenceNorms);
+      if (!sameSet)
+        PairwiseDistanceNorms(metric, querySet, queryNorms);
+    });
+  }
+
+  //! Get the values of the query set (after Compute()).
+  const arma::Col<ElemType>& QueryNorms() const
+  { return sameSet ? referenceNorms : queryNorms; }
+  //! Get the values of the reference set (after Compute()).
+  const arma::Col<ElemType>& ReferenceNorms() const { return referenceNorms; }
+
+ private:
+  //! Whether the values have been computed.
+  std::once_flag computed;
+  //! Whether the query set is the reference set.
+  bool sameSet;
+  //! The values of the query set, if it isn't the reference set.
+  arma::Col<ElemType> queryNorms;
+  //! The values of the reference set.
+  arma::Col<ElemType> referenceNorms;
+};
+
+/**
+ * Compute the distance between each of the points a.col(aIndices[i]) and each
+ * of the points b.col(bIndices[j]), and store it in distances(i, j).  This
+ * generic version calls metric.Evaluate() for every pair, so it works with any
+ * metric and any matrix type (including sparse matrices).
+ *
+ * The returned value is the largest possible absolute difference between an
+ * element of distances and the result of metric.Evaluate() for the same pair.
+ * Here the distances are exactly what Evaluate() returns, so it is 0.
+ *
+ * @param metric Instantiated metric to evaluate.
+ * @param a First dataset.
+ * @param aIndices Indices of the columns of the first dataset to use.
+ * @param aNorms Values from PairwiseDistanceNorms() for the whole first
+ *     dataset, or an empty vector if they are not available.
+ * @param b Second dataset.
+ * @param bIndices Indices of the columns of the second dataset to use.
+ * @param bNorms Values from PairwiseDistanceNorms() for the whole second
+ *     dataset, or an empty vector if they are not available.
+ * @param distances Matrix to store the distances in; it will be set to size
+ *     aIndices.n_elem x bIndices.n_elem.
+ * @return Bound on the error of each computed distance.
+ */
+template<typename MetricType, typename MatType>
+double PairwiseDistances(MetricType& metric,
+                         const MatType& a,
+                         const arma::uvec& aIndices,
+                         const arma::Col<typename MatType::elem_type>& aNorms,
+                         const MatType& b,
+                         const arma::uvec& bIndices,
+                         const arma::Col<typename MatType::elem_type>& bNorms,
+                         arma::Mat<typename MatType::elem_type>& distances)
+{
+  (void) aNorms;
+  (void) bNorms;
+
+  distances.set_size(aIndices.n_elem, bIndices.n_elem);
+  for (size_t j = 0; j < bIndices.n_elem; ++j)
+    for (size_t i = 0; i < aIndices.n_elem; ++i)
+      distances(i, j) = metric.Evaluate(a.col(aIndices[i]), b.col(bIndices[j]));
+
+  return 0.0;
+}
+
+/**
+ * Compute the (squared) Euclidean distance between each of the points
+ * a.col(aIndices[i]) and each of the points b.col(bIndices[j]), and store it in
+ * distances(i, j).  The expansion ||x - y||^2 = ||x||^2 + ||y||^2 - 2 x^T y is
+ * used, so that the bulk of the work is one matrix multiplication.
+ *
+ * The expansion loses precision when two points are much closer to each other
+ * than to the origin, so the returned error bound is not zero.  A caller that
+ * needs the exact result of Evaluate() (for instance because it compares the
+ * distance against a bound) should call Evaluate() again for the pairs whose
+ * distance is within the error bound of the decision.
+ */
+template<bool TakeRoot, typename eT>
+double PairwiseDistances(LMetric<2, TakeRoot>& /* metric */,
+                         const arma::Mat<eT>& a,
+                         const arma::uvec& aIndices,
+                         const arma::Col<eT>& aNorms,
+                         const arma::Mat<eT>& b,
+                         const arma::uvec& bIndices,
+                         const arma::Col<eT>& bNorms,
+                         arma::Mat<eT>& distances)
+{
+  const arma::Mat<eT> aBlock = a.cols(aIndices);
+  const arma::Mat<eT> bBlock = b.cols(bIndices);
+
+  const arma::Col<eT> aBlockNorms = aNorms.is_empty() ?
+      arma::Col<eT>(arma::trans(arma::sum(arma::square(aBlock)))) :
+      arma::Col<eT>(aNorms.elem(aIndices));
+  const arma::Row<eT> bBlockNorms = bNorms.is_empty() ?
+      arma::Row<eT>(arma::sum(arma::square(bBlock))) :
+      arma::Row<eT>(arma::trans(bNorms.elem(bIndices)));
+
+  distances = -2 * aBlock.t() * bBlock;
+  distances.each_col() += aBlockNorms;
+  distances.each_row() += bBlockNorms;
+  distances.transform([](const eT d) { return (d < 0) ? eT(0) : d; });
+
+  // The rounding error of each dot product and each norm is bounded by a small
+  // multiple of the dimensionality times the machine epsilon times the squared
+  // norms; this is a generous version of that bound.
+  const double squaredError = (4.0 * a.n_rows + 8.0) *
+      std::numeric_limits<eT>::epsilon() *
+      (double(aBlockNorms.max()) + double(bBlockNorms.max()));
+
+  if (TakeRoot)
+  {
+    distances = arma::sqrt(distances);
+    // |sqrt(x) - sqrt(y)| <= sqrt(|x - y|).
+    return std::sqrt(squaredError);
+  }
+
+  return squaredError;
+}
+
+/**
+ * Compute the distances between all pairs of the given columns without
+ * precomputed norms.  See the overloads above.
+ */
+template<typename MetricType, typename MatType>
+double PairwiseDistances(MetricType& metric,
+                         const MatType& a,
+                         const arma::uvec& aIndices,
+                         const MatType& b,
+                         const arma::uvec& bIndices,
+                         arma::Mat<typename MatType::elem_type>& distances)
+{
+  const arma::Col<typename MatType::elem_type> noNorms;
+  return PairwiseDistances(metric, a, aIndices, noNorms, b, bIndices, noNorms,
+      distances);
+}
+
+} // namespace metric
+} // namespace mlpack
+
+#endif
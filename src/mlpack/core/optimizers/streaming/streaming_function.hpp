@@ -0,0 +1,203 @@
+/**
+ * @file streaming_function.hpp
+ *
+ * Definition of StreamingFunction, which lets the mini-batch optimizers
+ * iterate over a dataset that is read from a data source one window of points
+ * at a time, instead of being held in memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_STREAMING_STREAMING_FUNCTION_HPP
+#define MLPACK_CORE_OPTIMIZERS_STREAMING_STREAMING_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <future>
+#include <memory>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * StreamingFunction is a decomposable function (see SGD) over a dataset that
+ * is too large to be held in memory.  The points are read from a data source
+ * in windows of consecutive points; for each window, a decomposable function
+ * over the points of the window (for instance a LogisticRegressionFunction) is
+ * built with the given factory, and the batches that fall in the window are
+ * handed to it.  While a window is in use, the next one is read on a
+ * background thread, so reading overlaps with the optimization.
+ *
+ * When the optimizer asks for the points to be shuffled (that is, at the start
+ * of each pass when shuffling is enabled), the points of each window are
+ * shuffled with the Shuffle() method of the window function; the windows
+ * themselves are still visited in order.  Only two windows are held in memory
+ * at once.
+ *
+ * The SourceType must implement the following functions:
+ *
+ * @code
+ * // Return the number of points.
+ * size_t NumPoints() const;
+ *
+ * // Store the given range of points in data, and their labels in labels (or
+ * // empty labels, if there are none).
+ * void Read(const size_t begin,
+ *           const size_t count,
+ *           arma::mat& data,
+ *           arma::Row<size_t>& labels);
+ * @endcode
+ *
+ * data::BinaryFileSource is such a source.  The FactoryType must be callable as
+ * factory(data, labels) and return the function for the window; the data and
+ * labels are kept alive (and in place) for as long as that function is in use,
+ * so it may keep references to them.
+ *
+ * The objective of a batch is whatever the window function returns for it.
+ * Functions whose regularization of a batch is scaled by the fraction of the
+ * dataset that the batch covers (such as LogisticRegressionFunction, which
+ * adds lambda * batchSize / (2 * n) times the squared norm) only see the n
+ * points of their window, so the factory has to scale their regularization
+ * parameter by the fraction of the dataset that the window covers; otherwise
+ * the regularization is weighted NumPoints() / n times too heavily.
+ *
+ * For example, L2-regularized logistic regression can be trained with SGD on a
+ * file that doesn't fit in memory like this:
+ *
+ * @code
+ * data::BinaryFileSource source("clicks.bin", true);
+ * const double lambda = 0.01;
+ * auto function = MakeStreamingFunction(source,
+ *     [&source, lambda](arma::mat& data, arma::Row<size_t>& labels)
+ *     {
+ *       const double windowLambda = lambda * data.n_cols / source.NumPoints();
+ *       return regression::LogisticRegressionFunction<>(data, labels,
+ *           windowLambda);
+ *     }, 1000000);
+ *
+ * regression::LogisticRegression<> lr(source.Dimensionality(), lambda);
+ * SGD<> sgd(0.01, 32);
+ * sgd.Optimize(function, lr.Parameters());
+ * @endcode
+ *
+ * @tparam SourceType Type of the data source.
+ * @tparam FactoryType Type of the function that builds the function of a
+ *     window.
+ */
+template<typename SourceType, typename FactoryType>
+class StreamingFunction
+{
+ public:
+  //! The type of the function of a window.
+  typedef decltype(std::declval<FactoryType&>()(std::declval<arma::mat&>(),
+      std::declval<arma::Row<size_t>&>())) FunctionType;
+
+  /**
+   * Create the streaming function over the given source.  The source must
+   * outlive the function.
+   *
+   * @param source Source of the points.
+   * @param factory Function that builds the function of a window.
+   * @param windowSize Number of points in each window.
+   */
+  StreamingFunction(SourceType& source,
+                    FactoryType factory,
+                    const size_t windowSize = 100000);
+
+  //! Get the number of functions (points).
+  size_t NumFunctions() const { return source.NumPoints(); }
+
+  //! Shuffle the points inside each window, starting with the next window.
+  void Shuffle();
+
+  /**
+   * Evaluate the objective function on the given batch of points.  The batch
+   * may span several windows.
+   *
+   * @param coordinates The parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& coordinates,
+                  const size_t begin,
+                  const size_t batchSize);
+
+  /**
+   * Compute the gradient of the objective function on the given batch of
+   * points.  The batch may span several windows.
+   *
+   * @param coordinates The parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix to store the gradient in.
+   * @param batchSize Number of points in the batch.
+   */
+  void Gradient(const arma::mat& coordinates,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize);
+
+  //! Get the number of points in each window.
+  size_t WindowSize() const { return windowSize; }
+
+ private:
+  //! The points of a window and the function built on them.
+  struct Window
+  {
+    //! The points of the window.
+    arma::mat data;
+    //! The labels of the points of the window.
+    arma::Row<size_t> labels;
+    //! The function over the points of the window.
+    std::unique_ptr<FunctionType> function;
+  };
+
+  //! Read the given window from the source.
+  static std::unique_ptr<Window> Read(SourceType* source,
+                                      const size_t begin,
+                                      const size_t count);
+
+  //! Make the given window the current one, and start reading the next one.
+  void Activate(const size_t index);
+
+  //! The source of the points.
+  SourceType& source;
+  //! The function that builds the function of a window.
+  FactoryType factory;
+  //! The number of points in each window.
+  size_t windowSize;
+  //! Whether to shuffle the points of each window.
+  bool shuffle;
+
+  //! The current window.
+  std::unique_ptr<Window> window;
+  //! The index of the current window.
+  size_t windowIndex;
+  //! The window being read in the background.
+  std::future<std::unique_ptr<Window>> next;
+  //! The index of the window being read in the background.
+  size_t nextIndex;
+};
+
+/**
+ * Create a StreamingFunction; this deduces the type of the factory, which may
+ * be a lambda.
+ */
+template<typename SourceType, typename FactoryType>
+StreamingFunction<SourceType, FactoryType> MakeStreamingFunction(
+    SourceType& source,
+    FactoryType factory,
+    const size_t windowSize = 100000)
+{
+  return StreamingFunction<SourceType, FactoryType>(source, factory,
+      windowSize);
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "streaming_function_impl.hpp"
+
+#endif
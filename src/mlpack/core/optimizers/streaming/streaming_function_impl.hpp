@@ -0,0 +1,166 @@
+/**
+ * @file streaming_function_impl.hpp
+ *
+ * Implementation of StreamingFunction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_STREAMING_STREAMING_FUNCTION_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_STREAMING_STREAMING_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "streaming_function.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename SourceType, typename FactoryType>
+StreamingFunction<SourceType, FactoryType>::StreamingFunction(
+    SourceType& source,
+    FactoryType factory,
+    const size_t windowSize) :
+    source(source),
+    factory(factory),
+    windowSize(windowSize),
+    shuffle(false),
+    windowIndex(0),
+    nextIndex(0)
+{
+  if (windowSize == 0)
+    throw std::invalid_argument("StreamingFunction: window size must be "
+        "positive");
+}
+
+template<typename SourceType, typename FactoryType>
+void StreamingFunction<SourceType, FactoryType>::Shuffle()
+{
+  // The optimizer asks for a shuffle before it starts a pass, which starts with
+  // the first window.  If that window is already in use (because it's the only
+  // one), shuffle it now; otherwise it is shuffled when it is used.
+  shuffle = true;
+  if (window && windowIndex == 0)
+    window->function->Shuffle();
+}
+
+template<typename SourceType, typename FactoryType>
+double StreamingFunction<SourceType, FactoryType>::Evaluate(
+    const arma::mat& coordinates,
+    const size_t begin,
+    const size_t batchSize)
+{
+  double objective = 0.0;
+  size_t i = begin;
+  while (i < begin + batchSize)
+  {
+    Activate(i / windowSize);
+
+    // Evaluate the part of the batch that is in this window.
+    const size_t windowBegin = windowIndex * windowSize;
+    const size_t count = std::min(begin + batchSize,
+        windowBegin + window->data.n_cols) - i;
+    objective += window->function->Evaluate(coordinates, i - windowBegin,
+        count);
+    i += count;
+  }
+
+  return objective;
+}
+
+template<typename SourceType, typename FactoryType>
+void StreamingFunction<SourceType, FactoryType>::Gradient(
+    const arma::mat& coordinates,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize)
+{
+  arma::mat windowGradient;
+  size_t i = begin;
+  while (i < begin + batchSize)
+  {
+    Activate(i / windowSize);
+
+    // The gradient of the batch is the sum of the gradients of its parts.
+    const size_t windowBegin = windowIndex * windowSize;
+    const size_t count = std::min(begin + batchSize,
+        windowBegin + window->data.n_cols) - i;
+    if (i == begin)
+    {
+      window->function->Gradient(coordinates, i - windowBegin, gradient,
+          count);
+    }
+    else
+    {
+      window->function->Gradient(coordinates, i - windowBegin,
+          windowGradient, count);
+      gradient += windowGradient;
+    }
+    i += count;
+  }
+}
+
+template<typename SourceType, typename FactoryType>
+std::unique_ptr<typename StreamingFunction<SourceType, FactoryType>::Window>
+StreamingFunction<SourceType, FactoryType>::Read(SourceType* source,
+                                                 const size_t begin,
+                                                 const size_t count)
+{
+  std::unique_ptr<Window> window(new Window());
+  source->Read(begin, count, window->data, window->labels);
+  return window;
+}
+
+template<typename SourceType, typename FactoryType>
+void StreamingFunction<SourceType, FactoryType>::Activate(const size_t index)
+{
+  if (window && windowIndex == index)
+    return;
+
+  const size_t numPoints = source.NumPoints();
+  const size_t numWindows = (numPoints + windowSize - 1) / windowSize;
+  if (index >= numWindows)
+    throw std::invalid_argument("StreamingFunction: point index out of range");
+
+  // Use the window that was read in the background, if it is the right one.
+  // In any case the background read has to finish before the source can be
+  // used again.
+  std::unique_ptr<Window> newWindow;
+  if (next.valid())
+  {
+    std::unique_ptr<Window> prefetched = next.get();
+    if (nextIndex == index)
+      newWindow = std::move(prefetched);
+  }
+
+  if (!newWindow)
+  {
+    const size_t begin = index * windowSize;
+    newWindow = Read(&source, begin, std::min(windowSize, numPoints - begin));
+  }
+
+  // The old function may refer to the old data, so it goes first.
+  window.reset();
+  window = std::move(newWindow);
+  window->function.reset(new FunctionType(factory(window->data,
+      window->labels)));
+  if (shuffle)
+    window->function->Shuffle();
+  windowIndex = index;
+
+  // The optimizer goes through the windows in order, and starts again from the
+  // first window after the last one.
+  if (numWindows > 1)
+  {
+    nextIndex = (index + 1) % numWindows;
+    const size_t begin = nextIndex * windowSize;
+    next = std::async(std::launch::async, &StreamingFunction::Read, &source,
+        begin, std::min(windowSize, numPoints - begin));
+  }
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -12,6 +12,7 @@
 #define MLPACK_CORE_TREE_BINARY_SPACE_TREE_BINARY_SPACE_TREE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <boost/preprocessor/punctuation/comma.hpp>
 
 #include "../statistic.hpp"
 #include "midpoint_split.hpp"
@@ -19,6 +20,10 @@
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 
+// Forward declaration for the friend declaration below.
+template<typename TreeType>
+class FlatTree;
+
 /**
  * A binary space partitioning tree, such as a KD-tree or a ball tree.  Once the
  * bound and type of dataset is defined, the tree will construct itself.  Call
@@ -32,6 +37,12 @@ namespace tree /** Trees and tree-building procedures. */ {
  * This tree does take one runtime parameter in the constructor, which is the
  * max leaf size to be used.
  *
+ * When mlpack is compiled with OpenMP, large trees are built in parallel: the
+ * points of large nodes are partitioned in parallel tasks, and if the split
+ * type allows it (see SplitTraits), the two children of large nodes are built
+ * at the same time.  The resulting tree and the mapping of points are the same
+ * as for a serial build.
+ *
  * @tparam MetricType The metric used for tree-building.  The BoundType may
  *     place restrictions on the metrics that can be used.
  * @tparam StatisticType Extra data contained in the node.  See statistic.hpp
@@ -85,10 +96,28 @@ class BinarySpaceTree
   ElemType furthestDescendantDistance;
   //! The minimum distance from the center to any edge of the bound.
   ElemType minimumBoundDistance;
+  //! The number of points inserted into or removed from this node since it was
+  //! built.
+  size_t numUpdates;
+  //! Whether the points of this node are the columns [begin, begin + count) of
+  //! the dataset.  This is false once the node was changed by Insert() or
+  //! Remove().
+  bool contiguous;
+  //! The indices of the points held by this node, if it is a leaf and its
+  //! points are not contiguous.
+  std::vector<size_t> points;
+  //! The columns of the dataset that hold no point of the tree (only set in
+  //! the root).  Insert() stores new points there.
+  std::vector<size_t> freeColumns;
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
 
+  //! Nodes with at least this many points build their children in parallel
+  //! OpenMP tasks, if the splits of SplitType are independent (see
+  //! SplitTraits).
+  static const size_t ParallelBuildMinimumSize = 1024;
+
  public:
   //! A single-tree traverser for binary space trees; see
   //! single_tree_traverser.hpp for implementation.
@@ -479,6 +508,10 @@ class BinarySpaceTree
     return bound.RangeDistance(point);
   }
 
+  //! Return whether the points of this node are the columns [Begin(),
+  //! Begin() + Count()) of the dataset.
+  bool IsContiguous() const { return contiguous; }
+
   //! Return the index of the beginning point of this subset.
   size_t Begin() const { return begin; }
   //! Modify the index of the beginning point of this subset.
@@ -492,6 +525,44 @@ class BinarySpaceTree
   //! Store the center of the bounding region in the given vector.
   void Center(arma::vec& center) const { bound.Center(center); }
 
+  /**
+   * Insert the given point into the tree.  This must be called on the root.
+   * The point is stored in a free column of the dataset (if there is none, the
+   * dataset is grown at the end, so no column of the dataset is ever moved),
+   * and added to the leaf whose bound is closest to it.  Only the nodes on the
+   * path from the root to that leaf are changed: their bounds are expanded,
+   * and the highest of them is rebuilt from scratch when more points have been
+   * inserted into or removed from it than half of the points it holds (so the
+   * tree is rebalanced lazily), or when a leaf holds more than maxLeafSize
+   * points.
+   *
+   * Once a node was changed, its points are not contiguous in the dataset
+   * anymore; use NumPoints() and Point() (or NumDescendants() and
+   * Descendant()) rather than Begin() and Count() to iterate over them.
+   *
+   * @param point Point to insert.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @return The index of the column of the dataset that holds the point.
+   */
+  template<typename VecType>
+  size_t Insert(const VecType& point, const size_t maxLeafSize = 20);
+
+  /**
+   * Remove the point held in the given column of the dataset from the tree.
+   * This must be called on the root.  The column is not removed from the
+   * dataset; it becomes free, and a later Insert() may reuse it.  Only the
+   * nodes on the path from the root to the leaf holding the point are changed,
+   * and their bounds are not shrunk until they are rebuilt (see Insert()).
+   *
+   * @param index Index of the column of the dataset holding the point.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   */
+  void Remove(const size_t index, const size_t maxLeafSize = 20);
+
+  //! Return the columns of the dataset that hold no point of the tree (only
+  //! set in the root).
+  const std::vector<size_t>& FreeColumns() const { return freeColumns; }
+
  private:
   /**
    * Splits the current node, assigning its left and right children recursively.
@@ -531,6 +602,70 @@ class BinarySpaceTree
    */
   void UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate);
 
+  //! Set the parent distances of the children of this node.
+  void UpdateChildParentDistances();
+
+  /**
+   * Find the path from this node to the leaf holding the given column of the
+   * dataset, and append it to the given vector.
+   *
+   * @param index Index of the column of the dataset.
+   * @param useBounds If true, only search the nodes whose bound contains the
+   *     point.
+   * @param path Vector to append the path to.
+   * @return Whether the point was found.
+   */
+  bool FindPath(const size_t index,
+                const bool useBounds,
+                std::vector<BinarySpaceTree*>& path);
+
+  //! Mark this node as non-contiguous, storing the indices of its points if it
+  //! is a leaf.
+  void MakeNonContiguous();
+
+  /**
+   * Store the indices of the points held by this node in the given vector,
+   * starting at the given position.
+   *
+   * @param indices Vector to store the indices in.
+   * @param position Position of the next index; it is advanced past the
+   *     points of this node.
+   */
+  void GetPoints(arma::uvec& indices, size_t& position) const;
+
+  /**
+   * Finish an insertion or a removal: rebuild the highest node of the given
+   * path that needs it, and refresh the parent distances and statistics of the
+   * nodes above it.
+   *
+   * @param path Nodes that held the point, starting with the root.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   */
+  static void RebalancePath(const std::vector<BinarySpaceTree*>& path,
+                            const size_t maxLeafSize);
+
+  /**
+   * Rebuild this node and its descendants from the points it holds.  The
+   * columns of the dataset are not moved; the leaves of the new subtree store
+   * the indices of their points.
+   *
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   */
+  void Rebuild(const size_t maxLeafSize);
+
+  /**
+   * Take this node and its descendants from a tree built on the given columns
+   * of the dataset: point the nodes to the dataset, and make the leaves store
+   * the indices of the columns.
+   *
+   * @param columns Columns of the dataset the tree was built on.
+   * @param oldFromNew Mapping from new to old point indices of the tree.
+   * @param data Dataset of this tree.
+   */
+  void AdoptNodes(const arma::uvec& columns,
+                  const std::vector<size_t>& oldFromNew,
+                  MatType* data);
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -543,6 +678,10 @@ class BinarySpaceTree
   //! Friend access is given for the default constructor.
   friend class boost::serialization::access;
 
+  //! Friend access is given to rebuild trees from flat tree files.
+  template<typename TreeType>
+  friend class FlatTree;
+
  public:
   /**
    * Serialize the tree.
@@ -554,6 +693,19 @@ class BinarySpaceTree
 } // namespace tree
 } // namespace mlpack
 
+//! Set the serialization version of the BinarySpaceTree class.
+BOOST_TEMPLATE_CLASS_VERSION(
+    template<typename MetricType BOOST_PP_COMMA()
+             typename StatisticType BOOST_PP_COMMA()
+             typename MatType BOOST_PP_COMMA()
+             template<typename BoundMetricType BOOST_PP_COMMA() typename...>
+                 class BoundType BOOST_PP_COMMA()
+             template<typename SplitBoundType BOOST_PP_COMMA()
+                      typename SplitMatType> class SplitType>,
+    mlpack::tree::BinarySpaceTree<MetricType BOOST_PP_COMMA()
+        StatisticType BOOST_PP_COMMA() MatType BOOST_PP_COMMA()
+        BoundType BOOST_PP_COMMA() SplitType>, 1);
+
 // Include implementation.
 #include "binary_space_tree_impl.hpp"
 
@@ -13,11 +13,16 @@
 
 // In case it wasn't included already for some reason.
 #include "binary_space_tree.hpp"
+#include "split_traits.hpp"
 
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
 #include <queue>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace tree {
 
@@ -40,6 +45,8 @@ BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
+    numUpdates(0),
+    contiguous(true),
     dataset(new MatType(data)) // Copies the dataset.
 {
   // Do the actual splitting of this node.
@@ -68,6 +75,8 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
+    numUpdates(0),
+    contiguous(true),
     dataset(new MatType(data)) // Copies the dataset.
 {
   // Initialize oldFromNew correctly.
@@ -102,6 +111,8 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
+    numUpdates(0),
+    contiguous(true),
     dataset(new MatType(data)) // Copies the dataset.
 {
   // Initialize the oldFromNew vector correctly.
@@ -137,6 +148,8 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
+    numUpdates(0),
+    contiguous(true),
     dataset(new MatType(std::move(data)))
 {
   // Do the actual splitting of this node.
@@ -165,6 +178,8 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
+    numUpdates(0),
+    contiguous(true),
     dataset(new MatType(std::move(data)))
 {
   // Initialize oldFromNew correctly.
@@ -199,6 +214,8 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
+    numUpdates(0),
+    contiguous(true),
     dataset(new MatType(std::move(data)))
 {
   // Initialize the oldFromNew vector correctly.
@@ -238,6 +255,8 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
+    numUpdates(0),
+    contiguous(true),
     dataset(&parent->Dataset()) // Point to the parent's dataset.
 {
   // Perform the actual splitting.
@@ -267,6 +286,8 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
+    numUpdates(0),
+    contiguous(true),
     dataset(&parent->Dataset())
 {
   // Hopefully the vector is initialized correctly!  We can't check that
@@ -301,6 +322,8 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset()->n_rows),
+    numUpdates(0),
+    contiguous(true),
     dataset(&parent->Dataset())
 {
   // Hopefully the vector is initialized correctly!  We can't check that
@@ -341,6 +364,10 @@ BinarySpaceTree(
     stat(other.stat),
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
+    numUpdates(other.numUpdates),
+    contiguous(other.contiguous),
+    points(other.points),
+    freeColumns(other.freeColumns),
     // Copy matrix, but only if we are the root.
     dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
 {
@@ -400,6 +427,10 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
+    numUpdates(other.numUpdates),
+    contiguous(other.contiguous),
+    points(std::move(other.points)),
+    freeColumns(std::move(other.freeColumns)),
     dataset(other.dataset)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
@@ -411,6 +442,8 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.parentDistance = 0.0;
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
+  other.numUpdates = 0;
+  other.contiguous = true;
   other.dataset = NULL;
 
   // Set new parent.
@@ -719,7 +752,14 @@ template<typename MetricType,
 inline size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
                               SplitType>::Descendant(const size_t index) const
 {
-  return (begin + index);
+  if (contiguous)
+    return (begin + index);
+  else if (!left)
+    return points[index];
+  else if (index < left->count)
+    return left->Descendant(index);
+  else
+    return right->Descendant(index - left->count);
 }
 
 /**
@@ -734,6 +774,9 @@ template<typename MetricType,
 inline size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
                               SplitType>::Point(const size_t index) const
 {
+  if (!contiguous && !left)
+    return points[index];
+
   return (begin + index);
 }
 
@@ -747,6 +790,22 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     SplitNode(const size_t maxLeafSize,
               SplitType<BoundType<MetricType>, MatType>& splitter)
 {
+#ifdef HAS_OPENMP
+  // When building a large tree outside of any parallel region, start one, so
+  // that the tasks created while splitting can run on all threads.  The
+  // recursion itself is done by a single thread.
+  if (parent == NULL && count >= ParallelBuildMinimumSize &&
+      omp_get_level() == 0)
+  {
+    #pragma omp parallel
+    {
+      #pragma omp single
+      SplitNode(maxLeafSize, splitter);
+    }
+    return;
+  }
+#endif
+
   // We need to expand the bounds of this node properly.
   UpdateBound(bound);
 
@@ -783,23 +842,19 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
+  // If the splits of the two children are independent, the left child is
+  // built in its own task while this thread builds the right child.
+  SplitType<BoundType<MetricType>, MatType>* splitterPtr = &splitter;
+  #pragma omp task if (SplitTraits<Split>::IndependentSplits && \
+      count >= ParallelBuildMinimumSize)
+  left = new BinarySpaceTree(this, begin, splitCol - begin, *splitterPtr,
       maxLeafSize);
   right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
       splitter, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
-  arma::vec center, leftCenter, rightCenter;
-  Center(center);
-  left->Center(leftCenter);
-  right->Center(rightCenter);
-
-  const ElemType leftParentDistance = MetricType::Evaluate(center, leftCenter);
-  const ElemType rightParentDistance = MetricType::Evaluate(center,
-      rightCenter);
-
-  left->ParentDistance() = leftParentDistance;
-  right->ParentDistance() = rightParentDistance;
+  UpdateChildParentDistances();
 }
 
 template<typename MetricType,
@@ -813,6 +868,22 @@ SplitNode(std::vector<size_t>& oldFromNew,
           const size_t maxLeafSize,
           SplitType<BoundType<MetricType>, MatType>& splitter)
 {
+#ifdef HAS_OPENMP
+  // When building a large tree outside of any parallel region, start one, so
+  // that the tasks created while splitting can run on all threads.  The
+  // recursion itself is done by a single thread.
+  if (parent == NULL && count >= ParallelBuildMinimumSize &&
+      omp_get_level() == 0)
+  {
+    #pragma omp parallel
+    {
+      #pragma omp single
+      SplitNode(oldFromNew, maxLeafSize, splitter);
+    }
+    return;
+  }
+#endif
+
   // We need to expand the bounds of this node properly.
   UpdateBound(bound);
 
@@ -850,23 +921,21 @@ SplitNode(std::vector<size_t>& oldFromNew,
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
-      splitter, maxLeafSize);
+  // If the splits of the two children are independent, the left child is
+  // built in its own task while this thread builds the right child.  The
+  // children only touch their own part of oldFromNew.
+  SplitType<BoundType<MetricType>, MatType>* splitterPtr = &splitter;
+  std::vector<size_t>* oldFromNewPtr = &oldFromNew;
+  #pragma omp task if (SplitTraits<Split>::IndependentSplits && \
+      count >= ParallelBuildMinimumSize)
+  left = new BinarySpaceTree(this, begin, splitCol - begin, *oldFromNewPtr,
+      *splitterPtr, maxLeafSize);
   right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
       oldFromNew, splitter, maxLeafSize);
+  #pragma omp taskwait
 
   // Calculate parent distances for those two nodes.
-  arma::vec center, leftCenter, rightCenter;
-  Center(center);
-  left->Center(leftCenter);
-  right->Center(rightCenter);
-
-  const ElemType leftParentDistance = MetricType::Evaluate(center, leftCenter);
-  const ElemType rightParentDistance = MetricType::Evaluate(center,
-      rightCenter);
-
-  left->ParentDistance() = leftParentDistance;
-  right->ParentDistance() = rightParentDistance;
+  UpdateChildParentDistances();
 }
 
 template<typename MetricType,
@@ -909,6 +978,344 @@ UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate)
     boundToUpdate |= dataset->cols(begin, begin + count - 1);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+UpdateChildParentDistances()
+{
+  if (!left || !right)
+    return;
+
+  arma::vec center, leftCenter, rightCenter;
+  Center(center);
+  left->Center(leftCenter);
+  right->Center(rightCenter);
+
+  const ElemType leftParentDistance = MetricType::Evaluate(center, leftCenter);
+  const ElemType rightParentDistance = MetricType::Evaluate(center,
+      rightCenter);
+
+  left->ParentDistance() = leftParentDistance;
+  right->ParentDistance() = rightParentDistance;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename VecType>
+size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::Insert(
+    const VecType& point,
+    const size_t maxLeafSize)
+{
+  if (parent)
+    throw std::invalid_argument("Insert() must be called on the root");
+  if (point.n_elem != dataset->n_rows)
+    throw std::invalid_argument("dimensionality of the point does not match "
+        "the dataset");
+
+  // Store the point in a free column.  If there is none, double the number of
+  // columns of the dataset, so that appending points costs amortized constant
+  // time per point.
+  if (freeColumns.empty())
+  {
+    const size_t oldCols = dataset->n_cols;
+    const size_t newCols = std::max(2 * oldCols, oldCols + 1);
+    dataset->resize(dataset->n_rows, newCols);
+    for (size_t i = newCols; i > oldCols; --i)
+      freeColumns.push_back(i - 1);
+  }
+
+  const size_t index = freeColumns.back();
+  freeColumns.pop_back();
+  dataset->col(index) = point;
+
+  // Find the leaf to put the point in.
+  std::vector<BinarySpaceTree*> path(1, this);
+  while (!path.back()->IsLeaf())
+  {
+    BinarySpaceTree* node = path.back();
+    path.push_back(&node->Child(node->GetNearestChild(point)));
+  }
+
+  // Only the nodes that hold the point change; their bounds are expanded.
+  for (size_t i = 0; i < path.size(); ++i)
+  {
+    path[i]->MakeNonContiguous();
+    ++path[i]->count;
+    ++path[i]->numUpdates;
+    path[i]->bound |= dataset->cols(index, index);
+    path[i]->furthestDescendantDistance = 0.5 * path[i]->bound.Diameter();
+  }
+  path.back()->points.push_back(index);
+
+  RebalancePath(path, maxLeafSize);
+
+  return index;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::Remove(
+    const size_t index,
+    const size_t maxLeafSize)
+{
+  if (parent)
+    throw std::invalid_argument("Remove() must be called on the root");
+  if (index >= dataset->n_cols)
+    throw std::invalid_argument("index of the point to remove is out of range");
+
+  // Find the nodes that hold the point.  Only the nodes whose bound contains
+  // the point need to be searched; if rounding errors made a bound exclude it,
+  // fall back to searching the whole tree.
+  std::vector<BinarySpaceTree*> path;
+  if (!FindPath(index, true, path) && !FindPath(index, false, path))
+    throw std::invalid_argument("the given column of the dataset does not "
+        "hold a point of the tree");
+
+  // The bounds are still valid (if loose), so they are left alone.
+  for (size_t i = 0; i < path.size(); ++i)
+  {
+    path[i]->MakeNonContiguous();
+    --path[i]->count;
+    ++path[i]->numUpdates;
+  }
+
+  std::vector<size_t>& leafPoints = path.back()->points;
+  *std::find(leafPoints.begin(), leafPoints.end(), index) = leafPoints.back();
+  leafPoints.pop_back();
+  freeColumns.push_back(index);
+
+  RebalancePath(path, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::FindPath(
+    const size_t index,
+    const bool useBounds,
+    std::vector<BinarySpaceTree*>& path)
+{
+  if (contiguous && (index < begin || index >= begin + count))
+    return false;
+  if (useBounds && !bound.Contains(dataset->col(index)))
+    return false;
+
+  path.push_back(this);
+  if (left)
+  {
+    if (left->FindPath(index, useBounds, path) ||
+        right->FindPath(index, useBounds, path))
+      return true;
+  }
+  else if (contiguous || std::find(points.begin(), points.end(), index) !=
+      points.end())
+  {
+    return true;
+  }
+
+  path.pop_back();
+  return false;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+MakeNonContiguous()
+{
+  if (contiguous && !left)
+  {
+    points.resize(count);
+    for (size_t i = 0; i < count; ++i)
+      points[i] = begin + i;
+  }
+
+  contiguous = false;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::GetPoints(
+    arma::uvec& indices,
+    size_t& position) const
+{
+  if (contiguous)
+  {
+    for (size_t i = 0; i < count; ++i)
+      indices[position++] = begin + i;
+  }
+  else if (left)
+  {
+    left->GetPoints(indices, position);
+    right->GetPoints(indices, position);
+  }
+  else
+  {
+    for (size_t i = 0; i < points.size(); ++i)
+      indices[position++] = points[i];
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::RebalancePath(
+    const std::vector<BinarySpaceTree*>& path,
+    const size_t maxLeafSize)
+{
+  // Rebuild the highest node that has changed too much since it was built,
+  // that has a leaf that is too large, or that has an empty child.  A node
+  // with n points is rebuilt at most once every n / 2 updates that go through
+  // it, so the rebuilds cost amortized O(d log n) per update and level of a
+  // balanced tree.
+  size_t rebuilt = path.size();
+  for (size_t i = 0; i < path.size(); ++i)
+  {
+    BinarySpaceTree* node = path[i];
+    const bool needsRebuild = node->IsLeaf() ?
+        (node->count > maxLeafSize) :
+        (node->count <= maxLeafSize || node->left->count == 0 ||
+         node->right->count == 0);
+    if (needsRebuild || 2 * node->numUpdates > node->count)
+    {
+      node->Rebuild(maxLeafSize);
+      rebuilt = i;
+      break;
+    }
+  }
+
+  // The nodes below a rebuilt node don't exist anymore; refresh the ones above
+  // it, from the bottom up.
+  for (size_t i = rebuilt; i > 0; --i)
+  {
+    BinarySpaceTree* node = path[i - 1];
+    node->UpdateChildParentDistances();
+    node->stat = StatisticType(*node);
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::Rebuild(
+    const size_t maxLeafSize)
+{
+  arma::uvec columns(count);
+  size_t position = 0;
+  GetPoints(columns, position);
+
+  delete left;
+  delete right;
+  left = NULL;
+  right = NULL;
+  numUpdates = 0;
+
+  if (count == 0)
+  {
+    // An empty tree is a single empty leaf.
+    contiguous = false;
+    points.clear();
+    bound = BoundType<MetricType>(dataset->n_rows);
+    furthestDescendantDistance = 0;
+    minimumBoundDistance = 0;
+    stat = StatisticType(*this);
+    return;
+  }
+
+  // Build a tree on a copy of the points, and take its nodes; the columns of
+  // the dataset stay where they are.
+  std::vector<size_t> oldFromNew;
+  BinarySpaceTree tree(MatType(dataset->cols(columns)), oldFromNew,
+      maxLeafSize);
+
+  left = tree.left;
+  right = tree.right;
+  tree.left = NULL;
+  tree.right = NULL;
+  bound = std::move(tree.bound);
+  furthestDescendantDistance = tree.furthestDescendantDistance;
+  minimumBoundDistance = tree.minimumBoundDistance;
+  contiguous = false;
+
+  if (left)
+  {
+    points.clear();
+    left->parent = this;
+    right->parent = this;
+    left->AdoptNodes(columns, oldFromNew, dataset);
+    right->AdoptNodes(columns, oldFromNew, dataset);
+  }
+  else
+  {
+    points.resize(count);
+    for (size_t i = 0; i < count; ++i)
+      points[i] = columns[oldFromNew[i]];
+  }
+
+  stat = StatisticType(*this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::AdoptNodes(
+    const arma::uvec& columns,
+    const std::vector<size_t>& oldFromNew,
+    MatType* data)
+{
+  dataset = data;
+  contiguous = false;
+  numUpdates = 0;
+
+  if (left)
+  {
+    left->parent = this;
+    right->parent = this;
+    left->AdoptNodes(columns, oldFromNew, data);
+    right->AdoptNodes(columns, oldFromNew, data);
+  }
+  else
+  {
+    points.resize(count);
+    for (size_t i = 0; i < count; ++i)
+      points[i] = columns[oldFromNew[begin + i]];
+  }
+
+  // The statistic is rebuilt now that the node refers to the right points.
+  stat = StatisticType(*this);
+}
+
 // Default constructor (private), for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
@@ -926,6 +1333,8 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
+    numUpdates(0),
+    contiguous(true),
     dataset(NULL)
 {
   // Nothing to do.
@@ -942,7 +1351,7 @@ template<typename MetricType,
              class SplitType>
 template<typename Archive>
 void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
-    serialize(Archive& ar, const unsigned int /* version */)
+    serialize(Archive& ar, const unsigned int version)
 {
   // If we're loading, and we have children, they need to be deleted.
   if (Archive::is_loading::value)
@@ -953,6 +1362,9 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
       delete right;
     if (!parent)
       delete dataset;
+
+    // The loaded tree is considered freshly built.
+    numUpdates = 0;
   }
 
   ar & BOOST_SERIALIZATION_NVP(begin);
@@ -964,6 +1376,20 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   ar & BOOST_SERIALIZATION_NVP(furthestDescendantDistance);
   ar & BOOST_SERIALIZATION_NVP(dataset);
 
+  // Older trees could not be updated, so their points are contiguous.
+  if (version > 0)
+  {
+    ar & BOOST_SERIALIZATION_NVP(contiguous);
+    ar & BOOST_SERIALIZATION_NVP(points);
+    ar & BOOST_SERIALIZATION_NVP(freeColumns);
+  }
+  else if (Archive::is_loading::value)
+  {
+    contiguous = true;
+    points.clear();
+    freeColumns.clear();
+  }
+
   // Save children last; otherwise boost::serialization gets confused.
   ar & BOOST_SERIALIZATION_NVP(left);
   ar & BOOST_SERIALIZATION_NVP(right);
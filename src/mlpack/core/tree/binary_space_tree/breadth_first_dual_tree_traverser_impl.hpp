@@ -130,10 +130,12 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
     if (queryNode.IsLeaf() && referenceNode.IsLeaf())
     {
       // Loop through each of the points in each node.
-      const size_t queryEnd = queryNode.Begin() + queryNode.Count();
-      const size_t refEnd = referenceNode.Begin() + referenceNode.Count();
-      for (size_t query = queryNode.Begin(); query < queryEnd; ++query)
+      const size_t numQueryPoints = queryNode.NumPoints();
+      const size_t numRefPoints = referenceNode.NumPoints();
+      for (size_t i = 0; i < numQueryPoints; ++i)
       {
+        const size_t query = queryNode.Point(i);
+
         // See if we need to investigate this point (this function should be
         // implemented for the single-tree recursion too).  Restore the
         // traversal information first.
@@ -142,10 +144,10 @@ BreadthFirstDualTreeTraverser<RuleType>::Traverse(
 //        if (childScore == DBL_MAX)
 //          continue; // We can't improve this particular point.
 
-        for (size_t ref = referenceNode.Begin(); ref < refEnd; ++ref)
-          rule.BaseCase(query, ref);
+        for (size_t j = 0; j < numRefPoints; ++j)
+          rule.BaseCase(query, referenceNode.Point(j));
 
-        numBaseCases += referenceNode.Count();
+        numBaseCases += numRefPoints;
       }
     }
     else if ((!queryNode.IsLeaf()) && referenceNode.IsLeaf())
@@ -0,0 +1,223 @@
+/**
+ * @file flat_tree.hpp
+ *
+ * Definition of FlatTree, which saves a BinarySpaceTree to a flat binary file
+ * and loads it back from a memory-mapped file.  The dataset is used in place
+ * from the mapping, so a large index doesn't need to be read or copied before
+ * it can be searched.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
+#include "../hrectbound.hpp"
+#include "../ballbound.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The header at the start of a flat tree file.  All offsets are in bytes from
+ * the start of the file, and all values are stored in the byte order of the
+ * machine that wrote the file.
+ */
+struct FlatTreeHeader
+{
+  //! Identifies the file as a flat tree ("MLPKTREE").
+  char magic[8];
+  //! Version of the file format.
+  uint64_t version;
+  //! Size in bytes of one element of the dataset.
+  uint64_t elemSize;
+  //! Number of rows (dimensions) of the dataset.
+  uint64_t nRows;
+  //! Number of columns (points) of the dataset.
+  uint64_t nCols;
+  //! Number of nodes in the tree.
+  uint64_t numNodes;
+  //! Number of values stored for the bound of each node.
+  uint64_t boundSize;
+  //! Number of elements of the mapping from new to old point indices (either
+  //! 0 or nCols).
+  uint64_t mappingSize;
+  //! Offset of the dataset (column-major).
+  uint64_t dataOffset;
+  //! Offset of the array of FlatTreeNode records.
+  uint64_t nodesOffset;
+  //! Offset of the bound values of all nodes.
+  uint64_t boundsOffset;
+  //! Offset of the mapping from new to old point indices.
+  uint64_t mappingOffset;
+};
+
+/**
+ * A node of a flat tree file.  The nodes are stored in depth-first order, so
+ * the root is node 0; a child index of 0 means that there is no such child.
+ */
+struct FlatTreeNode
+{
+  //! Index of the first point held in the node.
+  uint64_t begin;
+  //! Number of points held in the node.
+  uint64_t count;
+  //! Index of the left child.
+  uint64_t left;
+  //! Index of the right child.
+  uint64_t right;
+  //! Distance from the center of the node to the center of its parent.
+  double parentDistance;
+  //! Furthest distance from the center of the node to a descendant point.
+  double furthestDescendantDistance;
+  //! Minimum distance from the center of the node to the edge of its bound.
+  double minimumBoundDistance;
+};
+
+/**
+ * FlatBound converts a bound to and from the values stored for it in a flat
+ * tree file.  Only the bounds specialized below can be stored.
+ */
+template<typename BoundType>
+class FlatBound;
+
+//! Store an HRectBound as the lower and upper bound of each dimension,
+//! followed by the minimum width.
+template<typename MetricType, typename ElemType>
+class FlatBound<bound::HRectBound<MetricType, ElemType>>
+{
+ public:
+  static size_t Size(const size_t dim) { return 2 * dim + 1; }
+
+  static void Write(const bound::HRectBound<MetricType, ElemType>& bound,
+                    double* values);
+
+  static void Read(const double* values,
+                   bound::HRectBound<MetricType, ElemType>& bound);
+};
+
+//! Store a BallBound as its center followed by its radius.
+template<typename MetricType, typename VecType>
+class FlatBound<bound::BallBound<MetricType, VecType>>
+{
+ public:
+  static size_t Size(const size_t dim) { return dim + 1; }
+
+  static void Write(const bound::BallBound<MetricType, VecType>& bound,
+                    double* values);
+
+  static void Read(const double* values,
+                   bound::BallBound<MetricType, VecType>& bound);
+};
+
+/**
+ * FlatTree saves a BinarySpaceTree (such as a kd-tree or a ball tree) to a
+ * file with a flat, pointer-free layout, and loads it back from a
+ * data::MappedFile.  The file holds a header, the dataset as one column-major
+ * block, the nodes as one array, and the bounds of all nodes as one array.
+ *
+ * When the tree is loaded, the dataset of the tree points straight into the
+ * mapped file, so only the pages that are touched by a search are read from
+ * disk, and several processes that load the same file share the page cache.
+ * The nodes are rebuilt from the node array in one pass, without
+ * boost::serialization; the statistics of the nodes are built again with the
+ * StatisticType constructor, as when the tree is built.
+ *
+ * For example, a kNN index can be saved and loaded like this:
+ *
+ * @code
+ * typedef KNN::Tree TreeType;
+ *
+ * std::vector<size_t> oldFromNew;
+ * TreeType tree(dataset, oldFromNew);
+ * FlatTree<TreeType>::Save("index.bin", tree, oldFromNew);
+ *
+ * // Later, maybe in another process.
+ * data::MappedFile file("index.bin");
+ * std::vector<size_t> loadedOldFromNew;
+ * TreeType* loadedTree = FlatTree<TreeType>::Load(file, loadedOldFromNew);
+ * KNN knn(std::move(*loadedTree));
+ * delete loadedTree;
+ * @endcode
+ *
+ * The MappedFile must outlive the tree (and anything that the tree is moved
+ * into).  The file is not portable between machines with different byte
+ * orders.
+ *
+ * @tparam TreeType Type of BinarySpaceTree; its bound must be an HRectBound or
+ *     a BallBound, and its MatType must be a dense Armadillo matrix.
+ */
+template<typename TreeType>
+class FlatTree
+{
+ public:
+  //! The type of the dataset held by the tree.
+  typedef typename TreeType::Mat MatType;
+  //! The type of element held in the dataset.
+  typedef typename MatType::elem_type ElemType;
+  //! The type of the bound of each node.
+  typedef typename std::remove_cv<typename std::remove_reference<
+      decltype(std::declval<TreeType&>().Bound())>::type>::type BoundType;
+
+  //! The version of the file format written by Save().
+  static const uint64_t Version = 1;
+
+  /**
+   * Save the given tree to the given file.  A std::runtime_error is thrown if
+   * the file can't be written, and a std::invalid_argument if the points of
+   * the tree are not contiguous in its dataset (because it was changed with
+   * Insert() or Remove(); build it again first).
+   *
+   * @param filename Name of the file to write.
+   * @param tree Root of the tree to save.
+   * @param oldFromNew Mapping from new to old point indices, as returned by
+   *     the tree constructor; it may be empty.
+   */
+  static void Save(const std::string& filename,
+                   const TreeType& tree,
+                   const std::vector<size_t>& oldFromNew =
+                       std::vector<size_t>());
+
+  /**
+   * Load a tree from the given mapped file.  The dataset of the returned tree
+   * is stored in the mapped file.  A std::runtime_error is thrown if the file
+   * isn't a flat tree file for this type of tree.
+   *
+   * @param file Mapped flat tree file; it must outlive the returned tree.
+   * @param oldFromNew Filled with the mapping from new to old point indices,
+   *     if it was saved (otherwise it is emptied).
+   * @return The root of the tree; it must be deleted by the caller.
+   */
+  static TreeType* Load(const data::MappedFile& file,
+                        std::vector<size_t>& oldFromNew);
+
+ private:
+  //! Append the given node and its descendants to the node and bound arrays.
+  static void Flatten(const TreeType& node,
+                      const size_t boundSize,
+                      std::vector<FlatTreeNode>& nodes,
+                      std::vector<double>& bounds);
+
+  //! Set up the given node and its descendants from the node and bound arrays.
+  //! Nodes that were already visited, and children that don't split the points
+  //! of their parent, are rejected.
+  static void Unflatten(TreeType& node,
+                        const size_t index,
+                        const FlatTreeHeader& header,
+                        const FlatTreeNode* nodes,
+                        const double* bounds,
+                        MatType* dataset,
+                        std::vector<bool>& visited);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_tree_impl.hpp"
+
+#endif
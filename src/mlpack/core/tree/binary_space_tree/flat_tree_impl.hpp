@@ -0,0 +1,348 @@
+/**
+ * @file flat_tree_impl.hpp
+ *
+ * Implementation of FlatTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_IMPL_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_TREE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_tree.hpp"
+
+#include <cstring>
+#include <fstream>
+
+namespace mlpack {
+namespace tree {
+
+template<typename MetricType, typename ElemType>
+void FlatBound<bound::HRectBound<MetricType, ElemType>>::Write(
+    const bound::HRectBound<MetricType, ElemType>& bound,
+    double* values)
+{
+  for (size_t i = 0; i < bound.Dim(); ++i)
+  {
+    values[2 * i] = bound[i].Lo();
+    values[2 * i + 1] = bound[i].Hi();
+  }
+  values[2 * bound.Dim()] = bound.MinWidth();
+}
+
+template<typename MetricType, typename ElemType>
+void FlatBound<bound::HRectBound<MetricType, ElemType>>::Read(
+    const double* values,
+    bound::HRectBound<MetricType, ElemType>& bound)
+{
+  for (size_t i = 0; i < bound.Dim(); ++i)
+  {
+    bound[i].Lo() = values[2 * i];
+    bound[i].Hi() = values[2 * i + 1];
+  }
+  bound.MinWidth() = values[2 * bound.Dim()];
+}
+
+template<typename MetricType, typename VecType>
+void FlatBound<bound::BallBound<MetricType, VecType>>::Write(
+    const bound::BallBound<MetricType, VecType>& bound,
+    double* values)
+{
+  for (size_t i = 0; i < bound.Dim(); ++i)
+    values[i] = bound.Center()[i];
+  values[bound.Dim()] = bound.Radius();
+}
+
+template<typename MetricType, typename VecType>
+void FlatBound<bound::BallBound<MetricType, VecType>>::Read(
+    const double* values,
+    bound::BallBound<MetricType, VecType>& bound)
+{
+  for (size_t i = 0; i < bound.Dim(); ++i)
+    bound.Center()[i] = values[i];
+  bound.Radius() = values[bound.Dim()];
+}
+
+//! Round the given offset up to a multiple of 64 bytes.
+inline uint64_t FlatTreeAlign(const uint64_t offset)
+{
+  return (offset + 63) / 64 * 64;
+}
+
+/**
+ * Check that a block of rows * cols elements of the given size, starting at the
+ * given offset, fits in a file of the given size.  The sizes are read from the
+ * file and can be anything, so the check is done with divisions: the products
+ * could overflow.
+ */
+inline bool FlatTreeBlockFits(const uint64_t offset,
+                              const uint64_t rows,
+                              const uint64_t cols,
+                              const uint64_t elemSize,
+                              const uint64_t fileSize)
+{
+  if (offset > fileSize)
+    return false;
+  if (rows == 0 || cols == 0)
+    return true;
+
+  return (rows <= (fileSize - offset) / elemSize / cols);
+}
+
+template<typename TreeType>
+void FlatTree<TreeType>::Save(const std::string& filename,
+                              const TreeType& tree,
+                              const std::vector<size_t>& oldFromNew)
+{
+  if (!tree.IsContiguous())
+    throw std::invalid_argument("cannot save a tree whose points are not "
+        "contiguous in the dataset");
+
+  const MatType& dataset = tree.Dataset();
+  const size_t boundSize = FlatBound<BoundType>::Size(tree.Bound().Dim());
+
+  std::vector<FlatTreeNode> nodes;
+  std::vector<double> bounds;
+  Flatten(tree, boundSize, nodes, bounds);
+
+  FlatTreeHeader header;
+  std::memset(&header, 0, sizeof(FlatTreeHeader));
+  std::memcpy(header.magic, "MLPKTREE", 8);
+  header.version = Version;
+  header.elemSize = sizeof(ElemType);
+  header.nRows = dataset.n_rows;
+  header.nCols = dataset.n_cols;
+  header.numNodes = nodes.size();
+  header.boundSize = boundSize;
+  header.mappingSize = oldFromNew.size();
+
+  // Each block starts on a 64-byte boundary, so that the dataset can be used
+  // in place.
+  header.dataOffset = FlatTreeAlign(sizeof(FlatTreeHeader));
+  header.nodesOffset = FlatTreeAlign(header.dataOffset +
+      sizeof(ElemType) * dataset.n_elem);
+  header.boundsOffset = FlatTreeAlign(header.nodesOffset +
+      sizeof(FlatTreeNode) * nodes.size());
+  header.mappingOffset = FlatTreeAlign(header.boundsOffset +
+      sizeof(double) * bounds.size());
+
+  std::vector<uint64_t> mapping(oldFromNew.begin(), oldFromNew.end());
+
+  std::ofstream stream(filename.c_str(), std::ios::binary);
+  if (!stream.is_open())
+    throw std::runtime_error("cannot open file '" + filename + "' for writing");
+
+  const char padding[64] = { 0 };
+  uint64_t position = 0;
+  auto writeBlock = [&](const uint64_t offset, const void* data,
+                        const size_t size)
+  {
+    stream.write(padding, offset - position);
+    stream.write((const char*) data, size);
+    position = offset + size;
+  };
+
+  writeBlock(0, &header, sizeof(FlatTreeHeader));
+  writeBlock(header.dataOffset, dataset.memptr(),
+      sizeof(ElemType) * dataset.n_elem);
+  writeBlock(header.nodesOffset, nodes.data(),
+      sizeof(FlatTreeNode) * nodes.size());
+  writeBlock(header.boundsOffset, bounds.data(),
+      sizeof(double) * bounds.size());
+  writeBlock(header.mappingOffset, mapping.data(),
+      sizeof(uint64_t) * mapping.size());
+
+  if (!stream.good())
+    throw std::runtime_error("cannot write file '" + filename + "'");
+}
+
+template<typename TreeType>
+TreeType* FlatTree<TreeType>::Load(const data::MappedFile& file,
+                                   std::vector<size_t>& oldFromNew)
+{
+  const std::string error = "'" + file.Filename() + "' is not a valid flat "
+      "tree file for this tree type";
+
+  if (file.Size() < sizeof(FlatTreeHeader))
+    throw std::runtime_error(error);
+
+  FlatTreeHeader header;
+  std::memcpy(&header, file.Data(), sizeof(FlatTreeHeader));
+  if (std::memcmp(header.magic, "MLPKTREE", 8) != 0 ||
+      header.version != Version ||
+      header.elemSize != sizeof(ElemType) ||
+      header.numNodes == 0 ||
+      header.boundSize != FlatBound<BoundType>::Size(header.nRows) ||
+      (header.mappingSize != 0 && header.mappingSize != header.nCols))
+  {
+    throw std::runtime_error(error);
+  }
+
+  // Make sure that every block fits in the file.
+  if (!FlatTreeBlockFits(header.dataOffset, header.nRows, header.nCols,
+          header.elemSize, file.Size()) ||
+      !FlatTreeBlockFits(header.nodesOffset, header.numNodes, 1,
+          sizeof(FlatTreeNode), file.Size()) ||
+      !FlatTreeBlockFits(header.boundsOffset, header.boundSize,
+          header.numNodes, sizeof(double), file.Size()) ||
+      !FlatTreeBlockFits(header.mappingOffset, header.mappingSize, 1,
+          sizeof(uint64_t), file.Size()))
+  {
+    throw std::runtime_error(error);
+  }
+
+  const FlatTreeNode* nodes =
+      (const FlatTreeNode*) (file.Data() + header.nodesOffset);
+  const double* bounds = (const double*) (file.Data() + header.boundsOffset);
+  const uint64_t* mapping =
+      (const uint64_t*) (file.Data() + header.mappingOffset);
+
+  // The mapping is used to index matrices of results, so it has to be a
+  // permutation of the points.
+  std::vector<bool> mapped(header.mappingSize, false);
+  for (size_t i = 0; i < header.mappingSize; ++i)
+  {
+    if (mapping[i] >= header.mappingSize || mapped[mapping[i]])
+      throw std::runtime_error(error);
+    mapped[mapping[i]] = true;
+  }
+  oldFromNew.assign(mapping, mapping + header.mappingSize);
+
+  // The root holds all the points.
+  if (nodes[0].begin != 0 || nodes[0].count != header.nCols)
+    throw std::runtime_error(error);
+
+  // Use the dataset in place: Armadillo doesn't take ownership of auxiliary
+  // memory, so deleting the matrix with the tree leaves the mapping alone.
+  MatType* dataset = new MatType((ElemType*) (file.Data() + header.dataOffset),
+      header.nRows, header.nCols, false, true);
+
+  // The root owns the dataset, so everything is cleaned up by deleting the
+  // root if the file turns out to be invalid.
+  TreeType* tree = new TreeType();
+  tree->dataset = dataset;
+  try
+  {
+    std::vector<bool> visited(header.numNodes, false);
+    Unflatten(*tree, 0, header, nodes, bounds, dataset, visited);
+  }
+  catch (...)
+  {
+    delete tree;
+    throw;
+  }
+
+  return tree;
+}
+
+template<typename TreeType>
+void FlatTree<TreeType>::Flatten(const TreeType& node,
+                                 const size_t boundSize,
+                                 std::vector<FlatTreeNode>& nodes,
+                                 std::vector<double>& bounds)
+{
+  const size_t index = nodes.size();
+  nodes.push_back(FlatTreeNode());
+  bounds.resize(bounds.size() + boundSize);
+
+  nodes[index].begin = node.Begin();
+  nodes[index].count = node.Count();
+  nodes[index].parentDistance = node.ParentDistance();
+  nodes[index].furthestDescendantDistance = node.FurthestDescendantDistance();
+  nodes[index].minimumBoundDistance = node.MinimumBoundDistance();
+  FlatBound<BoundType>::Write(node.Bound(), &bounds[index * boundSize]);
+
+  nodes[index].left = 0;
+  nodes[index].right = 0;
+  if (node.Left())
+  {
+    nodes[index].left = nodes.size();
+    Flatten(*node.Left(), boundSize, nodes, bounds);
+  }
+  if (node.Right())
+  {
+    nodes[index].right = nodes.size();
+    Flatten(*node.Right(), boundSize, nodes, bounds);
+  }
+}
+
+template<typename TreeType>
+void FlatTree<TreeType>::Unflatten(TreeType& node,
+                                   const size_t index,
+                                   const FlatTreeHeader& header,
+                                   const FlatTreeNode* nodes,
+                                   const double* bounds,
+                                   MatType* dataset,
+                                   std::vector<bool>& visited)
+{
+  // Each node must have exactly one parent; otherwise a corrupt file could
+  // make us build the same subtree many times.
+  if (visited[index])
+    throw std::runtime_error("invalid node in flat tree file");
+  visited[index] = true;
+
+  const FlatTreeNode& flatNode = nodes[index];
+  if (flatNode.count > header.nCols ||
+      flatNode.begin > header.nCols - flatNode.count ||
+      flatNode.left >= header.numNodes || flatNode.right >= header.numNodes ||
+      (flatNode.left != 0 && flatNode.left <= index) ||
+      (flatNode.right != 0 && flatNode.right <= index))
+  {
+    throw std::runtime_error("invalid node in flat tree file");
+  }
+
+  // The children have to split the points of the node between them, in order;
+  // otherwise pruning would skip points.
+  if ((flatNode.left == 0) != (flatNode.right == 0))
+    throw std::runtime_error("invalid node in flat tree file");
+  if (flatNode.left != 0)
+  {
+    const FlatTreeNode& left = nodes[flatNode.left];
+    const FlatTreeNode& right = nodes[flatNode.right];
+    if (left.begin != flatNode.begin || left.count > flatNode.count ||
+        right.begin != flatNode.begin + left.count ||
+        right.count != flatNode.count - left.count)
+    {
+      throw std::runtime_error("invalid node in flat tree file");
+    }
+  }
+
+  node.begin = flatNode.begin;
+  node.count = flatNode.count;
+  node.parentDistance = flatNode.parentDistance;
+  node.furthestDescendantDistance = flatNode.furthestDescendantDistance;
+  node.minimumBoundDistance = flatNode.minimumBoundDistance;
+  node.dataset = dataset;
+  node.bound = BoundType(header.nRows);
+  FlatBound<BoundType>::Read(bounds + index * header.boundSize, node.bound);
+
+  // The children are owned by the node as soon as they are attached, so that
+  // they are cleaned up if a later node is invalid.
+  if (flatNode.left != 0)
+  {
+    node.left = new TreeType();
+    node.left->parent = &node;
+    Unflatten(*node.left, flatNode.left, header, nodes, bounds, dataset,
+        visited);
+  }
+  if (flatNode.right != 0)
+  {
+    node.right = new TreeType();
+    node.right->parent = &node;
+    Unflatten(*node.right, flatNode.right, header, nodes, bounds, dataset,
+        visited);
+  }
+
+  // The statistic is built once the children are ready, as in the tree
+  // constructor.
+  node.stat = typename std::remove_reference<decltype(node.Stat())>::type(
+      node);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
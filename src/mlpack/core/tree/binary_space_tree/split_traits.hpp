@@ -0,0 +1,64 @@
+/**
+ * @file split_traits.hpp
+ *
+ * This file defines the SplitTraits class, which describes properties of the
+ * split types used by the BinarySpaceTree, and its specializations for the
+ * split types in mlpack.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+
+#include "mean_split.hpp"
+#include "midpoint_split.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The SplitTraits class describes a split type used by the BinarySpaceTree.
+ * The unspecialized class holds the conservative defaults; a split type that
+ * has different properties should specialize this class.
+ */
+template<typename SplitType>
+class SplitTraits
+{
+ public:
+  /**
+   * If true, SplitNode() may be called on disjoint nodes at the same time, and
+   * the splits it chooses do not depend on the order of those calls.  This
+   * means it may not use random numbers or hold state that is shared between
+   * nodes.  In that case the BinarySpaceTree builds large children in parallel,
+   * and the resulting tree is the same as a serial build.
+   */
+  static const bool IndependentSplits = false;
+};
+
+/**
+ * The mean split only looks at the points in the node that is being split.
+ */
+template<typename BoundType, typename MatType>
+class SplitTraits<MeanSplit<BoundType, MatType>>
+{
+ public:
+  static const bool IndependentSplits = true;
+};
+
+/**
+ * The midpoint split only looks at the bound of the node that is being split.
+ */
+template<typename BoundType, typename MatType>
+class SplitTraits<MidpointSplit<BoundType, MatType>>
+{
+ public:
+  static const bool IndependentSplits = true;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file block_single_tree_traverser.hpp
+ *
+ * A single-tree traverser which traverses the reference tree once for a whole
+ * block of query points, instead of once for each query point.  The RuleType
+ * class must implement a block BaseCase() that takes a set of query indices and
+ * a reference node.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BLOCK_SINGLE_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_BLOCK_SINGLE_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The BlockSingleTreeTraverser visits a reference node as long as at least one
+ * query point of the block cannot prune it.  Each node carries the subset of
+ * the block that is still active there, so a query point that prunes a node is
+ * not considered again anywhere below it.  When a node holding points is
+ * reached, the base cases between all active query points and all points of
+ * the node are computed with one call to the block BaseCase() of the rules,
+ * which allows the distances to be computed as a dense block.
+ *
+ * Children are visited in order of the best score any active query point gives
+ * them, and the scores are checked again with Rescore() before the recursion,
+ * since the bounds may have improved while visiting the earlier children.
+ *
+ * This traverser requires that each point is held by exactly one node, so it
+ * cannot be used with trees where the first point of a node is its centroid
+ * (like the cover tree) or with spill trees.
+ */
+template<typename TreeType, typename RuleType>
+class BlockSingleTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the block single tree traverser with the given rule set.
+   */
+  BlockSingleTreeTraverser(RuleType& rule);
+
+  /**
+   * Traverse the tree with the given block of query points.
+   *
+   * @param queryIndices The indices of the points in the query set which are
+   *     being used as query points.
+   * @param referenceNode The tree node to be traversed.
+   */
+  void Traverse(const arma::uvec& queryIndices, TreeType& referenceNode);
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+ private:
+  /**
+   * Visit the given reference node with the given query points, all of which
+   * are known not to prune it.
+   */
+  void TraverseActive(const arma::uvec& queryIndices, TreeType& referenceNode);
+
+  //! Reference to the rules with which the tree will be traversed.
+  RuleType& rule;
+
+  //! The number of nodes which have been pruned for all query points of a
+  //! block during traversal.
+  size_t numPrunes;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "block_single_tree_traverser_impl.hpp"
+
+#endif
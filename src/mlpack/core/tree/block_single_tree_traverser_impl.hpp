@@ -0,0 +1,131 @@
+/**
+ * @file block_single_tree_traverser_impl.hpp
+ *
+ * Implementation of the BlockSingleTreeTraverser, which traverses the
+ * reference tree once for a whole block of query points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BLOCK_SINGLE_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_BLOCK_SINGLE_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "block_single_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType, typename RuleType>
+BlockSingleTreeTraverser<TreeType, RuleType>::BlockSingleTreeTraverser(
+    RuleType& rule) :
+    rule(rule),
+    numPrunes(0)
+{ /* Nothing to do. */ }
+
+template<typename TreeType, typename RuleType>
+void BlockSingleTreeTraverser<TreeType, RuleType>::Traverse(
+    const arma::uvec& queryIndices,
+    TreeType& referenceNode)
+{
+  // Find the query points that can't prune the root.
+  arma::uvec active(queryIndices.n_elem);
+  size_t numActive = 0;
+  for (size_t i = 0; i < queryIndices.n_elem; ++i)
+    if (rule.Score(queryIndices[i], referenceNode) != DBL_MAX)
+      active[numActive++] = queryIndices[i];
+
+  if (numActive == 0)
+  {
+    ++numPrunes;
+    return;
+  }
+
+  active.resize(numActive);
+  TraverseActive(active, referenceNode);
+}
+
+template<typename TreeType, typename RuleType>
+void BlockSingleTreeTraverser<TreeType, RuleType>::TraverseActive(
+    const arma::uvec& queryIndices,
+    TreeType& referenceNode)
+{
+  // Run the base cases for all the points held in the reference node at once.
+  if (referenceNode.NumPoints() > 0)
+    rule.BaseCase(queryIndices, referenceNode);
+
+  if (referenceNode.IsLeaf())
+    return;
+
+  // Score every child for every active query point, and keep the query points
+  // that don't prune each child.
+  const size_t numChildren = referenceNode.NumChildren();
+  std::vector<arma::uvec> childQueries(numChildren);
+  std::vector<arma::vec> childScores(numChildren);
+  std::vector<std::pair<double, size_t>> order;
+  order.reserve(numChildren);
+
+  for (size_t c = 0; c < numChildren; ++c)
+  {
+    TreeType& child = referenceNode.Child(c);
+    childQueries[c].set_size(queryIndices.n_elem);
+    childScores[c].set_size(queryIndices.n_elem);
+
+    size_t numActive = 0;
+    double bestScore = DBL_MAX;
+    for (size_t i = 0; i < queryIndices.n_elem; ++i)
+    {
+      const double score = rule.Score(queryIndices[i], child);
+      if (score == DBL_MAX)
+        continue;
+
+      childQueries[c][numActive] = queryIndices[i];
+      childScores[c][numActive] = score;
+      ++numActive;
+      bestScore = std::min(bestScore, score);
+    }
+
+    if (numActive == 0)
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    childQueries[c].resize(numActive);
+    childScores[c].resize(numActive);
+    order.push_back(std::make_pair(bestScore, c));
+  }
+
+  // Visit the most promising children first.
+  std::sort(order.begin(), order.end());
+
+  for (size_t o = 0; o < order.size(); ++o)
+  {
+    const size_t c = order[o].second;
+    TreeType& child = referenceNode.Child(c);
+
+    // The earlier children may have tightened the bounds of some query points.
+    size_t numActive = 0;
+    for (size_t i = 0; i < childQueries[c].n_elem; ++i)
+    {
+      if (rule.Rescore(childQueries[c][i], child, childScores[c][i]) != DBL_MAX)
+        childQueries[c][numActive++] = childQueries[c][i];
+    }
+
+    if (numActive == 0)
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    childQueries[c].resize(numActive);
+    TraverseActive(childQueries[c], child);
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
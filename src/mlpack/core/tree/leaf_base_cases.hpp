@@ -0,0 +1,119 @@
+/**
+ * @file leaf_base_cases.hpp
+ *
+ * Evaluate the base cases between two leaves during a dual-tree traversal.  If
+ * the rules can compute a whole block of base cases at once, the query points
+ * that can't prune the reference leaf are collected and handed to the rules in
+ * one call; otherwise each pair is evaluated with BaseCase().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_LEAF_BASE_CASES_HPP
+#define MLPACK_CORE_TREE_LEAF_BASE_CASES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace tree {
+
+HAS_MEM_FUNC(BaseCase, HasBlockBaseCaseCheck);
+
+/**
+ * HasBlockBaseCase<RuleType, TreeType>::value is true if RuleType has a method
+ * void BaseCase(const arma::uvec& queryIndices, TreeType& referenceNode) that
+ * computes the base cases between the given query points and all points held
+ * in the reference node.
+ */
+template<typename RuleType, typename TreeType>
+struct HasBlockBaseCase
+{
+  static const bool value = HasBlockBaseCaseCheck<RuleType,
+      void(RuleType::*)(const arma::uvec&, TreeType&)>::value;
+};
+
+/**
+ * Evaluate the base cases between the query leaf and the reference leaf with
+ * the block BaseCase() of the rules.  For each query point the reference leaf
+ * is scored first (with the given traversal info restored), and only the
+ * query points that can't prune it take part in the block.
+ *
+ * @param rule Rules to use.
+ * @param traversalInfo Traversal info to restore before each Score() call.
+ * @param queryNode Query leaf.
+ * @param referenceNode Reference leaf.
+ * @param numBaseCases Incremented by the number of base cases.
+ * @return The number of query points that pruned the reference leaf.
+ */
+template<typename RuleType, typename TreeType>
+size_t LeafBaseCases(
+    RuleType& rule,
+    const typename RuleType::TraversalInfoType& traversalInfo,
+    TreeType& queryNode,
+    TreeType& referenceNode,
+    size_t& numBaseCases,
+    const typename std::enable_if<
+        HasBlockBaseCase<RuleType, TreeType>::value>::type* = 0)
+{
+  arma::uvec queryIndices(queryNode.NumPoints());
+  size_t numActive = 0;
+  for (size_t i = 0; i < queryNode.NumPoints(); ++i)
+  {
+    rule.TraversalInfo() = traversalInfo;
+    if (rule.Score(queryNode.Point(i), referenceNode) != DBL_MAX)
+      queryIndices[numActive++] = queryNode.Point(i);
+  }
+
+  if (numActive > 0)
+  {
+    queryIndices.resize(numActive);
+    rule.BaseCase(queryIndices, referenceNode);
+    numBaseCases += numActive * referenceNode.NumPoints();
+  }
+
+  return queryNode.NumPoints() - numActive;
+}
+
+/**
+ * Evaluate the base cases between the query leaf and the reference leaf one
+ * pair at a time, for rules that don't have a block BaseCase().
+ */
+template<typename RuleType, typename TreeType>
+size_t LeafBaseCases(
+    RuleType& rule,
+    const typename RuleType::TraversalInfoType& traversalInfo,
+    TreeType& queryNode,
+    TreeType& referenceNode,
+    size_t& numBaseCases,
+    const typename std::enable_if<
+        !HasBlockBaseCase<RuleType, TreeType>::value>::type* = 0)
+{
+  size_t numPruned = 0;
+  for (size_t i = 0; i < queryNode.NumPoints(); ++i)
+  {
+    // See if we need to investigate this point.  Restore the traversal
+    // information first.
+    rule.TraversalInfo() = traversalInfo;
+    const size_t query = queryNode.Point(i);
+    if (rule.Score(query, referenceNode) == DBL_MAX)
+    {
+      ++numPruned; // We can't improve this particular point.
+      continue;
+    }
+
+    for (size_t ref = 0; ref < referenceNode.NumPoints(); ++ref)
+      rule.BaseCase(query, referenceNode.Point(ref));
+
+    numBaseCases += referenceNode.NumPoints();
+  }
+
+  return numPruned;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 
 // In case it hasn't been included yet.
 #include "dual_tree_traverser.hpp"
+#include <mlpack/core/tree/leaf_base_cases.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -44,26 +45,11 @@ void Octree<MetricType, StatisticType, MatType>::DualTreeTraverser<RuleType>::
 
   if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
-    const size_t begin = queryNode.Point(0);
-    const size_t end = begin + queryNode.NumPoints();
-    for (size_t q = begin; q < end; ++q)
-    {
-      // First, see if we can prune the reference node for this query point.
-      rule.TraversalInfo() = traversalInfo;
-      const double score = rule.Score(q, referenceNode);
-      if (score == DBL_MAX)
-      {
-        ++numPrunes;
-        continue;
-      }
-
-      const size_t rBegin = referenceNode.Point(0);
-      const size_t rEnd = rBegin + referenceNode.NumPoints();
-      for (size_t r = rBegin; r < rEnd; ++r)
-        rule.BaseCase(q, r);
-
-      numBaseCases += referenceNode.NumPoints();
-    }
+    // First, see if we can prune the reference node for each query point,
+    // then evaluate the base cases for the rest (as a block, if the rules
+    // allow it).
+    numPrunes += LeafBaseCases(rule, traversalInfo, queryNode, referenceNode,
+        numBaseCases);
   }
   else if (!queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
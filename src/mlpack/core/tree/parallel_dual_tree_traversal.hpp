@@ -0,0 +1,159 @@
+/**
+ * @file parallel_dual_tree_traversal.hpp
+ *
+ * A task-parallel driver for dual-tree traversals.  The query tree is split
+ * into a set of disjoint subtrees, and each of those is traversed against the
+ * reference tree by its own traverser and its own copy of the rules.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSAL_HPP
+#define MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSAL_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Split the given query node into a set of disjoint subtrees whose descendants
+ * together are exactly the descendants of the query node.  The node with the
+ * most descendants is split first, and splitting stops once there are at least
+ * the given number of subtrees, or once no subtree has more than
+ * minimumTaskSize descendants.  The subtrees are returned ordered from largest
+ * to smallest.
+ *
+ * @param queryNode Node to split.
+ * @param numTasks Desired number of subtrees.
+ * @param minimumTaskSize Subtrees with no more than this many descendants are
+ *     not split any further.
+ * @param frontier Vector to store the subtrees in.
+ */
+template<typename TreeType>
+void QueryTaskFrontier(TreeType& queryNode,
+                       const size_t numTasks,
+                       const size_t minimumTaskSize,
+                       std::vector<TreeType*>& frontier)
+{
+  frontier.clear();
+  frontier.push_back(&queryNode);
+
+  while (frontier.size() < numTasks)
+  {
+    // Find the largest subtree that can still be split.
+    size_t largest = frontier.size();
+    size_t largestSize = minimumTaskSize;
+    for (size_t i = 0; i < frontier.size(); ++i)
+    {
+      if (!frontier[i]->IsLeaf() &&
+          frontier[i]->NumDescendants() > largestSize)
+      {
+        largest = i;
+        largestSize = frontier[i]->NumDescendants();
+      }
+    }
+
+    if (largest == frontier.size())
+      break; // Nothing left to split.
+
+    // Replace the subtree with its children.
+    TreeType* node = frontier[largest];
+    frontier[largest] = &node->Child(0);
+    for (size_t i = 1; i < node->NumChildren(); ++i)
+      frontier.push_back(&node->Child(i));
+  }
+
+  // Start the largest tasks first so that the small ones fill in at the end.
+  std::stable_sort(frontier.begin(), frontier.end(),
+      [](const TreeType* a, const TreeType* b)
+      {
+        return a->NumDescendants() > b->NumDescendants();
+      });
+}
+
+/**
+ * Perform a dual-tree traversal of the given query and reference nodes, using
+ * all available OpenMP threads.  The query tree is split into subtrees with
+ * QueryTaskFrontier(), and the subtrees are handed out dynamically to the
+ * threads; each subtree is traversed against the whole reference tree by a
+ * separate TraverserType instance.
+ *
+ * Because the query subtrees are disjoint, two tasks never touch the results or
+ * the statistics of the same query point or query node, so no locking is
+ * necessary.  This places the following requirements on RuleType:
+ *
+ *  - A copy of the rules must share the result storage of the original (i.e.,
+ *    the neighbor candidate lists or the range search results) but hold its own
+ *    traversal information and counters.
+ *  - A dual-tree Score() or BaseCase() call may only modify state belonging to
+ *    the given query node and its descendants (and never the statistics of the
+ *    reference node, since the query and reference tree may be the same).
+ *  - BaseCases() and Scores() must be available, so that the counts of each
+ *    task can be added back to the given rules.
+ *
+ * The query tree must not have overlapping nodes (spill trees used as query
+ * trees must be built with tau = 0).  If mlpack is compiled without OpenMP, or
+ * only one thread is available, this is the same as a regular traversal.
+ *
+ * @param rule Rules to traverse with; the counts of every task are added to it.
+ * @param queryNode Root of the query tree to traverse.
+ * @param referenceNode Root of the reference tree to traverse.
+ * @param minimumTaskSize Query subtrees with no more than this many descendants
+ *     are not split into smaller tasks.
+ */
+template<typename TraverserType, typename RuleType, typename TreeType>
+void ParallelDualTreeTraversal(RuleType& rule,
+                               TreeType& queryNode,
+                               TreeType& referenceNode,
+                               const size_t minimumTaskSize = 1000)
+{
+#ifdef HAS_OPENMP
+  const size_t numThreads = (size_t) omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  if (numThreads == 1 || queryNode.NumDescendants() <= minimumTaskSize)
+  {
+    TraverserType traverser(rule);
+    traverser.Traverse(queryNode, referenceNode);
+    return;
+  }
+
+  // Create a few tasks per thread, so that the load stays balanced when some
+  // query subtrees prune much more than others.
+  std::vector<TreeType*> frontier;
+  QueryTaskFrontier(queryNode, 8 * numThreads, minimumTaskSize, frontier);
+
+  size_t baseCases = 0;
+  size_t scores = 0;
+
+  #pragma omp parallel for schedule(dynamic, 1) reduction(+:baseCases, scores)
+  for (omp_size_t i = 0; i < (omp_size_t) frontier.size(); ++i)
+  {
+    RuleType taskRule(rule);
+    taskRule.BaseCases() = 0;
+    taskRule.Scores() = 0;
+
+    TraverserType traverser(taskRule);
+    traverser.Traverse(*frontier[i], referenceNode);
+
+    baseCases += taskRule.BaseCases();
+    scores += taskRule.Scores();
+  }
+
+  rule.BaseCases() += baseCases;
+  rule.Scores() += scores;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -16,15 +16,124 @@
 #ifndef MLPACK_CORE_TREE_PERFORM_SPLIT_HPP
 #define MLPACK_CORE_TREE_PERFORM_SPLIT_HPP
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 namespace split {
 
+/**
+ * Nodes with at least this many points are partitioned by
+ * ParallelPerformSplit(), which evaluates AssignToLeftNode() in OpenMP tasks,
+ * when mlpack is compiled with OpenMP and the split happens inside a parallel
+ * region.
+ */
+const size_t ParallelSplitMinimumSize = 16384;
+
+/**
+ * Number of points handled by each of the tasks created by
+ * ParallelPerformSplit().
+ */
+const size_t ParallelSplitBlockSize = 4096;
+
+/**
+ * Rearrange the points according to the split information, like
+ * PerformSplit(), but evaluate SplitType::AssignToLeftNode() for blocks of
+ * points in separate OpenMP tasks.  The points are then swapped in the same
+ * pairs that the serial loop in PerformSplit() would choose, so the resulting
+ * order of the dataset (and of oldFromNew) is exactly the same.  Outside of a
+ * parallel region, the tasks are simply run one after another, so
+ * PerformSplit() only calls this inside one.
+ *
+ * @param data The dataset used by the binary space tree.
+ * @param begin Index of the starting point in the dataset that belongs to
+ *    this node.
+ * @param count Number of points in this node.
+ * @param splitInfo The information about the split.
+ * @param oldFromNew Vector holding the old positions for each new point, or
+ *    NULL if the mapping is not needed.
+ */
+template<typename MatType, typename SplitType>
+size_t ParallelPerformSplit(MatType& data,
+                            const size_t begin,
+                            const size_t count,
+                            const typename SplitType::SplitInfo& splitInfo,
+                            std::vector<size_t>* oldFromNew)
+{
+  // Pointers are used so that the tasks do not copy anything.
+  MatType* dataPtr = &data;
+  const typename SplitType::SplitInfo* splitInfoPtr = &splitInfo;
+  std::vector<char> assignLeft(count);
+  char* assignLeftPtr = assignLeft.data();
+
+  for (size_t blockBegin = 0; blockBegin < count;
+       blockBegin += ParallelSplitBlockSize)
+  {
+    #pragma omp task firstprivate(blockBegin)
+    {
+      const size_t blockEnd = std::min(blockBegin + ParallelSplitBlockSize,
+          count);
+      for (size_t i = blockBegin; i < blockEnd; ++i)
+      {
+        assignLeftPtr[i] = SplitType::AssignToLeftNode(
+            dataPtr->col(begin + i), *splitInfoPtr);
+      }
+    }
+  }
+  #pragma omp taskwait
+
+  const size_t numLeft = std::count(assignLeft.begin(), assignLeft.end(), 1);
+
+  // The serial loop swaps the i'th point from the left that belongs to the
+  // right child with the i'th point from the right that belongs to the left
+  // child, until the two scans meet at the split column.
+  std::vector<size_t> wrongLeft, wrongRight;
+  for (size_t i = 0; i < numLeft; ++i)
+    if (!assignLeft[i])
+      wrongLeft.push_back(begin + i);
+  for (size_t i = count; i > numLeft; --i)
+    if (assignLeft[i - 1])
+      wrongRight.push_back(begin + i - 1);
+
+  Log::Assert(wrongLeft.size() == wrongRight.size());
+
+  // Each pair of columns is distinct from all the others, so the swaps can be
+  // done in any order.
+  const size_t* wrongLeftPtr = wrongLeft.data();
+  const size_t* wrongRightPtr = wrongRight.data();
+  for (size_t blockBegin = 0; blockBegin < wrongLeft.size();
+       blockBegin += ParallelSplitBlockSize)
+  {
+    const size_t blockEnd = std::min(blockBegin + ParallelSplitBlockSize,
+        wrongLeft.size());
+
+    #pragma omp task firstprivate(blockBegin, blockEnd)
+    {
+      for (size_t i = blockBegin; i < blockEnd; ++i)
+      {
+        dataPtr->swap_cols(wrongLeftPtr[i], wrongRightPtr[i]);
+
+        if (oldFromNew)
+        {
+          std::swap((*oldFromNew)[wrongLeftPtr[i]],
+              (*oldFromNew)[wrongRightPtr[i]]);
+        }
+      }
+    }
+  }
+  #pragma omp taskwait
+
+  return begin + numLeft;
+}
+
 /**
  * This function implements the default split behavior i.e. it rearranges
  * points according to the split information. The SplitType::AssignToLeftNode()
  * function is used in order to determine the child that contains any particular
- * point.
+ * point.  Large nodes are handled by ParallelPerformSplit() inside a parallel
+ * region.
  *
  * @param data The dataset used by the binary space tree.
  * @param begin Index of the starting point in the dataset that belongs to
@@ -38,6 +147,15 @@ size_t PerformSplit(MatType& data,
                     const size_t count,
                     const typename SplitType::SplitInfo& splitInfo)
 {
+#ifdef HAS_OPENMP
+  // The tasks only pay off if there is a team of threads to run them.
+  if (count >= ParallelSplitMinimumSize && omp_get_level() > 0)
+  {
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, NULL);
+  }
+#endif
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -87,7 +205,8 @@ size_t PerformSplit(MatType& data,
  * points according to the split information. The SplitType::AssignToLeftNode()
  * function is used in order to determine the child that contains any particular
  * point. The function takes care of indices and returns the list of changed
- * indices.
+ * indices.  Large nodes are handled by ParallelPerformSplit() inside a
+ * parallel region.
  *
  * @param data The dataset used by the binary space tree.
  * @param begin Index of the starting point in the dataset that belongs to
@@ -104,6 +223,15 @@ size_t PerformSplit(MatType& data,
                     const typename SplitType::SplitInfo& splitInfo,
                     std::vector<size_t>& oldFromNew)
 {
+#ifdef HAS_OPENMP
+  // The tasks only pay off if there is a team of threads to run them.
+  if (count >= ParallelSplitMinimumSize && omp_get_level() > 0)
+  {
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, &oldFromNew);
+  }
+#endif
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
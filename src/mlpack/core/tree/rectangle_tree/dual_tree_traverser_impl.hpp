@@ -15,6 +15,7 @@
 #define MLPAC_CORE_TREE_RECTANGLE_TREE_DUAL_TREE_TRAVERSER_IMPL_HPP
 
 #include "dual_tree_traverser.hpp"
+#include <mlpack/core/tree/leaf_base_cases.hpp>
 
 #include <algorithm>
 #include <stack>
@@ -66,23 +67,10 @@ DualTreeTraverser<RuleType>::Traverse(RectangleTree& queryNode,
 
   if (queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
-    // Evaluate the base case.  Do the query points on the outside so we can
-    // possibly prune the reference node for that particular point.
-    for (size_t query = 0; query < queryNode.Count(); ++query)
-    {
-      // Restore the traversal information.
-      rule.TraversalInfo() = traversalInfo;
-      const double childScore = rule.Score(queryNode.Point(query),
-          referenceNode);
-
-      if (childScore == DBL_MAX)
-        continue;  // We don't require a search in this reference node.
-
-      for (size_t ref = 0; ref < referenceNode.Count(); ++ref)
-        rule.BaseCase(queryNode.Point(query), referenceNode.Point(ref));
-
-      numBaseCases += referenceNode.Count();
-    }
+    // Evaluate the base case.  The query points are scored first so we can
+    // possibly prune the reference node for that particular point; the rest
+    // are handed to the block BaseCase() of the rules if there is one.
+    LeafBaseCases(rule, traversalInfo, queryNode, referenceNode, numBaseCases);
   }
   else if (!queryNode.IsLeaf() && referenceNode.IsLeaf())
   {
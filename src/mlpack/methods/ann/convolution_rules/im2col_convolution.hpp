@@ -0,0 +1,376 @@
+/**
+ * @file im2col_convolution.hpp
+ *
+ * Implementation of the convolution through im2col and a matrix
+ * multiplication.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "border_modes.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the two-dimensional convolution by unfolding every filter-sized
+ * patch of the input into one row of a matrix (im2col), so that the
+ * convolution is a single matrix multiplication that BLAS can perform.  This
+ * class allows specification of the type of the border type. The convolution
+ * can be compute with the valid border type of the full border type (default).
+ *
+ * FullConvolution: returns the full two-dimensional convolution.
+ * ValidConvolution: returns only those parts of the convolution that are
+ * computed without the zero-padded edges.
+ *
+ * When used as the rule of the Convolution layer, the layer doesn't call
+ * Convolution() once per pair of maps, but uses Im2Col() and Col2Im() to
+ * compute the forward pass, the backward pass and the gradient for all the
+ * maps and all the samples of the batch with one matrix multiplication each.
+ *
+ * @tparam BorderMode Type of the border mode (FullConvolution or
+ * ValidConvolution).
+ */
+template<typename BorderMode = FullConvolution>
+class Im2ColConvolution
+{
+ public:
+  /*
+   * Unfold the patches of the given input into the rows of the given matrix,
+   * starting at the given row.  The matrix has one column per element of the
+   * filter, for every slice of the input: the column of element (i, j) of
+   * slice s is i + j * kW + s * kW * kH, which is the layout of the filters of
+   * the Convolution layer.  The row of output position (x, y) is
+   * offset + x + y * outputWidth, which is the layout of the output.  Patches
+   * that overlap the padding read zeros.
+   *
+   * @param input Input to unfold.
+   * @param kW Width of the filter.
+   * @param kH Height of the filter.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param padW Padding width of the input.
+   * @param padH Padding height of the input.
+   * @param columns Matrix to store the patches into; it must have at least
+   *     offset + outputWidth * outputHeight rows and kW * kH * input.n_slices
+   *     columns.
+   * @param offset Row of the first patch.
+   */
+  template<typename eT>
+  static void Im2Col(const arma::Cube<eT>& input,
+                     const size_t kW,
+                     const size_t kH,
+                     const size_t dW,
+                     const size_t dH,
+                     const size_t padW,
+                     const size_t padH,
+                     arma::Mat<eT>& columns,
+                     const size_t offset = 0)
+  {
+    const size_t outputWidth = OutputSize(input.n_rows, kW, dW, padW);
+    const size_t outputHeight = OutputSize(input.n_cols, kH, dH, padH);
+
+    for (size_t s = 0, k = 0; s < input.n_slices; ++s)
+    {
+      for (size_t kj = 0; kj < kH; ++kj)
+      {
+        for (size_t ki = 0; ki < kW; ++ki, ++k)
+        {
+          eT* columnPtr = columns.colptr(k) + offset;
+          for (size_t y = 0; y < outputHeight; ++y)
+          {
+            // Work with signed positions, since the padding is negative.
+            const ptrdiff_t col = (ptrdiff_t) (y * dH + kj) - (ptrdiff_t) padH;
+            if (col < 0 || col >= (ptrdiff_t) input.n_cols)
+            {
+              for (size_t x = 0; x < outputWidth; ++x, ++columnPtr)
+                *columnPtr = 0;
+              continue;
+            }
+
+            const eT* inputPtr = input.slice_colptr(s, col);
+            for (size_t x = 0; x < outputWidth; ++x, ++columnPtr)
+            {
+              const ptrdiff_t row = (ptrdiff_t) (x * dW + ki) -
+                  (ptrdiff_t) padW;
+              *columnPtr = (row < 0 || row >= (ptrdiff_t) input.n_rows) ? 0 :
+                  inputPtr[row];
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /*
+   * Fold the rows of the given matrix back into the patches of the given
+   * output; this is the transpose of Im2Col().  Overlapping patches are
+   * summed, and the parts of the patches that fall in the padding are
+   * dropped.  The output must have the size of the input given to Im2Col().
+   *
+   * @param columns Matrix that contains the patches, as given by Im2Col().
+   * @param kW Width of the filter.
+   * @param kH Height of the filter.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param padW Padding width of the input.
+   * @param padH Padding height of the input.
+   * @param output Output to add the patches to.
+   * @param offset Row of the first patch.
+   */
+  template<typename eT>
+  static void Col2Im(const arma::Mat<eT>& columns,
+                     const size_t kW,
+                     const size_t kH,
+                     const size_t dW,
+                     const size_t dH,
+                     const size_t padW,
+                     const size_t padH,
+                     arma::Cube<eT>& output,
+                     const size_t offset = 0)
+  {
+    const size_t outputWidth = OutputSize(output.n_rows, kW, dW, padW);
+    const size_t outputHeight = OutputSize(output.n_cols, kH, dH, padH);
+
+    for (size_t s = 0, k = 0; s < output.n_slices; ++s)
+    {
+      for (size_t kj = 0; kj < kH; ++kj)
+      {
+        for (size_t ki = 0; ki < kW; ++ki, ++k)
+        {
+          const eT* columnPtr = columns.colptr(k) + offset;
+          for (size_t y = 0; y < outputHeight; ++y)
+          {
+            const ptrdiff_t col = (ptrdiff_t) (y * dH + kj) - (ptrdiff_t) padH;
+            if (col < 0 || col >= (ptrdiff_t) output.n_cols)
+            {
+              columnPtr += outputWidth;
+              continue;
+            }
+
+            eT* outputPtr = output.slice_colptr(s, col);
+            for (size_t x = 0; x < outputWidth; ++x, ++columnPtr)
+            {
+              const ptrdiff_t row = (ptrdiff_t) (x * dW + ki) -
+                  (ptrdiff_t) padW;
+              if (row >= 0 && row < (ptrdiff_t) output.n_rows)
+                outputPtr[row] += *columnPtr;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /*
+   * Return the size of the output of the convolution in one dimension.
+   *
+   * @param size The size of the input (row or column).
+   * @param k The size of the filter (width or height).
+   * @param s The stride size (x or y direction).
+   * @param p The size of the padding (width or height).
+   */
+  static size_t OutputSize(const size_t size,
+                           const size_t k,
+                           const size_t s,
+                           const size_t p)
+  {
+    return (size + 2 * p < k) ? 0 : (size + 2 * p - k) / s + 1;
+  }
+
+  /*
+   * Perform a convolution (valid mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, ValidConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    Convolve(input, filter, output, dW, dH, 0, 0);
+  }
+
+  /*
+   * Perform a convolution (full mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, FullConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t /* dW */ = 1,
+              const size_t /* dH */ = 1)
+  {
+    // The full convolution is the valid convolution of the input padded with
+    // the filter size minus one.
+    Convolve(input, filter, output, 1, 1, filter.n_rows - 1, filter.n_cols - 1);
+  }
+
+  /*
+   * Perform a convolution using 3rd order tensors.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0),
+        filter.slice(0), convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i),
+          filter.slice(i), output.slice(i), dW, dH);
+    }
+  }
+
+  /*
+   * Perform a convolution using dense matrix as input and a 3rd order tensors
+   * as filter and output.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Mat<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(0),
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        filter.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < filter.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(i),
+          output.slice(i), dW, dH);
+    }
+  }
+
+  /*
+   * Perform a convolution using a 3rd order tensors as input and output and a
+   * dense matrix as filter.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Mat<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0), filter,
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i), filter,
+          output.slice(i), dW, dH);
+    }
+  }
+
+ private:
+  /*
+   * Convolve a single input map with a single filter: unfold the input and
+   * multiply it with the filter.
+   */
+  template<typename eT>
+  static void Convolve(const arma::Mat<eT>& input,
+                       const arma::Mat<eT>& filter,
+                       arma::Mat<eT>& output,
+                       const size_t dW,
+                       const size_t dH,
+                       const size_t padW,
+                       const size_t padH)
+  {
+    const size_t outputWidth = OutputSize(input.n_rows, filter.n_rows, dW,
+        padW);
+    const size_t outputHeight = OutputSize(input.n_cols, filter.n_cols, dH,
+        padH);
+
+    const arma::Cube<eT> inputCube(const_cast<eT*>(input.memptr()),
+        input.n_rows, input.n_cols, 1, false, true);
+    arma::Mat<eT> columns(outputWidth * outputHeight, filter.n_elem);
+    Im2Col(inputCube, filter.n_rows, filter.n_cols, dW, dH, padW, padH,
+        columns);
+
+    output = arma::reshape(columns * arma::vectorise(filter), outputWidth,
+        outputHeight);
+  }
+};
+
+/**
+ * Trait that tells the Convolution layer whether a convolution rule is an
+ * Im2ColConvolution, so that the layer can use one matrix multiplication for
+ * all the maps instead of one convolution per pair of maps.
+ */
+template<typename ConvolutionRule>
+struct IsIm2ColConvolution
+{
+  static const bool value = false;
+};
+
+template<typename BorderMode>
+struct IsIm2ColConvolution<Im2ColConvolution<BorderMode> >
+{
+  static const bool value = true;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -183,6 +183,12 @@ class FFN
    * and with respect to only one point in the dataset. This is useful for
    * optimizers such as SGD, which require a separable objective function.
    *
+   * If Threads() is larger than one, the batch is split between that many
+   * copies of the network that share the parameters, and the parts are
+   * processed in parallel with OpenMP; the gradients of the parts are then
+   * summed.  The result is the same as with one thread, up to the rounding of
+   * the sum.
+   *
    * @param parameters Matrix of the model parameters to be optimized.
    * @param begin Index of the starting point to use for objective function
    *        gradient evaluation.
@@ -219,6 +225,11 @@ class FFN
   //! Return the number of separable functions (the number of predictor points).
   size_t NumFunctions() const { return numFunctions; }
 
+  //! Get the number of threads that share each batch in Gradient().
+  size_t Threads() const { return threads; }
+  //! Modify the number of threads that share each batch in Gradient().
+  size_t& Threads() { return threads; }
+
   //! Return the initial point for the optimization.
   const arma::mat& Parameters() const { return parameter; }
   //! Modify the initial point for the optimization.
@@ -263,6 +274,9 @@ class FFN
    */
   size_t NetworkSize() const { return network.size(); }
   
+  //! Get the layers of the network.
+  const std::vector<LayerTypes>& Model() const { return network; }
+
   /**
    * Returns the layer of this network at the given index
    *
@@ -302,6 +316,29 @@ class FFN
    */
   void Gradient(arma::mat&& input);
 
+  /**
+   * Compute the gradient of the given batch, without evaluating the objective.
+   * This is the work of one thread in Gradient().
+   *
+   * @param input The input of the batch.
+   * @param target The responses of the batch.
+   * @param gradient Matrix to output the gradient into.
+   */
+  void BatchGradient(arma::mat&& input,
+                     arma::mat&& target,
+                     arma::mat& gradient);
+
+  /**
+   * Make sure that there are the given number of replicas of the network, that
+   * share the parameters of this network, for the data-parallel Gradient().
+   *
+   * @param count The number of replicas.
+   */
+  void PrepareReplicas(const size_t count);
+
+  //! Delete the replicas of the network.
+  void ClearReplicas();
+
   /**
    * Reset the module status by setting the current deterministic parameter
    * for all modules that implement the Deterministic function.
@@ -395,6 +432,18 @@ class FFN
 
   //! Locally-stored copy visitor
   CopyVisitor copyVisitor;
+
+  //! The number of threads that share each batch in Gradient().
+  size_t threads;
+
+  //! Copies of the network that share its parameters, one per extra thread.
+  std::vector<NetworkType*> replicas;
+
+  //! The gradients computed by the replicas.
+  std::vector<arma::mat> replicaGradients;
+
+  //! The parameter memory the replicas were built for.
+  const double* replicaParameter;
 }; // class FFN
 
 } // namespace ann
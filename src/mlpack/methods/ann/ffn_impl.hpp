@@ -22,6 +22,7 @@
 #include "visitor/gradient_visitor.hpp"
 #include "visitor/set_input_height_visitor.hpp"
 #include "visitor/set_input_width_visitor.hpp"
+#include "visitor/weight_set_visitor.hpp"
 
 #include <boost/serialization/variant.hpp>
 
@@ -38,7 +39,9 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     height(0),
     reset(false),
     numFunctions(0),
-    deterministic(true)
+    deterministic(true),
+    threads(1),
+    replicaParameter(NULL)
 {
   /* Nothing to do here */
 }
@@ -56,7 +59,9 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     reset(false),
     predictors(std::move(predictors)),
     responses(std::move(responses)),
-    deterministic(true)
+    deterministic(true),
+    threads(1),
+    replicaParameter(NULL)
 {
   numFunctions = this->responses.n_cols;
 }
@@ -64,6 +69,7 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
 template<typename OutputLayerType, typename InitializationRuleType>
 FFN<OutputLayerType, InitializationRuleType>::~FFN()
 {
+  ClearReplicas();
   std::for_each(network.begin(), network.end(),
       boost::apply_visitor(deleteVisitor));
 }
@@ -155,7 +161,7 @@ double FFN<OutputLayerType, InitializationRuleType>::Backward(
   outputLayer.Backward(std::move(boost::apply_visitor(outputParameterVisitor,
       network.back())), std::move(targets), std::move(error));
 
-  gradients = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+  gradients.zeros(parameter.n_rows, parameter.n_cols);
 
   Backward();
   ResetGradients(gradients);
@@ -224,10 +230,15 @@ double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
     ResetDeterministic();
   }
 
-  Forward(std::move(predictors.cols(begin, begin + batchSize - 1)));
+  // The batch is passed as an alias of the data, so that it isn't copied; the
+  // layers keep their outputs between calls, so once every layer has seen a
+  // batch of this size, no memory is allocated.
+  Forward(std::move(arma::mat(predictors.colptr(begin), predictors.n_rows,
+      batchSize, false, true)));
   double res = outputLayer.Forward(
       std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
-      std::move(responses.cols(begin, begin + batchSize - 1)));
+      std::move(arma::mat(responses.colptr(begin), responses.n_rows,
+      batchSize, false, true)));
 
   return res;
 }
@@ -251,16 +262,126 @@ void FFN<OutputLayerType, InitializationRuleType>::Gradient(
     gradient.zeros();
   }
 
+  const size_t parts = std::min(threads, batchSize);
+  if (parts > 1)
+  {
+    if (this->deterministic)
+    {
+      this->deterministic = false;
+      ResetDeterministic();
+    }
+
+    PrepareReplicas(parts - 1);
+
+    // Each thread computes the gradient of a contiguous part of the batch,
+    // with its own copy of the layers; the first part is done by this network.
+    #pragma omp parallel for num_threads(parts)
+    for (omp_size_t p = 0; p < (omp_size_t) parts; ++p)
+    {
+      const size_t partBegin = begin + p * batchSize / parts;
+      const size_t partSize = begin + (p + 1) * batchSize / parts - partBegin;
+
+      NetworkType& net = (p == 0) ? *this : *replicas[p - 1];
+      arma::mat& partGradient = (p == 0) ? gradient : replicaGradients[p - 1];
+      if (p != 0)
+        partGradient.zeros(parameter.n_rows, parameter.n_cols);
+
+      net.BatchGradient(arma::mat(predictors.colptr(partBegin),
+          predictors.n_rows, partSize, false, true),
+          arma::mat(responses.colptr(partBegin), responses.n_rows, partSize,
+          false, true), partGradient);
+    }
+
+    for (size_t p = 0; p < parts - 1; ++p)
+      gradient += replicaGradients[p];
+
+    return;
+  }
+
   Evaluate(parameters, begin, batchSize, false);
 
   outputLayer.Backward(
       std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
-      std::move(responses.cols(begin, begin + batchSize - 1)),
+      std::move(arma::mat(responses.colptr(begin), responses.n_rows,
+      batchSize, false, true)),
       std::move(error));
 
   Backward();
   ResetGradients(gradient);
-  Gradient(std::move(predictors.cols(begin, begin + batchSize - 1)));
+  Gradient(std::move(arma::mat(predictors.colptr(begin), predictors.n_rows,
+      batchSize, false, true)));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::BatchGradient(
+    arma::mat&& input, arma::mat&& target, arma::mat& gradient)
+{
+  Forward(std::move(input));
+
+  outputLayer.Backward(
+      std::move(boost::apply_visitor(outputParameterVisitor, network.back())),
+      std::move(target), std::move(error));
+
+  Backward();
+  ResetGradients(gradient);
+  Gradient(std::move(input));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::PrepareReplicas(
+    const size_t count)
+{
+  // The replicas point to the parameters, so they have to be rebuilt if the
+  // parameters moved or the network changed.
+  if (replicaParameter != parameter.memptr() || (!replicas.empty() &&
+      replicas[0]->network.size() != network.size()))
+  {
+    ClearReplicas();
+  }
+
+  replicaParameter = parameter.memptr();
+  while (replicas.size() < count)
+  {
+    NetworkType* replica = new NetworkType(outputLayer, initializeRule);
+    for (size_t i = 0; i < network.size(); ++i)
+      replica->network.push_back(boost::apply_visitor(copyVisitor, network[i]));
+
+    replica->width = width;
+    replica->height = height;
+    replica->reset = reset;
+
+    size_t offset = 0;
+    for (size_t i = 0; i < replica->network.size(); ++i)
+    {
+      offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+          offset), replica->network[i]);
+
+      boost::apply_visitor(resetVisitor, replica->network[i]);
+    }
+
+    replicas.push_back(replica);
+  }
+  replicaGradients.resize(replicas.size());
+
+  for (size_t i = 0; i < replicas.size(); ++i)
+  {
+    if (replicas[i]->deterministic != deterministic)
+    {
+      replicas[i]->deterministic = deterministic;
+      replicas[i]->ResetDeterministic();
+    }
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::ClearReplicas()
+{
+  for (size_t i = 0; i < replicas.size(); ++i)
+    delete replicas[i];
+
+  replicas.clear();
+  replicaGradients.clear();
+  replicaParameter = NULL;
 }
 
 template<typename OutputLayerType, typename InitializationRuleType>
@@ -408,6 +529,7 @@ void FFN<OutputLayerType, InitializationRuleType>::serialize(
   // Be sure to clear other layers before loading.
   if (Archive::is_loading::value)
   {
+    ClearReplicas();
     std::for_each(network.begin(), network.end(),
         boost::apply_visitor(deleteVisitor));
     network.clear();
@@ -454,6 +576,10 @@ void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
   std::swap(inputParameter, network.inputParameter);
   std::swap(outputParameter, network.outputParameter);
   std::swap(gradient, network.gradient);
+  std::swap(threads, network.threads);
+  std::swap(replicas, network.replicas);
+  std::swap(replicaGradients, network.replicaGradients);
+  std::swap(replicaParameter, network.replicaParameter);
 };
 
 template<typename OutputLayerType, typename InitializationRuleType>
@@ -474,7 +600,9 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(network.delta),
     inputParameter(network.inputParameter),
     outputParameter(network.outputParameter),
-    gradient(network.gradient)
+    gradient(network.gradient),
+    threads(network.threads),
+    replicaParameter(NULL)
 {
   // Build new layers according to source network
   for (size_t i = 0; i < network.network.size(); ++i)
@@ -502,7 +630,9 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(std::move(network.delta)),
     inputParameter(std::move(network.inputParameter)),
     outputParameter(std::move(network.outputParameter)),
-    gradient(std::move(network.gradient))
+    gradient(std::move(network.gradient)),
+    threads(network.threads),
+    replicaParameter(NULL)
 {
   this->network = std::move(network.network);
 };
@@ -0,0 +1,306 @@
+/**
+ * @file frozen_ffn.hpp
+ *
+ * Definition of the FrozenFFN class, an inference-only copy of a trained
+ * feedforward network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_FROZEN_FFN_HPP
+#define MLPACK_METHODS_ANN_FROZEN_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "ffn.hpp"
+#include "layer/layer.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * An inference-only version of a trained FFN.  Freezing the network copies
+ * its weights into one contiguous vector and turns its layers into a flat list
+ * of steps, where each linear or convolution layer is fused with the
+ * activation that follows it.  Predict() then runs the steps directly, without
+ * the layer variants and visitors of the FFN class and without the buffers
+ * needed for training.
+ *
+ * The weights can be stored with reduced precision, to cut the memory of the
+ * model:
+ *
+ *  - DOUBLE: the weights of the network, unchanged.
+ *  - FLOAT: single precision weights, and the steps are computed in single
+ *    precision (half the memory).
+ *  - INT8: each row of the weights of a linear layer (or each filter of a
+ *    convolution layer) is stored as 8-bit integers with one scale per row,
+ *    the largest weight being 127 times the scale (about an eighth of the
+ *    memory).  The inputs of these steps are quantized the same way, one scale
+ *    per point, and the products are accumulated as 32-bit integers.  The
+ *    biases and the other steps use single precision.
+ *
+ * Predict() is const and only keeps its intermediate results in local
+ * matrices, so one FrozenFFN can be used to predict from many threads at once.
+ * Changes to the original network after freezing have no effect on the
+ * FrozenFFN.
+ *
+ * The supported layers are Linear, LinearNoBias, Convolution, the BaseLayer
+ * activations (identity, logistic, tanh and rectifier), LogSoftMax and Dropout
+ * (which behaves as in the deterministic mode of the network).  Freezing a
+ * network with any other layer throws std::invalid_argument.
+ *
+ * @code
+ * FFN<> model;
+ * // Add layers and train the model...
+ *
+ * FrozenFFN frozen(model, FrozenFFN::INT8);
+ * arma::mat predictions;
+ * frozen.Predict(data, predictions);
+ * @endcode
+ */
+class FrozenFFN
+{
+ public:
+  //! The activation functions that can be applied by a step.
+  enum Activation
+  {
+    IDENTITY,
+    LOGISTIC,
+    TANH,
+    RECTIFIER,
+    LOG_SOFTMAX
+  };
+
+  //! The precisions the weights can be stored with.
+  enum Precision
+  {
+    DOUBLE,
+    FLOAT,
+    INT8
+  };
+
+  //! Create an empty FrozenFFN, that can be loaded with serialize().
+  FrozenFFN() : precision(DOUBLE) { }
+
+  /**
+   * Freeze the given trained network.  If the parameters of the network
+   * haven't been initialized yet, they are.  The input width and height of
+   * the convolution layers must be known, so a network whose inner
+   * convolution layers get their size from the previous layer must have been
+   * run once.
+   *
+   * @param network The network to freeze.
+   * @param precision The precision to store the weights with.
+   */
+  template<typename OutputLayerType, typename InitializationRuleType>
+  FrozenFFN(FFN<OutputLayerType, InitializationRuleType>& network,
+            const Precision precision = DOUBLE);
+
+  /**
+   * Predict the responses to the given predictors; with DOUBLE precision the
+   * results are the same as the results of FFN::Predict() on the original
+   * network, up to rounding.  This can be called from several threads at
+   * once.
+   *
+   * @param predictors Input predictors, one point per column.
+   * @param results Matrix to put the output predictions into.
+   */
+  void Predict(const arma::mat& predictors, arma::mat& results) const;
+
+  /**
+   * Predict the responses to the given single precision predictors, which
+   * avoids the conversions when the precision is FLOAT or INT8.  This can be
+   * called from several threads at once.
+   *
+   * @param predictors Input predictors, one point per column.
+   * @param results Matrix to put the output predictions into.
+   */
+  void Predict(const arma::fmat& predictors, arma::fmat& results) const;
+
+  //! Get the number of steps of the plan.
+  size_t NumSteps() const { return steps.size(); }
+
+  //! Get the precision of the weights.
+  Precision WeightPrecision() const { return precision; }
+
+  //! Get the memory used by the weights, in bytes.
+  size_t WeightBytes() const
+  {
+    return weights.n_elem * sizeof(double) +
+        floatWeights.n_elem * sizeof(float) + quantizedWeights.size();
+  }
+
+  //! Serialize the frozen network.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! One step of the plan: an optional affine transformation (or convolution)
+  //! followed by an activation, or a multiplication by a constant.
+  struct Step
+  {
+    //! The number of inputs of the affine transformation (for a convolution,
+    //! the size of a filter over all the input maps), or 0 if there is none.
+    size_t inSize;
+    //! The number of outputs of the affine transformation (for a convolution,
+    //! the number of output maps).
+    size_t outSize;
+    //! The number of rows of the output of the step, or 0 if it is the number
+    //! of rows of the input.
+    size_t outRows;
+    //! The offset of the weights in the storage of the precision.
+    size_t offset;
+    //! The offset of the scales and the biases in the single precision
+    //! weights, with INT8 precision.
+    size_t auxOffset;
+    //! The constant the input is multiplied with, if there is no affine
+    //! transformation.
+    double scale;
+    //! The activation applied to the output.
+    Activation activation;
+
+    //! The width of the input maps of a convolution, or 0 if the step isn't a
+    //! convolution.
+    size_t inputWidth;
+    //! The height of the input maps of a convolution.
+    size_t inputHeight;
+    //! The width of the filters.
+    size_t kW;
+    //! The height of the filters.
+    size_t kH;
+    //! The stride in the x direction.
+    size_t dW;
+    //! The stride in the y direction.
+    size_t dH;
+    //! The padding width.
+    size_t padW;
+    //! The padding height.
+    size_t padH;
+
+    //! Serialize the step.
+    template<typename Archive>
+    void serialize(Archive& ar, const unsigned int /* version */)
+    {
+      ar & BOOST_SERIALIZATION_NVP(inSize);
+      ar & BOOST_SERIALIZATION_NVP(outSize);
+      ar & BOOST_SERIALIZATION_NVP(outRows);
+      ar & BOOST_SERIALIZATION_NVP(offset);
+      ar & BOOST_SERIALIZATION_NVP(auxOffset);
+      ar & BOOST_SERIALIZATION_NVP(scale);
+      ar & BOOST_SERIALIZATION_NVP(activation);
+      ar & BOOST_SERIALIZATION_NVP(inputWidth);
+      ar & BOOST_SERIALIZATION_NVP(inputHeight);
+      ar & BOOST_SERIALIZATION_NVP(kW);
+      ar & BOOST_SERIALIZATION_NVP(kH);
+      ar & BOOST_SERIALIZATION_NVP(dW);
+      ar & BOOST_SERIALIZATION_NVP(dH);
+      ar & BOOST_SERIALIZATION_NVP(padW);
+      ar & BOOST_SERIALIZATION_NVP(padH);
+    }
+  };
+
+  /*
+   * Add an affine step with the given weights and bias to the plan, storing
+   * the weights with the precision of the plan.  The input of the step is
+   * multiplied with the given scale.
+   */
+  void AddAffine(const arma::mat& weight,
+                 const arma::vec& bias,
+                 const double scale);
+
+  /*
+   * Add a convolution step for the given layer to the plan.
+   */
+  template<typename ConvolutionType>
+  void AddConvolution(const ConvolutionType& layer, const double scale);
+
+  /*
+   * Add a step that multiplies its input with the given scale to the plan.
+   */
+  void AddScale(const double scale);
+
+  /*
+   * Add the given activation to the plan, fusing it with the last step if
+   * possible.
+   */
+  void AddActivation(const Activation activation);
+
+  /*
+   * Return a step without affine transformation, that multiplies its input
+   * with the given scale and then applies the given activation.
+   */
+  static Step ElementwiseStep(const double scale, const Activation activation);
+
+  /*
+   * Apply the given activation in place.
+   */
+  template<typename eT>
+  static void Apply(const Activation activation, arma::Mat<eT>& x);
+
+  /*
+   * Run all the steps on the given predictors.
+   */
+  template<typename eT>
+  void Run(const arma::Mat<eT>& predictors, arma::Mat<eT>& results) const;
+
+  /*
+   * Compute the affine transformation of the given step, with the precision
+   * of the plan.
+   */
+  template<typename eT>
+  void Affine(const Step& step,
+              const arma::Mat<eT>& input,
+              arma::Mat<eT>& output) const;
+
+  /*
+   * Compute the affine transformation of the given step with the 8-bit
+   * weights.
+   */
+  template<typename eT>
+  void QuantizedAffine(const Step& step,
+                       const arma::Mat<eT>& input,
+                       arma::Mat<eT>& output) const;
+
+  /*
+   * Compute the convolution of the given step, one point at a time.
+   */
+  template<typename eT>
+  void Convolve(const Step& step,
+                const arma::Mat<eT>& input,
+                arma::Mat<eT>& output) const;
+
+  //! Get the storage of the weights for the given element type.
+  const double* Storage(const double /* tag */) const
+  { return weights.memptr(); }
+  //! Get the storage of the weights for the given element type.
+  const float* Storage(const float /* tag */) const
+  { return floatWeights.memptr(); }
+
+  //! The precision of the weights.
+  Precision precision;
+
+  //! The steps of the plan, in order.
+  std::vector<Step> steps;
+
+  //! The weights and biases of all the steps, one after the other, with
+  //! DOUBLE precision.
+  arma::vec weights;
+
+  //! The weights and biases of all the steps with FLOAT precision, or the
+  //! scales and biases with INT8 precision.
+  arma::fvec floatWeights;
+
+  //! The 8-bit weights of all the steps with INT8 precision, one row of each
+  //! weight matrix after the other.
+  std::vector<int8_t> quantizedWeights;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "frozen_ffn_impl.hpp"
+
+#endif
@@ -0,0 +1,453 @@
+/**
+ * @file frozen_ffn_impl.hpp
+ *
+ * Implementation of the FrozenFFN class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_FROZEN_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_FROZEN_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "frozen_ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename OutputLayerType, typename InitializationRuleType>
+FrozenFFN::FrozenFFN(FFN<OutputLayerType, InitializationRuleType>& network,
+                     const Precision precision) :
+    precision(precision)
+{
+  typedef Convolution<NaiveConvolution<ValidConvolution>,
+      NaiveConvolution<FullConvolution>, NaiveConvolution<ValidConvolution>,
+      arma::mat, arma::mat> NaiveConvolutionType;
+  typedef Convolution<Im2ColConvolution<ValidConvolution>,
+      Im2ColConvolution<FullConvolution>, Im2ColConvolution<ValidConvolution>,
+      arma::mat, arma::mat> Im2ColConvolutionType;
+
+  if (network.Parameters().is_empty())
+    network.ResetParameters();
+
+  // The deterministic Dropout layers multiply their input with a constant,
+  // which is folded into the weights of the next affine step when there is
+  // one.
+  double scale = 1.0;
+  const std::vector<LayerTypes>& model = network.Model();
+  for (size_t i = 0; i < model.size(); ++i)
+  {
+    const LayerTypes& layer = model[i];
+    if (Linear<>* const* linear = boost::get<Linear<>*>(&layer))
+    {
+      AddAffine((*linear)->Weight(), (*linear)->Bias(), scale);
+      scale = 1.0;
+    }
+    else if (LinearNoBias<>* const* linear =
+        boost::get<LinearNoBias<>*>(&layer))
+    {
+      const arma::mat& weight = (*linear)->Weight();
+      AddAffine(weight, arma::zeros<arma::vec>(weight.n_rows), scale);
+      scale = 1.0;
+    }
+    else if (NaiveConvolutionType* const* convolution =
+        boost::get<NaiveConvolutionType*>(&layer))
+    {
+      AddConvolution(**convolution, scale);
+      scale = 1.0;
+    }
+    else if (Im2ColConvolutionType* const* convolution =
+        boost::get<Im2ColConvolutionType*>(&layer))
+    {
+      AddConvolution(**convolution, scale);
+      scale = 1.0;
+    }
+    else if (boost::get<BaseLayer<IdentityFunction>*>(&layer))
+    {
+      continue;
+    }
+    else if (boost::get<BaseLayer<LogisticFunction>*>(&layer))
+    {
+      AddScale(scale);
+      scale = 1.0;
+      AddActivation(LOGISTIC);
+    }
+    else if (boost::get<BaseLayer<TanhFunction>*>(&layer))
+    {
+      AddScale(scale);
+      scale = 1.0;
+      AddActivation(TANH);
+    }
+    else if (boost::get<BaseLayer<RectifierFunction>*>(&layer))
+    {
+      AddScale(scale);
+      scale = 1.0;
+      AddActivation(RECTIFIER);
+    }
+    else if (boost::get<LogSoftMax<>*>(&layer))
+    {
+      AddScale(scale);
+      scale = 1.0;
+      AddActivation(LOG_SOFTMAX);
+    }
+    else if (Dropout<>* const* dropout = boost::get<Dropout<>*>(&layer))
+    {
+      if ((*dropout)->Rescale())
+        scale *= 1.0 / (1.0 - (*dropout)->Ratio());
+    }
+    else
+    {
+      std::ostringstream oss;
+      oss << "FrozenFFN::FrozenFFN(): layer " << i << " of the network is not "
+          << "supported!";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  AddScale(scale);
+}
+
+inline void FrozenFFN::AddAffine(const arma::mat& weight,
+                                 const arma::vec& bias,
+                                 const double scale)
+{
+  Step step = ElementwiseStep(1.0, IDENTITY);
+  step.inSize = weight.n_cols;
+  step.outSize = weight.n_rows;
+  step.outRows = weight.n_rows;
+
+  if (precision == DOUBLE)
+  {
+    step.offset = weights.n_elem;
+    weights.resize(weights.n_elem + weight.n_elem + bias.n_elem);
+    weights.subvec(step.offset, step.offset + weight.n_elem - 1) =
+        scale * arma::vectorise(weight);
+    weights.subvec(step.offset + weight.n_elem, weights.n_elem - 1) = bias;
+  }
+  else if (precision == FLOAT)
+  {
+    step.offset = floatWeights.n_elem;
+    floatWeights.resize(floatWeights.n_elem + weight.n_elem + bias.n_elem);
+    floatWeights.subvec(step.offset, step.offset + weight.n_elem - 1) =
+        arma::conv_to<arma::fvec>::from(scale * arma::vectorise(weight));
+    floatWeights.subvec(step.offset + weight.n_elem, floatWeights.n_elem - 1) =
+        arma::conv_to<arma::fvec>::from(bias);
+  }
+  else
+  {
+    // Store each row with its own scale, so that the largest weight of the row
+    // is 127, and the rows one after the other so that a dot product reads
+    // contiguous memory.
+    step.offset = quantizedWeights.size();
+    step.auxOffset = floatWeights.n_elem;
+    quantizedWeights.resize(quantizedWeights.size() + weight.n_elem);
+    floatWeights.resize(floatWeights.n_elem + 2 * weight.n_rows);
+    for (size_t r = 0; r < weight.n_rows; ++r)
+    {
+      const double maxWeight = std::abs(scale) *
+          arma::abs(weight.row(r)).max();
+      const double rowScale = (maxWeight > 0.0) ? maxWeight / 127.0 : 1.0;
+      for (size_t k = 0; k < weight.n_cols; ++k)
+      {
+        quantizedWeights[step.offset + r * weight.n_cols + k] = (int8_t)
+            std::round(scale * weight(r, k) / rowScale);
+      }
+
+      floatWeights[step.auxOffset + r] = rowScale;
+      floatWeights[step.auxOffset + weight.n_rows + r] = bias[r];
+    }
+  }
+
+  steps.push_back(step);
+}
+
+template<typename ConvolutionType>
+void FrozenFFN::AddConvolution(const ConvolutionType& layer,
+                               const double scale)
+{
+  if (layer.InputWidth() == 0 || layer.InputHeight() == 0)
+  {
+    throw std::invalid_argument("FrozenFFN::FrozenFFN(): the input size of a "
+        "convolution layer is unknown; run the network once before freezing "
+        "it!");
+  }
+
+  // The filters of an output map are contiguous in the parameters of the
+  // layer, so each filter is one row of the weights of the affine step.
+  const size_t filterSize = layer.KernelWidth() * layer.KernelHeight() *
+      layer.InputSize();
+  const arma::mat& parameters = layer.Parameters();
+  const arma::mat filters(const_cast<double*>(parameters.memptr()),
+      filterSize, layer.OutputSize(), false, true);
+  const arma::vec bias(const_cast<double*>(parameters.memptr()) +
+      filters.n_elem, layer.OutputSize(), false, true);
+  AddAffine(filters.t(), bias, scale);
+
+  Step& step = steps.back();
+  step.inputWidth = layer.InputWidth();
+  step.inputHeight = layer.InputHeight();
+  step.kW = layer.KernelWidth();
+  step.kH = layer.KernelHeight();
+  step.dW = layer.StrideWidth();
+  step.dH = layer.StrideHeight();
+  step.padW = layer.PadWidth();
+  step.padH = layer.PadHeight();
+  step.outRows = Im2ColConvolution<>::OutputSize(step.inputWidth, step.kW,
+      step.dW, step.padW) * Im2ColConvolution<>::OutputSize(step.inputHeight,
+      step.kH, step.dH, step.padH) * step.outSize;
+}
+
+inline void FrozenFFN::AddScale(const double scale)
+{
+  if (scale != 1.0)
+    steps.push_back(ElementwiseStep(scale, IDENTITY));
+}
+
+inline void FrozenFFN::AddActivation(const Activation activation)
+{
+  // Fuse the activation with the last step, unless it already has one.
+  if (steps.empty() || steps.back().activation != IDENTITY)
+    steps.push_back(ElementwiseStep(1.0, activation));
+  else
+    steps.back().activation = activation;
+}
+
+inline FrozenFFN::Step FrozenFFN::ElementwiseStep(const double scale,
+                                                  const Activation activation)
+{
+  Step step;
+  step.inSize = 0;
+  step.outSize = 0;
+  step.outRows = 0;
+  step.offset = 0;
+  step.auxOffset = 0;
+  step.scale = scale;
+  step.activation = activation;
+  step.inputWidth = 0;
+  step.inputHeight = 0;
+  step.kW = 0;
+  step.kH = 0;
+  step.dW = 0;
+  step.dH = 0;
+  step.padW = 0;
+  step.padH = 0;
+  return step;
+}
+
+template<typename eT>
+void FrozenFFN::Apply(const Activation activation, arma::Mat<eT>& x)
+{
+  switch (activation)
+  {
+    case IDENTITY:
+      break;
+
+    case LOGISTIC:
+      x = 1.0 / (1.0 + arma::exp(-x));
+      break;
+
+    case TANH:
+      x = arma::tanh(x);
+      break;
+
+    case RECTIFIER:
+      x.transform([](const eT v) { return std::max(v, eT(0)); });
+      break;
+
+    case LOG_SOFTMAX:
+      // Subtract the maximum of each column before the exponential, so that it
+      // can't overflow.
+      x.each_row() -= arma::max(x);
+      x.each_row() -= arma::log(arma::sum(arma::exp(x)));
+      break;
+  }
+}
+
+inline void FrozenFFN::Predict(const arma::mat& predictors,
+                               arma::mat& results) const
+{
+  if (precision == DOUBLE)
+  {
+    Run(predictors, results);
+  }
+  else
+  {
+    arma::fmat floatResults;
+    Run(arma::conv_to<arma::fmat>::from(predictors), floatResults);
+    results = arma::conv_to<arma::mat>::from(floatResults);
+  }
+}
+
+inline void FrozenFFN::Predict(const arma::fmat& predictors,
+                               arma::fmat& results) const
+{
+  if (precision == DOUBLE)
+  {
+    arma::mat doubleResults;
+    Run(arma::conv_to<arma::mat>::from(predictors), doubleResults);
+    results = arma::conv_to<arma::fmat>::from(doubleResults);
+  }
+  else
+  {
+    Run(predictors, results);
+  }
+}
+
+template<typename eT>
+void FrozenFFN::Run(const arma::Mat<eT>& predictors,
+                    arma::Mat<eT>& results) const
+{
+  // The intermediate results alternate between two local buffers that are
+  // large enough for the largest step, so nothing is shared between calls.
+  size_t maxRows = predictors.n_rows;
+  for (size_t i = 0; i < steps.size(); ++i)
+    maxRows = std::max(maxRows, steps[i].outRows);
+
+  const size_t n = predictors.n_cols;
+  arma::Mat<eT> buffers[2] = { arma::Mat<eT>(maxRows, n),
+      arma::Mat<eT>(maxRows, n) };
+
+  // The current values are the predictors until the first step has run.
+  const eT* current = predictors.memptr();
+  size_t rows = predictors.n_rows;
+  size_t next = 0;
+  for (size_t i = 0; i < steps.size(); ++i)
+  {
+    const Step& step = steps[i];
+    const arma::Mat<eT> input(const_cast<eT*>(current), rows, n, false, true);
+
+    if (step.inSize > 0)
+    {
+      const size_t inRows = (step.inputWidth > 0) ? step.inputWidth *
+          step.inputHeight * (step.inSize / (step.kW * step.kH)) : step.inSize;
+      if (rows != inRows)
+      {
+        std::ostringstream oss;
+        oss << "FrozenFFN::Predict(): step " << i << " expects " << inRows
+            << " inputs, but the input has " << rows << " rows!";
+        throw std::invalid_argument(oss.str());
+      }
+
+      arma::Mat<eT> output(buffers[next].memptr(), step.outRows, n, false,
+          true);
+      if (step.inputWidth > 0)
+        Convolve(step, input, output);
+      else
+        Affine(step, input, output);
+
+      Apply(step.activation, output);
+      rows = step.outRows;
+    }
+    else
+    {
+      // Scale and activation steps keep the number of rows.
+      arma::Mat<eT> output(buffers[next].memptr(), rows, n, false, true);
+      output = eT(step.scale) * input;
+      Apply(step.activation, output);
+    }
+
+    current = buffers[next].memptr();
+    next = 1 - next;
+  }
+
+  results = arma::Mat<eT>(current, rows, n);
+}
+
+template<typename eT>
+void FrozenFFN::Affine(const Step& step,
+                       const arma::Mat<eT>& input,
+                       arma::Mat<eT>& output) const
+{
+  if (precision == INT8)
+  {
+    QuantizedAffine(step, input, output);
+    return;
+  }
+
+  const eT* storage = Storage(eT());
+  const arma::Mat<eT> weight(const_cast<eT*>(storage) + step.offset,
+      step.outSize, step.inSize, false, true);
+  output = weight * input;
+  output.each_col() += arma::Col<eT>(const_cast<eT*>(storage) + step.offset +
+      weight.n_elem, step.outSize, false, true);
+}
+
+template<typename eT>
+void FrozenFFN::QuantizedAffine(const Step& step,
+                                const arma::Mat<eT>& input,
+                                arma::Mat<eT>& output) const
+{
+  const int8_t* weight = quantizedWeights.data() + step.offset;
+  const float* scales = floatWeights.memptr() + step.auxOffset;
+  const float* bias = scales + step.outSize;
+
+  std::vector<int8_t> quantizedInput(step.inSize);
+  for (size_t j = 0; j < input.n_cols; ++j)
+  {
+    // Quantize the point with its own scale.
+    const eT* point = input.colptr(j);
+    eT maxInput = 0;
+    for (size_t k = 0; k < step.inSize; ++k)
+      maxInput = std::max(maxInput, std::abs(point[k]));
+
+    const eT inputScale = (maxInput > 0) ? maxInput / eT(127) : eT(1);
+    for (size_t k = 0; k < step.inSize; ++k)
+      quantizedInput[k] = (int8_t) std::round(point[k] / inputScale);
+
+    // The dot products are exact in 32-bit integers, and the compiler can
+    // vectorize these loops.
+    eT* result = output.colptr(j);
+    for (size_t r = 0; r < step.outSize; ++r)
+    {
+      const int8_t* row = weight + r * step.inSize;
+      int32_t sum = 0;
+      for (size_t k = 0; k < step.inSize; ++k)
+        sum += int32_t(row[k]) * int32_t(quantizedInput[k]);
+
+      result[r] = eT(scales[r]) * inputScale * eT(sum) + eT(bias[r]);
+    }
+  }
+}
+
+template<typename eT>
+void FrozenFFN::Convolve(const Step& step,
+                         const arma::Mat<eT>& input,
+                         arma::Mat<eT>& output) const
+{
+  const size_t maps = step.inSize / (step.kW * step.kH);
+  const size_t positions = step.outRows / step.outSize;
+
+  // Each point is unfolded into its patches, one per column, so that the
+  // output maps of the point are one affine transformation of the patches.
+  arma::Mat<eT> columns(positions, step.inSize);
+  arma::Mat<eT> patches, result;
+  for (size_t j = 0; j < input.n_cols; ++j)
+  {
+    const arma::Cube<eT> point(const_cast<eT*>(input.colptr(j)),
+        step.inputWidth, step.inputHeight, maps, false, true);
+    Im2ColConvolution<>::Im2Col(point, step.kW, step.kH, step.dW, step.dH,
+        step.padW, step.padH, columns);
+
+    patches = columns.t();
+    result.set_size(step.outSize, positions);
+    Affine(step, patches, result);
+    output.col(j) = arma::vectorise(result.t());
+  }
+}
+
+template<typename Archive>
+void FrozenFFN::serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(precision);
+  ar & BOOST_SERIALIZATION_NVP(steps);
+  ar & BOOST_SERIALIZATION_NVP(weights);
+  ar & BOOST_SERIALIZATION_NVP(floatWeights);
+  ar & BOOST_SERIALIZATION_NVP(quantizedWeights);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -82,7 +82,6 @@ class BaseLayer
                 arma::Mat<eT>&& gy,
                 arma::Mat<eT>&& g)
   {
-    arma::Mat<eT> derivative;
     ActivationFunction::Deriv(input, derivative);
     g = gy % derivative;
   }
@@ -120,6 +119,10 @@ class BaseLayer
 
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
+
+  //! Locally-stored derivative of the activation, kept between calls so that
+  //! its memory is reused.
+  OutputDataType derivative;
 }; // class BaseLayer
 
 // Convenience typedefs.
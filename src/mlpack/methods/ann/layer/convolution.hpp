@@ -18,6 +18,7 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
 
 #include "layer_types.hpp"
 
@@ -28,6 +29,17 @@ namespace ann /** Artificial Neural Network. */ {
  * Implementation of the Convolution class. The Convolution class represents a
  * single layer of a neural network.
  *
+ * If all three rules are Im2ColConvolution, the forward pass, the backward pass
+ * and the gradient are each computed for all the input maps, output maps and
+ * samples of the batch with a single matrix multiplication; otherwise each
+ * pair of maps of the first sample is convolved separately.  For example:
+ *
+ * @code
+ * typedef Convolution<Im2ColConvolution<ValidConvolution>,
+ *     Im2ColConvolution<FullConvolution>,
+ *     Im2ColConvolution<ValidConvolution> > FastConvolution;
+ * @endcode
+ *
  * @tparam ForwardConvolutionRule Convolution to perform forward process.
  * @tparam BackwardConvolutionRule Convolution to perform backward process.
  * @tparam GradientConvolutionRule Convolution to calculate gradient.
@@ -161,6 +173,30 @@ class Convolution
   //! Modify the output height.
   size_t& OutputHeight() { return outputHeight; }
 
+  //! Get the number of input maps.
+  size_t InputSize() const { return inSize; }
+
+  //! Get the number of output maps.
+  size_t OutputSize() const { return outSize; }
+
+  //! Get the width of the filters.
+  size_t KernelWidth() const { return kW; }
+
+  //! Get the height of the filters.
+  size_t KernelHeight() const { return kH; }
+
+  //! Get the stride in the x direction.
+  size_t StrideWidth() const { return dW; }
+
+  //! Get the stride in the y direction.
+  size_t StrideHeight() const { return dH; }
+
+  //! Get the padding width.
+  size_t PadWidth() const { return padW; }
+
+  //! Get the padding height.
+  size_t PadHeight() const { return padH; }
+
   /**
    * Serialize the layer
    */
@@ -185,6 +221,50 @@ class Convolution
     return std::floor(size + p * 2 - k) / s + 1;
   }
 
+  /*
+   * Unfold the patches of all the samples of the given input into the columns
+   * matrix, for the im2col rules.
+   *
+   * @param input The input of the layer, one sample per column.
+   */
+  template<typename eT>
+  void Im2ColInput(const arma::Mat<eT>& input);
+
+  /*
+   * Arrange the given error of the layer, one sample per column, into a matrix
+   * with one row per output position of each sample and one column per output
+   * map, for the im2col rules.
+   *
+   * @param error The error of the layer.
+   * @param mappedError The arranged error.
+   */
+  template<typename eT>
+  void MapError(const arma::Mat<eT>& error, arma::Mat<eT>& mappedError);
+
+  /*
+   * Whether the im2col passes are used.  They are only used together, because
+   * the other backward and gradient passes need the input that the other
+   * forward pass stores.
+   */
+  static const bool useIm2Col =
+      IsIm2ColConvolution<ForwardConvolutionRule>::value &&
+      IsIm2ColConvolution<BackwardConvolutionRule>::value &&
+      IsIm2ColConvolution<GradientConvolutionRule>::value;
+
+  //! Forward pass with the im2col rules.
+  template<typename eT>
+  void ForwardIm2Col(const arma::Mat<eT>& input, arma::Mat<eT>& output);
+
+  //! Backward pass with the im2col rules.
+  template<typename eT>
+  void BackwardIm2Col(const arma::Mat<eT>& gy, arma::Mat<eT>& g);
+
+  //! Gradient with the im2col rules.
+  template<typename eT>
+  void GradientIm2Col(const arma::Mat<eT>& input,
+                      const arma::Mat<eT>& error,
+                      arma::Mat<eT>& gradient);
+
   /*
    * Rotates a 3rd-order tensor counterclockwise by 180 degrees.
    *
@@ -318,6 +398,9 @@ class Convolution
   //! Locally-stored transformed error parameter.
   arma::cube gTemp;
 
+  //! Locally-stored input patches of the im2col rules.
+  arma::mat columns;
+
   //! Locally-stored transformed gradient parameter.
   arma::cube gradientTemp;
 
@@ -113,6 +113,12 @@ void Convolution<
     OutputDataType
 >::Forward(const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
+  if (useIm2Col)
+  {
+    ForwardIm2Col(input, output);
+    return;
+  }
+
   inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, inSize);
 
   if (padW != 0 || padH != 0)
@@ -171,6 +177,12 @@ void Convolution<
 >::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
+  if (useIm2Col)
+  {
+    BackwardIm2Col(gy, g);
+    return;
+  }
+
   arma::cube mappedError = arma::cube(gy.memptr(),
         outputWidth, outputHeight, outSize);
   gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
@@ -219,10 +231,16 @@ void Convolution<
     InputDataType,
     OutputDataType
 >::Gradient(
-    const arma::Mat<eT>&& /* input */,
+    const arma::Mat<eT>&& input,
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
+  if (useIm2Col)
+  {
+    GradientIm2Col(input, error, gradient);
+    return;
+  }
+
   arma::cube mappedError;
   if (padW != 0 && padH != 0)
   {
@@ -291,6 +309,173 @@ void Convolution<
       gradientTemp.memptr(), gradientTemp.n_elem, 1, false, false);
 }
 
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::Im2ColInput(const arma::Mat<eT>& input)
+{
+  const size_t wConv = ConvOutSize(inputWidth, kW, dW, padW);
+  const size_t hConv = ConvOutSize(inputHeight, kH, dH, padH);
+  const size_t positions = wConv * hConv;
+
+  columns.set_size(positions * input.n_cols, kW * kH * inSize);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) input.n_cols; ++i)
+  {
+    const arma::Cube<eT> sample(const_cast<eT*>(input.colptr(i)), inputWidth,
+        inputHeight, inSize, false, true);
+    Im2ColConvolution<>::Im2Col(sample, kW, kH, dW, dH, padW, padH, columns,
+        i * positions);
+  }
+
+  outputWidth = wConv;
+  outputHeight = hConv;
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::MapError(const arma::Mat<eT>& error, arma::Mat<eT>& mappedError)
+{
+  // Each sample of the error is an outputWidth x outputHeight x outSize cube,
+  // that is a matrix with one row per position and one column per map.
+  const size_t positions = outputWidth * outputHeight;
+  mappedError.set_size(positions * error.n_cols, outSize);
+  for (size_t i = 0; i < error.n_cols; ++i)
+  {
+    mappedError.rows(i * positions, (i + 1) * positions - 1) = arma::Mat<eT>(
+        const_cast<eT*>(error.colptr(i)), positions, outSize, false, true);
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::ForwardIm2Col(const arma::Mat<eT>& input, arma::Mat<eT>& output)
+{
+  Im2ColInput(input);
+
+  // The filters of an output map are contiguous in the weights, in the order
+  // of the columns of the patches.
+  const arma::Mat<eT> weightMatrix(weight.memptr(), kW * kH * inSize, outSize,
+      false, true);
+  arma::Mat<eT> result = columns * weightMatrix;
+  result.each_row() += bias.t();
+
+  // Each block of rows of the result is the output of one sample.
+  const size_t positions = outputWidth * outputHeight;
+  output.set_size(positions * outSize, input.n_cols);
+  for (size_t i = 0; i < input.n_cols; ++i)
+  {
+    output.col(i) = arma::vectorise(result.rows(i * positions,
+        (i + 1) * positions - 1));
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::BackwardIm2Col(const arma::Mat<eT>& gy, arma::Mat<eT>& g)
+{
+  arma::Mat<eT> mappedError;
+  MapError(gy, mappedError);
+
+  const arma::Mat<eT> weightMatrix(weight.memptr(), kW * kH * inSize, outSize,
+      false, true);
+  const arma::Mat<eT> errorColumns = mappedError * weightMatrix.t();
+
+  const size_t positions = outputWidth * outputHeight;
+  g.zeros(inputWidth * inputHeight * inSize, gy.n_cols);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) gy.n_cols; ++i)
+  {
+    arma::Cube<eT> sample(g.colptr(i), inputWidth, inputHeight, inSize, false,
+        true);
+    Im2ColConvolution<>::Col2Im(errorColumns, kW, kH, dW, dH, padW, padH,
+        sample, i * positions);
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::GradientIm2Col(const arma::Mat<eT>& input,
+                  const arma::Mat<eT>& error,
+                  arma::Mat<eT>& gradient)
+{
+  // The patches of the forward pass are reused, unless they were computed for
+  // a batch of another size.
+  if (columns.n_rows != outputWidth * outputHeight * input.n_cols)
+    Im2ColInput(input);
+
+  arma::Mat<eT> mappedError;
+  MapError(error, mappedError);
+
+  // The product has the layout of the weights, and the bias gradient is the
+  // sum of the error of each output map.
+  gradient.submat(0, 0, weight.n_elem - 1, 0) = arma::vectorise(
+      columns.t() * mappedError);
+  gradient.submat(weight.n_elem, 0, weight.n_elem + outSize - 1, 0) =
+      arma::sum(mappedError).t();
+}
+
 template<
     typename ForwardConvolutionRule,
     typename BackwardConvolutionRule,
@@ -53,7 +53,7 @@ void Dropout<InputDataType, OutputDataType>::Forward(
   {
     // Scale with input / (1 - ratio) and set values to zero with probability
     // ratio.
-    mask = arma::randu<arma::Mat<eT> >(input.n_rows, input.n_cols);
+    mask.randu(input.n_rows, input.n_cols);
     mask.transform( [&](double val) { return (val > ratio); } );
     output = input % mask * scale;
   }
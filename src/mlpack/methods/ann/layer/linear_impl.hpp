@@ -67,8 +67,10 @@ void Linear<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient.submat(0, 0, weight.n_elem - 1, 0) = arma::vectorise(
-      error * input.t());
+  // Write the weight gradient directly into the gradient memory.
+  arma::Mat<eT> weightGradient(gradient.memptr(), weight.n_rows,
+      weight.n_cols, false, true);
+  weightGradient = error * input.t();
   gradient.submat(weight.n_elem, 0, gradient.n_elem - 1, 0) =
       arma::sum(error, 1);
 }
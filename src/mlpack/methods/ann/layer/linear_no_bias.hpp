@@ -112,6 +112,9 @@ class LinearNoBias
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
+  //! Get the weights.
+  OutputDataType const& Weight() const { return weight; }
+
   /**
    * Serialize the layer
    */
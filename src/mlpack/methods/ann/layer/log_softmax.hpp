@@ -95,6 +95,10 @@ class LogSoftMax
 
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
+
+  //! Locally-stored maximum of each input column, kept between calls so that
+  //! its memory is reused.
+  OutputDataType maxInput;
 }; // class LogSoftmax
 
 } // namespace ann
@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_ANN_LAYER_LSTM_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <boost/preprocessor/punctuation/comma.hpp>
 #include <limits>
 
 namespace mlpack {
@@ -160,9 +161,15 @@ class LSTM
    * Serialize the layer
    */
   template<typename Archive>
-  void serialize(Archive& ar, const unsigned int /* version */);
+  void serialize(Archive& ar, const unsigned int version);
 
  private:
+  /*
+   * Copy the weights of each gate into the stacked weight matrices, so that
+   * all the gates are computed with one product.
+   */
+  void PackWeights();
+
   //! Locally-stored number of input units.
   size_t inSize;
 
@@ -248,29 +255,33 @@ class LSTM
   //! Weights between cell and output gate.
   OutputDataType cell2GateOutputWeight;
 
-  //! Locally-stored input gate parameter.
-  OutputDataType inputGate;
+  //! Locally-stored gate parameters, the output gate, forget gate, input gate
+  //! and hidden layer stacked by rows, for every step of the sequence.
+  OutputDataType gate;
 
-  //! Locally-stored forget gate parameter.
-  OutputDataType forgetGate;
+  //! Locally-stored gate activations, stacked like the gate parameters.
+  OutputDataType gateActivation;
 
-  //! Locally-stored hidden layer parameter.
-  OutputDataType hiddenLayer;
+  //! Locally-stored gate errors, stacked like the gate parameters.
+  OutputDataType gateError;
 
-  //! Locally-stored output gate parameter.
-  OutputDataType outputGate;
+  //! Locally-stored cell error.
+  OutputDataType cellError;
 
-  //! Locally-stored input gate activation.
-  OutputDataType inputGateActivation;
+  //! Stacked input to gate weights, a copy of the weights of each gate.
+  OutputDataType input2GateWeight;
 
-  //! Locally-stored forget gate activation.
-  OutputDataType forgetGateActivation;
+  //! Stacked input to gate biases, a copy of the bias of each gate.
+  OutputDataType input2GateBias;
 
-  //! Locally-stored output gate activation.
-  OutputDataType outputGateActivation;
+  //! Stacked output to gate weights, a copy of the weights of each gate.
+  OutputDataType output2GateWeight;
 
-  //! Locally-stored hidden layer activation.
-  OutputDataType hiddenLayerActivation;
+  //! Locally-stored gradient of the stacked input to gate weights.
+  OutputDataType input2GateGradient;
+
+  //! Locally-stored gradient of the stacked output to gate weights.
+  OutputDataType output2GateGradient;
 
   //! Locally-stored input to hidden weight.
   OutputDataType input2HiddenWeight;
@@ -287,12 +298,6 @@ class LSTM
   //! Locally-stored cell activation error.
   OutputDataType cellActivation;
 
-  //! Locally-stored forget gate error.
-  OutputDataType forgetGateError;
-
-  //! Locally-stored output gate error.
-  OutputDataType outputGateError;
-
   //! Locally-stored previous error.
   OutputDataType prevError;
 
@@ -302,12 +307,6 @@ class LSTM
   //! Locally-stored input cell error parameter.
   OutputDataType inputCellError;
 
-  //! Locally-stored input gate error.
-  OutputDataType inputGateError;
-
-  //! Locally-stored hidden layer error.
-  OutputDataType hiddenError;
-
   //! Locally-stored current rho size.
   size_t rhoSize;
 
@@ -318,6 +317,11 @@ class LSTM
 } // namespace ann
 } // namespace mlpack
 
+//! Set the serialization version of the LSTM class.
+BOOST_TEMPLATE_CLASS_VERSION(
+    template<typename InputDataType BOOST_PP_COMMA() typename OutputDataType>,
+    mlpack::ann::LSTM<InputDataType BOOST_PP_COMMA() OutputDataType>, 1);
+
 // Include implementation.
 #include "lstm_impl.hpp"
 
@@ -60,21 +60,19 @@ void LSTM<InputDataType, OutputDataType>::ResetCell(const size_t size)
   backwardStep = batchSize * size - 1;
   gradientStep = batchSize * size - 1;
 
+  // The buffers hold every step of the sequence, so that no memory is
+  // allocated during the forward and backward passes.
   const size_t rhoBatchSize = size * batchSize;
-  if (inputGate.is_empty() || inputGate.n_cols < rhoBatchSize)
+  if (gate.is_empty() || gate.n_cols < rhoBatchSize ||
+      gateError.n_cols != batchSize)
   {
-    inputGate.set_size(outSize, rhoBatchSize);
-    forgetGate.set_size(outSize, rhoBatchSize);
-    hiddenLayer.set_size(outSize, rhoBatchSize);
-    outputGate.set_size(outSize, rhoBatchSize);
-
-    inputGateActivation.set_size(outSize, rhoBatchSize);
-    forgetGateActivation.set_size(outSize, rhoBatchSize);
-    outputGateActivation.set_size(outSize, rhoBatchSize);
-    hiddenLayerActivation.set_size(outSize, rhoBatchSize);
-
+    gate.set_size(4 * outSize, rhoBatchSize);
+    gateActivation.set_size(4 * outSize, rhoBatchSize);
     cellActivation.set_size(outSize, rhoBatchSize);
-    prevError.set_size(4 * outSize, batchSize);
+
+    gateError.set_size(4 * outSize, batchSize);
+    cellError.set_size(outSize, batchSize);
+    prevError.set_size(outSize, batchSize);
 
     if (cell.is_empty())
     {
@@ -159,6 +157,30 @@ void LSTM<InputDataType, OutputDataType>::Reset()
       offset, outSize, 1, false, false);
 }
 
+template<typename InputDataType, typename OutputDataType>
+void LSTM<InputDataType, OutputDataType>::PackWeights()
+{
+  // Stack the weights of the output gate, forget gate, input gate and hidden
+  // layer, in the order of the parameters.
+  input2GateWeight.set_size(4 * outSize, inSize);
+  input2GateWeight.rows(0, outSize - 1) = input2GateOutputWeight;
+  input2GateWeight.rows(outSize, 2 * outSize - 1) = input2GateForgetWeight;
+  input2GateWeight.rows(2 * outSize, 3 * outSize - 1) = input2GateInputWeight;
+  input2GateWeight.rows(3 * outSize, 4 * outSize - 1) = input2HiddenWeight;
+
+  input2GateBias.set_size(4 * outSize, 1);
+  input2GateBias.rows(0, outSize - 1) = input2GateOutputBias;
+  input2GateBias.rows(outSize, 2 * outSize - 1) = input2GateForgetBias;
+  input2GateBias.rows(2 * outSize, 3 * outSize - 1) = input2GateInputBias;
+  input2GateBias.rows(3 * outSize, 4 * outSize - 1) = input2HiddenBias;
+
+  output2GateWeight.set_size(4 * outSize, outSize);
+  output2GateWeight.rows(0, outSize - 1) = output2GateOutputWeight;
+  output2GateWeight.rows(outSize, 2 * outSize - 1) = output2GateForgetWeight;
+  output2GateWeight.rows(2 * outSize, 3 * outSize - 1) = output2GateInputWeight;
+  output2GateWeight.rows(3 * outSize, 4 * outSize - 1) = output2HiddenWeight;
+}
+
 template<typename InputDataType, typename OutputDataType>
 template<typename InputType, typename OutputType>
 void LSTM<InputDataType, OutputDataType>::Forward(
@@ -173,78 +195,64 @@ void LSTM<InputDataType, OutputDataType>::Forward(
     ResetCell(rhoSize);
   }
 
-  inputGate.cols(forwardStep, forwardStep + batchStep) = input2GateInputWeight *
-      input + output2GateInputWeight * outParameter.cols(forwardStep,
-      forwardStep + batchStep);
-  inputGate.cols(forwardStep, forwardStep + batchStep).each_col() +=
-      input2GateInputBias;
+  // The weights don't change during a sequence, so they are stacked once at
+  // its start.
+  if (forwardStep == 0)
+    PackWeights();
+
+  const size_t begin = forwardStep;
+  const size_t end = forwardStep + batchStep;
 
-  forgetGate.cols(forwardStep, forwardStep + batchStep) = input2GateForgetWeight
-      * input + output2GateForgetWeight * outParameter.cols(
-      forwardStep, forwardStep + batchStep);
-  forgetGate.cols(forwardStep, forwardStep + batchStep).each_col() +=
-      input2GateForgetBias;
+  // All the gates in two products; the rows are the output gate, the forget
+  // gate, the input gate and the hidden layer.
+  gate.cols(begin, end) = input2GateWeight * input +
+      output2GateWeight * outParameter.cols(begin, end);
+  gate.cols(begin, end).each_col() += input2GateBias;
 
   if (forwardStep > 0)
   {
-    inputGate.cols(forwardStep, forwardStep + batchStep) +=
-        cell2GateInputWeight % cell.cols(forwardStep - batchSize,
-        forwardStep - batchSize + batchStep);
-
-    forgetGate.cols(forwardStep, forwardStep + batchStep) +=
-        cell2GateForgetWeight % cell.cols(forwardStep - batchSize,
-        forwardStep - batchSize + batchStep);
+    // Peephole connections of the forget and input gates.
+    gate.submat(outSize, begin, 2 * outSize - 1, end) +=
+        cell.cols(begin - batchSize, end - batchSize).each_col() %
+        cell2GateForgetWeight;
+    gate.submat(2 * outSize, begin, 3 * outSize - 1, end) +=
+        cell.cols(begin - batchSize, end - batchSize).each_col() %
+        cell2GateInputWeight;
   }
 
-  inputGateActivation.cols(forwardStep, forwardStep + batchStep) = 1.0 /
-      (1 + arma::exp(-inputGate.cols(forwardStep, forwardStep + batchStep)));
-
-  forgetGateActivation.cols(forwardStep, forwardStep + batchStep) = 1.0 /
-      (1 + arma::exp(-forgetGate.cols(forwardStep, forwardStep + batchStep)));
-
-  hiddenLayer.cols(forwardStep, forwardStep + batchStep) = input2HiddenWeight *
-      input + output2HiddenWeight * outParameter.cols(
-      forwardStep, forwardStep + batchStep);
-
-  hiddenLayer.cols(forwardStep, forwardStep + batchStep).each_col() +=
-      input2HiddenBias;
-
-  hiddenLayerActivation.cols(forwardStep, forwardStep + batchStep) =
-      arma::tanh(hiddenLayer.cols(forwardStep, forwardStep + batchStep));
+  // The forget and input gates are next to each other, so one pass computes
+  // both.
+  gateActivation.submat(outSize, begin, 3 * outSize - 1, end) = 1.0 /
+      (1 + arma::exp(-gate.submat(outSize, begin, 3 * outSize - 1, end)));
+  gateActivation.submat(3 * outSize, begin, 4 * outSize - 1, end) =
+      arma::tanh(gate.submat(3 * outSize, begin, 4 * outSize - 1, end));
 
   if (forwardStep == 0)
   {
-    cell.cols(forwardStep, forwardStep + batchStep) =
-        inputGateActivation.cols(forwardStep, forwardStep + batchStep) %
-        hiddenLayerActivation.cols(forwardStep, forwardStep + batchStep);
+    cell.cols(begin, end) =
+        gateActivation.submat(2 * outSize, begin, 3 * outSize - 1, end) %
+        gateActivation.submat(3 * outSize, begin, 4 * outSize - 1, end);
   }
   else
   {
-    cell.cols(forwardStep, forwardStep + batchStep) =
-        forgetGateActivation.cols(forwardStep, forwardStep + batchStep) %
-        cell.cols(forwardStep - batchSize, forwardStep - batchSize + batchStep)
-        + inputGateActivation.cols(forwardStep, forwardStep + batchStep) %
-        hiddenLayerActivation.cols(forwardStep, forwardStep + batchStep);
+    cell.cols(begin, end) =
+        gateActivation.submat(outSize, begin, 2 * outSize - 1, end) %
+        cell.cols(begin - batchSize, end - batchSize) +
+        gateActivation.submat(2 * outSize, begin, 3 * outSize - 1, end) %
+        gateActivation.submat(3 * outSize, begin, 4 * outSize - 1, end);
   }
 
-  outputGate.cols(forwardStep, forwardStep + batchStep) = input2GateOutputWeight
-      * input + output2GateOutputWeight * outParameter.cols(
-      forwardStep, forwardStep + batchStep) + cell.cols(forwardStep,
-      forwardStep + batchStep).each_col() % cell2GateOutputWeight;
-
-  outputGate.cols(forwardStep, forwardStep + batchStep).each_col() +=
-      input2GateOutputBias;
-
-  outputGateActivation.cols(forwardStep, forwardStep + batchStep) = 1.0 /
-      (1 + arma::exp(-outputGate.cols(forwardStep, forwardStep + batchStep)));
+  // The output gate looks at the new cell.
+  gate.submat(0, begin, outSize - 1, end) += cell.cols(begin, end).each_col() %
+      cell2GateOutputWeight;
+  gateActivation.submat(0, begin, outSize - 1, end) = 1.0 /
+      (1 + arma::exp(-gate.submat(0, begin, outSize - 1, end)));
 
-  cellActivation.cols(forwardStep, forwardStep + batchStep) =
-      arma::tanh(cell.cols(forwardStep, forwardStep + batchStep));
+  cellActivation.cols(begin, end) = arma::tanh(cell.cols(begin, end));
 
-  outParameter.cols(forwardStep + batchSize,
-      forwardStep + batchSize + batchStep) =
-      cellActivation.cols(forwardStep, forwardStep + batchStep) %
-      outputGateActivation.cols(forwardStep, forwardStep + batchStep);
+  outParameter.cols(begin + batchSize, end + batchSize) =
+      cellActivation.cols(begin, end) %
+      gateActivation.submat(0, begin, outSize - 1, end);
 
   output = OutputType(outParameter.memptr() +
       (forwardStep + batchSize) * outSize, outSize, batchSize, false, false);
@@ -266,63 +274,60 @@ void LSTM<InputDataType, OutputDataType>::Backward(
     gy += prevError;
   }
 
-  outputGateError =
-      gy % cellActivation.cols(backwardStep - batchStep, backwardStep) %
-      (outputGateActivation.cols(backwardStep - batchStep, backwardStep) %
-      (1.0 - outputGateActivation.cols(backwardStep - batchStep,
-      backwardStep)));
+  const size_t begin = backwardStep - batchStep;
+  const size_t end = backwardStep;
 
-  OutputDataType cellError = gy %
-      outputGateActivation.cols(backwardStep - batchStep, backwardStep) %
-      (1 - arma::pow(cellActivation.cols(backwardStep -
-      batchStep, backwardStep), 2)) + outputGateError.each_col() %
-      cell2GateOutputWeight;
+  // The error of the gates has the same rows as the gates.
+  gateError.rows(0, outSize - 1) = gy % cellActivation.cols(begin, end) %
+      (gateActivation.submat(0, begin, outSize - 1, end) %
+      (1.0 - gateActivation.submat(0, begin, outSize - 1, end)));
+
+  cellError = gy % gateActivation.submat(0, begin, outSize - 1, end) %
+      (1 - arma::pow(cellActivation.cols(begin, end), 2)) +
+      gateError.rows(0, outSize - 1).each_col() % cell2GateOutputWeight;
 
   if (gradientStepIdx > 0)
   {
     cellError += inputCellError;
   }
 
-  if (backwardStep != 0)
+  if (begin != 0)
   {
-    forgetGateError = cell.cols((backwardStep - batchSize) - batchStep,
-      (backwardStep - batchSize)) % cellError % (forgetGateActivation.cols(
-      backwardStep - batchStep, backwardStep) % (1.0 -
-      forgetGateActivation.cols(backwardStep - batchStep, backwardStep)));
+    gateError.rows(outSize, 2 * outSize - 1) =
+        cell.cols(begin - batchSize, end - batchSize) % cellError %
+        (gateActivation.submat(outSize, begin, 2 * outSize - 1, end) %
+        (1.0 - gateActivation.submat(outSize, begin, 2 * outSize - 1, end)));
   }
   else
   {
-    forgetGateError.zeros();
+    gateError.rows(outSize, 2 * outSize - 1).zeros();
   }
 
-  inputGateError = hiddenLayerActivation.cols(backwardStep - batchStep,
-      backwardStep) % cellError %
-      (inputGateActivation.cols(backwardStep - batchStep, backwardStep) %
-      (1.0 - inputGateActivation.cols(backwardStep - batchStep, backwardStep)));
-
-  hiddenError = inputGateActivation.cols(backwardStep - batchStep,
-      backwardStep) % cellError % (1 - arma::pow(hiddenLayerActivation.cols(
-      backwardStep - batchStep, backwardStep), 2));
+  gateError.rows(2 * outSize, 3 * outSize - 1) =
+      gateActivation.submat(3 * outSize, begin, 4 * outSize - 1, end) %
+      cellError % (gateActivation.submat(2 * outSize, begin,
+      3 * outSize - 1, end) % (1.0 - gateActivation.submat(2 * outSize, begin,
+      3 * outSize - 1, end)));
 
-  inputCellError = forgetGateActivation.cols(backwardStep - batchStep,
-      backwardStep) %cellError + forgetGateError.each_col() %
-      cell2GateForgetWeight + inputGateError.each_col() % cell2GateInputWeight;
+  gateError.rows(3 * outSize, 4 * outSize - 1) =
+      gateActivation.submat(2 * outSize, begin, 3 * outSize - 1, end) %
+      cellError % (1 - arma::pow(gateActivation.submat(3 * outSize, begin,
+      4 * outSize - 1, end), 2));
 
-  g = input2GateInputWeight.t() * inputGateError +
-      input2HiddenWeight.t() * hiddenError +
-      input2GateForgetWeight.t() * forgetGateError +
-      input2GateOutputWeight.t() * outputGateError;
+  inputCellError = gateActivation.submat(outSize, begin, 2 * outSize - 1,
+      end) % cellError + gateError.rows(outSize, 2 * outSize - 1).each_col() %
+      cell2GateForgetWeight + gateError.rows(2 * outSize,
+      3 * outSize - 1).each_col() % cell2GateInputWeight;
 
-  prevError = output2GateOutputWeight.t() * outputGateError +
-      output2GateForgetWeight.t() * forgetGateError +
-      output2GateInputWeight.t() * inputGateError +
-      output2HiddenWeight.t() * hiddenError;
+  // One product for the input and one for the previous output.
+  g = input2GateWeight.t() * gateError;
+  prevError = output2GateWeight.t() * gateError;
 
   backwardStep -= batchSize;
   gradientStepIdx++;
   if (gradientStepIdx == bpttSteps)
   {
-    backwardStep = bpttSteps - 1;
+    backwardStep = batchSize * bpttSteps - 1;
     gradientStepIdx = 0;
   }
 }
@@ -332,89 +337,56 @@ template<typename InputType, typename ErrorType, typename GradientType>
 void LSTM<InputDataType, OutputDataType>::Gradient(
     InputType&& input, ErrorType&& /* error */, GradientType&& gradient)
 {
-  // Input2GateOutputWeight and input2GateOutputBias gradients.
-  gradient.submat(0, 0, input2GateOutputWeight.n_elem - 1, 0) =
-      arma::vectorise(outputGateError * input.t());
-  gradient.submat(input2GateOutputWeight.n_elem, 0,
-      input2GateOutputWeight.n_elem + input2GateOutputBias.n_elem - 1, 0) =
-      arma::sum(outputGateError, 1);
-  size_t offset = input2GateOutputWeight.n_elem + input2GateOutputBias.n_elem;
-
-  // Input2GateForgetWeight and input2GateForgetBias gradients.
-  gradient.submat(offset, 0, offset + input2GateForgetWeight.n_elem - 1, 0) =
-      arma::vectorise(forgetGateError * input.t());
-  gradient.submat(offset + input2GateForgetWeight.n_elem, 0,
-      offset + input2GateForgetWeight.n_elem +
-      input2GateForgetBias.n_elem - 1, 0) = arma::sum(forgetGateError, 1);
-  offset += input2GateForgetWeight.n_elem + input2GateForgetBias.n_elem;
-
-  // Input2GateInputWeight and input2GateInputBias gradients.
-  gradient.submat(offset, 0, offset + input2GateInputWeight.n_elem - 1, 0) =
-      arma::vectorise(inputGateError * input.t());
-  gradient.submat(offset + input2GateInputWeight.n_elem, 0,
-      offset + input2GateInputWeight.n_elem +
-      input2GateInputBias.n_elem - 1, 0) = arma::sum(inputGateError, 1);
-  offset += input2GateInputWeight.n_elem + input2GateInputBias.n_elem;
-
-  // Input2HiddenWeight and input2HiddenBias gradients.
-  gradient.submat(offset, 0, offset + input2HiddenWeight.n_elem - 1, 0) =
-      arma::vectorise(hiddenError * input.t());
-  gradient.submat(offset + input2HiddenWeight.n_elem, 0,
-      offset + input2HiddenWeight.n_elem + input2HiddenBias.n_elem - 1, 0) =
-      arma::sum(hiddenError, 1);
-  offset += input2HiddenWeight.n_elem + input2HiddenBias.n_elem;
-
-  // Output2GateOutputWeight gradients.
-  gradient.submat(offset, 0, offset + output2GateOutputWeight.n_elem - 1, 0) =
-      arma::vectorise(outputGateError *
-      outParameter.cols(gradientStep - batchStep, gradientStep).t());
-  offset += output2GateOutputWeight.n_elem;
-
-  // Output2GateForgetWeight gradients.
-  gradient.submat(offset, 0, offset + output2GateForgetWeight.n_elem - 1, 0) =
-      arma::vectorise(forgetGateError *
-      outParameter.cols(gradientStep - batchStep, gradientStep).t());
-  offset += output2GateForgetWeight.n_elem;
-
-  // Output2GateInputWeight gradients.
-  gradient.submat(offset, 0, offset + output2GateInputWeight.n_elem - 1, 0) =
-      arma::vectorise(inputGateError *
-      outParameter.cols(gradientStep - batchStep, gradientStep).t());
-  offset += output2GateInputWeight.n_elem;
+  // Compute the gradients of the stacked weights with one product each, then
+  // copy the block of each gate to its place in the parameters.
+  input2GateGradient = gateError * input.t();
+  output2GateGradient = gateError *
+      outParameter.cols(gradientStep - batchStep, gradientStep).t();
+
+  size_t offset = 0;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    gradient.submat(offset, 0, offset + outSize * inSize - 1, 0) =
+        arma::vectorise(input2GateGradient.rows(i * outSize,
+        (i + 1) * outSize - 1));
+    offset += outSize * inSize;
+
+    gradient.submat(offset, 0, offset + outSize - 1, 0) = arma::sum(
+        gateError.rows(i * outSize, (i + 1) * outSize - 1), 1);
+    offset += outSize;
+  }
 
-  // Output2HiddenWeight gradients.
-  gradient.submat(offset, 0, offset + output2HiddenWeight.n_elem - 1, 0) =
-      arma::vectorise(hiddenError *
-      outParameter.cols(gradientStep - batchStep, gradientStep).t());
-  offset += output2HiddenWeight.n_elem;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    gradient.submat(offset, 0, offset + outSize * outSize - 1, 0) =
+        arma::vectorise(output2GateGradient.rows(i * outSize,
+        (i + 1) * outSize - 1));
+    offset += outSize * outSize;
+  }
 
   // Cell2GateOutputWeight gradients.
-  gradient.submat(offset, 0, offset + cell2GateOutputWeight.n_elem - 1, 0) =
-      arma::sum(outputGateError %
+  gradient.submat(offset, 0, offset + outSize - 1, 0) = arma::sum(
+      gateError.rows(0, outSize - 1) %
       cell.cols(gradientStep - batchStep, gradientStep), 1);
-  offset += cell2GateOutputWeight.n_elem;
+  offset += outSize;
 
   // Cell2GateForgetWeight and cell2GateInputWeight gradients.
-  if (gradientStep != 0)
+  if (gradientStep != batchStep)
   {
-    gradient.submat(offset, 0, offset + cell2GateForgetWeight.n_elem - 1, 0) =
-        arma::sum(forgetGateError % cell.cols(gradientStep - batchStep -
-        batchSize, gradientStep - batchSize), 1);
-    gradient.submat(offset + cell2GateForgetWeight.n_elem, 0, offset +
-        cell2GateForgetWeight.n_elem + cell2GateInputWeight.n_elem - 1, 0) =
-        arma::sum(inputGateError % cell.cols(gradientStep - batchStep -
-        batchSize, gradientStep - batchSize), 1);
+    gradient.submat(offset, 0, offset + outSize - 1, 0) = arma::sum(
+        gateError.rows(outSize, 2 * outSize - 1) % cell.cols(gradientStep -
+        batchStep - batchSize, gradientStep - batchSize), 1);
+    gradient.submat(offset + outSize, 0, offset + 2 * outSize - 1, 0) =
+        arma::sum(gateError.rows(2 * outSize, 3 * outSize - 1) %
+        cell.cols(gradientStep - batchStep - batchSize,
+        gradientStep - batchSize), 1);
   }
   else
   {
-    gradient.submat(offset, 0, offset +
-        cell2GateForgetWeight.n_elem - 1, 0).zeros();
-    gradient.submat(offset + cell2GateForgetWeight.n_elem, 0, offset +
-        cell2GateForgetWeight.n_elem +
-        cell2GateInputWeight.n_elem - 1, 0).zeros();
+    gradient.submat(offset, 0, offset + 2 * outSize - 1, 0).zeros();
   }
 
-  if (gradientStep == 0)
+  if (gradientStep == batchStep)
   {
     gradientStep = batchSize * bpttSteps - 1;
   }
@@ -427,7 +399,7 @@ void LSTM<InputDataType, OutputDataType>::Gradient(
 template<typename InputDataType, typename OutputDataType>
 template<typename Archive>
 void LSTM<InputDataType, OutputDataType>::serialize(
-    Archive& ar, const unsigned int /* version */)
+    Archive& ar, const unsigned int version)
 {
   ar & BOOST_SERIALIZATION_NVP(weights);
   ar & BOOST_SERIALIZATION_NVP(inSize);
@@ -441,10 +413,26 @@ void LSTM<InputDataType, OutputDataType>::serialize(
   ar & BOOST_SERIALIZATION_NVP(gradientStep);
   ar & BOOST_SERIALIZATION_NVP(gradientStepIdx);
   ar & BOOST_SERIALIZATION_NVP(cell);
-  ar & BOOST_SERIALIZATION_NVP(inputGateActivation);
-  ar & BOOST_SERIALIZATION_NVP(forgetGateActivation);
-  ar & BOOST_SERIALIZATION_NVP(outputGateActivation);
-  ar & BOOST_SERIALIZATION_NVP(hiddenLayerActivation);
+
+  // Older versions stored the activation of each gate separately.  They are
+  // only needed during a sequence, so they are dropped, and the buffers are
+  // recreated by the next call to Forward().
+  if (version == 0)
+  {
+    OutputDataType inputGateActivation, forgetGateActivation,
+        outputGateActivation, hiddenLayerActivation;
+    ar & BOOST_SERIALIZATION_NVP(inputGateActivation);
+    ar & BOOST_SERIALIZATION_NVP(forgetGateActivation);
+    ar & BOOST_SERIALIZATION_NVP(outputGateActivation);
+    ar & BOOST_SERIALIZATION_NVP(hiddenLayerActivation);
+    batchSize = 0;
+  }
+  else
+  {
+    ar & BOOST_SERIALIZATION_NVP(gate);
+    ar & BOOST_SERIALIZATION_NVP(gateActivation);
+  }
+
   ar & BOOST_SERIALIZATION_NVP(cellActivation);
   ar & BOOST_SERIALIZATION_NVP(prevError);
   ar & BOOST_SERIALIZATION_NVP(outParameter);
@@ -325,9 +325,14 @@ class RNN
   //! Locally-stored output parameter visitor.
   OutputParameterVisitor outputParameterVisitor;
 
-  //! List of all module parameters for the backward pass (BBTT).
+  //! List of all module parameters for the backward pass (BBTT).  The
+  //! matrices are kept between batches, so that their memory is reused.
   std::vector<arma::mat> moduleOutputParameter;
 
+  //! The number of module parameters of the current batch in
+  //! moduleOutputParameter.
+  size_t moduleOutputIndex;
+
   //! Locally-stored weight size visitor.
   WeightSizeVisitor weightSizeVisitor;
 
@@ -342,6 +347,12 @@ class RNN
 
   //! The current gradient for the gradient pass.
   arma::mat currentGradient;
+
+  //! The input of the current time step of the batch.
+  arma::mat currentInput;
+
+  //! The target of the current time step of the batch.
+  arma::mat currentTarget;
 }; // class RNN
 
 } // namespace ann
@@ -45,6 +45,7 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     reset(false),
     single(single),
     numFunctions(0),
+    moduleOutputIndex(0),
     deterministic(true)
 {
   /* Nothing to do here */
@@ -69,6 +70,7 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     predictors(std::move(predictors)),
     responses(std::move(responses)),
     numFunctions(0),
+    moduleOutputIndex(0),
     deterministic(true)
 {
   numFunctions = this->responses.n_cols;
@@ -230,24 +232,29 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
 
   double performance = 0;
 
+  // The outputs of the time steps overwrite those of the previous batch.  The
+  // inputs and targets of the time steps are copied into the same matrices, so
+  // that after the first batch no memory is allocated for them.
+  moduleOutputIndex = 0;
   for (size_t seqNum = 0; seqNum < rho; ++seqNum)
   {
-    Forward(std::move(predictors.submat(seqNum * inputSize, begin,
-        (seqNum + 1) * inputSize - 1, begin + batchSize - 1)));
+    currentInput = predictors.submat(seqNum * inputSize, begin,
+        (seqNum + 1) * inputSize - 1, begin + batchSize - 1);
+    Forward(std::move(currentInput));
 
     if (!deterministic)
     {
       for (size_t l = 0; l < network.size(); ++l)
       {
         boost::apply_visitor(SaveOutputParameterVisitor(
-            std::move(moduleOutputParameter)), network[l]);
+            std::move(moduleOutputParameter), moduleOutputIndex), network[l]);
       }
     }
 
+    currentTarget = responses.submat(seqNum * targetSize, begin,
+        (seqNum + 1) * targetSize - 1, begin + batchSize - 1);
     performance += outputLayer.Forward(std::move(boost::apply_visitor(
-        outputParameterVisitor, network.back())),
-        std::move(responses.submat(seqNum * targetSize, begin,
-        (seqNum + 1) * targetSize - 1, begin + batchSize - 1)));
+        outputParameterVisitor, network.back())), std::move(currentTarget));
   }
 
   if (outputSize == 0)
@@ -300,7 +307,8 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
     for (size_t l = 0; l < network.size(); ++l)
     {
       boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(moduleOutputParameter)), network[network.size() - 1 - l]);
+          std::move(moduleOutputParameter), moduleOutputIndex),
+          network[network.size() - 1 - l]);
     }
 
     if (single && seqNum > 0)
@@ -309,16 +317,17 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
     }
     else
     {
+      currentTarget = responses.submat((rho - seqNum - 1) * targetSize, begin,
+          (rho - seqNum) * targetSize - 1, begin + batchSize - 1);
       outputLayer.Backward(std::move(boost::apply_visitor(
-          outputParameterVisitor, network.back())),
-          std::move(responses.submat((rho - seqNum - 1) * targetSize, begin,
-          (rho - seqNum) * targetSize - 1, begin + batchSize - 1)),
+          outputParameterVisitor, network.back())), std::move(currentTarget),
           std::move(error));
     }
 
     Backward();
-    Gradient(std::move(predictors.submat((rho - seqNum - 1) * inputSize, begin,
-        (rho - seqNum) * inputSize - 1, begin + batchSize - 1)));
+    currentInput = predictors.submat((rho - seqNum - 1) * inputSize, begin,
+        (rho - seqNum) * inputSize - 1, begin + batchSize - 1);
+    Gradient(std::move(currentInput));
     gradient += currentGradient;
   }
 }
@@ -32,6 +32,18 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
   //! Restore the output parameter given a parameter set.
   LoadOutputParameterVisitor(std::vector<arma::mat>&& parameter);
 
+  /**
+   * Restore the output parameter from the parameters of the given parameter
+   * set before the given position, which is moved back past the restored
+   * parameters.  The set itself is left unchanged, so that its matrices can be
+   * reused by SaveOutputParameterVisitor.
+   *
+   * @param parameter The parameter set.
+   * @param position The position after the last parameter to restore.
+   */
+  LoadOutputParameterVisitor(std::vector<arma::mat>&& parameter,
+                             size_t& position);
+
   //! Restore the output parameter.
   template<typename LayerType>
   void operator()(LayerType* layer) const;
@@ -40,6 +52,13 @@ class LoadOutputParameterVisitor : public boost::static_visitor<void>
   //! The parameter set.
   std::vector<arma::mat>&& parameter;
 
+  //! The position after the last parameter to restore, or NULL to take the
+  //! parameters from the end of the set.
+  size_t* position;
+
+  //! Restore the given output parameter of a layer.
+  void Load(arma::mat& outputParameter) const;
+
   //! Restore the output parameter for a module which doesn't implement the
   //! Model() function.
   template<typename T>
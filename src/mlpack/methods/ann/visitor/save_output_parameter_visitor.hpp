@@ -31,6 +31,17 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
   //! Save the output parameter into the given parameter set.
   SaveOutputParameterVisitor(std::vector<arma::mat>&& parameter);
 
+  /**
+   * Save the output parameter into the given parameter set, starting at the
+   * given position, which is advanced past the saved parameters.  The matrices
+   * that are already in the set are overwritten, so their memory is reused.
+   *
+   * @param parameter The parameter set.
+   * @param position The position of the next saved parameter.
+   */
+  SaveOutputParameterVisitor(std::vector<arma::mat>&& parameter,
+                             size_t& position);
+
   //! Save the output parameter.
   template<typename LayerType>
   void operator()(LayerType* layer) const;
@@ -39,6 +50,12 @@ class SaveOutputParameterVisitor : public boost::static_visitor<void>
   //! The parameter set.
   std::vector<arma::mat>&& parameter;
 
+  //! The position of the next saved parameter, or NULL to append to the set.
+  size_t* position;
+
+  //! Save the output parameter of the given layer.
+  void Save(const arma::mat& outputParameter) const;
+
   //! Save the output parameter for a module which doesn't implement the
   //! Model() function.
   template<typename T>
@@ -20,11 +20,33 @@ namespace ann {
 
 //! SaveOutputParameterVisitor visitor class.
 inline SaveOutputParameterVisitor::SaveOutputParameterVisitor(
-    std::vector<arma::mat>&& parameter) : parameter(std::move(parameter))
+    std::vector<arma::mat>&& parameter) :
+    parameter(std::move(parameter)),
+    position(NULL)
 {
   /* Nothing to do here. */
 }
 
+inline SaveOutputParameterVisitor::SaveOutputParameterVisitor(
+    std::vector<arma::mat>&& parameter, size_t& position) :
+    parameter(std::move(parameter)),
+    position(&position)
+{
+  /* Nothing to do here. */
+}
+
+inline void SaveOutputParameterVisitor::Save(
+    const arma::mat& outputParameter) const
+{
+  if (position == NULL || *position == parameter.size())
+    parameter.push_back(outputParameter);
+  else
+    parameter[*position] = outputParameter;
+
+  if (position != NULL)
+    ++(*position);
+}
+
 template<typename LayerType>
 inline void SaveOutputParameterVisitor::operator()(LayerType* layer) const
 {
@@ -36,7 +58,7 @@ inline typename std::enable_if<
     !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
 SaveOutputParameterVisitor::OutputParameter(T* layer) const
 {
-  parameter.push_back(layer->OutputParameter());
+  Save(layer->OutputParameter());
 }
 
 template<typename T>
@@ -44,12 +66,20 @@ inline typename std::enable_if<
     HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
 SaveOutputParameterVisitor::OutputParameter(T* layer) const
 {
-  parameter.push_back(layer->OutputParameter());
+  Save(layer->OutputParameter());
 
   for (size_t i = 0; i < layer->Model().size(); ++i)
   {
-    boost::apply_visitor(SaveOutputParameterVisitor(std::move(parameter)),
-        layer->Model()[i]);
+    if (position == NULL)
+    {
+      boost::apply_visitor(SaveOutputParameterVisitor(std::move(parameter)),
+          layer->Model()[i]);
+    }
+    else
+    {
+      boost::apply_visitor(SaveOutputParameterVisitor(std::move(parameter),
+          *position), layer->Model()[i]);
+    }
   }
 }
 
@@ -52,7 +52,8 @@ class AllCategoricalSplit
    * @param aux Auxiliary split information, which may be modified on a
    *      successful split.
    */
-  template<bool UseWeights, typename VecType, typename WeightVecType>
+  template<bool UseWeights, typename VecType, typename WeightVecType,
+           typename ElemType>
   static double SplitIfBetter(
       const double bestGain,
       const VecType& data,
@@ -61,8 +62,8 @@ class AllCategoricalSplit
       const size_t numClasses,
       const WeightVecType& weights,
       const size_t minimumLeafSize,
-      arma::Col<typename VecType::elem_type>& classProbabilities,
-      AuxiliarySplitInfo<typename VecType::elem_type>& aux);
+      arma::Col<ElemType>& classProbabilities,
+      AuxiliarySplitInfo<ElemType>& aux);
 
   /**
    * Return the number of children in the split.
@@ -75,14 +76,17 @@ class AllCategoricalSplit
                             const AuxiliarySplitInfo<ElemType>& /* aux */);
 
   /**
-   * Calculate the direction a point should percolate to.
+   * Calculate the direction a point should percolate to.  The point may have
+   * a different type than the split information (for instance, when the tree
+   * is trained on 8-bit codes).
    *
+   * @param point Category of the point.
    * @param classProbabilities Auxiliary information for the split.
    * @param aux (Unused) auxiliary information for the split.
    */
-  template<typename ElemType>
+  template<typename PointType, typename ElemType>
   static size_t CalculateDirection(
-      const ElemType& point,
+      const PointType& point,
       const arma::Col<ElemType>& classProbabilities,
       const AuxiliarySplitInfo<ElemType>& /* aux */);
 };
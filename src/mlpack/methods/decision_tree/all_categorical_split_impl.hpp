@@ -16,7 +16,8 @@ namespace mlpack {
 namespace tree {
 
 template<typename FitnessFunction>
-template<bool UseWeights, typename VecType, typename WeightVecType>
+template<bool UseWeights, typename VecType, typename WeightVecType,
+         typename ElemType>
 double AllCategoricalSplit<FitnessFunction>::SplitIfBetter(
     const double bestGain,
     const VecType& data,
@@ -25,8 +26,8 @@ double AllCategoricalSplit<FitnessFunction>::SplitIfBetter(
     const size_t numClasses,
     const WeightVecType& weights,
     const size_t minimumLeafSize,
-    arma::Col<typename VecType::elem_type>& classProbabilities,
-    AuxiliarySplitInfo<typename VecType::elem_type>& /* aux */)
+    arma::Col<ElemType>& classProbabilities,
+    AuxiliarySplitInfo<ElemType>& /* aux */)
 {
   // Count the number of elements in each potential child.
   const double epsilon = 1e-7; // Tolerance for floating-point errors.
@@ -118,9 +119,9 @@ size_t AllCategoricalSplit<FitnessFunction>::NumChildren(
 }
 
 template<typename FitnessFunction>
-template<typename ElemType>
+template<typename PointType, typename ElemType>
 size_t AllCategoricalSplit<FitnessFunction>::CalculateDirection(
-    const ElemType& point,
+    const PointType& point,
     const arma::Col<ElemType>& /* classProbabilities */,
     const AuxiliarySplitInfo<ElemType>& /* aux */)
 {
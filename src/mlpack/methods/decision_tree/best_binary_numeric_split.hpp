@@ -21,6 +21,13 @@ namespace tree {
  * The BestBinaryNumericSplit is a splitting function for decision trees that
  * will exhaustively search a numeric dimension for the best binary split.
  *
+ * The points are sorted once, and then the candidate splits are scanned in
+ * order while the class counts of each child are updated one point at a time,
+ * so the search takes O(n log n + n * numClasses) time.  Because of this, the
+ * FitnessFunction must provide the static function
+ * EvaluatePtr(counts, numClasses, totalCount), which calculates the gain from
+ * the class counts (see GiniGain and InformationGain).
+ *
  * @tparam FitnessFunction Fitness function to use to calculate gain.
  */
 template<typename FitnessFunction>
@@ -47,50 +47,61 @@ double BestBinaryNumericSplit<FitnessFunction>::SplitIfBetter(
       sortedWeights[i] = weights[sortedIndices[i]];
   }
 
-  // Loop through all possible split points, choosing the best one.  Also, force
-  // a minimum leaf size of 1 (empty children don't make sense).
-  double bestFoundGain = bestGain;
+  // We scan the sorted points from left to right, moving one point at a time
+  // from the right child to the left child.  So that each candidate split can
+  // be evaluated in O(numClasses) time, we keep the count (or the weight sum)
+  // of each class in each child.  The first column holds the counts of the
+  // left child, and the second column holds the counts of the right child.
+  // Also, force a minimum leaf size of 1 (empty children don't make sense).
   const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
+  arma::mat classCounts(numClasses, 2, arma::fill::zeros);
+  double* leftCounts = classCounts.colptr(0);
+  double* rightCounts = classCounts.colptr(1);
+  double leftWeight = 0.0;
+  double totalWeight = 0.0;
+  for (size_t i = 0; i < sortedLabels.n_elem; ++i)
+  {
+    const double weight = UseWeights ? sortedWeights[i] : 1.0;
+    // The first minimum - 1 points are always in the left child.
+    if (i < minimum - 1)
+    {
+      leftCounts[sortedLabels[i]] += weight;
+      leftWeight += weight;
+    }
+    else
+    {
+      rightCounts[sortedLabels[i]] += weight;
+    }
+    totalWeight += weight;
+  }
+
+  // Loop through all possible split points, choosing the best one.
+  double bestFoundGain = bestGain;
   for (size_t index = minimum; index < data.n_elem - (minimum - 1); ++index)
   {
+    // Move the point at index - 1 to the left child.
+    const double weight = UseWeights ? sortedWeights[index - 1] : 1.0;
+    leftCounts[sortedLabels[index - 1]] += weight;
+    rightCounts[sortedLabels[index - 1]] -= weight;
+    leftWeight += weight;
+
     // Make sure that the value has changed.
     if (data[sortedIndices[index]] == data[sortedIndices[index - 1]])
       continue;
 
-    // Calculate the gain for the left and right child.  Only use weights if
-    // needed.
-    const double leftGain = UseWeights ?
-        FitnessFunction::template Evaluate<true>(sortedLabels.subvec(0,
-            index - 1), numClasses, sortedWeights.subvec(0, index - 1)) :
-        FitnessFunction::template Evaluate<false>(sortedLabels.subvec(0,
-            index - 1), numClasses, sortedWeights /* ignored */);
-    const double rightGain = UseWeights ?
-        FitnessFunction::template Evaluate<true>(sortedLabels.subvec(index,
-            sortedLabels.n_elem - 1), numClasses, sortedWeights.subvec(index,
-            sortedLabels.n_elem - 1)) :
-        FitnessFunction::template Evaluate<false>(sortedLabels.subvec(index,
-            sortedLabels.n_elem - 1), numClasses, sortedWeights /* ignored */);
+    // Calculate the gain for the left and right child.  The weight of the
+    // right child is computed from the total, so that it does not accumulate
+    // rounding errors.
+    const double rightWeight = totalWeight - leftWeight;
+    const double leftGain = FitnessFunction::EvaluatePtr(leftCounts,
+        numClasses, leftWeight);
+    const double rightGain = FitnessFunction::EvaluatePtr(rightCounts,
+        numClasses, rightWeight);
 
-    double gain;
-    if (UseWeights)
-    {
-      const double leftWeights = arma::accu(sortedWeights.subvec(0, index - 1));
-      const double rightWeights = arma::accu(sortedWeights.subvec(index,
-          sortedWeights.n_elem - 1));
-      const double fullWeight = leftWeights + rightWeights;
-
-      gain = (leftWeights / fullWeight) * leftGain +
-          (rightWeights / fullWeight) * rightGain;
-    }
-    else
-    {
-      // Calculate the fraction of points in the left and right children.
-      const double leftRatio = double(index) / double(sortedLabels.n_elem);
-      const double rightRatio = 1.0 - leftRatio;
-
-      // Calculate the gain at this split point.
-      gain = leftRatio * leftGain + rightRatio * rightGain;
-    }
+    // Calculate the gain at this split point, weighting each child by its
+    // fraction of the points (or of the weight).
+    const double gain = (leftWeight / totalWeight) * leftGain +
+        (rightWeight / totalWeight) * rightGain;
 
     // Corner case: is this the best possible split?
     if (gain >= 0.0)
@@ -20,6 +20,15 @@
 #include "all_dimension_select.hpp"
 #include <type_traits>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+// Training a tree in parallel needs OpenMP tasks, which appeared in OpenMP 3.0.
+#if defined(HAS_OPENMP) && defined(_OPENMP) && (_OPENMP >= 200805)
+  #define MLPACK_DECISION_TREE_TASKS
+#endif
+
 namespace mlpack {
 namespace tree {
 
@@ -29,6 +38,19 @@ namespace tree {
  *
  * The class inherits from the auxiliary split information in order to prevent
  * an empty auxiliary split information struct from taking any extra size.
+ *
+ * If the parallel option of Train() is set and mlpack is compiled with OpenMP,
+ * the candidate dimensions of each node with at least MinimumParallelSize
+ * points are evaluated in separate OpenMP tasks, and so are the subtrees of
+ * its children.  The tasks run in the current team of threads if Train() is
+ * called inside a parallel region (for instance in the loop over the trees of
+ * a RandomForest), and in a new team otherwise, so the threads are never
+ * oversubscribed.  The trained tree is the same as the one trained serially,
+ * unless the DimensionSelectionType draws random dimensions: the candidate
+ * dimensions of the nodes are then drawn from the global random number
+ * generator one node at a time, in an order that depends on the scheduling of
+ * the tasks.  Tasks need OpenMP 3.0; with older versions the tree is always
+ * trained serially.
  */
 template<typename FitnessFunction = GiniGain,
          template<typename> class NumericSplitType = BestBinaryNumericSplit,
@@ -50,6 +72,10 @@ class DecisionTree :
   //! Allow access to the dimension selection type.
   typedef DimensionSelectionType DimensionSelection;
 
+  //! The minimum number of points in a node for its dimensions and its
+  //! children to be trained in parallel tasks.
+  static const size_t MinimumParallelSize = 1024;
+
   /**
    * Construct the decision tree on the given data and labels, where the data
    * can be both numeric and categorical.  Setting minimumLeafSize too small may
@@ -61,13 +87,15 @@ class DecisionTree :
    * @param labels Labels for each training point.
    * @param numClasses Number of classes in the dataset.
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<typename MatType, typename LabelsType>
   DecisionTree(MatType&& data,
                const data::DatasetInfo& datasetInfo,
                LabelsType&& labels,
                const size_t numClasses,
-               const size_t minimumLeafSize = 10);
+               const size_t minimumLeafSize = 10,
+               const bool parallel = false);
 
   /**
    * Construct the decision tree on the given data and labels, assuming that the
@@ -79,12 +107,14 @@ class DecisionTree :
    * @param labels Labels for each training point.
    * @param numClasses Number of classes in the dataset.
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<typename MatType, typename LabelsType>
   DecisionTree(MatType&& data,
                LabelsType&& labels,
                const size_t numClasses,
-               const size_t minimumLeafSize = 10);
+               const size_t minimumLeafSize = 10,
+               const bool parallel = false);
 
   /**
    * Construct the decision tree on the given data and labels with weights,
@@ -98,6 +128,7 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights The weight list of given label.
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<typename MatType, typename LabelsType, typename WeightsType>
   DecisionTree(MatType&& data,
@@ -106,6 +137,7 @@ class DecisionTree :
                const size_t numClasses,
                WeightsType&& weights,
                const size_t minimumLeafSize = 10,
+               const bool parallel = false,
                const std::enable_if_t<arma::is_arma_type<
                    typename std::remove_reference<WeightsType>::type>::value>*
                     = 0);
@@ -121,6 +153,7 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights The Weight list of given labels.
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<typename MatType, typename LabelsType, typename WeightsType>
   DecisionTree(MatType&& data,
@@ -128,6 +161,7 @@ class DecisionTree :
                const size_t numClasses,
                WeightsType&& weights,
                const size_t minimumLeafSize = 10,
+               const bool parallel = false,
                const std::enable_if_t<arma::is_arma_type<
                    typename std::remove_reference<WeightsType>::type>::value>*
                     = 0);
@@ -188,13 +222,15 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights Weights of all the labels
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<typename MatType, typename LabelsType>
   void Train(MatType&& data,
              const data::DatasetInfo& datasetInfo,
              LabelsType&& labels,
              const size_t numClasses,
-             const size_t minimumLeafSize = 10);
+             const size_t minimumLeafSize = 10,
+             const bool parallel = false);
 
   /**
    * Train the decision tree on the given data, assuming that all dimensions are
@@ -207,12 +243,14 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights Weights of all the labels
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<typename MatType, typename LabelsType>
   void Train(MatType&& data,
              LabelsType&& labels,
              const size_t numClasses,
-             const size_t minimumLeafSize = 10);
+             const size_t minimumLeafSize = 10,
+             const bool parallel = false);
 
   /**
    * Train the decision tree on the given weighted data.  This will overwrite
@@ -227,6 +265,7 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights Weights of all the labels
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<typename MatType, typename LabelsType, typename WeightsType>
   void Train(MatType&& data,
@@ -235,6 +274,7 @@ class DecisionTree :
              const size_t numClasses,
              WeightsType&& weights,
              const size_t minimumLeafSize = 10,
+             const bool parallel = false,
              const std::enable_if_t<arma::is_arma_type<typename
                  std::remove_reference<WeightsType>::type>::value>* = 0);
 
@@ -249,6 +289,7 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights Weights of all the labels
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<typename MatType, typename LabelsType, typename WeightsType>
   void Train(MatType&& data,
@@ -256,6 +297,7 @@ class DecisionTree :
              const size_t numClasses,
              WeightsType&& weights,
              const size_t minimumLeafSize = 10,
+             const bool parallel = false,
              const std::enable_if_t<arma::is_arma_type<typename
                  std::remove_reference<WeightsType>::type>::value>* = 0);
 
@@ -337,6 +379,19 @@ class DecisionTree :
    */
   size_t NumClasses() const;
 
+  //! Get the dimension this node splits on (only meaningful if this is not a
+  //! leaf).
+  size_t SplitDimension() const { return splitDimension; }
+
+  //! Get the type of the dimension this node splits on (only meaningful if
+  //! this is not a leaf).
+  data::Datatype SplitDimensionType() const
+  { return (data::Datatype) dimensionTypeOrMajorityClass; }
+
+  //! Get the class probabilities of a leaf, or the split information of the
+  //! split type if this is not a leaf.
+  const arma::vec& ClassProbabilities() const { return classProbabilities; }
+
  private:
   //! The vector of children.
   std::vector<DecisionTree*> children;
@@ -362,6 +417,16 @@ class DecisionTree :
   typedef typename CategoricalSplit::template AuxiliarySplitInfo<ElemType>
       CategoricalAuxiliarySplitInfo;
 
+  /**
+   * Store the candidate dimensions given by the DimensionSelectionType for a
+   * node in the given vector.
+   *
+   * @param dimensionality Number of dimensions of the data.
+   * @param candidates Vector to store the candidate dimensions in.
+   */
+  static void SelectDimensions(const size_t dimensionality,
+                               std::vector<size_t>& candidates);
+
   /**
    * Calculate the class probabilities of the given labels.
    */
@@ -383,6 +448,7 @@ class DecisionTree :
    * @param labels Labels for each training point.
    * @param numClasses Number of classes in the dataset.
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<bool UseWeights, typename MatType>
   void Train(MatType& data,
@@ -392,7 +458,8 @@ class DecisionTree :
              arma::Row<size_t>& labels,
              const size_t numClasses,
              arma::rowvec& weights,
-             const size_t minimumLeafSize = 10);
+             const size_t minimumLeafSize = 10,
+             const bool parallel = false);
 
   /**
    * Corresponding to the public Train() method, this method is designed for
@@ -406,6 +473,7 @@ class DecisionTree :
    * @param labels Labels for each training point.
    * @param numClasses Number of classes in the dataset.
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to train the tree in parallel with OpenMP tasks.
    */
   template<bool UseWeights, typename MatType>
   void Train(MatType& data,
@@ -414,7 +482,8 @@ class DecisionTree :
              arma::Row<size_t>& labels,
              const size_t numClasses,
              arma::rowvec& weights,
-             const size_t minimumLeafSize = 10);
+             const size_t minimumLeafSize = 10,
+             const bool parallel = false);
 };
 
 /**
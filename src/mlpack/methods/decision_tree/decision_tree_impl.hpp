@@ -32,7 +32,8 @@ DecisionTree<FitnessFunction,
                                         const data::DatasetInfo& datasetInfo,
                                         LabelsType&& labels,
                                         const size_t numClasses,
-                                        const size_t minimumLeafSize)
+                                        const size_t minimumLeafSize,
+                                        const bool parallel)
 {
   using TrueMatType = typename std::decay<MatType>::type;
   using TrueLabelsType = typename std::decay<LabelsType>::type;
@@ -44,7 +45,7 @@ DecisionTree<FitnessFunction,
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
   Train<false>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
-      weights, minimumLeafSize);
+      weights, minimumLeafSize, parallel);
 }
 
 //! Construct and train.
@@ -63,7 +64,8 @@ DecisionTree<FitnessFunction,
              NoRecursion>::DecisionTree(MatType&& data,
                                         LabelsType&& labels,
                                         const size_t numClasses,
-                                        const size_t minimumLeafSize)
+                                        const size_t minimumLeafSize,
+                                        const bool parallel)
 {
   using TrueMatType = typename std::decay<MatType>::type;
   using TrueLabelsType = typename std::decay<LabelsType>::type;
@@ -75,7 +77,7 @@ DecisionTree<FitnessFunction,
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
   Train<false>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, weights,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 //! Construct and train with weights.
@@ -97,6 +99,7 @@ DecisionTree<FitnessFunction,
                                         const size_t numClasses,
                                         WeightsType&& weights,
                                         const size_t minimumLeafSize,
+                                        const bool parallel,
                                         const std::enable_if_t<
                                             arma::is_arma_type<
                                             typename std::remove_reference<
@@ -113,7 +116,7 @@ DecisionTree<FitnessFunction,
 
   // Pass off work to the weighted Train() method.
   Train<true>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
-      tmpWeights, minimumLeafSize);
+      tmpWeights, minimumLeafSize, parallel);
 }
 
 //! Construct and train with weights.
@@ -134,6 +137,7 @@ DecisionTree<FitnessFunction,
                                         const size_t numClasses,
                                         WeightsType&& weights,
                                         const size_t minimumLeafSize,
+                                        const bool parallel,
                                         const std::enable_if_t<
                                             arma::is_arma_type<
                                             typename std::remove_reference<
@@ -150,7 +154,7 @@ DecisionTree<FitnessFunction,
 
   // Pass off work to the weighted Train() method.
   Train<true>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, tmpWeights,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 //! Construct, don't train.
@@ -345,7 +349,8 @@ void DecisionTree<FitnessFunction,
                                       const data::DatasetInfo& datasetInfo,
                                       LabelsType&& labels,
                                       const size_t numClasses,
-                                      const size_t minimumLeafSize)
+                                      const size_t minimumLeafSize,
+                                      const bool parallel)
 {
   // Sanity check on data.
   if (data.n_cols != labels.n_elem)
@@ -367,7 +372,7 @@ void DecisionTree<FitnessFunction,
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
   Train<false>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
-      weights, minimumLeafSize);
+      weights, minimumLeafSize, parallel);
 }
 
 //! Train on the given data, assuming all dimensions are numeric.
@@ -386,7 +391,8 @@ void DecisionTree<FitnessFunction,
                   NoRecursion>::Train(MatType&& data,
                                       LabelsType&& labels,
                                       const size_t numClasses,
-                                      const size_t minimumLeafSize)
+                                      const size_t minimumLeafSize,
+                                      const bool parallel)
 {
   // Sanity check on data.
   if (data.n_cols != labels.n_elem)
@@ -408,7 +414,7 @@ void DecisionTree<FitnessFunction,
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
   Train<false>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, weights,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 //! Train on the given weighted data.
@@ -430,6 +436,7 @@ void DecisionTree<FitnessFunction,
                                       const size_t numClasses,
                                       WeightsType&& weights,
                                       const size_t minimumLeafSize,
+                                      const bool parallel,
                                       const std::enable_if_t<arma::is_arma_type<
                                           typename std::remove_reference<
                                           WeightsType>::type>::value>*)
@@ -455,7 +462,7 @@ void DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   Train<true>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
-      tmpWeights, minimumLeafSize);
+      tmpWeights, minimumLeafSize, parallel);
 }
 
 //! Train on the given weighted data.
@@ -476,6 +483,7 @@ void DecisionTree<FitnessFunction,
                                       const size_t numClasses,
                                       WeightsType&& weights,
                                       const size_t minimumLeafSize,
+                                      const bool parallel,
                                       const std::enable_if_t<arma::is_arma_type<
                                           typename std::remove_reference<
                                           WeightsType>::type>::value>*)
@@ -501,7 +509,7 @@ void DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   Train<true>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, tmpWeights,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 //! Train on the given data.
@@ -524,8 +532,27 @@ void DecisionTree<FitnessFunction,
                                       arma::Row<size_t>& labels,
                                       const size_t numClasses,
                                       arma::rowvec& weights,
-                                      const size_t minimumLeafSize)
+                                      const size_t minimumLeafSize,
+                                      const bool parallel)
 {
+#ifdef MLPACK_DECISION_TREE_TASKS
+  // The tasks need a team of threads.  If we aren't in a parallel region yet,
+  // start one and build the tree from one of its threads.
+  if (parallel && omp_get_level() == 0)
+  {
+    #pragma omp parallel
+    {
+      #pragma omp single
+      Train<UseWeights>(data, begin, count, datasetInfo, labels, numClasses,
+          weights, minimumLeafSize, parallel);
+    }
+    return;
+  }
+#endif
+
+  // Small nodes aren't worth the overhead of the tasks.
+  const bool parallelNode = parallel && (count >= MinimumParallelSize);
+
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
     delete children[i];
@@ -541,45 +568,139 @@ void DecisionTree<FitnessFunction,
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = datasetInfo.Dimensionality(); // This means "no split".
-  DimensionSelectionType dimensions(datasetInfo.Dimensionality());
-  for (size_t i = dimensions.Begin(); i != dimensions.End();
-       i = dimensions.Next())
+
+  // The dimension selection may draw the candidate dimensions from the global
+  // random number generator, which isn't thread-safe; when other subtrees are
+  // being trained in other tasks, the candidates are drawn one node at a time.
+  std::vector<size_t> candidates;
+  if (parallel)
+  {
+    #ifdef MLPACK_DECISION_TREE_TASKS
+    #pragma omp critical(DecisionTreeDimensionSelection)
+    #endif
+    SelectDimensions(datasetInfo.Dimensionality(), candidates);
+  }
+  else
+  {
+    SelectDimensions(datasetInfo.Dimensionality(), candidates);
+  }
+
+  if (parallelNode)
   {
-    double dimGain = -DBL_MAX;
-    if (datasetInfo.Type(i) == data::Datatype::categorical)
+    // Evaluate each candidate dimension in its own task, against the gain of
+    // the unsplit node and with its own split information.  The best
+    // dimension is then chosen in the same order as in the serial loop below,
+    // which gives the same split.
+    const double nodeGain = bestGain;
+    std::vector<double> gains(candidates.size(), nodeGain);
+    std::vector<arma::vec> splitInfo(candidates.size());
+    std::vector<NumericAuxiliarySplitInfo> numericAux(candidates.size());
+    std::vector<CategoricalAuxiliarySplitInfo> categoricalAux(
+        candidates.size());
+    for (size_t c = 0; c < candidates.size(); ++c)
     {
-      dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(bestGain,
-          data.cols(begin, begin + count - 1).row(i),
-          datasetInfo.NumMappings(i),
-          labels.subvec(begin, begin + count - 1),
-          numClasses,
-          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-          minimumLeafSize,
-          classProbabilities,
-          *this);
+      #ifdef MLPACK_DECISION_TREE_TASKS
+      #pragma omp task default(shared) firstprivate(c)
+      #endif
+      {
+        const size_t i = candidates[c];
+        if (datasetInfo.Type(i) == data::Datatype::categorical)
+        {
+          gains[c] = CategoricalSplit::template SplitIfBetter<UseWeights>(
+              nodeGain,
+              data.cols(begin, begin + count - 1).row(i),
+              datasetInfo.NumMappings(i),
+              labels.subvec(begin, begin + count - 1),
+              numClasses,
+              UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+              minimumLeafSize,
+              splitInfo[c],
+              categoricalAux[c]);
+        }
+        else if (datasetInfo.Type(i) == data::Datatype::numeric)
+        {
+          gains[c] = NumericSplit::template SplitIfBetter<UseWeights>(
+              nodeGain,
+              data.cols(begin, begin + count - 1).row(i),
+              labels.subvec(begin, begin + count - 1),
+              numClasses,
+              UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+              minimumLeafSize,
+              splitInfo[c],
+              numericAux[c]);
+        }
+      }
     }
-    else if (datasetInfo.Type(i) == data::Datatype::numeric)
+    #ifdef MLPACK_DECISION_TREE_TASKS
+    #pragma omp taskwait
+    #endif
+
+    size_t best = candidates.size();
+    for (size_t c = 0; c < candidates.size(); ++c)
     {
-      dimGain = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
-          data.cols(begin, begin + count - 1).row(i),
-          labels.subvec(begin, begin + count - 1),
-          numClasses,
-          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-          minimumLeafSize,
-          classProbabilities,
-          *this);
+      if (gains[c] > bestGain)
+      {
+        best = c;
+        bestGain = gains[c];
+      }
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain >= 0.0)
+        break;
     }
 
-    // Was there an improvement?  If so mark that it's the new best dimension.
-    if (dimGain > bestGain)
+    if (best != candidates.size())
     {
-      bestDim = i;
-      bestGain = dimGain;
+      bestDim = candidates[best];
+      classProbabilities = std::move(splitInfo[best]);
+      NumericAuxiliarySplitInfo::operator=(std::move(numericAux[best]));
+      CategoricalAuxiliarySplitInfo::operator=(
+          std::move(categoricalAux[best]));
     }
+  }
+  else
+  {
+    for (size_t c = 0; c < candidates.size(); ++c)
+    {
+      const size_t i = candidates[c];
+      double dimGain = -DBL_MAX;
+      if (datasetInfo.Type(i) == data::Datatype::categorical)
+      {
+        dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(
+            bestGain,
+            data.cols(begin, begin + count - 1).row(i),
+            datasetInfo.NumMappings(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            classProbabilities,
+            *this);
+      }
+      else if (datasetInfo.Type(i) == data::Datatype::numeric)
+      {
+        dimGain = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
+            data.cols(begin, begin + count - 1).row(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            classProbabilities,
+            *this);
+      }
+
+      // Was there an improvement?  If so mark that it's the new best
+      // dimension.
+      if (dimGain > bestGain)
+      {
+        bestDim = i;
+        bestGain = dimGain;
+      }
 
-    // If the gain is the best possible, no need to keep looking.
-    if (bestGain >= 0.0)
-      break;
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain >= 0.0)
+        break;
+    }
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -635,22 +756,35 @@ void DecisionTree<FitnessFunction,
         }
       }
 
-      // Now build the child recursively.
+      // Now build the child recursively.  Each child only touches its own
+      // columns of the data, so in parallel the children are built in tasks,
+      // while the points of the next children are still being moved.
       DecisionTree* child = new DecisionTree();
-      if (NoRecursion)
+      children.push_back(child);
+      const size_t childCount = currentCol - currentChildBegin;
+      const size_t childLeafSize = NoRecursion ? childCount : minimumLeafSize;
+      if (parallelNode)
       {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, currentCol - currentChildBegin);
+        #ifdef MLPACK_DECISION_TREE_TASKS
+        #pragma omp task default(shared) \
+            firstprivate(child, currentChildBegin, childCount, childLeafSize)
+        #endif
+        child->Train<UseWeights>(data, currentChildBegin, childCount,
+            datasetInfo, labels, numClasses, weights, childLeafSize, parallel);
       }
       else
       {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, minimumLeafSize);
+        child->Train<UseWeights>(data, currentChildBegin, childCount,
+            datasetInfo, labels, numClasses, weights, childLeafSize, parallel);
       }
-      children.push_back(child);
     }
+
+    #ifdef MLPACK_DECISION_TREE_TASKS
+    if (parallelNode)
+    {
+      #pragma omp taskwait
+    }
+    #endif
   }
   else
   {
@@ -685,8 +819,27 @@ void DecisionTree<FitnessFunction,
                                       arma::Row<size_t>& labels,
                                       const size_t numClasses,
                                       arma::rowvec& weights,
-                                      const size_t minimumLeafSize)
+                                      const size_t minimumLeafSize,
+                                      const bool parallel)
 {
+#ifdef MLPACK_DECISION_TREE_TASKS
+  // The tasks need a team of threads.  If we aren't in a parallel region yet,
+  // start one and build the tree from one of its threads.
+  if (parallel && omp_get_level() == 0)
+  {
+    #pragma omp parallel
+    {
+      #pragma omp single
+      Train<UseWeights>(data, begin, count, labels, numClasses, weights,
+          minimumLeafSize, parallel);
+    }
+    return;
+  }
+#endif
+
+  // Small nodes aren't worth the overhead of the tasks.
+  const bool parallelNode = parallel && (count >= MinimumParallelSize);
+
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
     delete children[i];
@@ -705,29 +858,81 @@ void DecisionTree<FitnessFunction,
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = data.n_rows; // This means "no split".
-  for (size_t i = 0; i < data.n_rows; ++i)
+  if (parallelNode)
   {
-    const double dimGain = NumericSplitType<FitnessFunction>::template
-        SplitIfBetter<UseWeights>(bestGain,
-                                  data.cols(begin, begin + count - 1).row(i),
-                                  labels.cols(begin, begin + count - 1),
-                                  numClasses,
-                                  UseWeights ?
-                                      weights.cols(begin, begin + count - 1) :
-                                      weights,
-                                  minimumLeafSize,
-                                  classProbabilities,
-                                  *this);
-
-    if (dimGain > bestGain)
+    // Evaluate each dimension in its own task, against the gain of the unsplit
+    // node and with its own split information, and then choose the best
+    // dimension in the same order as the serial loop below.
+    const double nodeGain = bestGain;
+    std::vector<double> gains(data.n_rows, nodeGain);
+    std::vector<arma::vec> splitInfo(data.n_rows);
+    std::vector<NumericAuxiliarySplitInfo> numericAux(data.n_rows);
+    for (size_t i = 0; i < data.n_rows; ++i)
+    {
+      #ifdef MLPACK_DECISION_TREE_TASKS
+      #pragma omp task default(shared) firstprivate(i)
+      #endif
+      gains[i] = NumericSplitType<FitnessFunction>::template
+          SplitIfBetter<UseWeights>(nodeGain,
+                                    data.cols(begin, begin + count - 1).row(i),
+                                    labels.cols(begin, begin + count - 1),
+                                    numClasses,
+                                    UseWeights ?
+                                        weights.cols(begin, begin + count - 1) :
+                                        weights,
+                                    minimumLeafSize,
+                                    splitInfo[i],
+                                    numericAux[i]);
+    }
+    #ifdef MLPACK_DECISION_TREE_TASKS
+    #pragma omp taskwait
+    #endif
+
+    for (size_t i = 0; i < data.n_rows; ++i)
     {
-      bestDim = i;
-      bestGain = dimGain;
+      if (gains[i] > bestGain)
+      {
+        bestDim = i;
+        bestGain = gains[i];
+      }
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain >= 0.0)
+        break;
     }
 
-    // If the gain is the best possible, no need to keep looking.
-    if (bestGain >= 0.0)
-      break;
+    if (bestDim != data.n_rows)
+    {
+      classProbabilities = std::move(splitInfo[bestDim]);
+      NumericAuxiliarySplitInfo::operator=(std::move(numericAux[bestDim]));
+    }
+  }
+  else
+  {
+    for (size_t i = 0; i < data.n_rows; ++i)
+    {
+      const double dimGain = NumericSplitType<FitnessFunction>::template
+          SplitIfBetter<UseWeights>(bestGain,
+                                    data.cols(begin, begin + count - 1).row(i),
+                                    labels.cols(begin, begin + count - 1),
+                                    numClasses,
+                                    UseWeights ?
+                                        weights.cols(begin, begin + count - 1) :
+                                        weights,
+                                    minimumLeafSize,
+                                    classProbabilities,
+                                    *this);
+
+      if (dimGain > bestGain)
+      {
+        bestDim = i;
+        bestGain = dimGain;
+      }
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain >= 0.0)
+        break;
+    }
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -770,22 +975,33 @@ void DecisionTree<FitnessFunction,
         }
       }
 
-      // Now build the child recursively.
+      // Now build the child recursively, in a task if we are in parallel.
       DecisionTree* child = new DecisionTree();
-      if (NoRecursion)
+      children.push_back(child);
+      const size_t childCount = currentCol - currentChildBegin;
+      const size_t childLeafSize = NoRecursion ? childCount : minimumLeafSize;
+      if (parallelNode)
       {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            currentCol - currentChildBegin);
+        #ifdef MLPACK_DECISION_TREE_TASKS
+        #pragma omp task default(shared) \
+            firstprivate(child, currentChildBegin, childCount, childLeafSize)
+        #endif
+        child->Train<UseWeights>(data, currentChildBegin, childCount, labels,
+            numClasses, weights, childLeafSize, parallel);
       }
       else
       {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            minimumLeafSize);
+        child->Train<UseWeights>(data, currentChildBegin, childCount, labels,
+            numClasses, weights, childLeafSize, parallel);
       }
-      children.push_back(child);
     }
+
+    #ifdef MLPACK_DECISION_TREE_TASKS
+    if (parallelNode)
+    {
+      #pragma omp taskwait
+    }
+    #endif
   }
   else
   {
@@ -800,6 +1016,28 @@ void DecisionTree<FitnessFunction,
   }
 }
 
+//! Get the candidate dimensions of a node.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::SelectDimensions(
+    const size_t dimensionality,
+    std::vector<size_t>& candidates)
+{
+  DimensionSelectionType dimensions(dimensionality);
+  for (size_t i = dimensions.Begin(); i != dimensions.End();
+       i = dimensions.Next())
+    candidates.push_back(i);
+}
+
 //! Return the class.
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
@@ -175,6 +175,36 @@ class GiniGain
     return -impurity;
   }
 
+  /**
+   * Evaluate the Gini impurity from the given class counts (or class weight
+   * sums), instead of from the labels.  This takes O(numClasses) time, so a
+   * split search that maintains the counts of each child as points are moved
+   * from one child to the other can evaluate every candidate split cheaply.
+   *
+   * @param counts Array of numClasses counts (or weight sums), one per class.
+   * @param numClasses Number of classes in the dataset.
+   * @param totalCount Sum of the counts.
+   */
+  template<typename CountType>
+  static double EvaluatePtr(const CountType* counts,
+                            const size_t numClasses,
+                            const double totalCount)
+  {
+    // Corner case: if there are no elements (or no weight), the impurity is
+    // zero.
+    if (totalCount <= 0.0)
+      return 0.0;
+
+    double impurity = 0.0;
+    for (size_t i = 0; i < numClasses; ++i)
+    {
+      const double f = ((double) counts[i] / totalCount);
+      impurity += f * (1.0 - f);
+    }
+
+    return -impurity;
+  }
+
   /**
    * Return the range of the Gini impurity for the given number of classes.
    * (That is, the difference between the maximum possible value and the minimum
@@ -0,0 +1,133 @@
+/**
+ * @file histogram_numeric_split_impl.hpp
+ *
+ * Implementation of the HistogramNumericSplit class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "histogram_numeric_split.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction>
+template<bool UseWeights, typename VecType, typename WeightVecType,
+         typename ElemType>
+double HistogramNumericSplit<FitnessFunction>::SplitIfBetter(
+    const double bestGain,
+    const VecType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const WeightVecType& weights,
+    const size_t minimumLeafSize,
+    arma::Col<ElemType>& classProbabilities,
+    AuxiliarySplitInfo<ElemType>& /* aux */)
+{
+  // First sanity check: if we don't have enough points, we can't split.
+  if (data.n_elem < (minimumLeafSize * 2))
+    return bestGain;
+
+  // Build the histogram: the count (or weight sum) of each class in each bin,
+  // and the number of points in each bin, which we need for the minimum leaf
+  // size.
+  arma::mat histogram(numClasses, MaxBins, arma::fill::zeros);
+  arma::Col<size_t> binCounts(MaxBins, arma::fill::zeros);
+  size_t maxBin = 0;
+  for (size_t i = 0; i < data.n_elem; ++i)
+  {
+    const size_t bin = (size_t) data[i];
+    if (bin >= MaxBins)
+    {
+      std::ostringstream oss;
+      oss << "HistogramNumericSplit::SplitIfBetter(): value "
+          << (double) data[i]
+          << " is not a bin code!  Use QuantileBinning to convert the data."
+          << std::endl;
+      throw std::invalid_argument(oss.str());
+    }
+
+    histogram(labels[i], bin) += UseWeights ? (double) weights[i] : 1.0;
+    ++binCounts[bin];
+    maxBin = std::max(maxBin, bin);
+  }
+
+  // The right child starts with all the points; we then move one bin at a time
+  // to the left child.
+  arma::vec leftCounts(numClasses, arma::fill::zeros);
+  arma::vec rightCounts = arma::sum(histogram, 1);
+  const double totalWeight = arma::accu(rightCounts);
+  double leftWeight = 0.0;
+  size_t leftPoints = 0;
+
+  // Force a minimum leaf size of 1 (empty children don't make sense).
+  const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
+  double bestFoundGain = bestGain;
+  for (size_t bin = 0; bin < maxBin; ++bin)
+  {
+    // An empty bin gives the same split as the previous bin.
+    if (binCounts[bin] == 0)
+      continue;
+
+    leftCounts += histogram.col(bin);
+    rightCounts -= histogram.col(bin);
+    leftWeight += arma::accu(histogram.col(bin));
+    leftPoints += binCounts[bin];
+
+    if (leftPoints < minimum)
+      continue;
+    if (data.n_elem - leftPoints < minimum)
+      break;
+
+    const double rightWeight = totalWeight - leftWeight;
+    const double leftGain = FitnessFunction::EvaluatePtr(leftCounts.memptr(),
+        numClasses, leftWeight);
+    const double rightGain = FitnessFunction::EvaluatePtr(
+        rightCounts.memptr(), numClasses, rightWeight);
+    const double gain = (leftWeight / totalWeight) * leftGain +
+        (rightWeight / totalWeight) * rightGain;
+
+    // Corner case: is this the best possible split?
+    if (gain >= 0.0)
+    {
+      // We can take a shortcut: no split will be better than this, so just take
+      // this one.
+      classProbabilities.set_size(1);
+      classProbabilities[0] = bin;
+      return gain;
+    }
+    else if (gain > bestFoundGain)
+    {
+      // We still have a better split.
+      bestFoundGain = gain;
+      classProbabilities.set_size(1);
+      classProbabilities[0] = bin;
+    }
+  }
+
+  return bestFoundGain;
+}
+
+template<typename FitnessFunction>
+template<typename PointType, typename ElemType>
+size_t HistogramNumericSplit<FitnessFunction>::CalculateDirection(
+    const PointType& point,
+    const arma::Col<ElemType>& classProbabilities,
+    const AuxiliarySplitInfo<ElemType>& /* aux */)
+{
+  if ((double) point <= (double) classProbabilities[0])
+    return 0; // Go left.
+  else
+    return 1; // Go right.
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
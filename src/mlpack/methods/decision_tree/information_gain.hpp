@@ -172,6 +172,37 @@ class InformationGain
     return gain;
   }
 
+  /**
+   * Calculate the information gain from the given class counts (or class
+   * weight sums), instead of from the labels.  This takes O(numClasses) time,
+   * so a split search that maintains the counts of each child as points are
+   * moved from one child to the other can evaluate every candidate split
+   * cheaply.
+   *
+   * @param counts Array of numClasses counts (or weight sums), one per class.
+   * @param numClasses Number of classes in the dataset.
+   * @param totalCount Sum of the counts.
+   */
+  template<typename CountType>
+  static double EvaluatePtr(const CountType* counts,
+                            const size_t numClasses,
+                            const double totalCount)
+  {
+    // Edge case: if there are no elements (or no weight), the gain is zero.
+    if (totalCount <= 0.0)
+      return 0.0;
+
+    double gain = 0.0;
+    for (size_t i = 0; i < numClasses; ++i)
+    {
+      const double f = ((double) counts[i] / totalCount);
+      if (f > 0.0)
+        gain += f * std::log2(f);
+    }
+
+    return gain;
+  }
+
   /**
    * Return the range of the information gain for the given number of classes.
    * (That is, the difference between the maximum possible value and the minimum
@@ -0,0 +1,126 @@
+/**
+ * @file quantile_binning.hpp
+ *
+ * Definition of the QuantileBinning class, which maps each numeric feature of
+ * a dataset to a small number of quantile bins.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_QUANTILE_BINNING_HPP
+#define MLPACK_METHODS_DECISION_TREE_QUANTILE_BINNING_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The QuantileBinning class maps each dimension of a dataset to at most 256
+ * bins, so that the dataset can be stored as 8-bit bin codes and decision trees
+ * can be trained on it with the HistogramNumericSplit.  The bins of each
+ * dimension are chosen from the quantiles of the training data, so that they
+ * hold about the same number of points.  If a dimension has no more distinct
+ * values than bins, each distinct value gets its own bin, and splitting on the
+ * codes gives the same splits as splitting on the values.
+ *
+ * The bins of each dimension are defined by increasing edges: a value goes to
+ * bin b if it is greater than edge b - 1 and not greater than edge b.  The bins
+ * are computed once, in Train(), and Transform() then converts any dataset
+ * (training or test) to codes.  Points to be classified by a tree trained on
+ * codes must be transformed in the same way.
+ *
+ * @code
+ * QuantileBinning binning(data);
+ * arma::Mat<unsigned char> codes;
+ * binning.Transform(data, codes);
+ *
+ * DecisionTree<GiniGain, HistogramNumericSplit> tree(codes, labels, 2);
+ * @endcode
+ */
+class QuantileBinning
+{
+ public:
+  /**
+   * Create the QuantileBinning object without training it.
+   *
+   * @param maxBins Maximum number of bins for each dimension (at most 256).
+   */
+  QuantileBinning(const size_t maxBins = 256);
+
+  /**
+   * Compute the bins of each dimension of the given dataset.
+   *
+   * @param data Dataset to compute the bins from, one point per column.
+   * @param maxBins Maximum number of bins for each dimension (at most 256).
+   */
+  template<typename MatType>
+  QuantileBinning(const MatType& data, const size_t maxBins = 256);
+
+  /**
+   * Compute the bins of each dimension of the given dataset, replacing any
+   * bins computed before.
+   *
+   * @param data Dataset to compute the bins from, one point per column.
+   */
+  template<typename MatType>
+  void Train(const MatType& data);
+
+  /**
+   * Convert the given dataset to bin codes.  The dataset must have the same
+   * dimensionality as the training data.
+   *
+   * @param data Dataset to convert, one point per column.
+   * @param codes Matrix to store the bin code of each value in.
+   */
+  template<typename MatType>
+  void Transform(const MatType& data, arma::Mat<unsigned char>& codes) const;
+
+  /**
+   * Get the bin code of the given value in the given dimension.
+   *
+   * @param dimension Dimension of the value.
+   * @param value Value to get the bin of.
+   */
+  unsigned char Bin(const size_t dimension, const double value) const
+  {
+    const arma::vec& dimEdges = edges[dimension];
+    return (unsigned char) (std::lower_bound(dimEdges.begin(), dimEdges.end(),
+        value) - dimEdges.begin());
+  }
+
+  //! Get the maximum number of bins of each dimension.
+  size_t MaxBins() const { return maxBins; }
+
+  //! Get the number of dimensions.
+  size_t Dimensionality() const { return edges.size(); }
+
+  //! Get the number of bins of the given dimension.
+  size_t NumBins(const size_t dimension) const
+  { return edges[dimension].n_elem + 1; }
+
+  //! Get the edges of the bins of the given dimension.
+  const arma::vec& Edges(const size_t dimension) const
+  { return edges[dimension]; }
+
+  //! Serialize the bins.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The maximum number of bins of each dimension.
+  size_t maxBins;
+
+  //! The edges of the bins of each dimension.
+  std::vector<arma::vec> edges;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "quantile_binning_impl.hpp"
+
+#endif
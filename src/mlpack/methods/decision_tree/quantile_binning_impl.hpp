@@ -0,0 +1,113 @@
+/**
+ * @file quantile_binning_impl.hpp
+ *
+ * Implementation of the QuantileBinning class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_QUANTILE_BINNING_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_QUANTILE_BINNING_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantile_binning.hpp"
+
+namespace mlpack {
+namespace tree {
+
+inline QuantileBinning::QuantileBinning(const size_t maxBins) :
+    maxBins(maxBins)
+{
+  if (maxBins < 2 || maxBins > 256)
+  {
+    std::ostringstream oss;
+    oss << "QuantileBinning::QuantileBinning(): the maximum number of bins ("
+        << maxBins << ") must be between 2 and 256!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename MatType>
+QuantileBinning::QuantileBinning(const MatType& data, const size_t maxBins) :
+    QuantileBinning(maxBins)
+{
+  Train(data);
+}
+
+template<typename MatType>
+void QuantileBinning::Train(const MatType& data)
+{
+  edges.clear();
+  edges.resize(data.n_rows);
+
+  arma::vec sorted(data.n_cols);
+  for (size_t d = 0; d < data.n_rows; ++d)
+  {
+    if (data.n_cols == 0)
+      continue;
+
+    for (size_t i = 0; i < data.n_cols; ++i)
+      sorted[i] = (double) data(d, i);
+    sorted = arma::sort(sorted);
+
+    arma::vec uniqueValues = arma::unique(sorted);
+    if (uniqueValues.n_elem <= maxBins)
+    {
+      // Each value gets its own bin; put the edges halfway between the values.
+      edges[d] = (uniqueValues.head(uniqueValues.n_elem - 1) +
+          uniqueValues.tail(uniqueValues.n_elem - 1)) / 2.0;
+      continue;
+    }
+
+    // Otherwise take the edges from the quantiles, halfway between the last
+    // value of a bin and the first value of the next.  Repeated values can give
+    // the same quantile more than once, so we only keep distinct edges; the
+    // largest value doesn't need an edge, since it goes to the last bin anyway.
+    std::vector<double> dimEdges;
+    for (size_t b = 1; b < maxBins; ++b)
+    {
+      const size_t cut = (b * sorted.n_elem) / maxBins;
+      const double edge = (sorted[cut - 1] + sorted[cut]) / 2.0;
+      if (edge < sorted[sorted.n_elem - 1] &&
+          (dimEdges.empty() || edge > dimEdges.back()))
+        dimEdges.push_back(edge);
+    }
+    edges[d] = arma::vec(dimEdges);
+  }
+}
+
+template<typename MatType>
+void QuantileBinning::Transform(const MatType& data,
+                                arma::Mat<unsigned char>& codes) const
+{
+  if (data.n_rows != edges.size())
+  {
+    std::ostringstream oss;
+    oss << "QuantileBinning::Transform(): dimensionality of data ("
+        << data.n_rows << ") does not match the dimensionality of the bins ("
+        << edges.size() << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  codes.set_size(data.n_rows, data.n_cols);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+  {
+    for (size_t d = 0; d < data.n_rows; ++d)
+      codes(d, i) = Bin(d, (double) data(d, i));
+  }
+}
+
+template<typename Archive>
+void QuantileBinning::serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(maxBins);
+  ar & BOOST_SERIALIZATION_NVP(edges);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,387 @@
+/**
+ * @file gradient_boosting.hpp
+ *
+ * Definition of the GradientBoosting class, which trains an ensemble of
+ * regression trees with gradient boosting.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_HPP
+#define MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_HPP
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/decision_tree/all_dimension_select.hpp>
+#include <mlpack/methods/decision_tree/quantile_binning.hpp>
+
+#include "squared_error_loss.hpp"
+#include "logistic_loss.hpp"
+#include "softmax_loss.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * An implementation of gradient boosted decision trees.  Each boosting round
+ * fits one regression tree per output of the loss to the first and second
+ * derivatives of the loss, and adds the predictions of the trees, scaled by
+ * the learning rate (shrinkage), to the scores of the model.  The trees are
+ * grown depth-first; the leaf values and the gain of the splits are the
+ * second-order ones of
+ *
+ * @code
+ * @inproceedings{chen2016xgboost,
+ *   title={XGBoost: A Scalable Tree Boosting System},
+ *   author={Chen, Tianqi and Guestrin, Carlos},
+ *   booktitle={Proceedings of the 22nd ACM SIGKDD International Conference on
+ *       Knowledge Discovery and Data Mining},
+ *   pages={785--794},
+ *   year={2016}
+ * }
+ * @endcode
+ *
+ * Before training, the numeric dimensions are binned with QuantileBinning, and
+ * splits are searched from histograms of the derivatives in each bin.  The
+ * histograms of the candidate dimensions are built in parallel with OpenMP,
+ * and the histograms of the larger child of a node are obtained by
+ * subtracting the histograms of the smaller child from the histograms of the
+ * node.  Categorical dimensions (given by a data::DatasetInfo, with at most 256
+ * categories) are split into two groups of categories, ordered by the ratio
+ * of their derivative sums.  The trees keep the thresholds of the original
+ * values, so prediction doesn't need the bins.
+ *
+ * Each round can be trained on a random fraction of the points, and each tree
+ * on a random fraction of the dimensions given by the DimensionSelectionType.
+ *
+ * @code
+ * GradientBoosting<SoftmaxLoss> gbdt(100, 0.1, 6);
+ * gbdt.Train(data, datasetInfo, labels, numClasses);
+ *
+ * arma::Row<size_t> predictions;
+ * gbdt.Classify(testData, predictions);
+ * @endcode
+ *
+ * @tparam LossType Loss to minimize (SquaredErrorLoss, LogisticLoss or
+ *     SoftmaxLoss).
+ * @tparam DimensionSelectionType Selects the dimensions each tree may split
+ *     on, as with DecisionTree.
+ */
+template<typename LossType = SquaredErrorLoss,
+         typename DimensionSelectionType = AllDimensionSelect>
+class GradientBoosting
+{
+ public:
+  /**
+   * Create the GradientBoosting object with the given parameters, without
+   * training it.
+   *
+   * @param numRounds Number of boosting rounds.
+   * @param learningRate Scale of the predictions of each tree (shrinkage).
+   * @param maximumDepth Maximum depth of the trees.
+   * @param minimumLeafSize Minimum number of points in each leaf.
+   * @param lambda L2 regularization of the leaf values.
+   * @param rowFraction Fraction of the points each round is trained on.
+   * @param columnFraction Fraction of the selected dimensions each tree may
+   *     split on.
+   * @param maxBins Maximum number of bins of each numeric dimension.
+   */
+  GradientBoosting(const size_t numRounds = 100,
+                   const double learningRate = 0.1,
+                   const size_t maximumDepth = 6,
+                   const size_t minimumLeafSize = 20,
+                   const double lambda = 1.0,
+                   const double rowFraction = 1.0,
+                   const double columnFraction = 1.0,
+                   const size_t maxBins = 256);
+
+  /**
+   * Train the model on the given numeric data and responses (for the
+   * SquaredErrorLoss) or 0/1 labels (for the LogisticLoss).  This overwrites
+   * any previous model.
+   *
+   * @param data Dataset to train on, one point per column.
+   * @param responses Response of each point.
+   */
+  template<typename MatType>
+  void Train(const MatType& data, const arma::rowvec& responses);
+
+  /**
+   * Train the model on the given data, whose dimensions may be numeric or
+   * categorical, and responses (for the SquaredErrorLoss) or 0/1 labels (for
+   * the LogisticLoss).  This overwrites any previous model.
+   *
+   * @param data Dataset to train on, one point per column.
+   * @param datasetInfo Type information for each dimension.
+   * @param responses Response of each point.
+   */
+  template<typename MatType>
+  void Train(const MatType& data,
+             const data::DatasetInfo& datasetInfo,
+             const arma::rowvec& responses);
+
+  /**
+   * Train a classifier on the given numeric data and labels.  This overwrites
+   * any previous model.
+   *
+   * @param data Dataset to train on, one point per column.
+   * @param labels Label of each point.
+   * @param numClasses Number of classes.
+   */
+  template<typename MatType>
+  void Train(const MatType& data,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses);
+
+  /**
+   * Train a classifier on the given data, whose dimensions may be numeric or
+   * categorical, and labels.  This overwrites any previous model.
+   *
+   * @param data Dataset to train on, one point per column.
+   * @param datasetInfo Type information for each dimension.
+   * @param labels Label of each point.
+   * @param numClasses Number of classes.
+   */
+  template<typename MatType>
+  void Train(const MatType& data,
+             const data::DatasetInfo& datasetInfo,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses);
+
+  /**
+   * Compute the scores of the given points: one row per output of the loss.
+   * For the SquaredErrorLoss, these are the predicted responses.
+   *
+   * @param data Points to predict, one per column.
+   * @param scores Matrix to store the scores in.
+   */
+  template<typename MatType>
+  void Predict(const MatType& data, arma::mat& scores) const;
+
+  /**
+   * Predict the responses of the given points, with a model of one output.
+   *
+   * @param data Points to predict, one per column.
+   * @param predictions Vector to store the predictions in.
+   */
+  template<typename MatType>
+  void Predict(const MatType& data, arma::rowvec& predictions) const;
+
+  /**
+   * Classify the given points, with a classification loss.
+   *
+   * @param data Points to classify, one per column.
+   * @param predictions Vector to store the predicted labels in.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data, arma::Row<size_t>& predictions) const;
+
+  /**
+   * Classify the given points and compute the probability of each class, with
+   * a classification loss.
+   *
+   * @param data Points to classify, one per column.
+   * @param predictions Vector to store the predicted labels in.
+   * @param probabilities Matrix to store the class probabilities in.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of boosting rounds.
+  size_t NumRounds() const { return numRounds; }
+  //! Modify the number of boosting rounds.
+  size_t& NumRounds() { return numRounds; }
+
+  //! Get the learning rate.
+  double LearningRate() const { return learningRate; }
+  //! Modify the learning rate.
+  double& LearningRate() { return learningRate; }
+
+  //! Get the maximum depth of the trees.
+  size_t MaximumDepth() const { return maximumDepth; }
+  //! Modify the maximum depth of the trees.
+  size_t& MaximumDepth() { return maximumDepth; }
+
+  //! Get the minimum number of points in each leaf.
+  size_t MinimumLeafSize() const { return minimumLeafSize; }
+  //! Modify the minimum number of points in each leaf.
+  size_t& MinimumLeafSize() { return minimumLeafSize; }
+
+  //! Get the L2 regularization of the leaf values.
+  double Lambda() const { return lambda; }
+  //! Modify the L2 regularization of the leaf values.
+  double& Lambda() { return lambda; }
+
+  //! Get the fraction of the points each round is trained on.
+  double RowFraction() const { return rowFraction; }
+  //! Modify the fraction of the points each round is trained on.
+  double& RowFraction() { return rowFraction; }
+
+  //! Get the fraction of the dimensions each tree may split on.
+  double ColumnFraction() const { return columnFraction; }
+  //! Modify the fraction of the dimensions each tree may split on.
+  double& ColumnFraction() { return columnFraction; }
+
+  //! Get the maximum number of bins of each numeric dimension.
+  size_t MaxBins() const { return maxBins; }
+  //! Modify the maximum number of bins of each numeric dimension.
+  size_t& MaxBins() { return maxBins; }
+
+  //! Get the number of outputs of the trained model.
+  size_t NumOutputs() const { return initialScores.n_elem; }
+
+  //! Get the number of trees of the trained model.
+  size_t NumTrees() const { return roots.size(); }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! A node of a tree.  The children of a node are stored one after the other,
+  //! so a node only keeps the index of its left child.
+  struct Node
+  {
+    //! The index of the left child in the nodes of the model, or 0 for a leaf.
+    size_t child;
+    //! The dimension the node splits on.
+    size_t dimension;
+    //! For a numeric split, points whose value is at most the threshold go to
+    //! the left child.
+    double threshold;
+    //! For a categorical split, the number of categories of the dimension, or
+    //! 0 for a numeric split.
+    size_t numCategories;
+    //! For a categorical split, the offset of the categories that go to the
+    //! left child in categoryMasks.
+    size_t maskOffset;
+    //! The value of a leaf.
+    double value;
+
+    //! Serialize the node.
+    template<typename Archive>
+    void serialize(Archive& ar, const unsigned int /* version */)
+    {
+      ar & BOOST_SERIALIZATION_NVP(child);
+      ar & BOOST_SERIALIZATION_NVP(dimension);
+      ar & BOOST_SERIALIZATION_NVP(threshold);
+      ar & BOOST_SERIALIZATION_NVP(numCategories);
+      ar & BOOST_SERIALIZATION_NVP(maskOffset);
+      ar & BOOST_SERIALIZATION_NVP(value);
+    }
+  };
+
+  //! The data needed to grow one tree.
+  struct TreeData
+  {
+    //! The bin code (or category) of each value of the training set.
+    const arma::Mat<unsigned char>* codes;
+    //! The bins of the numeric dimensions.
+    const QuantileBinning* binning;
+    //! The number of categories of each dimension (0 if it is numeric).
+    const arma::Col<size_t>* numCategories;
+    //! The first derivatives of the loss of each point.
+    arma::rowvec gradients;
+    //! The second derivatives of the loss of each point.
+    arma::rowvec hessians;
+    //! The dimensions the tree may split on.
+    arma::uvec dimensions;
+  };
+
+  /*
+   * Train the model on the given responses, which are labels if numClasses
+   * isn't 0.
+   */
+  template<typename MatType>
+  void TrainInternal(const MatType& data,
+                     const data::DatasetInfo& datasetInfo,
+                     const arma::rowvec& responses,
+                     const size_t numClasses);
+
+  /*
+   * Select the dimensions the next tree may split on.
+   */
+  arma::uvec SelectDimensions(const size_t dimensionality) const;
+
+  /*
+   * Build the histograms of the derivatives of the given points in each bin
+   * of each dimension of the tree, in parallel over the dimensions.
+   */
+  static void BuildHistograms(const TreeData& tree,
+                              const arma::uvec& points,
+                              const size_t begin,
+                              const size_t count,
+                              arma::mat& gradientSums,
+                              arma::mat& hessianSums,
+                              arma::mat& counts);
+
+  /*
+   * Grow the node of the given index from the given points, whose histograms
+   * are given, and its subtree.  The histograms are overwritten.
+   */
+  void BuildNode(const TreeData& tree,
+                 const size_t node,
+                 arma::uvec& points,
+                 const size_t begin,
+                 const size_t count,
+                 const size_t depth,
+                 arma::mat& gradientSums,
+                 arma::mat& hessianSums,
+                 arma::mat& counts);
+
+  /*
+   * Get the categories present in the given column of the histograms, sorted
+   * by the ratio of their gradient and hessian sums.
+   */
+  arma::uvec CategoryOrder(const arma::mat& gradientSums,
+                           const arma::mat& hessianSums,
+                           const arma::mat& counts,
+                           const size_t column) const;
+
+  /*
+   * Get the value of the leaf of the tree with the given root that the given
+   * point falls into.
+   */
+  template<typename VecType>
+  double TreeValue(const size_t root, const VecType& point) const;
+
+  //! The number of boosting rounds.
+  size_t numRounds;
+  //! The learning rate.
+  double learningRate;
+  //! The maximum depth of the trees.
+  size_t maximumDepth;
+  //! The minimum number of points in each leaf.
+  size_t minimumLeafSize;
+  //! The L2 regularization of the leaf values.
+  double lambda;
+  //! The fraction of the points each round is trained on.
+  double rowFraction;
+  //! The fraction of the dimensions each tree may split on.
+  double columnFraction;
+  //! The maximum number of bins of each numeric dimension.
+  size_t maxBins;
+
+  //! The number of dimensions of the training data.
+  size_t dimensionality;
+  //! The initial score of each output.
+  arma::vec initialScores;
+  //! The nodes of all the trees.
+  std::vector<Node> nodes;
+  //! The index of the root of each tree; tree t adds to output t % NumOutputs().
+  std::vector<size_t> roots;
+  //! For each categorical split, one flag per category, set if the category
+  //! goes to the left child.
+  std::vector<unsigned char> categoryMasks;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "gradient_boosting_impl.hpp"
+
+#endif
@@ -0,0 +1,583 @@
+/**
+ * @file gradient_boosting_impl.hpp
+ *
+ * Implementation of the GradientBoosting class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_IMPL_HPP
+#define MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "gradient_boosting.hpp"
+
+#include <algorithm>
+
+namespace mlpack {
+namespace tree {
+
+template<typename LossType, typename DimensionSelectionType>
+GradientBoosting<LossType, DimensionSelectionType>::GradientBoosting(
+    const size_t numRounds,
+    const double learningRate,
+    const size_t maximumDepth,
+    const size_t minimumLeafSize,
+    const double lambda,
+    const double rowFraction,
+    const double columnFraction,
+    const size_t maxBins) :
+    numRounds(numRounds),
+    learningRate(learningRate),
+    maximumDepth(maximumDepth),
+    minimumLeafSize(minimumLeafSize),
+    lambda(lambda),
+    rowFraction(rowFraction),
+    columnFraction(columnFraction),
+    maxBins(maxBins),
+    dimensionality(0)
+{
+  // Nothing to do.
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename MatType>
+void GradientBoosting<LossType, DimensionSelectionType>::Train(
+    const MatType& data,
+    const arma::rowvec& responses)
+{
+  data::DatasetInfo datasetInfo(data.n_rows);
+  TrainInternal(data, datasetInfo, responses, 0);
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename MatType>
+void GradientBoosting<LossType, DimensionSelectionType>::Train(
+    const MatType& data,
+    const data::DatasetInfo& datasetInfo,
+    const arma::rowvec& responses)
+{
+  TrainInternal(data, datasetInfo, responses, 0);
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename MatType>
+void GradientBoosting<LossType, DimensionSelectionType>::Train(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses)
+{
+  data::DatasetInfo datasetInfo(data.n_rows);
+  Train(data, datasetInfo, labels, numClasses);
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename MatType>
+void GradientBoosting<LossType, DimensionSelectionType>::Train(
+    const MatType& data,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses)
+{
+  if (labels.n_elem > 0 && arma::max(labels) >= numClasses)
+  {
+    std::ostringstream oss;
+    oss << "GradientBoosting::Train(): label " << arma::max(labels) << " is "
+        << "not smaller than the number of classes (" << numClasses << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  TrainInternal(data, datasetInfo, arma::conv_to<arma::rowvec>::from(labels),
+      numClasses);
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename MatType>
+void GradientBoosting<LossType, DimensionSelectionType>::Predict(
+    const MatType& data,
+    arma::mat& scores) const
+{
+  if (initialScores.n_elem == 0)
+  {
+    throw std::invalid_argument("GradientBoosting::Predict(): no model "
+        "trained!");
+  }
+
+  if (data.n_rows != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "GradientBoosting::Predict(): dimensionality of data ("
+        << data.n_rows << ") does not match the dimensionality of the model ("
+        << dimensionality << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t numOutputs = initialScores.n_elem;
+  scores = arma::repmat(initialScores, 1, data.n_cols);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+  {
+    for (size_t t = 0; t < roots.size(); ++t)
+      scores(t % numOutputs, i) += TreeValue(roots[t], data.col(i));
+  }
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename MatType>
+void GradientBoosting<LossType, DimensionSelectionType>::Predict(
+    const MatType& data,
+    arma::rowvec& predictions) const
+{
+  if (NumOutputs() != 1)
+  {
+    std::ostringstream oss;
+    oss << "GradientBoosting::Predict(): the model has " << NumOutputs()
+        << " outputs; use the overload that returns a matrix!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  arma::mat scores;
+  Predict(data, scores);
+  predictions = scores.row(0);
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename MatType>
+void GradientBoosting<LossType, DimensionSelectionType>::Classify(
+    const MatType& data,
+    arma::Row<size_t>& predictions) const
+{
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename MatType>
+void GradientBoosting<LossType, DimensionSelectionType>::Classify(
+    const MatType& data,
+    arma::Row<size_t>& predictions,
+    arma::mat& probabilities) const
+{
+  arma::mat scores;
+  Predict(data, scores);
+  LossType::Probabilities(scores, probabilities);
+
+  predictions.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    arma::uword maxIndex = 0;
+    probabilities.col(i).max(maxIndex);
+    predictions[i] = (size_t) maxIndex;
+  }
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename Archive>
+void GradientBoosting<LossType, DimensionSelectionType>::serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(numRounds);
+  ar & BOOST_SERIALIZATION_NVP(learningRate);
+  ar & BOOST_SERIALIZATION_NVP(maximumDepth);
+  ar & BOOST_SERIALIZATION_NVP(minimumLeafSize);
+  ar & BOOST_SERIALIZATION_NVP(lambda);
+  ar & BOOST_SERIALIZATION_NVP(rowFraction);
+  ar & BOOST_SERIALIZATION_NVP(columnFraction);
+  ar & BOOST_SERIALIZATION_NVP(maxBins);
+  ar & BOOST_SERIALIZATION_NVP(dimensionality);
+  ar & BOOST_SERIALIZATION_NVP(initialScores);
+  ar & BOOST_SERIALIZATION_NVP(nodes);
+  ar & BOOST_SERIALIZATION_NVP(roots);
+  ar & BOOST_SERIALIZATION_NVP(categoryMasks);
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename MatType>
+void GradientBoosting<LossType, DimensionSelectionType>::TrainInternal(
+    const MatType& data,
+    const data::DatasetInfo& datasetInfo,
+    const arma::rowvec& responses,
+    const size_t numClasses)
+{
+  // Sanity checks on the data and the parameters.
+  if (data.n_cols != responses.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "GradientBoosting::Train(): number of points (" << data.n_cols
+        << ") does not match number of responses (" << responses.n_elem
+        << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (data.n_cols == 0)
+    throw std::invalid_argument("GradientBoosting::Train(): no points given!");
+
+  if (datasetInfo.Dimensionality() != data.n_rows)
+  {
+    std::ostringstream oss;
+    oss << "GradientBoosting::Train(): dimensionality of data (" << data.n_rows
+        << ") does not match the dimensionality of the dataset info ("
+        << datasetInfo.Dimensionality() << ")!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (rowFraction <= 0.0 || rowFraction > 1.0 || columnFraction <= 0.0 ||
+      columnFraction > 1.0)
+  {
+    throw std::invalid_argument("GradientBoosting::Train(): the row and "
+        "column fractions must be in (0, 1]!");
+  }
+
+  const size_t numOutputs = LossType::NumOutputs(numClasses);
+  if (numOutputs == 0)
+  {
+    throw std::invalid_argument("GradientBoosting::Train(): the loss has no "
+        "outputs; was the number of classes given?");
+  }
+
+  // Convert the data to bin codes.  The codes of categorical dimensions are
+  // the categories themselves.
+  arma::Col<size_t> numCategories(data.n_rows, arma::fill::zeros);
+  for (size_t d = 0; d < data.n_rows; ++d)
+  {
+    if (datasetInfo.Type(d) != data::Datatype::categorical)
+      continue;
+
+    numCategories[d] = datasetInfo.NumMappings(d);
+    if (numCategories[d] > 256)
+    {
+      std::ostringstream oss;
+      oss << "GradientBoosting::Train(): dimension " << d << " has "
+          << numCategories[d] << " categories, but at most 256 are supported!"
+          << std::endl;
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  QuantileBinning binning(data, maxBins);
+  arma::Mat<unsigned char> codes;
+  binning.Transform(data, codes);
+  for (size_t d = 0; d < data.n_rows; ++d)
+  {
+    if (numCategories[d] > 0)
+    {
+      for (size_t i = 0; i < data.n_cols; ++i)
+        codes(d, i) = (unsigned char) data(d, i);
+    }
+  }
+
+  // Start from the constant model.
+  dimensionality = data.n_rows;
+  LossType::InitialScores(responses, numOutputs, initialScores);
+  arma::mat scores = arma::repmat(initialScores, 1, data.n_cols);
+  nodes.clear();
+  roots.clear();
+  categoryMasks.clear();
+
+  TreeData tree;
+  tree.codes = &codes;
+  tree.binning = &binning;
+  tree.numCategories = &numCategories;
+
+  const arma::uvec allPoints = arma::linspace<arma::uvec>(0, data.n_cols - 1,
+      data.n_cols);
+  const size_t sampleSize = std::max((size_t) 1,
+      (size_t) (rowFraction * data.n_cols));
+  arma::mat gradients, hessians;
+  for (size_t r = 0; r < numRounds; ++r)
+  {
+    LossType::Gradients(responses, scores, gradients, hessians);
+
+    // Sample the points of this round.  Keeping them sorted makes the accesses
+    // to the codes more regular.
+    arma::uvec sample = allPoints;
+    if (sampleSize < data.n_cols)
+    {
+      const arma::uvec shuffled = arma::shuffle(allPoints);
+      sample = arma::sort(shuffled.head(sampleSize));
+    }
+
+    for (size_t k = 0; k < numOutputs; ++k)
+    {
+      tree.gradients = gradients.row(k);
+      tree.hessians = hessians.row(k);
+      tree.dimensions = SelectDimensions(data.n_rows);
+
+      // Grow the tree from the histograms of all the sampled points.
+      arma::uvec points = sample;
+      const size_t root = nodes.size();
+      nodes.resize(root + 1);
+      roots.push_back(root);
+
+      arma::mat gradientSums, hessianSums, counts;
+      BuildHistograms(tree, points, 0, points.n_elem, gradientSums,
+          hessianSums, counts);
+      BuildNode(tree, root, points, 0, points.n_elem, 0, gradientSums,
+          hessianSums, counts);
+
+      // Update the scores of all the points, sampled or not.
+      #pragma omp parallel for
+      for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
+        scores(k, i) += TreeValue(root, data.col(i));
+    }
+  }
+}
+
+template<typename LossType, typename DimensionSelectionType>
+arma::uvec GradientBoosting<LossType, DimensionSelectionType>::
+    SelectDimensions(const size_t dimensionality) const
+{
+  DimensionSelectionType selection(dimensionality);
+  std::vector<size_t> selected;
+  for (size_t i = selection.Begin(); i != selection.End();
+       i = selection.Next())
+    selected.push_back(i);
+
+  arma::uvec dimensions(selected.size());
+  for (size_t i = 0; i < selected.size(); ++i)
+    dimensions[i] = selected[i];
+
+  // Keep a random fraction of the selected dimensions.
+  const size_t numDimensions = std::max((size_t) 1,
+      (size_t) (columnFraction * dimensions.n_elem));
+  if (numDimensions < dimensions.n_elem)
+  {
+    const arma::uvec shuffled = arma::shuffle(dimensions);
+    dimensions = arma::sort(shuffled.head(numDimensions));
+  }
+
+  return dimensions;
+}
+
+template<typename LossType, typename DimensionSelectionType>
+void GradientBoosting<LossType, DimensionSelectionType>::BuildHistograms(
+    const TreeData& tree,
+    const arma::uvec& points,
+    const size_t begin,
+    const size_t count,
+    arma::mat& gradientSums,
+    arma::mat& hessianSums,
+    arma::mat& counts)
+{
+  const arma::Mat<unsigned char>& codes = *tree.codes;
+  gradientSums.zeros(256, tree.dimensions.n_elem);
+  hessianSums.zeros(256, tree.dimensions.n_elem);
+  counts.zeros(256, tree.dimensions.n_elem);
+
+  // Each thread fills the histograms of different dimensions.  Small nodes
+  // aren't worth the overhead of the threads.
+  #pragma omp parallel for if (count * tree.dimensions.n_elem > 16384)
+  for (omp_size_t j = 0; j < (omp_size_t) tree.dimensions.n_elem; ++j)
+  {
+    const size_t d = tree.dimensions[j];
+    double* gradientSum = gradientSums.colptr(j);
+    double* hessianSum = hessianSums.colptr(j);
+    double* pointCount = counts.colptr(j);
+    for (size_t i = begin; i < begin + count; ++i)
+    {
+      const size_t point = points[i];
+      const size_t bin = codes(d, point);
+      gradientSum[bin] += tree.gradients[point];
+      hessianSum[bin] += tree.hessians[point];
+      ++pointCount[bin];
+    }
+  }
+}
+
+template<typename LossType, typename DimensionSelectionType>
+void GradientBoosting<LossType, DimensionSelectionType>::BuildNode(
+    const TreeData& tree,
+    const size_t node,
+    arma::uvec& points,
+    const size_t begin,
+    const size_t count,
+    const size_t depth,
+    arma::mat& gradientSums,
+    arma::mat& hessianSums,
+    arma::mat& counts)
+{
+  // Every dimension sums to the totals of the node.
+  const double gradient = arma::accu(gradientSums.col(0));
+  const double hessian = arma::accu(hessianSums.col(0));
+
+  // Make the node a leaf, until we find a split.
+  nodes[node].child = 0;
+  nodes[node].dimension = 0;
+  nodes[node].threshold = 0.0;
+  nodes[node].numCategories = 0;
+  nodes[node].maskOffset = 0;
+  nodes[node].value = -learningRate * gradient / (hessian + lambda);
+
+  const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
+  if (depth >= maximumDepth || count < 2 * minimum)
+    return;
+
+  // Find the best split of each dimension, in parallel.  For a numeric
+  // dimension, the split is the last bin of the left child; for a categorical
+  // dimension, it is the number of categories (in the order of their gradient
+  // ratio) in the left child, minus one.
+  const arma::Col<size_t>& numCategories = *tree.numCategories;
+  const double nodeScore = gradient * gradient / (hessian + lambda);
+  arma::vec gains(tree.dimensions.n_elem);
+  arma::Col<size_t> splits(tree.dimensions.n_elem);
+  #pragma omp parallel for if (count * tree.dimensions.n_elem > 16384)
+  for (omp_size_t j = 0; j < (omp_size_t) tree.dimensions.n_elem; ++j)
+  {
+    const size_t d = tree.dimensions[j];
+
+    // The bins in the order in which they are moved to the left child.
+    const arma::uvec order = (numCategories[d] == 0) ?
+        arma::uvec(arma::find(counts.col(j) > 0)) :
+        CategoryOrder(gradientSums, hessianSums, counts, j);
+
+    gains[j] = 0.0;
+    splits[j] = 0;
+    double leftGradient = 0.0;
+    double leftHessian = 0.0;
+    size_t leftCount = 0;
+    for (size_t k = 0; k + 1 < order.n_elem; ++k)
+    {
+      leftGradient += gradientSums(order[k], j);
+      leftHessian += hessianSums(order[k], j);
+      leftCount += (size_t) counts(order[k], j);
+      if (leftCount < minimum)
+        continue;
+      if (count - leftCount < minimum)
+        break;
+
+      const double rightGradient = gradient - leftGradient;
+      const double rightHessian = hessian - leftHessian;
+      const double gain = leftGradient * leftGradient / (leftHessian + lambda) +
+          rightGradient * rightGradient / (rightHessian + lambda) - nodeScore;
+      if (gain > gains[j])
+      {
+        gains[j] = gain;
+        splits[j] = (numCategories[d] == 0) ? order[k] : k;
+      }
+    }
+  }
+
+  // Take the best dimension; only split if it reduces the loss.
+  arma::uword bestIndex = 0;
+  if (gains.n_elem == 0 || gains.max(bestIndex) <= 0.0)
+    return;
+
+  const size_t bestDimension = tree.dimensions[bestIndex];
+  const size_t split = splits[bestIndex];
+  nodes[node].dimension = bestDimension;
+  if (numCategories[bestDimension] == 0)
+  {
+    nodes[node].threshold = tree.binning->Edges(bestDimension)[split];
+  }
+  else
+  {
+    // Recompute the order of the categories and mark those of the left child.
+    const arma::uvec order = CategoryOrder(gradientSums, hessianSums, counts,
+        bestIndex);
+
+    nodes[node].numCategories = numCategories[bestDimension];
+    nodes[node].maskOffset = categoryMasks.size();
+    categoryMasks.resize(categoryMasks.size() +
+        numCategories[bestDimension], 0);
+    for (size_t k = 0; k <= split; ++k)
+      categoryMasks[nodes[node].maskOffset + order[k]] = 1;
+  }
+
+  // Partition the points of the node between the children.
+  const arma::Mat<unsigned char>& codes = *tree.codes;
+  const Node& splitNode = nodes[node];
+  const size_t leftCount = std::stable_partition(points.begin() + begin,
+      points.begin() + begin + count, [&](const arma::uword point)
+      {
+        const size_t code = codes(bestDimension, point);
+        return (splitNode.numCategories == 0) ? (code <= split) :
+            (categoryMasks[splitNode.maskOffset + code] != 0);
+      }) - (points.begin() + begin);
+  const size_t rightCount = count - leftCount;
+
+  const size_t child = nodes.size();
+  nodes[node].child = child;
+  nodes.resize(child + 2);
+
+  // Build the histograms of the smaller child, and get those of the larger
+  // child by subtracting them from the histograms of this node.
+  arma::mat smallGradientSums, smallHessianSums, smallCounts;
+  const bool leftIsSmaller = (leftCount <= rightCount);
+  BuildHistograms(tree, points, leftIsSmaller ? begin : begin + leftCount,
+      leftIsSmaller ? leftCount : rightCount, smallGradientSums,
+      smallHessianSums, smallCounts);
+  gradientSums -= smallGradientSums;
+  hessianSums -= smallHessianSums;
+  counts -= smallCounts;
+
+  if (leftIsSmaller)
+  {
+    BuildNode(tree, child, points, begin, leftCount, depth + 1,
+        smallGradientSums, smallHessianSums, smallCounts);
+    BuildNode(tree, child + 1, points, begin + leftCount, rightCount,
+        depth + 1, gradientSums, hessianSums, counts);
+  }
+  else
+  {
+    BuildNode(tree, child, points, begin, leftCount, depth + 1, gradientSums,
+        hessianSums, counts);
+    BuildNode(tree, child + 1, points, begin + leftCount, rightCount,
+        depth + 1, smallGradientSums, smallHessianSums, smallCounts);
+  }
+}
+
+template<typename LossType, typename DimensionSelectionType>
+arma::uvec GradientBoosting<LossType, DimensionSelectionType>::CategoryOrder(
+    const arma::mat& gradientSums,
+    const arma::mat& hessianSums,
+    const arma::mat& counts,
+    const size_t column) const
+{
+  const arma::vec gradientSum = gradientSums.col(column);
+  const arma::vec hessianSum = hessianSums.col(column);
+  const arma::uvec present = arma::find(counts.col(column) > 0);
+  const arma::vec ratios = gradientSum.elem(present) /
+      (hessianSum.elem(present) + lambda);
+
+  return present.elem(arma::stable_sort_index(ratios));
+}
+
+template<typename LossType, typename DimensionSelectionType>
+template<typename VecType>
+double GradientBoosting<LossType, DimensionSelectionType>::TreeValue(
+    const size_t root,
+    const VecType& point) const
+{
+  size_t node = root;
+  while (nodes[node].child != 0)
+  {
+    const Node& current = nodes[node];
+    const double value = (double) point[current.dimension];
+    bool left;
+    if (current.numCategories == 0)
+    {
+      left = (value <= current.threshold);
+    }
+    else
+    {
+      // Unknown categories go to the right child.
+      const size_t category = (size_t) value;
+      left = (category < current.numCategories) &&
+          (categoryMasks[current.maskOffset + category] != 0);
+    }
+
+    node = left ? current.child : current.child + 1;
+  }
+
+  return nodes[node].value;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
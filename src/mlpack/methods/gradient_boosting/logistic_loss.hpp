@@ -0,0 +1,100 @@
+/**
+ * @file logistic_loss.hpp
+ *
+ * The logistic loss for gradient boosted binary classification.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GRADIENT_BOOSTING_LOGISTIC_LOSS_HPP
+#define MLPACK_METHODS_GRADIENT_BOOSTING_LOGISTIC_LOSS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The logistic loss (negative log-likelihood of a logistic model) for binary
+ * classification with GradientBoosting.  The labels must be 0 or 1, and the
+ * model has one output, the log-odds of class 1.
+ */
+class LogisticLoss
+{
+ public:
+  /**
+   * Get the number of outputs (trees per boosting round) of the model.  Only
+   * two classes are supported.
+   *
+   * @param numClasses Number of classes, or 0 if the model is trained on 0/1
+   *     responses.
+   */
+  static size_t NumOutputs(const size_t numClasses)
+  {
+    if (numClasses != 0 && numClasses != 2)
+    {
+      std::ostringstream oss;
+      oss << "LogisticLoss::NumOutputs(): the logistic loss needs 2 classes, "
+          << "but " << numClasses << " were given!" << std::endl;
+      throw std::invalid_argument(oss.str());
+    }
+
+    return 1;
+  }
+
+  /**
+   * Compute the initial score, the log-odds of class 1 in the training set.
+   *
+   * @param responses Labels of the training points.
+   * @param numOutputs Number of outputs.
+   * @param initialScores Vector to store the initial scores in.
+   */
+  static void InitialScores(const arma::rowvec& responses,
+                            const size_t numOutputs,
+                            arma::vec& initialScores)
+  {
+    // Keep the probability away from 0 and 1, in case there is only one class.
+    const double p = (arma::accu(responses) + 1.0) / (responses.n_elem + 2.0);
+    initialScores.set_size(numOutputs);
+    initialScores.fill(std::log(p / (1.0 - p)));
+  }
+
+  /**
+   * Compute the first and second derivatives of the loss of each point with
+   * respect to its score.
+   *
+   * @param responses Labels of the training points.
+   * @param scores Current scores of the training points.
+   * @param gradients Matrix to store the first derivatives in.
+   * @param hessians Matrix to store the second derivatives in.
+   */
+  static void Gradients(const arma::rowvec& responses,
+                        const arma::mat& scores,
+                        arma::mat& gradients,
+                        arma::mat& hessians)
+  {
+    const arma::rowvec p = 1.0 / (1.0 + arma::exp(-scores.row(0)));
+    gradients = p - responses;
+    hessians = arma::clamp(p % (1.0 - p), 1e-16, 1.0);
+  }
+
+  /**
+   * Convert the scores into class probabilities.
+   *
+   * @param scores Scores of the points.
+   * @param probabilities Matrix to store the probabilities of each class in.
+   */
+  static void Probabilities(const arma::mat& scores, arma::mat& probabilities)
+  {
+    probabilities.set_size(2, scores.n_cols);
+    probabilities.row(1) = 1.0 / (1.0 + arma::exp(-scores.row(0)));
+    probabilities.row(0) = 1.0 - probabilities.row(1);
+  }
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * @file softmax_loss.hpp
+ *
+ * The softmax loss for gradient boosted multiclass classification.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GRADIENT_BOOSTING_SOFTMAX_LOSS_HPP
+#define MLPACK_METHODS_GRADIENT_BOOSTING_SOFTMAX_LOSS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The softmax loss (negative log-likelihood of a softmax model) for
+ * multiclass classification with GradientBoosting.  The model has one output
+ * per class, and each boosting round adds one tree per class.
+ */
+class SoftmaxLoss
+{
+ public:
+  /**
+   * Get the number of outputs (trees per boosting round) of the model: one per
+   * class.
+   *
+   * @param numClasses Number of classes.
+   */
+  static size_t NumOutputs(const size_t numClasses) { return numClasses; }
+
+  /**
+   * Compute the initial scores, the log of the frequency of each class in the
+   * training set.
+   *
+   * @param responses Labels of the training points.
+   * @param numOutputs Number of outputs.
+   * @param initialScores Vector to store the initial scores in.
+   */
+  static void InitialScores(const arma::rowvec& responses,
+                            const size_t numOutputs,
+                            arma::vec& initialScores)
+  {
+    // Start every class with one point, so that no score is infinite.
+    initialScores.ones(numOutputs);
+    for (size_t i = 0; i < responses.n_elem; ++i)
+      initialScores[(size_t) responses[i]]++;
+    initialScores = arma::log(initialScores / arma::accu(initialScores));
+  }
+
+  /**
+   * Compute the first and second derivatives of the loss of each point with
+   * respect to the score of each class.
+   *
+   * @param responses Labels of the training points.
+   * @param scores Current scores of the training points.
+   * @param gradients Matrix to store the first derivatives in.
+   * @param hessians Matrix to store the second derivatives in.
+   */
+  static void Gradients(const arma::rowvec& responses,
+                        const arma::mat& scores,
+                        arma::mat& gradients,
+                        arma::mat& hessians)
+  {
+    Probabilities(scores, gradients);
+    hessians = arma::clamp(gradients % (1.0 - gradients), 1e-16, 1.0);
+    for (size_t i = 0; i < responses.n_elem; ++i)
+      gradients((size_t) responses[i], i) -= 1.0;
+  }
+
+  /**
+   * Convert the scores into class probabilities.
+   *
+   * @param scores Scores of the points.
+   * @param probabilities Matrix to store the probabilities of each class in.
+   */
+  static void Probabilities(const arma::mat& scores, arma::mat& probabilities)
+  {
+    // Subtract the largest score of each point, for numerical stability.
+    probabilities = arma::exp(scores.each_row() - arma::max(scores, 0));
+    probabilities.each_row() /= arma::sum(probabilities, 0);
+  }
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
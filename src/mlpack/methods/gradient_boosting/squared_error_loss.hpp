@@ -0,0 +1,72 @@
+/**
+ * @file squared_error_loss.hpp
+ *
+ * The squared error loss for gradient boosted regression.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GRADIENT_BOOSTING_SQUARED_ERROR_LOSS_HPP
+#define MLPACK_METHODS_GRADIENT_BOOSTING_SQUARED_ERROR_LOSS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The squared error loss, (score - response)^2 / 2, for regression with
+ * GradientBoosting.  The model has one output, which is the predicted
+ * response.
+ */
+class SquaredErrorLoss
+{
+ public:
+  /**
+   * Get the number of outputs (trees per boosting round) of the model.
+   *
+   * @param numClasses (Unused) number of classes.
+   */
+  static size_t NumOutputs(const size_t /* numClasses */) { return 1; }
+
+  /**
+   * Compute the initial score of each output, the constant that minimizes the
+   * loss: the mean of the responses.
+   *
+   * @param responses Responses of the training points.
+   * @param numOutputs Number of outputs.
+   * @param initialScores Vector to store the initial scores in.
+   */
+  static void InitialScores(const arma::rowvec& responses,
+                            const size_t numOutputs,
+                            arma::vec& initialScores)
+  {
+    initialScores.set_size(numOutputs);
+    initialScores.fill(responses.n_elem == 0 ? 0.0 : arma::mean(responses));
+  }
+
+  /**
+   * Compute the first and second derivatives of the loss of each point with
+   * respect to its score.
+   *
+   * @param responses Responses of the training points.
+   * @param scores Current scores of the training points.
+   * @param gradients Matrix to store the first derivatives in.
+   * @param hessians Matrix to store the second derivatives in.
+   */
+  static void Gradients(const arma::rowvec& responses,
+                        const arma::mat& scores,
+                        arma::mat& gradients,
+                        arma::mat& hessians)
+  {
+    gradients = scores.row(0) - responses;
+    hessians.ones(1, responses.n_elem);
+  }
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
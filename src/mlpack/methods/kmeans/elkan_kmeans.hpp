@@ -26,7 +26,8 @@ class ElkanKMeans
 
   /**
    * Run a single iteration of Elkan's algorithm, updating the given centroids
-   * into the newCentroids matrix.
+   * into the newCentroids matrix.  If OpenMP is available, the points are
+   * split between the threads.
    *
    * @param centroids Current cluster centroids.
    * @param newCentroids New cluster centroids.
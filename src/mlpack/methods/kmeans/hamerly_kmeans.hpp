@@ -27,7 +27,8 @@ class HamerlyKMeans
 
   /**
    * Run a single iteration of Hamerly's algorithm, updating the given centroids
-   * into the newCentroids matrix.
+   * into the newCentroids matrix.  If OpenMP is available, the points are
+   * split between the threads.
    *
    * @param centroids Current cluster centroids.
    * @param newCentroids New cluster centroids.
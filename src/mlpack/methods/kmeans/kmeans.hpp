@@ -18,6 +18,7 @@
 #include "sample_initialization.hpp"
 #include "max_variance_new_cluster.hpp"
 #include "naive_kmeans.hpp"
+#include "mini_batch_kmeans.hpp"
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
 
@@ -63,7 +64,7 @@ namespace kmeans /** K-Means clustering. */ {
  * @tparam LloydStepType Implementation of single Lloyd step to use.
  *
  * @see RandomPartition, SampleInitialization, RefinedStart, AllowEmptyClusters,
- *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans
+ *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans, MiniBatchKMeans
  */
 template<typename MetricType = metric::EuclideanDistance,
          typename InitialPartitionPolicy = SampleInitialization,
@@ -155,6 +156,43 @@ class KMeans
                const bool initialAssignmentGuess = false,
                const bool initialCentroidGuess = false);
 
+  /**
+   * Update the given centroids with a batch of points.  This is streaming
+   * mini-batch k-means (see MiniBatchKMeans): each point of the batch is
+   * assigned to its closest centroid, and each centroid moves towards its
+   * points with a learning rate of one over the number of points it has
+   * received so far.  Calling Update() on each chunk of a dataset that doesn't
+   * fit in memory clusters the whole dataset while holding only one chunk at a
+   * time.
+   *
+   * If centroids is empty, the centroids are first initialized from the batch
+   * with the InitialPartitionPolicy, and the counts are set to zero.
+   * Afterwards, clusters that have never received a point are handled by the
+   * EmptyClusterPolicy, using the points of the batch.
+   *
+   * @code
+   * arma::mat centroids;
+   * arma::Col<size_t> counts;
+   * KMeans<> k;
+   * for (size_t i = 0; i < numChunks; ++i)
+   * {
+   *   arma::mat chunk;
+   *   data::Load("chunk" + std::to_string(i) + ".csv", chunk);
+   *   k.Update(chunk, 100, centroids, counts);
+   * }
+   * @endcode
+   *
+   * @param batch Points to update the centroids with.
+   * @param clusters Number of clusters.
+   * @param centroids Centroids to update (or an empty matrix).
+   * @param counts Number of points each cluster has received; updated.
+   * @return The distance the centroids moved.
+   */
+  double Update(const MatType& batch,
+                const size_t clusters,
+                arma::mat& centroids,
+                arma::Col<size_t>& counts);
+
   //! Get the maximum number of iterations.
   size_t MaxIterations() const { return maxIterations; }
   //! Set the maximum number of iterations.
@@ -337,6 +337,96 @@ Cluster(const MatType& data,
   }
 }
 
+/**
+ * Update the centroids with a batch of points.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+double KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Update(const MatType& batch,
+       const size_t clusters,
+       arma::mat& centroids,
+       arma::Col<size_t>& counts)
+{
+  if (batch.n_cols == 0)
+    return 0.0;
+
+  // Initialize the centroids with the first batch.
+  if (centroids.n_cols == 0)
+  {
+    if (clusters > batch.n_cols)
+      Log::Warn << "KMeans::Update(): more clusters requested than points in "
+          << "the first batch." << std::endl;
+
+    arma::Row<size_t> assignments;
+    const bool gotAssignments = GetInitialAssignmentsOrCentroids(partitioner,
+        batch, clusters, assignments, centroids);
+    if (gotAssignments)
+    {
+      // The partitioner gives assignments, so we need to calculate centroids
+      // from those assignments.
+      arma::Row<size_t> initialCounts;
+      initialCounts.zeros(clusters);
+      centroids.zeros(batch.n_rows, clusters);
+      for (size_t i = 0; i < batch.n_cols; ++i)
+      {
+        centroids.col(assignments[i]) += arma::vec(batch.col(i));
+        initialCounts[assignments[i]]++;
+      }
+
+      for (size_t i = 0; i < clusters; ++i)
+        if (initialCounts[i] != 0)
+          centroids.col(i) /= initialCounts[i];
+    }
+
+    counts.zeros(clusters);
+  }
+
+  if (centroids.n_cols != clusters || counts.n_elem != clusters)
+    Log::Fatal << "KMeans::Update(): wrong number of centroids or counts ("
+        << centroids.n_cols << " and " << counts.n_elem << ", should be "
+        << clusters << ")!" << std::endl;
+
+  if (centroids.n_rows != batch.n_rows)
+    Log::Fatal << "KMeans::Update(): centroids have wrong dimensionality ("
+        << centroids.n_rows << ", should be " << batch.n_rows << ")!"
+        << std::endl;
+
+  // The empty cluster policy may cache things between calls in the same
+  // iteration, so each batch gets its own iteration number: the number of
+  // points seen before it.
+  const size_t iteration = arma::accu(counts);
+
+  MiniBatchKMeans<MetricType, MatType> step(batch, metric);
+  arma::mat newCentroids;
+  const double cNorm = step.Update(centroids, newCentroids, counts);
+
+  for (size_t i = 0; i < clusters; ++i)
+  {
+    if (counts[i] == 0)
+    {
+      Log::Info << "Cluster " << i << " is empty.\n";
+      emptyClusterAction.EmptyCluster(batch, i, centroids, newCentroids,
+          counts, metric, iteration);
+    }
+  }
+
+  centroids.steal_mem(newCentroids);
+
+  Log::Info << "KMeans::Update(): " << batch.n_cols << " points, residual "
+      << cNorm << ".\n";
+
+  return cNorm;
+}
+
 template<typename MetricType,
          typename InitialPartitionPolicy,
          typename EmptyClusterPolicy,
@@ -0,0 +1,132 @@
+/**
+ * @file kmeans_parallel_initialization.hpp
+ *
+ * An implementation of the k-means|| initialization of Bahmani et al., a
+ * parallel version of k-means++ that chooses the initial centroids in a few
+ * passes over the data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The k-means|| ("k-means parallel") initialization, which chooses initial
+ * centroids that are about as good as those of k-means++, but in a handful of
+ * passes over the data instead of one pass per cluster.  It is an
+ * implementation of the following paper:
+ *
+ * @code
+ * @article{bahmani2012scalable,
+ *   title={Scalable k-means++},
+ *   author={Bahmani, Bahman and Moseley, Benjamin and Vattani, Andrea and
+ *       Kumar, Ravi and Vassilvitskii, Sergei},
+ *   journal={Proceedings of the VLDB Endowment},
+ *   volume={5},
+ *   number={7},
+ *   pages={622--633},
+ *   year={2012}
+ * }
+ * @endcode
+ *
+ * Starting from one random point, each round samples every point independently
+ * with probability proportional to its squared distance to the candidates
+ * chosen so far, so that about oversampling * k new candidates are chosen per
+ * round.  After the rounds, each candidate is weighted by the number of points
+ * closest to it, and the weighted candidates are clustered into k centroids
+ * with k-means++ followed by a few weighted Lloyd iterations.  Only the rounds
+ * touch the whole dataset; they are run in parallel with OpenMP, and the random
+ * choices don't depend on the number of threads.
+ *
+ * Distances are Euclidean.
+ */
+class KMeansParallelInitialization
+{
+ public:
+  /**
+   * Create the KMeansParallelInitialization object, optionally specifying the
+   * parameters of the initialization.
+   *
+   * @param oversampling Expected number of candidates chosen in each round, as
+   *     a multiple of the number of clusters.
+   * @param rounds Number of sampling rounds (passes over the data).
+   * @param refineIterations Maximum number of weighted Lloyd iterations run on
+   *     the candidates after k-means++.
+   */
+  KMeansParallelInitialization(const double oversampling = 2.0,
+                               const size_t rounds = 5,
+                               const size_t refineIterations = 10) :
+      oversampling(oversampling),
+      rounds(rounds),
+      refineIterations(refineIterations) { }
+
+  /**
+   * Choose initial centroids for the given number of clusters.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset to choose the centroids for.
+   * @param clusters Number of clusters.
+   * @param centroids Matrix to store the centroids into.
+   */
+  template<typename MatType>
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::mat& centroids);
+
+  //! Get the oversampling factor.
+  double Oversampling() const { return oversampling; }
+  //! Modify the oversampling factor.
+  double& Oversampling() { return oversampling; }
+
+  //! Get the number of sampling rounds.
+  size_t Rounds() const { return rounds; }
+  //! Modify the number of sampling rounds.
+  size_t& Rounds() { return rounds; }
+
+  //! Get the maximum number of Lloyd iterations run on the candidates.
+  size_t RefineIterations() const { return refineIterations; }
+  //! Modify the maximum number of Lloyd iterations run on the candidates.
+  size_t& RefineIterations() { return refineIterations; }
+
+  //! Serialize the object.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & BOOST_SERIALIZATION_NVP(oversampling);
+    ar & BOOST_SERIALIZATION_NVP(rounds);
+    ar & BOOST_SERIALIZATION_NVP(refineIterations);
+  }
+
+ private:
+  /**
+   * Cluster the weighted candidates into the given number of centroids, with
+   * k-means++ and then weighted Lloyd iterations.
+   */
+  void Recluster(const arma::mat& candidates,
+                 const arma::vec& weights,
+                 const size_t clusters,
+                 arma::mat& centroids) const;
+
+  //! The expected number of candidates per round, per cluster.
+  double oversampling;
+  //! The number of sampling rounds.
+  size_t rounds;
+  //! The maximum number of Lloyd iterations run on the candidates.
+  size_t refineIterations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "kmeans_parallel_initialization_impl.hpp"
+
+#endif
@@ -0,0 +1,246 @@
+/**
+ * @file kmeans_parallel_initialization_impl.hpp
+ *
+ * Implementation of the k-means|| initialization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_parallel_initialization.hpp"
+
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * Return a uniform random number in [0, 1) for the given point of a round.
+ * This is the SplitMix64 generator applied to the index of the point, so the
+ * points can be sampled in parallel with the same result as sequentially.
+ */
+inline double PointUniform(const uint64_t seed, const uint64_t index)
+{
+  uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z = z ^ (z >> 31);
+  return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+template<typename MatType>
+void KMeansParallelInitialization::Cluster(const MatType& data,
+                                           const size_t clusters,
+                                           arma::mat& centroids)
+{
+  typedef metric::SquaredEuclideanDistance DistanceType;
+
+  const size_t n = data.n_cols;
+  if (n == 0 || clusters == 0)
+  {
+    centroids.zeros(data.n_rows, clusters);
+    return;
+  }
+
+  // Start with one random point.  For each point, keep its squared distance to
+  // the closest candidate, and the index of that candidate.
+  std::vector<size_t> candidates(1, math::RandInt(0, n));
+  arma::vec minDistances(n);
+  arma::Col<size_t> closest(n);
+  double cost = 0.0;
+  {
+    const arma::vec first(data.col(candidates[0]));
+    #pragma omp parallel for reduction(+:cost)
+    for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+    {
+      minDistances[i] = DistanceType::Evaluate(data.col(i), first);
+      closest[i] = 0;
+      cost += minDistances[i];
+    }
+  }
+
+  const double expected = oversampling * clusters;
+  for (size_t round = 0; round < rounds && cost > 0.0; ++round)
+  {
+    // Sample each point with probability expected * d^2(x) / cost.
+    const uint64_t seed = (uint64_t(math::RandInt(0, INT_MAX)) << 31) ^
+        uint64_t(math::RandInt(0, INT_MAX));
+    std::vector<size_t> sampled;
+    #pragma omp parallel
+    {
+      std::vector<size_t> localSampled;
+      #pragma omp for nowait
+      for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+      {
+        if (PointUniform(seed, i) * cost < expected * minDistances[i])
+          localSampled.push_back(i);
+      }
+
+      #pragma omp critical
+      sampled.insert(sampled.end(), localSampled.begin(), localSampled.end());
+    }
+
+    if (sampled.empty())
+      continue;
+
+    // Keep the candidates in the order of the points, whatever the threads did.
+    std::sort(sampled.begin(), sampled.end());
+    const size_t firstNew = candidates.size();
+    candidates.insert(candidates.end(), sampled.begin(), sampled.end());
+
+    arma::mat newCandidates(data.n_rows, sampled.size());
+    for (size_t j = 0; j < sampled.size(); ++j)
+      newCandidates.col(j) = arma::vec(data.col(sampled[j]));
+
+    // Update the distances with the new candidates.
+    cost = 0.0;
+    #pragma omp parallel for schedule(dynamic, 256) reduction(+:cost)
+    for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+    {
+      for (size_t j = 0; j < newCandidates.n_cols; ++j)
+      {
+        const double distance = DistanceType::Evaluate(data.col(i),
+            newCandidates.unsafe_col(j));
+        if (distance < minDistances[i])
+        {
+          minDistances[i] = distance;
+          closest[i] = firstNew + j;
+        }
+      }
+      cost += minDistances[i];
+    }
+  }
+
+  Log::Info << "KMeansParallelInitialization::Cluster(): chose "
+      << candidates.size() << " candidates." << std::endl;
+
+  // Weight each candidate by the number of points closest to it.
+  arma::vec weights(candidates.size(), arma::fill::zeros);
+  for (size_t i = 0; i < n; ++i)
+    weights[closest[i]] += 1.0;
+
+  arma::mat candidateMatrix(data.n_rows, candidates.size());
+  for (size_t j = 0; j < candidates.size(); ++j)
+    candidateMatrix.col(j) = arma::vec(data.col(candidates[j]));
+
+  if (candidates.size() <= clusters)
+  {
+    // There are too few candidates (all the points may be the same), so use
+    // them all and fill the rest with random points.
+    centroids.set_size(data.n_rows, clusters);
+    centroids.cols(0, candidates.size() - 1) = candidateMatrix;
+    for (size_t i = candidates.size(); i < clusters; ++i)
+      centroids.col(i) = arma::vec(data.col(math::RandInt(0, n)));
+
+    return;
+  }
+
+  Recluster(candidateMatrix, weights, clusters, centroids);
+}
+
+inline void KMeansParallelInitialization::Recluster(
+    const arma::mat& candidates,
+    const arma::vec& weights,
+    const size_t clusters,
+    arma::mat& centroids) const
+{
+  typedef metric::SquaredEuclideanDistance DistanceType;
+
+  // Weighted k-means++: each centroid is a candidate chosen with probability
+  // proportional to its weight times its squared distance to the centroids
+  // chosen so far.
+  centroids.set_size(candidates.n_rows, clusters);
+  arma::vec minDistances(candidates.n_cols);
+  minDistances.fill(DBL_MAX);
+  arma::vec probabilities = weights;
+  for (size_t c = 0; c < clusters; ++c)
+  {
+    const double total = arma::accu(probabilities);
+    size_t chosen = candidates.n_cols - 1;
+    if (total > 0.0)
+    {
+      const double target = math::Random() * total;
+      double sum = 0.0;
+      for (size_t j = 0; j < candidates.n_cols; ++j)
+      {
+        sum += probabilities[j];
+        if (sum > target)
+        {
+          chosen = j;
+          break;
+        }
+      }
+    }
+    else
+    {
+      // The remaining candidates all coincide with chosen centroids.
+      chosen = math::RandInt(0, candidates.n_cols);
+    }
+
+    centroids.col(c) = candidates.col(chosen);
+    for (size_t j = 0; j < candidates.n_cols; ++j)
+    {
+      const double distance = DistanceType::Evaluate(candidates.col(j),
+          centroids.col(c));
+      if (distance < minDistances[j])
+        minDistances[j] = distance;
+      probabilities[j] = weights[j] * minDistances[j];
+    }
+  }
+
+  // Now refine the centroids with weighted Lloyd iterations on the candidates.
+  arma::Col<size_t> assignments(candidates.n_cols);
+  assignments.fill(clusters);
+  for (size_t iteration = 0; iteration < refineIterations; ++iteration)
+  {
+    size_t changed = 0;
+    #pragma omp parallel for reduction(+:changed)
+    for (omp_size_t j = 0; j < (omp_size_t) candidates.n_cols; ++j)
+    {
+      double minDistance = DBL_MAX;
+      size_t closestCluster = 0;
+      for (size_t c = 0; c < clusters; ++c)
+      {
+        const double distance = DistanceType::Evaluate(candidates.col(j),
+            centroids.col(c));
+        if (distance < minDistance)
+        {
+          minDistance = distance;
+          closestCluster = c;
+        }
+      }
+
+      if (assignments[j] != closestCluster)
+      {
+        assignments[j] = closestCluster;
+        ++changed;
+      }
+    }
+
+    if (changed == 0)
+      break;
+
+    arma::mat sums(candidates.n_rows, clusters, arma::fill::zeros);
+    arma::vec totalWeights(clusters, arma::fill::zeros);
+    for (size_t j = 0; j < candidates.n_cols; ++j)
+    {
+      sums.col(assignments[j]) += weights[j] * candidates.col(j);
+      totalWeights[assignments[j]] += weights[j];
+    }
+
+    // A centroid without any weight stays where it is.
+    for (size_t c = 0; c < clusters; ++c)
+      if (totalWeights[c] > 0.0)
+        centroids.col(c) = sums.col(c) / totalWeights[c];
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
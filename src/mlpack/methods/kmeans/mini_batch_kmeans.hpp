@@ -0,0 +1,141 @@
+/**
+ * @file mini_batch_kmeans.hpp
+ *
+ * An implementation of mini-batch k-means (Sculley, 2010), which updates the
+ * centroids with a small random sample of the points at each iteration.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This is an implementation of a single iteration of mini-batch k-means, as
+ * described in the following paper:
+ *
+ * @code
+ * @inproceedings{sculley2010web,
+ *   title={Web-scale k-means clustering},
+ *   author={Sculley, David},
+ *   booktitle={Proceedings of the 19th International Conference on World Wide
+ *       Web (WWW '10)},
+ *   pages={1177--1178},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * Instead of assigning every point of the dataset, each iteration samples a
+ * batch of points, assigns them to their closest centroids, and moves each
+ * centroid towards its points with a learning rate of one over the number of
+ * points that centroid has received so far, so that each centroid is the mean
+ * of all the points it has received.  An iteration therefore costs
+ * O(batchSize * k) instead of O(n * k), and the centroids converge after a
+ * small number of passes over the data; the result is an approximation of the
+ * result of Lloyd's algorithm.
+ *
+ * The counts returned by Iterate() are the number of points each centroid has
+ * received since the start of the clustering, so a cluster is empty until it
+ * receives its first point.  If the number of clusters is large compared to
+ * the batch size, an EmptyClusterPolicy that doesn't look at the whole dataset
+ * (like AllowEmptyClusters) is much cheaper than MaxVarianceNewCluster.  The
+ * residual of an iteration decreases with the number of iterations, so the
+ * number of iterations is usually given by the maximum number of iterations of
+ * KMeans.
+ *
+ * This class is used by KMeans as the implementation of the Lloyd iteration,
+ * and by KMeans::Update() to fold batches of points into existing centroids.
+ *
+ * @tparam MetricType Type of metric used with this implementation.
+ * @tparam MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class MiniBatchKMeans
+{
+ public:
+  /**
+   * Construct the MiniBatchKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points sampled at each iteration.
+   */
+  MiniBatchKMeans(const MatType& dataset,
+                  MetricType& metric,
+                  const size_t batchSize = 1000);
+
+  /**
+   * Run a single iteration of mini-batch k-means on a random sample of the
+   * points, updating the given centroids into the newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points each cluster has received since the start
+   *     of the clustering, at the end of the iteration.
+   * @return The distance the centroids moved.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  /**
+   * Update the given centroids with all the points of the dataset, in order,
+   * as if they were one batch.  The counts give the number of points each
+   * centroid has already received (all zeros for new centroids), and are
+   * updated.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points each cluster has received.
+   * @return The distance the centroids moved.
+   */
+  double Update(const arma::mat& centroids,
+                arma::mat& newCentroids,
+                arma::Col<size_t>& counts);
+
+  //! Get the number of distance calculations.
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the number of points sampled at each iteration.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points sampled at each iteration.
+  size_t& BatchSize() { return batchSize; }
+
+ private:
+  /**
+   * Assign the given points to their closest centroids, then move each
+   * centroid towards its points.
+   */
+  double Step(const arma::Col<size_t>& points,
+              const arma::mat& centroids,
+              arma::mat& newCentroids,
+              arma::Col<size_t>& counts);
+
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! The number of points sampled at each iteration.
+  size_t batchSize;
+
+  //! The number of points each cluster has received.
+  arma::Col<size_t> clusterCounts;
+
+  //! Track distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
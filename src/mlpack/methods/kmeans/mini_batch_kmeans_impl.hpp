@@ -0,0 +1,126 @@
+/**
+ * @file mini_batch_kmeans_impl.hpp
+ *
+ * Implementation of mini-batch k-means iterations.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(const MatType& dataset,
+                                                      MetricType& metric,
+                                                      const size_t batchSize) :
+    dataset(dataset),
+    metric(metric),
+    batchSize(batchSize),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Iterate(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  // On the first iteration no cluster has received any point.  Afterwards, the
+  // counts are the ones we returned, as modified by the empty cluster policy.
+  if (clusterCounts.n_elem != centroids.n_cols)
+    clusterCounts.zeros(centroids.n_cols);
+  else
+    clusterCounts = counts;
+
+  // Sample the batch.
+  arma::Col<size_t> points(std::min(batchSize, (size_t) dataset.n_cols));
+  for (size_t i = 0; i < points.n_elem; ++i)
+    points[i] = math::RandInt(0, dataset.n_cols);
+
+  const double cNorm = Step(points, centroids, newCentroids, clusterCounts);
+  counts = clusterCounts;
+
+  return cNorm;
+}
+
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Update(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  arma::Col<size_t> points(dataset.n_cols);
+  for (size_t i = 0; i < points.n_elem; ++i)
+    points[i] = i;
+
+  return Step(points, centroids, newCentroids, counts);
+}
+
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Step(
+    const arma::Col<size_t>& points,
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  // Find the closest centroid to each point of the batch, in parallel.
+  arma::Col<size_t> assignments(points.n_elem);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) points.n_elem; ++i)
+  {
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      const double distance = metric.Evaluate(dataset.col(points[i]),
+          centroids.unsafe_col(j));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    assignments[i] = closestCluster;
+  }
+  distanceCalculations += points.n_elem * centroids.n_cols;
+
+  // Now move each centroid towards its points.  The learning rate of a centroid
+  // is one over the number of points it has received, so that it stays the
+  // mean of those points.
+  newCentroids = centroids;
+  for (size_t i = 0; i < points.n_elem; ++i)
+  {
+    const size_t cluster = assignments[i];
+    ++counts[cluster];
+    const double learningRate = 1.0 / counts[cluster];
+    newCentroids.col(cluster) += learningRate *
+        (arma::vec(dataset.col(points[i])) - newCentroids.col(cluster));
+  }
+
+  // Calculate the movement of the centroids.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
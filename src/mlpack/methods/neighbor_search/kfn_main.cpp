@@ -86,7 +86,9 @@ PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
 PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', 'single_tree', "
-    "'dual_tree', 'greedy'.", "a", "dual_tree");
+    "'dual_tree', 'greedy', 'block'.  'block' is a single-tree search that "
+    "handles the query points in blocks; it is not available for cover trees "
+    "or spill trees.", "a", "dual_tree");
 PARAM_FLAG("naive", "(Deprecated) If true, O(n^2) naive mode is used for "
     "computation. Will be removed in mlpack 3.0.0. Use '--algorithm naive' "
     "instead.", "N");
@@ -198,10 +200,12 @@ void mlpackMain()
     searchMode = DUAL_TREE_MODE;
   else if (algorithm == "greedy")
     searchMode = GREEDY_SINGLE_TREE_MODE;
+  else if (algorithm == "block")
+    searchMode = BLOCK_SINGLE_TREE_MODE;
   else
     Log::Fatal << "Unknown neighbor search algorithm '" << algorithm << "'; "
-        << "valid choices are 'naive', 'single_tree', 'dual_tree' and 'greedy'."
-        << endl;
+        << "valid choices are 'naive', 'single_tree', 'dual_tree', 'greedy' "
+        << "and 'block'." << endl;
 
   if (CLI::HasParam("single_mode"))
   {
@@ -236,6 +240,11 @@ void mlpackMain()
     const string treeType = CLI::GetParam<string>("tree_type");
     const bool randomBasis = CLI::HasParam("random_basis");
 
+    if (searchMode == BLOCK_SINGLE_TREE_MODE &&
+        (treeType == "cover" || treeType == "spill"))
+      Log::Fatal << "--algorithm block cannot be used with --tree_type "
+          << treeType << "." << endl;
+
     KFNModel::TreeTypes tree = KFNModel::KD_TREE;
     if (treeType == "kd")
       tree = KFNModel::KD_TREE;
@@ -91,10 +91,15 @@ PARAM_DOUBLE_IN("rho", "Balance threshold (only valid for spill trees).", "b",
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
 PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+PARAM_FLAG("single_precision", "If set, the reference set is stored and the "
+    "tree is built in single precision, which halves the memory used and "
+    "speeds up distance computations at the cost of accuracy.", "f");
 
 // Search settings.
 PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', 'single_tree', "
-    "'dual_tree', 'greedy'.", "a", "dual_tree");
+    "'dual_tree', 'greedy', 'block'.  'block' is a single-tree search that "
+    "handles the query points in blocks; it is not available for cover trees "
+    "or spill trees.", "a", "dual_tree");
 PARAM_FLAG("naive", "(Deprecated) If true, O(n^2) naive mode is used for "
     "computation. Will be removed in mlpack 3.0.0. Use '--algorithm naive' "
     "instead.", "N");
@@ -211,10 +216,12 @@ void mlpackMain()
     searchMode = DUAL_TREE_MODE;
   else if (algorithm == "greedy")
     searchMode = GREEDY_SINGLE_TREE_MODE;
+  else if (algorithm == "block")
+    searchMode = BLOCK_SINGLE_TREE_MODE;
   else
     Log::Fatal << "Unknown neighbor search algorithm '" << algorithm << "'; "
-        << "valid choices are 'naive', 'single_tree', 'dual_tree' and 'greedy'."
-        << endl;
+        << "valid choices are 'naive', 'single_tree', 'dual_tree', 'greedy' "
+        << "and 'block'." << endl;
 
   if (CLI::HasParam("single_mode"))
   {
@@ -249,6 +256,11 @@ void mlpackMain()
     const string treeType = CLI::GetParam<string>("tree_type");
     const bool randomBasis = CLI::HasParam("random_basis");
 
+    if (searchMode == BLOCK_SINGLE_TREE_MODE &&
+        (treeType == "cover" || treeType == "spill"))
+      Log::Fatal << "--algorithm block cannot be used with --tree_type "
+          << treeType << "." << endl;
+
     KNNModel::TreeTypes tree = KNNModel::KD_TREE;
     if (treeType == "kd")
       tree = KNNModel::KD_TREE;
@@ -292,20 +304,53 @@ void mlpackMain()
     knn.Tau() = tau;
     knn.Rho() = rho;
 
-    arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
+    if (CLI::HasParam("single_precision"))
+    {
+      arma::fmat referenceSet;
+#if (BINDING_TYPE == BINDING_TYPE_CLI)
+      // Load the file straight into single precision, so that the reference
+      // set is never held in double precision.
+      data::Load(CLI::GetPrintableParam<arma::mat>("reference"), referenceSet,
+          true);
+#else
+      // Other bindings pass the reference set in memory; free it once it has
+      // been converted.
+      arma::mat& doubleReferenceSet = CLI::GetParam<arma::mat>("reference");
+      referenceSet = arma::conv_to<arma::fmat>::from(doubleReferenceSet);
+      doubleReferenceSet.reset();
+#endif
+
+      Log::Info << "Loaded reference data from '"
+          << CLI::GetPrintableParam<arma::mat>("reference") << "' ("
+          << referenceSet.n_rows << " x " << referenceSet.n_cols << ")."
+          << endl;
+
+      knn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode,
+          epsilon);
+    }
+    else
+    {
+      arma::mat referenceSet =
+          std::move(CLI::GetParam<arma::mat>("reference"));
 
-    Log::Info << "Loaded reference data from '"
-        << CLI::GetPrintableParam<arma::mat>("reference") << "' ("
-        << referenceSet.n_rows << " x " << referenceSet.n_cols << ")."
-        << endl;
+      Log::Info << "Loaded reference data from '"
+          << CLI::GetPrintableParam<arma::mat>("reference") << "' ("
+          << referenceSet.n_rows << " x " << referenceSet.n_cols << ")."
+          << endl;
 
-    knn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode, epsilon);
+      knn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode,
+          epsilon);
+    }
   }
   else
   {
     // Load the model from file.
     knn = std::move(CLI::GetParam<KNNModel>("input_model"));
 
+    if (CLI::HasParam("single_precision") && !knn.SinglePrecision())
+      Log::Warn << "--single_precision ignored because the model in "
+          << "--input_model was built in double precision." << endl;
+
     // Adjust search mode.
     knn.SearchMode() = searchMode;
     knn.Epsilon() = epsilon;
@@ -316,10 +361,13 @@ void mlpackMain()
     if (CLI::HasParam("leaf_size"))
       knn.LeafSize() = size_t(lsInt);
 
+    const size_t dimensionality = knn.SinglePrecision() ?
+        knn.Dataset<arma::fmat>().n_rows : knn.Dataset().n_rows;
+    const size_t numReferences = knn.SinglePrecision() ?
+        knn.Dataset<arma::fmat>().n_cols : knn.Dataset().n_cols;
     Log::Info << "Loaded kNN model from '"
         << CLI::GetPrintableParam<KNNModel>("input_model") << "' (trained on "
-        << knn.Dataset().n_rows << "x" << knn.Dataset().n_cols << " dataset)."
-        << endl;
+        << dimensionality << "x" << numReferences << " dataset)." << endl;
   }
 
   // Perform search, if desired.
@@ -339,11 +387,13 @@ void mlpackMain()
     // Sanity check on k value: must be greater than 0, must be less than the
     // number of reference points.  Since it is unsigned, we only test the upper
     // bound.
-    if (k > knn.Dataset().n_cols)
+    const size_t numReferences = knn.SinglePrecision() ?
+        knn.Dataset<arma::fmat>().n_cols : knn.Dataset().n_cols;
+    if (k > numReferences)
     {
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
       Log::Fatal << "than or equal to the number of reference points (";
-      Log::Fatal << knn.Dataset().n_cols << ")." << endl;
+      Log::Fatal << numReferences << ")." << endl;
     }
 
     // Now run the search.
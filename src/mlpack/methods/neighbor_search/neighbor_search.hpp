@@ -16,6 +16,7 @@
 #include <mlpack/prereqs.hpp>
 #include <vector>
 #include <string>
+#include <boost/preprocessor/punctuation/comma.hpp>
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
@@ -34,13 +35,20 @@ namespace neighbor  {
 template<typename SortPolicy>
 class TrainVisitor;
 
-//! NeighborSearchMode represents the different neighbor search modes available.
+/**
+ * NeighborSearchMode represents the different neighbor search modes available.
+ * BLOCK_SINGLE_TREE_MODE is a single-tree search that traverses the reference
+ * tree once per block of query points and computes the base cases of a block
+ * as a dense distance matrix; it is not available for the cover tree or for
+ * spill trees.
+ */
 enum NeighborSearchMode
 {
   NAIVE_MODE,
   SINGLE_TREE_MODE,
   DUAL_TREE_MODE,
-  GREEDY_SINGLE_TREE_MODE
+  GREEDY_SINGLE_TREE_MODE,
+  BLOCK_SINGLE_TREE_MODE
 };
 
 /**
@@ -277,6 +285,36 @@ class NeighborSearch
    */
   void Train(Tree&& referenceTree);
 
+  /**
+   * Add the given point to the reference set, without rebuilding the whole
+   * reference tree.  The new point gets the next unused index: the first point
+   * inserted after Train() gets the index n, where n is the number of points
+   * given to Train(), the next one n + 1, and so on.  The indices of the other
+   * points don't change.  With a reference tree, this is only available for
+   * BinarySpaceTrees (such as kd-trees); see BinarySpaceTree::Insert().  If the
+   * reference tree was not built by this object, it is modified in place.
+   *
+   * @param point Point to add to the reference set.
+   * @param maxLeafSize Maximum number of points held in a leaf of the
+   *     reference tree.
+   * @return The index of the new point.
+   */
+  template<typename VecType>
+  size_t Insert(const VecType& point, const size_t maxLeafSize = 20);
+
+  /**
+   * Remove the point with the given index from the reference set, without
+   * rebuilding the whole reference tree.  The indices of the other points
+   * don't change, and the index of the removed point is not given to another
+   * point.  With a reference tree, this is only available for
+   * BinarySpaceTrees (such as kd-trees); see BinarySpaceTree::Remove().
+   *
+   * @param index Index of the point to remove.
+   * @param maxLeafSize Maximum number of points held in a leaf of the
+   *     reference tree.
+   */
+  void Remove(const size_t index, const size_t maxLeafSize = 20);
+
   /**
    * For each point in the query set, compute the nearest neighbors and store
    * the output in the given matrices.  The matrices will be set to the size of
@@ -334,6 +372,10 @@ class NeighborSearch
    * where n is the number of points in the query dataset and k is the number of
    * neighbors being searched for.
    *
+   * If points were inserted or removed with Insert() and Remove(), column i of
+   * the results holds the neighbors of the point with index i; the columns of
+   * removed points hold the index size_t() - 1 and the worst distance.
+   *
    * @param k Number of neighbors to search for.
    * @param neighbors Matrix storing lists of neighbors for each query point.
    * @param distances Matrix storing distances of neighbors for each query
@@ -392,7 +434,8 @@ class NeighborSearch
   //! Modify the relative error to be considered in approximate search.
   double& Epsilon() { return epsilon; }
 
-  //! Access the reference dataset.
+  //! Access the reference dataset.  Once points were inserted or removed, some
+  //! of its columns may hold no reference point.
   const MatType& ReferenceSet() const { return *referenceSet; }
 
   //! Access the reference tree.
@@ -402,11 +445,20 @@ class NeighborSearch
 
   //! Serialize the NeighborSearch model.
   template<typename Archive>
-  void serialize(Archive& ar, const unsigned int /* version */);
+  void serialize(Archive& ar, const unsigned int version);
 
  private:
-  //! Permutations of reference points during tree building.
+  //! Permutations of reference points during tree building.  Once points were
+  //! inserted or removed, this holds the index of the point held by each column
+  //! of the reference set, or size_t() - 1 for columns that hold no point.
   std::vector<size_t> oldFromNewReferences;
+  //! The column of the reference set that holds each reference point (or
+  //! size_t() - 1 if the point was removed).  This is empty until points are
+  //! inserted or removed.
+  std::vector<size_t> referenceColumns;
+  //! The columns of the reference set that hold no point, in naive mode.  (The
+  //! reference tree keeps track of them otherwise.)
+  std::vector<size_t> freeReferenceColumns;
   //! Pointer to the root of the reference tree.
   Tree* referenceTree;
   //! Reference dataset.  In some situations we may be the owner of this.
@@ -419,6 +471,7 @@ class NeighborSearch
 
   //! Indicates the neighbor search mode.
   NeighborSearchMode searchMode;
+
   //! Indicates the relative error to be considered in approximate search.
   double epsilon;
 
@@ -434,6 +487,35 @@ class NeighborSearch
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  //! The number of query points traversed together in BLOCK_SINGLE_TREE_MODE.
+  static const size_t QueryBlockSize = 64;
+
+  /**
+   * Run the block single-tree search for the query points 0 through
+   * numQueries - 1 with the given rules, taking QueryBlockSize consecutive
+   * query points at a time, and add the counts of the rules to baseCases and
+   * scores.  If referenceQueries is true, the query points are the columns of
+   * the reference set, and the columns that hold no point are skipped.
+   */
+  template<typename RuleType>
+  void BlockSearch(RuleType& rules,
+                   const size_t numQueries,
+                   const bool referenceQueries = false);
+
+  //! Return the number of points in the reference set.
+  size_t NumReferences() const;
+
+  //! Return whether the given column of the reference set holds a point.
+  bool HoldsReference(const size_t column) const
+  {
+    return referenceColumns.empty() ||
+        oldFromNewReferences[column] != size_t() - 1;
+  }
+
+  //! Set up the indices of the reference points before the first insertion or
+  //! removal.
+  void InitReferenceColumns();
+
   //! The NSModel class should have access to internal members.
   template<typename SortPol>
   friend class TrainVisitor;
@@ -442,6 +524,21 @@ class NeighborSearch
 } // namespace neighbor
 } // namespace mlpack
 
+//! Set the serialization version of the NeighborSearch class.
+BOOST_TEMPLATE_CLASS_VERSION(
+    template<typename SortPolicy BOOST_PP_COMMA()
+             typename MetricType BOOST_PP_COMMA()
+             typename MatType BOOST_PP_COMMA()
+             template<typename TreeMetricType BOOST_PP_COMMA()
+                      typename TreeStatType BOOST_PP_COMMA()
+                      typename TreeMatType> class TreeType BOOST_PP_COMMA()
+             template<typename> class DualTreeTraversalType BOOST_PP_COMMA()
+             template<typename> class SingleTreeTraversalType>,
+    mlpack::neighbor::NeighborSearch<SortPolicy BOOST_PP_COMMA()
+        MetricType BOOST_PP_COMMA() MatType BOOST_PP_COMMA()
+        TreeType BOOST_PP_COMMA() DualTreeTraversalType BOOST_PP_COMMA()
+        SingleTreeTraversalType>, 1);
+
 // Include implementation.
 #include "neighbor_search_impl.hpp"
 
@@ -15,6 +15,8 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/greedy_single_tree_traverser.hpp>
+#include <mlpack/core/tree/block_single_tree_traverser.hpp>
+#include <mlpack/core/tree/parallel_dual_tree_traversal.hpp>
 #include "neighbor_search_rules.hpp"
 #include <mlpack/core/tree/spill_tree/is_spill_tree.hpp>
 
@@ -212,6 +214,8 @@ template<typename SortPolicy,
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
 SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
     oldFromNewReferences(other.oldFromNewReferences),
+    referenceColumns(other.referenceColumns),
+    freeReferenceColumns(other.freeReferenceColumns),
     referenceTree(other.referenceTree ? new Tree(*other.referenceTree) : NULL),
     referenceSet(other.referenceTree ? &referenceTree->Dataset() :
         new MatType(*other.referenceSet)),
@@ -239,6 +243,8 @@ template<typename SortPolicy,
 NeighborSearch<SortPolicy, MetricType, MatType, TreeType, DualTreeTraversalType,
 SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     oldFromNewReferences(std::move(other.oldFromNewReferences)),
+    referenceColumns(std::move(other.referenceColumns)),
+    freeReferenceColumns(std::move(other.freeReferenceColumns)),
     referenceTree(other.referenceTree),
     referenceSet(other.referenceSet),
     treeOwner(other.treeOwner),
@@ -292,6 +298,8 @@ NeighborSearch<SortPolicy,
     delete referenceSet;
 
   oldFromNewReferences = other.oldFromNewReferences;
+  referenceColumns = other.referenceColumns;
+  freeReferenceColumns = other.freeReferenceColumns;
   referenceTree = other.referenceTree ? new Tree(*other.referenceTree) : NULL;
   referenceSet = other.referenceTree ? &referenceTree->Dataset() :
       new MatType(*other.referenceSet);
@@ -334,6 +342,8 @@ NeighborSearch<SortPolicy,
     delete referenceSet;
 
   oldFromNewReferences = std::move(other.oldFromNewReferences);
+  referenceColumns = std::move(other.referenceColumns);
+  freeReferenceColumns = std::move(other.freeReferenceColumns);
   referenceTree = other.referenceTree;
   referenceSet = other.referenceSet;
   treeOwner = other.treeOwner;
@@ -390,10 +400,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(
 {
   // Clean up the old tree, if we built one.
   if (treeOwner && referenceTree)
-  {
-    oldFromNewReferences.clear();
     delete referenceTree;
-  }
+
+  // Forget the indices of the old reference points.
+  oldFromNewReferences.clear();
+  referenceColumns.clear();
+  freeReferenceColumns.clear();
 
   // We may need to rebuild the tree.
   if (searchMode != NAIVE_MODE)
@@ -430,10 +442,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType&& referenceSetIn)
 {
   // Clean up the old tree, if we built one.
   if (treeOwner && referenceTree)
-  {
-    oldFromNewReferences.clear();
     delete referenceTree;
-  }
+
+  // Forget the indices of the old reference points.
+  oldFromNewReferences.clear();
+  referenceColumns.clear();
+  freeReferenceColumns.clear();
 
   // We may need to rebuild the tree.
   if (searchMode != NAIVE_MODE)
@@ -480,10 +494,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(
         "naive search (without trees) is desired");
 
   if (treeOwner && this->referenceTree)
-  {
-    oldFromNewReferences.clear();
     delete this->referenceTree;
-  }
+
+  oldFromNewReferences.clear();
+  referenceColumns.clear();
+  freeReferenceColumns.clear();
 
   if (setOwner && referenceSet)
     delete this->referenceSet;
@@ -510,10 +525,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree&& referenceTree)
         "naive search (without trees) is desired");
 
   if (treeOwner && this->referenceTree)
-  {
-    oldFromNewReferences.clear();
     delete this->referenceTree;
-  }
+
+  oldFromNewReferences.clear();
+  referenceColumns.clear();
+  freeReferenceColumns.clear();
 
   if (setOwner && referenceSet)
     delete this->referenceSet;
@@ -524,6 +540,145 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree&& referenceTree)
   setOwner = false;
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename VecType>
+size_t NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Insert(
+    const VecType& point,
+    const size_t maxLeafSize)
+{
+  if (point.n_elem != referenceSet->n_rows)
+    throw std::invalid_argument("dimensionality of the point does not match "
+        "the reference set");
+
+  InitReferenceColumns();
+
+  size_t column;
+  if (referenceTree)
+  {
+    column = referenceTree->Insert(point, maxLeafSize);
+  }
+  else
+  {
+    // Take our own copy of the reference set the first time, and then grow it
+    // geometrically, so that each insertion costs amortized O(d).
+    if (!setOwner)
+    {
+      referenceSet = new MatType(*referenceSet);
+      setOwner = true;
+    }
+
+    MatType& set = const_cast<MatType&>(*referenceSet);
+    if (freeReferenceColumns.empty())
+    {
+      const size_t oldCols = set.n_cols;
+      const size_t newCols = std::max(2 * oldCols, oldCols + 1);
+      set.resize(set.n_rows, newCols);
+      for (size_t i = newCols; i > oldCols; --i)
+        freeReferenceColumns.push_back(i - 1);
+    }
+
+    column = freeReferenceColumns.back();
+    freeReferenceColumns.pop_back();
+    set.col(column) = point;
+  }
+
+  // The reference set may have grown.
+  if (oldFromNewReferences.size() < referenceSet->n_cols)
+    oldFromNewReferences.resize(referenceSet->n_cols, size_t() - 1);
+
+  const size_t index = referenceColumns.size();
+  referenceColumns.push_back(column);
+  oldFromNewReferences[column] = index;
+
+  return index;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Remove(
+    const size_t index,
+    const size_t maxLeafSize)
+{
+  InitReferenceColumns();
+
+  if (index >= referenceColumns.size() ||
+      referenceColumns[index] == size_t() - 1)
+    throw std::invalid_argument("there is no reference point with the given "
+        "index");
+
+  // The column is left in the reference set; it just doesn't hold a point
+  // anymore.
+  const size_t column = referenceColumns[index];
+  if (referenceTree)
+    referenceTree->Remove(column, maxLeafSize);
+  else
+    freeReferenceColumns.push_back(column);
+
+  referenceColumns[index] = size_t() - 1;
+  oldFromNewReferences[column] = size_t() - 1;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+size_t NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::NumReferences() const
+{
+  if (referenceColumns.empty())
+    return referenceSet->n_cols;
+  else if (referenceTree)
+    return referenceTree->NumDescendants();
+  else
+    return referenceSet->n_cols - freeReferenceColumns.size();
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::InitReferenceColumns()
+{
+  if (!referenceColumns.empty())
+    return;
+
+  // Until now, every column held a point.
+  if (oldFromNewReferences.empty())
+  {
+    oldFromNewReferences.resize(referenceSet->n_cols);
+    for (size_t i = 0; i < oldFromNewReferences.size(); ++i)
+      oldFromNewReferences[i] = i;
+  }
+
+  referenceColumns.resize(oldFromNewReferences.size());
+  for (size_t i = 0; i < oldFromNewReferences.size(); ++i)
+    referenceColumns[oldFromNewReferences[i]] = i;
+}
+
 /**
  * Computes the best neighbors and stores them in resultingNeighbors and
  * distances.
@@ -543,14 +698,21 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferences())
   {
     std::stringstream ss;
     ss << "requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferences() << ")";
     throw std::invalid_argument(ss.str());
   }
 
+  // The block traversal needs every point to be held by exactly one node.
+  if (searchMode == BLOCK_SINGLE_TREE_MODE &&
+      (tree::TreeTraits<Tree>::FirstPointIsCentroid ||
+       tree::IsSpillTree<Tree>::value))
+    throw std::invalid_argument("block single-tree search is not available "
+        "for this tree type");
+
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -566,8 +728,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   arma::Mat<size_t>* neighborPtr = &neighbors;
   arma::mat* distancePtr = &distances;
 
-  // Mapping is only necessary if the tree rearranges points.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
+  // Mapping is only necessary if the tree rearranges points, or if points were
+  // inserted or removed.
+  if (tree::TreeTraits<Tree>::RearrangesDataset ||
+      !oldFromNewReferences.empty())
   {
     if (searchMode == DUAL_TREE_MODE)
     {
@@ -594,9 +758,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // The naive brute-force traversal.
       for (size_t i = 0; i < querySet.n_cols; ++i)
         for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
+          if (HoldsReference(j))
+            rules.BaseCase(i, j);
 
-      baseCases += querySet.n_cols * referenceSet->n_cols;
+      baseCases += querySet.n_cols * NumReferences();
 
       rules.GetResults(*neighborPtr, *distancePtr);
       break;
@@ -636,10 +801,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Create the helper object for the tree traversal.
       RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon);
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
-      traverser.Traverse(*queryTree, *referenceTree);
+      // Traverse, splitting the query tree into parallel tasks if possible.
+      tree::ParallelDualTreeTraversal<DualTreeTraversalType<RuleType>>(rules,
+          *queryTree, *referenceTree);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -669,6 +833,22 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       scores += rules.Scores();
       baseCases += rules.BaseCases();
 
+      Log::Info << rules.Scores() << " node combinations were scored."
+          << std::endl;
+      Log::Info << rules.BaseCases() << " base cases were calculated."
+          << std::endl;
+
+      rules.GetResults(*neighborPtr, *distancePtr);
+      break;
+    }
+    case BLOCK_SINGLE_TREE_MODE:
+    {
+      // Create the helper object for the tree traversal.
+      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+
+      // Traverse the reference tree once for each block of query points.
+      BlockSearch(rules, querySet.n_cols);
+
       Log::Info << rules.Scores() << " node combinations were scored."
           << std::endl;
       Log::Info << rules.BaseCases() << " base cases were calculated."
@@ -682,7 +862,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   Timer::Stop("computing_neighbors");
 
   // Map points back to original indices, if necessary.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
+  if (tree::TreeTraits<Tree>::RearrangesDataset ||
+      !oldFromNewReferences.empty())
   {
     if (searchMode == DUAL_TREE_MODE && !oldFromNewReferences.empty())
     {
@@ -757,11 +938,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::mat& distances,
     bool sameSet)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferences())
   {
     std::stringstream ss;
     ss << "requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferences() << ")";
     throw std::invalid_argument(ss.str());
   }
 
@@ -781,8 +962,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   // We won't need to map query indices, but will we need to map distances?
   arma::Mat<size_t>* neighborPtr = &neighbors;
 
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
     neighborPtr = new arma::Mat<size_t>;
 
   neighborPtr->set_size(k, querySet.n_cols);
@@ -792,9 +972,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, querySet, k, metric, epsilon, sameSet);
 
-  // Create the traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
-  traverser.Traverse(queryTree, *referenceTree);
+  // Traverse, splitting the query tree into parallel tasks if possible.
+  tree::ParallelDualTreeTraversal<DualTreeTraversalType<RuleType>>(rules,
+      queryTree, *referenceTree);
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
@@ -810,8 +990,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   Timer::Stop("computing_neighbors");
 
   // Do we need to map indices?
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
   {
     // We must map reference indices only.
     neighbors.set_size(k, querySet.n_cols);
@@ -840,14 +1019,21 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferences())
   {
     std::stringstream ss;
     ss << "requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferences() << ")";
     throw std::invalid_argument(ss.str());
   }
 
+  // The block traversal needs every point to be held by exactly one node.
+  if (searchMode == BLOCK_SINGLE_TREE_MODE &&
+      (tree::TreeTraits<Tree>::FirstPointIsCentroid ||
+       tree::IsSpillTree<Tree>::value))
+    throw std::invalid_argument("block single-tree search is not available "
+        "for this tree type");
+
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -856,8 +1042,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   arma::Mat<size_t>* neighborPtr = &neighbors;
   arma::mat* distancePtr = &distances;
 
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
   {
     // We will always need to rearrange in this case.
     distancePtr = new arma::mat;
@@ -880,9 +1065,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // The naive brute-force solution.
       for (size_t i = 0; i < referenceSet->n_cols; ++i)
         for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
+          if (HoldsReference(i) && HoldsReference(j))
+            rules.BaseCase(i, j);
 
-      baseCases += referenceSet->n_cols * referenceSet->n_cols;
+      baseCases += NumReferences() * NumReferences();
       break;
     }
     case SINGLE_TREE_MODE:
@@ -892,7 +1078,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       // Now have it traverse for each point.
       for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+        if (HoldsReference(i))
+          traverser.Traverse(i, *referenceTree);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -925,19 +1112,20 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
         }
       }
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
       if (tree::IsSpillTree<Tree>::value)
       {
         // For Dual Tree Search on SpillTree, the queryTree must be built with
         // non overlapping (tau = 0).
         Tree queryTree(*referenceSet);
-        traverser.Traverse(queryTree, *referenceTree);
+        tree::ParallelDualTreeTraversal<DualTreeTraversalType<RuleType>>(
+            rules, queryTree, *referenceTree);
       }
       else
       {
-        traverser.Traverse(*referenceTree, *referenceTree);
+        // The query subtrees handled by each task are disjoint, so this is
+        // safe even though the query and reference trees are the same.
+        tree::ParallelDualTreeTraversal<DualTreeTraversalType<RuleType>>(
+            rules, *referenceTree, *referenceTree);
         // Next time we perform this search, we'll need to reset the tree.
         treeNeedsReset = true;
       }
@@ -961,11 +1149,24 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
       // Now have it traverse for each point.
       for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+        if (HoldsReference(i))
+          traverser.Traverse(i, *referenceTree);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
 
+      Log::Info << rules.Scores() << " node combinations were scored."
+          << std::endl;
+      Log::Info << rules.BaseCases() << " base cases were calculated."
+          << std::endl;
+      break;
+    }
+    case BLOCK_SINGLE_TREE_MODE:
+    {
+      // Since the tree may have rearranged the points, consecutive points are
+      // usually close to each other, and so are the points of each block.
+      BlockSearch(rules, referenceSet->n_cols, true);
+
       Log::Info << rules.Scores() << " node combinations were scored."
           << std::endl;
       Log::Info << rules.BaseCases() << " base cases were calculated."
@@ -979,20 +1180,30 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   Timer::Stop("computing_neighbors");
 
   // Do we need to map the reference indices?
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
   {
-    neighbors.set_size(k, referenceSet->n_cols);
-    distances.set_size(k, referenceSet->n_cols);
+    // If points were removed, their columns are left empty.
+    const size_t numIndices = referenceColumns.empty() ?
+        referenceSet->n_cols : referenceColumns.size();
+    neighbors.set_size(k, numIndices);
+    distances.set_size(k, numIndices);
+    if (numIndices != NumReferences())
+    {
+      neighbors.fill(size_t() - 1);
+      distances.fill(SortPolicy::WorstDistance());
+    }
 
-    for (size_t i = 0; i < distances.n_cols; ++i)
+    for (size_t i = 0; i < distancePtr->n_cols; ++i)
     {
+      if (!HoldsReference(i))
+        continue;
+
       // Map distances (copy a column).
       const size_t refMapping = oldFromNewReferences[i];
       distances.col(refMapping) = distancePtr->col(i);
 
       // Map each neighbor's index.
-      for (size_t j = 0; j < distances.n_rows; ++j)
+      for (size_t j = 0; j < distancePtr->n_rows; ++j)
         neighbors(j, refMapping) = oldFromNewReferences[(*neighborPtr)(j, i)];
     }
 
@@ -1002,6 +1213,44 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::BlockSearch(
+    RuleType& rules,
+    const size_t numQueries,
+    const bool referenceQueries)
+{
+  tree::BlockSingleTreeTraverser<Tree, RuleType> traverser(rules);
+
+  arma::uvec block;
+  for (size_t begin = 0; begin < numQueries; begin += QueryBlockSize)
+  {
+    const size_t end = std::min(begin + QueryBlockSize, numQueries);
+    block.set_size(end - begin);
+    size_t blockSize = 0;
+    for (size_t i = begin; i < end; ++i)
+      if (!referenceQueries || HoldsReference(i))
+        block[blockSize++] = i;
+
+    if (blockSize == 0)
+      continue;
+    block.resize(blockSize);
+
+    traverser.Traverse(block, *referenceTree);
+  }
+
+  scores += rules.Scores();
+  baseCases += rules.BaseCases();
+}
+
 //! Calculate the average relative error.
 template<typename SortPolicy,
          typename MetricType,
@@ -1084,7 +1333,7 @@ template<typename Archive>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::serialize(
     Archive& ar,
-    const unsigned int /* version */)
+    const unsigned int version)
 {
   // Serialize preferences for search.
   ar & BOOST_SERIALIZATION_NVP(searchMode);
@@ -1145,6 +1394,20 @@ DualTreeTraversalType, SingleTreeTraversalType>::serialize(
     }
   }
 
+  // Older models could not have points inserted or removed.
+  if (version > 0)
+  {
+    if (searchMode == NAIVE_MODE)
+      ar & BOOST_SERIALIZATION_NVP(oldFromNewReferences);
+    ar & BOOST_SERIALIZATION_NVP(referenceColumns);
+    ar & BOOST_SERIALIZATION_NVP(freeReferenceColumns);
+  }
+  else if (Archive::is_loading::value)
+  {
+    referenceColumns.clear();
+    freeReferenceColumns.clear();
+  }
+
   // Reset base cases and scores.
   if (Archive::is_loading::value)
   {
@@ -14,8 +14,10 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/pairwise_distances.hpp>
 
 #include <queue>
+#include <memory>
 
 namespace mlpack {
 namespace neighbor {
@@ -27,6 +29,10 @@ namespace neighbor {
  * reference dataset which have the 'best' distance according to a given sorting
  * policy.
  *
+ * Copies of a NeighborSearchRules object share the same candidate lists, but
+ * keep their own traversal information and statistics.  This allows several
+ * copies to be used at once by traversals of disjoint query subtrees.
+ *
  * @tparam SortPolicy The sort policy for distances.
  * @tparam MetricType The metric to use for computation.
  * @tparam TreeType The tree type to use; must adhere to the TreeType API.
@@ -73,6 +79,21 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between each of the given query points and each of
+   * the points held in the given reference node, and update the lists of
+   * candidates.  The distances are computed as one block with
+   * metric::PairwiseDistances(), which is much faster than separate calls to
+   * BaseCase() for the Euclidean distance.  Pairs that may enter a candidate
+   * list are evaluated again with the metric, so the results are the same as
+   * with BaseCase().  This is used by the tree::BlockSingleTreeTraverser and
+   * by tree::LeafBaseCases().
+   *
+   * @param queryIndices Indices of query points.
+   * @param referenceNode Node holding the reference points.
+   */
+  void BaseCase(const arma::uvec& queryIndices, TreeType& referenceNode);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -179,8 +200,18 @@ class NeighborSearchRules
   typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
       CandidateList;
 
-  //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  //! The element type of the datasets.
+  typedef typename TreeType::Mat::elem_type ElemType;
+
+  //! Per-point values of the datasets reused by the block BaseCase(), computed
+  //! by its first call and shared by copies of the rules; see
+  //! metric::PairwiseDistanceNorms().
+  std::shared_ptr<metric::PairwiseDistanceNormCache<ElemType>> norms;
+
+  //! Set of candidate neighbors for each point.  This is shared by copies of
+  //! the rules, so that each task of a parallel traversal can hold its own
+  //! copy (see tree::ParallelDualTreeTraversal()).
+  std::shared_ptr<std::vector<CandidateList>> candidates;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -29,6 +29,7 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
     const bool sameSet) :
     referenceSet(referenceSet),
     querySet(querySet),
+    candidates(new std::vector<CandidateList>()),
     k(k),
     metric(metric),
     sameSet(sameSet),
@@ -54,9 +55,13 @@ NeighborSearchRules<SortPolicy, MetricType, TreeType>::NeighborSearchRules(
   std::vector<Candidate> vect(k, def);
   CandidateList pqueue(CandidateCmp(), std::move(vect));
 
-  candidates.reserve(querySet.n_cols);
+  candidates->reserve(querySet.n_cols);
   for (size_t i = 0; i < querySet.n_cols; i++)
-    candidates.push_back(pqueue);
+    candidates->push_back(pqueue);
+
+  // The values reused by the block base cases are only computed if there are
+  // any block base cases.
+  norms.reset(new metric::PairwiseDistanceNormCache<ElemType>());
 }
 
 template<typename SortPolicy, typename MetricType, typename TreeType>
@@ -69,7 +74,7 @@ void NeighborSearchRules<SortPolicy, MetricType, TreeType>::GetResults(
 
   for (size_t i = 0; i < querySet.n_cols; i++)
   {
-    CandidateList& pqueue = candidates[i];
+    CandidateList& pqueue = (*candidates)[i];
     for (size_t j = 1; j <= k; j++)
     {
       neighbors(k - j, i) = pqueue.top().second;
@@ -107,6 +112,55 @@ BaseCase(const size_t queryIndex, const size_t referenceIndex)
   return distance;
 }
 
+template<typename SortPolicy, typename MetricType, typename TreeType>
+void NeighborSearchRules<SortPolicy, MetricType, TreeType>::BaseCase(
+    const arma::uvec& queryIndices,
+    TreeType& referenceNode)
+{
+  arma::uvec referenceIndices(referenceNode.NumPoints());
+  for (size_t i = 0; i < referenceIndices.n_elem; ++i)
+    referenceIndices[i] = referenceNode.Point(i);
+
+  if (queryIndices.n_elem == 0 || referenceIndices.n_elem == 0)
+    return;
+
+  norms->Compute(metric, querySet, referenceSet);
+  arma::Mat<ElemType> blockDistances;
+  const double error = metric::PairwiseDistances(metric, querySet,
+      queryIndices, norms->QueryNorms(), referenceSet, referenceIndices,
+      norms->ReferenceNorms(), blockDistances);
+  baseCases += queryIndices.n_elem * referenceIndices.n_elem;
+
+  for (size_t j = 0; j < referenceIndices.n_elem; ++j)
+  {
+    const size_t referenceIndex = referenceIndices[j];
+    for (size_t i = 0; i < queryIndices.n_elem; ++i)
+    {
+      const size_t queryIndex = queryIndices[i];
+
+      // Don't return a query point as its own neighbor.
+      if (sameSet && (queryIndex == referenceIndex))
+        continue;
+
+      double distance = blockDistances(i, j);
+      if (error > 0.0)
+      {
+        // Skip the pair if even the best distance it could have can't enter
+        // the candidate list; otherwise, get the exact distance.
+        const double bestDistance = SortPolicy::CombineBest(distance, error);
+        if (SortPolicy::IsBetter((*candidates)[queryIndex].top().first,
+            bestDistance))
+          continue;
+
+        distance = metric.Evaluate(querySet.col(queryIndex),
+                                   referenceSet.col(referenceIndex));
+      }
+
+      InsertNeighbor(queryIndex, referenceIndex, distance);
+    }
+  }
+}
+
 template<typename SortPolicy, typename MetricType, typename TreeType>
 inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
     const size_t queryIndex,
@@ -143,7 +197,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Score(
   }
 
   // Compare against the best k'th distance for this query point so far.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = (*candidates)[queryIndex].top().first;
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ?
@@ -179,7 +233,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::Rescore(
   const double distance = SortPolicy::ConvertToDistance(oldScore);
 
   // Just check the score again against the distances.
-  double bestDistance = candidates[queryIndex].top().first;
+  double bestDistance = (*candidates)[queryIndex].top().first;
   bestDistance = SortPolicy::Relax(bestDistance, epsilon);
 
   return (SortPolicy::IsBetter(distance, bestDistance)) ? oldScore : DBL_MAX;
@@ -404,7 +458,7 @@ inline double NeighborSearchRules<SortPolicy, MetricType, TreeType>::
   // Loop over points held in the node.
   for (size_t i = 0; i < queryNode.NumPoints(); ++i)
   {
-    const double distance = candidates[queryNode.Point(i)].top().first;
+    const double distance = (*candidates)[queryNode.Point(i)].top().first;
     if (SortPolicy::IsBetter(worstDistance, distance))
       worstDistance = distance;
     if (SortPolicy::IsBetter(distance, bestPointDistance))
@@ -499,7 +553,7 @@ InsertNeighbor(
     const size_t neighbor,
     const double distance)
 {
-  CandidateList& pqueue = candidates[queryIndex];
+  CandidateList& pqueue = (*candidates)[queryIndex];
   Candidate c = std::make_pair(distance, neighbor);
 
   if (CandidateCmp()(c, pqueue.top()))
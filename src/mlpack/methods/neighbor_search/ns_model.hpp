@@ -27,19 +27,21 @@ namespace mlpack {
 namespace neighbor {
 
 /**
- * Alias template for euclidean neighbor search.
+ * Alias template for euclidean neighbor search.  MatType may be arma::mat or
+ * arma::fmat.
  */
 template<typename SortPolicy,
          template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType>
+                  typename TreeMatType> class TreeType,
+         typename MatType = arma::mat>
 using NSType = NeighborSearch<SortPolicy,
                               metric::EuclideanDistance,
-                              arma::mat,
+                              MatType,
                               TreeType,
                               TreeType<metric::EuclideanDistance,
                                   NeighborSearchStat<SortPolicy>,
-                                  arma::mat>::template DualTreeTraverser>;
+                                  MatType>::template DualTreeTraverser>;
 
 template<typename SortPolicy>
 struct NSModelName
@@ -93,13 +95,15 @@ class MonoSearchVisitor : public boost::static_visitor<void>
  * We use template specialization to differentiate those tree types that
  * accept leafSize as a parameter. In these cases, before doing neighbor search,
  * a query tree with proper leafSize is built from the querySet.
+ *
+ * @tparam MatType The type of the query set; it must match the NSType.
  */
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType = arma::mat>
 class BiSearchVisitor : public boost::static_visitor<void>
 {
  private:
   //! The query set for the bichromatic search.
-  const arma::mat& querySet;
+  const MatType& querySet;
   //! The number of neighbors to search for.
   const size_t k;
   //! The result matrix for neighbors.
@@ -122,7 +126,10 @@ class BiSearchVisitor : public boost::static_visitor<void>
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
-  using NSTypeT = NSType<SortPolicy, TreeType>;
+  using NSTypeT = NSType<SortPolicy, TreeType, MatType>;
+
+  //! The spill tree search type (which always uses defeatist traversals).
+  typedef DefeatistKNN<tree::SPTree, MatType> SpillType;
 
   //! Default Bichromatic neighbor search on the given NSType instance.
   template<template<typename TreeMetricType,
@@ -137,13 +144,13 @@ class BiSearchVisitor : public boost::static_visitor<void>
   void operator()(NSTypeT<tree::BallTree>* ns) const;
 
   //! Bichromatic neighbor search specialized for SPTrees.
-  void operator()(SpillKNN* ns) const;
+  void operator()(SpillType* ns) const;
 
   //! Bichromatic neighbor search specialized for octrees.
   void operator()(NSTypeT<tree::Octree>* ns) const;
 
   //! Construct the BiSearchVisitor.
-  BiSearchVisitor(const arma::mat& querySet,
+  BiSearchVisitor(const MatType& querySet,
                   const size_t k,
                   arma::Mat<size_t>& neighbors,
                   arma::mat& distances,
@@ -157,13 +164,15 @@ class BiSearchVisitor : public boost::static_visitor<void>
  * NSType. We use template specialization to differentiate those tree types that
  * accept leafSize as a parameter. In these cases, a reference tree with proper
  * leafSize is built from the referenceSet.
+ *
+ * @tparam MatType The type of the reference set; it must match the NSType.
  */
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType = arma::mat>
 class TrainVisitor : public boost::static_visitor<void>
 {
  private:
   //! The reference set to use for training.
-  arma::mat&& referenceSet;
+  MatType&& referenceSet;
   //! The leaf size, used only by BinarySpaceTree.
   size_t leafSize;
   //! Overlapping size (for spill trees).
@@ -180,7 +189,10 @@ class TrainVisitor : public boost::static_visitor<void>
   template<template<typename TreeMetricType,
                     typename TreeStatType,
                     typename TreeMatType> class TreeType>
-  using NSTypeT = NSType<SortPolicy, TreeType>;
+  using NSTypeT = NSType<SortPolicy, TreeType, MatType>;
+
+  //! The spill tree search type (which always uses defeatist traversals).
+  typedef DefeatistKNN<tree::SPTree, MatType> SpillType;
 
   //! Default Train on the given NSType instance.
   template<template<typename TreeMetricType,
@@ -195,14 +207,14 @@ class TrainVisitor : public boost::static_visitor<void>
   void operator()(NSTypeT<tree::BallTree>* ns) const;
 
   //! Train specialized for SPTrees.
-  void operator()(SpillKNN* ns) const;
+  void operator()(SpillType* ns) const;
 
   //! Train specialized for octrees.
   void operator()(NSTypeT<tree::Octree>* ns) const;
 
   //! Construct the TrainVisitor object with the given reference set, leafSize
   //! for BinarySpaceTrees, and tau and rho for spill trees.
-  TrainVisitor(arma::mat&& referenceSet,
+  TrainVisitor(MatType&& referenceSet,
                const size_t leafSize,
                const double tau,
                const double rho);
@@ -232,13 +244,16 @@ class EpsilonVisitor : public boost::static_visitor<double&>
 
 /**
  * ReferenceSetVisitor exposes the referenceSet of the given NSType.
+ *
+ * @tparam MatType The type of the reference set; it must match the NSType.
  */
-class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
+template<typename MatType = arma::mat>
+class ReferenceSetVisitor : public boost::static_visitor<const MatType&>
 {
  public:
   //! Return the reference set.
   template<typename NSType>
-  const arma::mat& operator()(NSType *ns) const;
+  const MatType& operator()(NSType *ns) const;
 };
 
 /**
@@ -260,6 +275,11 @@ class DeleteVisitor : public boost::static_visitor<void>
  * flexibility as the NeighborSearch class.  So if you are using it outside of
  * mlpack_knn and mlpack_kfn, be aware that it is limited!
  *
+ * The model holds its reference set (and builds its trees) either in double
+ * precision (arma::mat) or in single precision (arma::fmat); the choice is made
+ * by the type of the reference set given to BuildModel().  Query sets of either
+ * type are converted to the precision of the model.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  */
 template<typename SortPolicy>
@@ -324,6 +344,59 @@ class NSModel
                  NSType<SortPolicy, tree::UBTree>*,
                  NSType<SortPolicy, tree::Octree>*> nSearch;
 
+  //! If true, the model is stored in nSearchFloat instead of nSearch.
+  bool singlePrecision;
+
+  /**
+   * nSearchFloat holds the single-precision instance of the NeighborSearch
+   * class for the current treeType, if the model was built on an arma::fmat.
+   */
+  boost::variant<NSType<SortPolicy, tree::KDTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::StandardCoverTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::RTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::RStarTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::BallTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::XTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::HilbertRTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::RPlusTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::RPlusPlusTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::VPTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::RPTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::MaxRPTree, arma::fmat>*,
+                 DefeatistKNN<tree::SPTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::UBTree, arma::fmat>*,
+                 NSType<SortPolicy, tree::Octree, arma::fmat>*> nSearchFloat;
+
+  //! Select the variant that holds models built on the given matrix type.
+  const decltype(nSearch)& Models(const arma::mat*) const { return nSearch; }
+  //! Select the variant that holds models built on the given matrix type.
+  const decltype(nSearchFloat)& Models(const arma::fmat*) const
+  { return nSearchFloat; }
+
+  /**
+   * Build the model on the given reference set (which is taken) and store it
+   * in the given variant (nSearch or nSearchFloat).
+   */
+  template<typename MatType, typename VariantType>
+  void BuildSearch(MatType& referenceSet,
+                   const NeighborSearchMode searchMode,
+                   const double epsilon,
+                   VariantType& search);
+
+  /**
+   * Perform bichromatic search with the model stored in the given variant; the
+   * query set must have the precision of the model, and it will be reordered.
+   */
+  template<typename MatType, typename VariantType>
+  void SearchWith(MatType& querySet,
+                  const size_t k,
+                  arma::Mat<size_t>& neighbors,
+                  arma::mat& distances,
+                  VariantType& search);
+
+  //! Print which kind of search is about to be done.
+  void LogSearch(const size_t k) const;
+
  public:
   /**
    * Initialize the NSModel with the given type and whether or not a random
@@ -370,8 +443,13 @@ class NSModel
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int /* version */);
 
-  //! Expose the dataset.
-  const arma::mat& Dataset() const;
+  //! Expose the dataset.  MatType must be arma::fmat if the model is single
+  //! precision, and arma::mat otherwise.
+  template<typename MatType = arma::mat>
+  const MatType& Dataset() const;
+
+  //! Return whether the model is stored in single precision.
+  bool SinglePrecision() const { return singlePrecision; }
 
   //! Expose SearchMode.
   NeighborSearchMode SearchMode() const;
@@ -401,18 +479,31 @@ class NSModel
   bool RandomBasis() const { return randomBasis; }
   bool& RandomBasis() { return randomBasis; }
 
-  //! Build the reference tree.
+  //! Build the reference tree in double precision.
   void BuildModel(arma::mat&& referenceSet,
                   const size_t leafSize,
                   const NeighborSearchMode searchMode,
                   const double epsilon = 0);
 
+  //! Build the reference tree in single precision.
+  void BuildModel(arma::fmat&& referenceSet,
+                  const size_t leafSize,
+                  const NeighborSearchMode searchMode,
+                  const double epsilon = 0);
+
   //! Perform neighbor search.  The query set will be reordered.
   void Search(arma::mat&& querySet,
               const size_t k,
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  //! Perform neighbor search with a single-precision query set.  The query set
+  //! will be reordered.
+  void Search(arma::fmat&& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
   //! Perform monochromatic neighbor search.
   void Search(const size_t k,
               arma::Mat<size_t>& neighbors,
@@ -427,7 +518,7 @@ class NSModel
 
 //! Set the serialization version of the NSModel class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::NSModel<SortPolicy>, 1);
+    mlpack::neighbor::NSModel<SortPolicy>, 2);
 
 // Include implementation.
 #include "ns_model_impl.hpp"
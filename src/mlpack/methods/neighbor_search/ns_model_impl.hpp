@@ -33,14 +33,15 @@ void MonoSearchVisitor::operator()(NSType *ns) const
 }
 
 //! Save parameters for bichromatic neighbor search.
-template<typename SortPolicy>
-BiSearchVisitor<SortPolicy>::BiSearchVisitor(const arma::mat& querySet,
-                                             const size_t k,
-                                             arma::Mat<size_t>& neighbors,
-                                             arma::mat& distances,
-                                             const size_t leafSize,
-                                             const double tau,
-                                             const double rho) :
+template<typename SortPolicy, typename MatType>
+BiSearchVisitor<SortPolicy, MatType>::BiSearchVisitor(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    const size_t leafSize,
+    const double tau,
+    const double rho) :
     querySet(querySet),
     k(k),
     neighbors(neighbors),
@@ -51,11 +52,11 @@ BiSearchVisitor<SortPolicy>::BiSearchVisitor(const arma::mat& querySet,
 {}
 
 //! Default Bichromatic neighbor search on the given NSType instance.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
+void BiSearchVisitor<SortPolicy, MatType>::operator()(NSTypeT<TreeType>* ns) const
 {
   if (ns)
     return ns->Search(querySet, k, neighbors, distances);
@@ -63,8 +64,9 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
 }
 
 //! Bichromatic neighbor search on the given NSType specialized for KDTrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::KDTree>* ns) const
 {
   if (ns)
     return SearchLeaf(ns);
@@ -72,8 +74,9 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
 }
 
 //! Bichromatic neighbor search on the given NSType specialized for BallTrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::BallTree>* ns) const
 {
   if (ns)
     return SearchLeaf(ns);
@@ -81,8 +84,8 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
 }
 
 //! Bichromatic neighbor search specialized for SPTrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(SpillKNN* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(SpillType* ns) const
 {
   if (ns)
   {
@@ -90,7 +93,7 @@ void BiSearchVisitor<SortPolicy>::operator()(SpillKNN* ns) const
     {
       // For Dual Tree Search on SpillTrees, the queryTree must be built with
       // non overlapping (tau = 0).
-      typename SpillKNN::Tree queryTree(std::move(querySet), 0 /* tau*/,
+      typename SpillType::Tree queryTree(std::move(querySet), 0 /* tau*/,
           leafSize, rho);
       ns->Search(queryTree, k, neighbors, distances);
     }
@@ -102,8 +105,9 @@ void BiSearchVisitor<SortPolicy>::operator()(SpillKNN* ns) const
 }
 
 //! Bichromatic neighbor search specialized for octrees.
-template<typename SortPolicy>
-void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
+template<typename SortPolicy, typename MatType>
+void BiSearchVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::Octree>* ns) const
 {
   if (ns)
     return SearchLeaf(ns);
@@ -111,9 +115,9 @@ void BiSearchVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
 }
 
 //! Bichromatic neighbor search on the given NSType considering the leafSize.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<typename NSType>
-void BiSearchVisitor<SortPolicy>::SearchLeaf(NSType* ns) const
+void BiSearchVisitor<SortPolicy, MatType>::SearchLeaf(NSType* ns) const
 {
   if (ns->SearchMode() == DUAL_TREE_MODE)
   {
@@ -139,11 +143,11 @@ void BiSearchVisitor<SortPolicy>::SearchLeaf(NSType* ns) const
 }
 
 //! Save parameters for Train.
-template<typename SortPolicy>
-TrainVisitor<SortPolicy>::TrainVisitor(arma::mat&& referenceSet,
-                                       const size_t leafSize,
-                                       const double tau,
-                                       const double rho) :
+template<typename SortPolicy, typename MatType>
+TrainVisitor<SortPolicy, MatType>::TrainVisitor(MatType&& referenceSet,
+                                                const size_t leafSize,
+                                                const double tau,
+                                                const double rho) :
     referenceSet(std::move(referenceSet)),
     leafSize(leafSize),
     tau(tau),
@@ -151,11 +155,11 @@ TrainVisitor<SortPolicy>::TrainVisitor(arma::mat&& referenceSet,
 {}
 
 //! Default Train on the given NSType instance.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
+void TrainVisitor<SortPolicy, MatType>::operator()(NSTypeT<TreeType>* ns) const
 {
   if (ns)
     return ns->Train(std::move(referenceSet));
@@ -163,8 +167,9 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<TreeType>* ns) const
 }
 
 //! Train on the given NSType specialized for KDTrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::KDTree>* ns) const
 {
   if (ns)
     return TrainLeaf(ns);
@@ -172,8 +177,9 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::KDTree>* ns) const
 }
 
 //! Train on the given NSType specialized for BallTrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::BallTree>* ns) const
 {
   if (ns)
     return TrainLeaf(ns);
@@ -181,8 +187,8 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::BallTree>* ns) const
 }
 
 //! Train specialized for SPTrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(SpillKNN* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(SpillType* ns) const
 {
   if (ns)
   {
@@ -190,7 +196,7 @@ void TrainVisitor<SortPolicy>::operator()(SpillKNN* ns) const
       ns->Train(std::move(referenceSet));
     else
     {
-      typename SpillKNN::Tree tree(std::move(referenceSet), tau, leafSize, rho);
+      typename SpillType::Tree tree(std::move(referenceSet), tau, leafSize, rho);
       ns->Train(std::move(tree));
     }
   }
@@ -199,8 +205,9 @@ void TrainVisitor<SortPolicy>::operator()(SpillKNN* ns) const
 }
 
 //! Train specialized for Octrees.
-template<typename SortPolicy>
-void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
+template<typename SortPolicy, typename MatType>
+void TrainVisitor<SortPolicy, MatType>::operator()(
+    NSTypeT<tree::Octree>* ns) const
 {
   if (ns)
     return TrainLeaf(ns);
@@ -208,9 +215,9 @@ void TrainVisitor<SortPolicy>::operator()(NSTypeT<tree::Octree>* ns) const
 }
 
 //! Train on the given NSType considering the leafSize.
-template<typename SortPolicy>
+template<typename SortPolicy, typename MatType>
 template<typename NSType>
-void TrainVisitor<SortPolicy>::TrainLeaf(NSType* ns) const
+void TrainVisitor<SortPolicy, MatType>::TrainLeaf(NSType* ns) const
 {
   if (ns->SearchMode() == NAIVE_MODE)
     ns->Train(std::move(referenceSet));
@@ -244,8 +251,9 @@ double& EpsilonVisitor::operator()(NSType* ns) const
 }
 
 //! Expose the referenceSet of the given NSType.
+template<typename MatType>
 template<typename NSType>
-const arma::mat& ReferenceSetVisitor::operator()(NSType* ns) const
+const MatType& ReferenceSetVisitor<MatType>::operator()(NSType* ns) const
 {
   if (ns)
     return ns->ReferenceSet();
@@ -270,7 +278,8 @@ NSModel<SortPolicy>::NSModel(TreeTypes treeType, bool randomBasis) :
     leafSize(20),
     tau(0),
     rho(0.7),
-    randomBasis(randomBasis)
+    randomBasis(randomBasis),
+    singlePrecision(false)
 {
   // Nothing to do.
 }
@@ -283,7 +292,9 @@ NSModel<SortPolicy>::NSModel(const NSModel& other) :
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(other.q),
-    nSearch(other.nSearch)
+    nSearch(other.nSearch),
+    singlePrecision(other.singlePrecision),
+    nSearchFloat(other.nSearchFloat)
 {
   // Nothing to do.
 }
@@ -296,7 +307,9 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(std::move(other.q)),
-    nSearch(other.nSearch)
+    nSearch(other.nSearch),
+    singlePrecision(other.singlePrecision),
+    nSearchFloat(other.nSearchFloat)
 {
   // Reset parameters of the other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -305,12 +318,15 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
   other.rho = 0.7;
   other.randomBasis = false;
   other.nSearch = decltype(other.nSearch)();
+  other.singlePrecision = false;
+  other.nSearchFloat = decltype(other.nSearchFloat)();
 }
 
 template<typename SortPolicy>
 NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
 {
   boost::apply_visitor(DeleteVisitor(), nSearch);
+  boost::apply_visitor(DeleteVisitor(), nSearchFloat);
 
   treeType = other.treeType;
   leafSize = other.leafSize;
@@ -319,6 +335,8 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
   randomBasis = other.randomBasis;
   q = other.q;
   nSearch = other.nSearch;
+  singlePrecision = other.singlePrecision;
+  nSearchFloat = other.nSearchFloat;
 
   return *this;
 }
@@ -327,6 +345,7 @@ template<typename SortPolicy>
 NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
 {
   boost::apply_visitor(DeleteVisitor(), nSearch);
+  boost::apply_visitor(DeleteVisitor(), nSearchFloat);
 
   treeType = other.treeType;
   leafSize = other.leafSize;
@@ -334,8 +353,10 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   rho = other.rho;
   randomBasis = other.randomBasis;
   q = std::move(other.q);
-  // Copy the pointer and type.
+  // Copy the pointers and types.
   nSearch = other.nSearch;
+  singlePrecision = other.singlePrecision;
+  nSearchFloat = other.nSearchFloat;
 
   // Reset parameters of the other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -344,6 +365,8 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   other.rho = 0.7;
   other.randomBasis = false;
   other.nSearch = decltype(other.nSearch)();
+  other.singlePrecision = false;
+  other.nSearchFloat = decltype(other.nSearchFloat)();
 
   return *this;
 }
@@ -353,6 +376,7 @@ template<typename SortPolicy>
 NSModel<SortPolicy>::~NSModel()
 {
   boost::apply_visitor(DeleteVisitor(), nSearch);
+  boost::apply_visitor(DeleteVisitor(), nSearchFloat);
 }
 
 /**
@@ -362,6 +386,7 @@ NSModel<SortPolicy>::~NSModel()
  */
 template<typename Archive,
          typename SortPolicy,
+         typename MatType,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType,
@@ -371,7 +396,7 @@ void serialize(
     Archive& ar,
     NeighborSearch<SortPolicy,
                    metric::EuclideanDistance,
-                   arma::mat,
+                   MatType,
                    TreeType,
                    TraversalType,
                    SingleTreeTraversalType>& ns,
@@ -397,48 +422,78 @@ void NSModel<SortPolicy>::serialize(Archive& ar, const unsigned int version)
   ar & BOOST_SERIALIZATION_NVP(randomBasis);
   ar & BOOST_SERIALIZATION_NVP(q);
 
+  // Older versions of NSModel were always double precision.
+  if (version > 1)
+    ar & BOOST_SERIALIZATION_NVP(singlePrecision);
+  else if (Archive::is_loading::value)
+    singlePrecision = false;
+
   // This should never happen, but just in case, be clean with memory.
   if (Archive::is_loading::value)
+  {
     boost::apply_visitor(DeleteVisitor(), nSearch);
+    boost::apply_visitor(DeleteVisitor(), nSearchFloat);
+    nSearch = decltype(nSearch)();
+    nSearchFloat = decltype(nSearchFloat)();
+  }
 
   //const std::string& name = NSModelName<SortPolicy>::Name();
-  ar & BOOST_SERIALIZATION_NVP(nSearch);
+  if (singlePrecision)
+    ar & BOOST_SERIALIZATION_NVP(nSearchFloat);
+  else
+    ar & BOOST_SERIALIZATION_NVP(nSearch);
 }
 
 //! Expose the dataset.
 template<typename SortPolicy>
-const arma::mat& NSModel<SortPolicy>::Dataset() const
+template<typename MatType>
+const MatType& NSModel<SortPolicy>::Dataset() const
 {
-  return boost::apply_visitor(ReferenceSetVisitor(), nSearch);
+  if (singlePrecision != std::is_same<MatType, arma::fmat>::value)
+  {
+    throw std::invalid_argument(std::string("the model is stored in ") +
+        (singlePrecision ? "single" : "double") + " precision");
+  }
+
+  return boost::apply_visitor(ReferenceSetVisitor<MatType>(),
+      Models((const MatType*) NULL));
 }
 
 //! Access the search mode.
 template<typename SortPolicy>
 NeighborSearchMode NSModel<SortPolicy>::SearchMode() const
 {
-  return boost::apply_visitor(SearchModeVisitor(), nSearch);
+  return singlePrecision ?
+      boost::apply_visitor(SearchModeVisitor(), nSearchFloat) :
+      boost::apply_visitor(SearchModeVisitor(), nSearch);
 }
 
 //! Modify the search mode.
 template<typename SortPolicy>
 NeighborSearchMode& NSModel<SortPolicy>::SearchMode()
 {
-  return boost::apply_visitor(SearchModeVisitor(), nSearch);
+  return singlePrecision ?
+      boost::apply_visitor(SearchModeVisitor(), nSearchFloat) :
+      boost::apply_visitor(SearchModeVisitor(), nSearch);
 }
 
 template<typename SortPolicy>
 double NSModel<SortPolicy>::Epsilon() const
 {
-  return boost::apply_visitor(EpsilonVisitor(), nSearch);
+  return singlePrecision ?
+      boost::apply_visitor(EpsilonVisitor(), nSearchFloat) :
+      boost::apply_visitor(EpsilonVisitor(), nSearch);
 }
 
 template<typename SortPolicy>
 double& NSModel<SortPolicy>::Epsilon()
 {
-  return boost::apply_visitor(EpsilonVisitor(), nSearch);
+  return singlePrecision ?
+      boost::apply_visitor(EpsilonVisitor(), nSearchFloat) :
+      boost::apply_visitor(EpsilonVisitor(), nSearch);
 }
 
-//! Build the reference tree.
+//! Build the reference tree in double precision.
 template<typename SortPolicy>
 void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
                                      const size_t leafSize,
@@ -446,6 +501,28 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
                                      const double epsilon)
 {
   this->leafSize = leafSize;
+  BuildSearch(referenceSet, searchMode, epsilon, nSearch);
+}
+
+//! Build the reference tree in single precision.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::BuildModel(arma::fmat&& referenceSet,
+                                     const size_t leafSize,
+                                     const NeighborSearchMode searchMode,
+                                     const double epsilon)
+{
+  this->leafSize = leafSize;
+  BuildSearch(referenceSet, searchMode, epsilon, nSearchFloat);
+}
+
+//! Build the model and store it in the given variant.
+template<typename SortPolicy>
+template<typename MatType, typename VariantType>
+void NSModel<SortPolicy>::BuildSearch(MatType& referenceSet,
+                                      const NeighborSearchMode searchMode,
+                                      const double epsilon,
+                                      VariantType& search)
+{
   // Initialize random basis if necessary.
   if (randomBasis)
   {
@@ -478,12 +555,16 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
     }
   }
 
-  // Clean memory, if necessary.
+  // Clean memory, if necessary.  Only one of the two variants holds a model.
   boost::apply_visitor(DeleteVisitor(), nSearch);
+  boost::apply_visitor(DeleteVisitor(), nSearchFloat);
+  nSearch = decltype(nSearch)();
+  nSearchFloat = decltype(nSearchFloat)();
+  singlePrecision = std::is_same<MatType, arma::fmat>::value;
 
   // Do we need to modify the reference set?
   if (randomBasis)
-    referenceSet = q * referenceSet;
+    referenceSet = arma::conv_to<MatType>::from(q) * referenceSet;
 
   if (searchMode != NAIVE_MODE)
   {
@@ -494,56 +575,69 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   switch (treeType)
   {
     case KD_TREE:
-      nSearch = new NSType<SortPolicy, tree::KDTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::KDTree, MatType>(searchMode,
+          epsilon);
       break;
     case COVER_TREE:
-      nSearch = new NSType<SortPolicy, tree::StandardCoverTree>(searchMode,
-          epsilon);
+      search = new NSType<SortPolicy, tree::StandardCoverTree, MatType>(
+          searchMode, epsilon);
       break;
     case R_TREE:
-      nSearch = new NSType<SortPolicy, tree::RTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::RTree, MatType>(searchMode,
+          epsilon);
       break;
     case R_STAR_TREE:
-      nSearch = new NSType<SortPolicy, tree::RStarTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::RStarTree, MatType>(searchMode,
+          epsilon);
       break;
     case BALL_TREE:
-      nSearch = new NSType<SortPolicy, tree::BallTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::BallTree, MatType>(searchMode,
+          epsilon);
       break;
     case X_TREE:
-      nSearch = new NSType<SortPolicy, tree::XTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::XTree, MatType>(searchMode,
+          epsilon);
       break;
     case HILBERT_R_TREE:
-      nSearch = new NSType<SortPolicy, tree::HilbertRTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::HilbertRTree, MatType>(searchMode,
+          epsilon);
       break;
     case R_PLUS_TREE:
-      nSearch = new NSType<SortPolicy, tree::RPlusTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::RPlusTree, MatType>(searchMode,
+          epsilon);
       break;
     case R_PLUS_PLUS_TREE:
-      nSearch = new NSType<SortPolicy, tree::RPlusPlusTree>(searchMode,
-          epsilon);
+      search = new NSType<SortPolicy, tree::RPlusPlusTree, MatType>(
+          searchMode, epsilon);
       break;
     case VP_TREE:
-      nSearch = new NSType<SortPolicy, tree::VPTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::VPTree, MatType>(searchMode,
+          epsilon);
       break;
     case RP_TREE:
-      nSearch = new NSType<SortPolicy, tree::RPTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::RPTree, MatType>(searchMode,
+          epsilon);
       break;
     case MAX_RP_TREE:
-      nSearch = new NSType<SortPolicy, tree::MaxRPTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::MaxRPTree, MatType>(searchMode,
+          epsilon);
       break;
     case SPILL_TREE:
-      nSearch = new SpillKNN(searchMode, epsilon);
+      search = new DefeatistKNN<tree::SPTree, MatType>(searchMode, epsilon);
       break;
     case UB_TREE:
-      nSearch = new NSType<SortPolicy, tree::UBTree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::UBTree, MatType>(searchMode,
+          epsilon);
       break;
     case OCTREE:
-      nSearch = new NSType<SortPolicy, tree::Octree>(searchMode, epsilon);
+      search = new NSType<SortPolicy, tree::Octree, MatType>(searchMode,
+          epsilon);
       break;
   }
 
-  TrainVisitor<SortPolicy> tn(std::move(referenceSet), leafSize, tau, rho);
-  boost::apply_visitor(tn, nSearch);
+  TrainVisitor<SortPolicy, MatType> tn(std::move(referenceSet), leafSize, tau,
+      rho);
+  boost::apply_visitor(tn, search);
 
   if (searchMode != NAIVE_MODE)
   {
@@ -559,32 +653,56 @@ void NSModel<SortPolicy>::Search(arma::mat&& querySet,
                                  arma::Mat<size_t>& neighbors,
                                  arma::mat& distances)
 {
-  // We may need to map the query set randomly.
-  if (randomBasis)
-    querySet = q * querySet;
-
-  Log::Info << "Searching for " << k << " neighbors with ";
+  if (singlePrecision)
+  {
+    arma::fmat floatQuerySet = arma::conv_to<arma::fmat>::from(querySet);
+    querySet.reset();
+    SearchWith(floatQuerySet, k, neighbors, distances, nSearchFloat);
+  }
+  else
+  {
+    SearchWith(querySet, k, neighbors, distances, nSearch);
+  }
+}
 
-  switch (SearchMode())
+//! Perform neighbor search with a single-precision query set.  The query set
+//! will be reordered.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Search(arma::fmat&& querySet,
+                                 const size_t k,
+                                 arma::Mat<size_t>& neighbors,
+                                 arma::mat& distances)
+{
+  if (singlePrecision)
   {
-    case NAIVE_MODE:
-      Log::Info << "brute-force (naive) search..." << std::endl;
-      break;
-    case SINGLE_TREE_MODE:
-      Log::Info << "single-tree " << TreeName() << " search..." << std::endl;
-      break;
-    case DUAL_TREE_MODE:
-      Log::Info << "dual-tree " << TreeName() << " search..." << std::endl;
-      break;
-    case GREEDY_SINGLE_TREE_MODE:
-      Log::Info << "greedy single-tree " << TreeName() << " search..."
-          << std::endl;
-      break;
+    SearchWith(querySet, k, neighbors, distances, nSearchFloat);
+  }
+  else
+  {
+    arma::mat doubleQuerySet = arma::conv_to<arma::mat>::from(querySet);
+    querySet.reset();
+    SearchWith(doubleQuerySet, k, neighbors, distances, nSearch);
   }
+}
+
+//! Perform bichromatic search with the model in the given variant.
+template<typename SortPolicy>
+template<typename MatType, typename VariantType>
+void NSModel<SortPolicy>::SearchWith(MatType& querySet,
+                                     const size_t k,
+                                     arma::Mat<size_t>& neighbors,
+                                     arma::mat& distances,
+                                     VariantType& search)
+{
+  // We may need to map the query set randomly.
+  if (randomBasis)
+    querySet = arma::conv_to<MatType>::from(q) * querySet;
+
+  LogSearch(k);
 
-  BiSearchVisitor<SortPolicy> search(querySet, k, neighbors, distances,
-      leafSize, tau, rho);
-  boost::apply_visitor(search, nSearch);
+  BiSearchVisitor<SortPolicy, MatType> visitor(querySet, k, neighbors,
+      distances, leafSize, tau, rho);
+  boost::apply_visitor(visitor, search);
 }
 
 //! Perform neighbor search.
@@ -592,6 +710,23 @@ template<typename SortPolicy>
 void NSModel<SortPolicy>::Search(const size_t k,
                                  arma::Mat<size_t>& neighbors,
                                  arma::mat& distances)
+{
+  LogSearch(k);
+
+  if (Epsilon() != 0 && SearchMode() != NAIVE_MODE)
+    Log::Info << "Maximum of " << Epsilon() * 100 << "% relative error."
+        << std::endl;
+
+  MonoSearchVisitor search(k, neighbors, distances);
+  if (singlePrecision)
+    boost::apply_visitor(search, nSearchFloat);
+  else
+    boost::apply_visitor(search, nSearch);
+}
+
+//! Print which kind of search is about to be done.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::LogSearch(const size_t k) const
 {
   Log::Info << "Searching for " << k << " neighbors with ";
 
@@ -610,14 +745,11 @@ void NSModel<SortPolicy>::Search(const size_t k,
       Log::Info << "greedy single-tree " << TreeName() << " search..."
           << std::endl;
       break;
+    case BLOCK_SINGLE_TREE_MODE:
+      Log::Info << "block single-tree " << TreeName() << " search..."
+          << std::endl;
+      break;
   }
-
-  if (Epsilon() != 0 && SearchMode() != NAIVE_MODE)
-    Log::Info << "Maximum of " << Epsilon() * 100 << "% relative error."
-        << std::endl;
-
-  MonoSearchVisitor search(k, neighbors, distances);
-  boost::apply_visitor(search, nSearch);
 }
 
 //! Get the name of the tree type.
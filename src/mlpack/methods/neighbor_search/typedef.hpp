@@ -43,21 +43,23 @@ typedef NeighborSearch<FurthestNeighborSort, metric::EuclideanDistance> KFN;
  * the k nearest neighbors found.
  * @tparam TreeType The tree type to use; must adhere to the TreeType API,
  *     and implement Defeatist Traversers.
+ * @tparam MatType The type of data matrix (arma::mat or arma::fmat).
  */
 template<template<typename TreeMetricType,
                   typename TreeStatType,
-                  typename TreeMatType> class TreeType = tree::SPTree>
+                  typename TreeMatType> class TreeType = tree::SPTree,
+         typename MatType = arma::mat>
 using DefeatistKNN = NeighborSearch<
     NearestNeighborSort,
     metric::EuclideanDistance,
-    arma::mat,
+    MatType,
     TreeType,
     TreeType<metric::EuclideanDistance,
         NeighborSearchStat<NearestNeighborSort>,
-        arma::mat>::template DefeatistDualTreeTraverser,
+        MatType>::template DefeatistDualTreeTraverser,
     TreeType<metric::EuclideanDistance,
         NeighborSearchStat<NearestNeighborSort>,
-        arma::mat>::template DefeatistSingleTreeTraverser>;
+        MatType>::template DefeatistSingleTreeTraverser>;
 
 /**
  * The SpillKNN class is the k-nearest-neighbors method considering defeatist
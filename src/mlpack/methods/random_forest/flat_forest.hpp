@@ -0,0 +1,205 @@
+/**
+ * @file flat_forest.hpp
+ *
+ * Definition of the FlatForest class, a flattened copy of a trained random
+ * forest or decision tree for fast classification.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "random_forest.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A classification-only copy of a trained RandomForest or DecisionTree, laid
+ * out for fast prediction.  The nodes of all the trees are stored in one
+ * contiguous array, each node holding its split dimension, its threshold and
+ * the index of its first child, and the children of a node are stored next to
+ * each other.  Classifying a node then takes one comparison and no calls to
+ * the split types, and batches of points are classified in blocks: each tree
+ * is evaluated on every point of a block before moving to the next tree, so
+ * that the nodes of the tree stay in cache, and the blocks are classified in
+ * parallel with OpenMP.
+ *
+ * The predictions and probabilities are the same as those of the original
+ * forest (or tree).  Numeric splits must be binary splits that send a point to
+ * the left child if its value is at most the threshold stored in the split
+ * information, as the BestBinaryNumericSplit and HistogramNumericSplit do;
+ * categorical splits must have one child per category, as the
+ * AllCategoricalSplit does.  A categorical value that has no child (a category
+ * that wasn't seen in training, a negative value or NaN) is sent to the first
+ * child.  Changes to the original forest after flattening have no effect on the
+ * FlatForest.
+ *
+ * @code
+ * RandomForest<> rf(data, labels, numClasses, 500);
+ * FlatForest flat(rf);
+ *
+ * arma::Row<size_t> predictions;
+ * flat.Classify(testData, predictions);
+ * @endcode
+ */
+class FlatForest
+{
+ public:
+  //! Create an empty FlatForest, that can be loaded with serialize().
+  FlatForest() : numClasses(0) { }
+
+  /**
+   * Flatten the given trained random forest.
+   *
+   * @param forest The forest to flatten.
+   */
+  template<typename FitnessFunction,
+           typename DimensionSelectionType,
+           template<typename> class NumericSplitType,
+           template<typename> class CategoricalSplitType,
+           typename ElemType>
+  FlatForest(const RandomForest<FitnessFunction,
+                                DimensionSelectionType,
+                                NumericSplitType,
+                                CategoricalSplitType,
+                                ElemType>& forest);
+
+  /**
+   * Flatten the given trained decision tree, as a forest of one tree.
+   *
+   * @param tree The tree to flatten.
+   */
+  template<typename FitnessFunction,
+           template<typename> class NumericSplitType,
+           template<typename> class CategoricalSplitType,
+           typename DimensionSelectionType,
+           typename ElemType,
+           bool NoRecursion>
+  FlatForest(const DecisionTree<FitnessFunction,
+                                NumericSplitType,
+                                CategoricalSplitType,
+                                DimensionSelectionType,
+                                ElemType,
+                                NoRecursion>& tree);
+
+  /**
+   * Predict the class of the given point.
+   *
+   * @param point Point to classify.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point) const;
+
+  /**
+   * Predict the classes of the given points.
+   *
+   * @param data Points to classify, one per column.
+   * @param predictions Vector to store the predictions in.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data, arma::Row<size_t>& predictions) const;
+
+  /**
+   * Predict the classes of the given points, and the probabilities of each
+   * class.
+   *
+   * @param data Points to classify, one per column.
+   * @param predictions Vector to store the predictions in.
+   * @param probabilities Matrix to store the class probabilities in.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of trees.
+  size_t NumTrees() const { return roots.size(); }
+
+  //! Get the total number of nodes of the trees.
+  size_t NumNodes() const { return nodes.size(); }
+
+  //! Get the number of classes.
+  size_t NumClasses() const { return numClasses; }
+
+  //! Serialize the flattened forest.
+  template<typename Archive>
+  void serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! One node of a tree.
+  struct Node
+  {
+    //! The index of the first child, or 0 for a leaf.
+    size_t child;
+    //! The dimension the node splits on, or for a leaf, the column of its
+    //! class probabilities.
+    size_t dimension;
+    //! The threshold of a numeric split: points whose value is at most the
+    //! threshold go to the first child, the others to the second.
+    double threshold;
+    //! The number of children of a categorical split (the point goes to the
+    //! child of its category), or 0 for a numeric split.
+    size_t numCategories;
+
+    //! Serialize the node.
+    template<typename Archive>
+    void serialize(Archive& ar, const unsigned int /* version */)
+    {
+      ar & BOOST_SERIALIZATION_NVP(child);
+      ar & BOOST_SERIALIZATION_NVP(dimension);
+      ar & BOOST_SERIALIZATION_NVP(threshold);
+      ar & BOOST_SERIALIZATION_NVP(numCategories);
+    }
+  };
+
+  //! The number of points classified together, tree by tree.
+  static const size_t BlockSize = 64;
+
+  /*
+   * Append the given tree to the forest, and the class probabilities of its
+   * leaves to the given values.
+   */
+  template<typename TreeType>
+  void AddTree(const TreeType& tree, std::vector<double>& leafValues);
+
+  /*
+   * Store the given node of a tree at the given index, and its subtree after
+   * the last node.
+   */
+  template<typename TreeType>
+  void AddNode(const TreeType& node,
+               const size_t index,
+               std::vector<double>& leafValues);
+
+  /*
+   * Get the column of the probabilities of the leaf of the tree with the given
+   * root that the given point falls into.
+   */
+  template<typename VecType>
+  size_t Leaf(const size_t root, const VecType& point) const;
+
+  //! The number of classes.
+  size_t numClasses;
+
+  //! The nodes of all the trees.
+  std::vector<Node> nodes;
+
+  //! The index of the root of each tree.
+  std::vector<size_t> roots;
+
+  //! The class probabilities of each leaf, one leaf per column.
+  arma::mat leafProbabilities;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_forest_impl.hpp"
+
+#endif
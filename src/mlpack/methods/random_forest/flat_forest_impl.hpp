@@ -0,0 +1,238 @@
+/**
+ * @file flat_forest_impl.hpp
+ *
+ * Implementation of the FlatForest class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_IMPL_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_forest.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+FlatForest::FlatForest(const RandomForest<FitnessFunction,
+                                          DimensionSelectionType,
+                                          NumericSplitType,
+                                          CategoricalSplitType,
+                                          ElemType>& forest) :
+    numClasses(0)
+{
+  if (forest.NumTrees() == 0)
+  {
+    throw std::invalid_argument("FlatForest::FlatForest(): no random forest "
+        "trained!");
+  }
+
+  numClasses = forest.Tree(0).NumClasses();
+  std::vector<double> leafValues;
+  for (size_t i = 0; i < forest.NumTrees(); ++i)
+    AddTree(forest.Tree(i), leafValues);
+
+  leafProbabilities = arma::mat(leafValues.data(), numClasses,
+      leafValues.size() / numClasses);
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+FlatForest::FlatForest(const DecisionTree<FitnessFunction,
+                                          NumericSplitType,
+                                          CategoricalSplitType,
+                                          DimensionSelectionType,
+                                          ElemType,
+                                          NoRecursion>& tree) :
+    numClasses(tree.NumClasses())
+{
+  std::vector<double> leafValues;
+  AddTree(tree, leafValues);
+
+  leafProbabilities = arma::mat(leafValues.data(), numClasses,
+      leafValues.size() / numClasses);
+}
+
+template<typename VecType>
+size_t FlatForest::Classify(const VecType& point) const
+{
+  if (roots.empty())
+  {
+    throw std::invalid_argument("FlatForest::Classify(): no forest "
+        "flattened!");
+  }
+
+  arma::vec probabilities(numClasses, arma::fill::zeros);
+  for (size_t t = 0; t < roots.size(); ++t)
+    probabilities += leafProbabilities.col(Leaf(roots[t], point));
+  probabilities /= roots.size();
+
+  arma::uword maxIndex = 0;
+  probabilities.max(maxIndex);
+  return (size_t) maxIndex;
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions) const
+{
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions,
+                          arma::mat& probabilities) const
+{
+  if (roots.empty())
+  {
+    throw std::invalid_argument("FlatForest::Classify(): no forest "
+        "flattened!");
+  }
+
+  probabilities.zeros(numClasses, data.n_cols);
+  predictions.set_size(data.n_cols);
+
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+  #pragma omp parallel for
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t end = std::min((size_t) data.n_cols, begin + BlockSize);
+
+    // Sum the probabilities of the leaves, one tree at a time.
+    for (size_t t = 0; t < roots.size(); ++t)
+    {
+      for (size_t i = begin; i < end; ++i)
+      {
+        const double* leaf = leafProbabilities.colptr(Leaf(roots[t],
+            data.col(i)));
+        double* probs = probabilities.colptr(i);
+        for (size_t c = 0; c < numClasses; ++c)
+          probs[c] += leaf[c];
+      }
+    }
+
+    for (size_t i = begin; i < end; ++i)
+    {
+      arma::vec probs = probabilities.unsafe_col(i); // Alias of column.
+      probs /= roots.size();
+
+      arma::uword maxIndex = 0;
+      probs.max(maxIndex);
+      predictions[i] = (size_t) maxIndex;
+    }
+  }
+}
+
+template<typename Archive>
+void FlatForest::serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & BOOST_SERIALIZATION_NVP(numClasses);
+  ar & BOOST_SERIALIZATION_NVP(nodes);
+  ar & BOOST_SERIALIZATION_NVP(roots);
+  ar & BOOST_SERIALIZATION_NVP(leafProbabilities);
+}
+
+template<typename TreeType>
+void FlatForest::AddTree(const TreeType& tree,
+                         std::vector<double>& leafValues)
+{
+  if (tree.NumClasses() != numClasses)
+  {
+    std::ostringstream oss;
+    oss << "FlatForest::AddTree(): tree has " << tree.NumClasses() << " "
+        << "classes, but the forest has " << numClasses << "!" << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t root = nodes.size();
+  roots.push_back(root);
+  nodes.resize(root + 1);
+  AddNode(tree, root, leafValues);
+}
+
+template<typename TreeType>
+void FlatForest::AddNode(const TreeType& node,
+                         const size_t index,
+                         std::vector<double>& leafValues)
+{
+  if (node.NumChildren() == 0)
+  {
+    // Append the class probabilities of the leaf.
+    nodes[index].child = 0;
+    nodes[index].dimension = leafValues.size() / numClasses;
+    nodes[index].threshold = 0.0;
+    nodes[index].numCategories = 0;
+    leafValues.insert(leafValues.end(), node.ClassProbabilities().begin(),
+        node.ClassProbabilities().end());
+    return;
+  }
+
+  nodes[index].dimension = node.SplitDimension();
+  if (node.SplitDimensionType() == data::Datatype::categorical)
+  {
+    nodes[index].threshold = 0.0;
+    nodes[index].numCategories = node.NumChildren();
+  }
+  else
+  {
+    if (node.NumChildren() != 2 || node.ClassProbabilities().n_elem != 1)
+    {
+      throw std::invalid_argument("FlatForest::AddNode(): only binary numeric "
+          "splits with a threshold can be flattened!");
+    }
+
+    nodes[index].threshold = node.ClassProbabilities()[0];
+    nodes[index].numCategories = 0;
+  }
+
+  // Store the children next to each other, then their subtrees.
+  const size_t child = nodes.size();
+  nodes[index].child = child;
+  nodes.resize(child + node.NumChildren());
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    AddNode(node.Child(i), child + i, leafValues);
+}
+
+template<typename VecType>
+size_t FlatForest::Leaf(const size_t root, const VecType& point) const
+{
+  const Node* node = &nodes[root];
+  while (node->child != 0)
+  {
+    const double value = (double) point[node->dimension];
+    if (node->numCategories == 0)
+    {
+      node = &nodes[node->child + ((value <= node->threshold) ? 0 : 1)];
+    }
+    else
+    {
+      // A category without a child must not index past the children; the
+      // comparisons are also false for NaN.
+      const size_t category = (value >= 0.0 && value < node->numCategories) ?
+          (size_t) value : 0;
+      node = &nodes[node->child + category];
+    }
+  }
+
+  return node->dimension;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -42,13 +42,16 @@ class RandomForest
    * @param numClasses Number of classes in dataset.
    * @param numTrees Number of trees in the forest.
    * @param minimumLeafSize Minimum number of points in each tree's leaf nodes.
+   * @param parallel Whether to also train each tree in parallel with OpenMP
+   *     tasks (see DecisionTree); useful when there are fewer trees than cores.
    */
   template<typename MatType>
   RandomForest(const MatType& dataset,
                const arma::Row<size_t>& labels,
                const size_t numClasses,
                const size_t numTrees = 50,
-               const size_t minimumLeafSize = 20);
+               const size_t minimumLeafSize = 20,
+               const bool parallel = false);
 
   /**
    * Create a random forest, training on the given labeled training data with
@@ -62,6 +65,8 @@ class RandomForest
    * @param numClasses Number of classes in dataset.
    * @param numTrees Number of trees in the forest.
    * @param minimumLeafSize Minimum number of points in each tree's leaf nodes.
+   * @param parallel Whether to also train each tree in parallel with OpenMP
+   *     tasks (see DecisionTree); useful when there are fewer trees than cores.
    */
   template<typename MatType>
   RandomForest(const MatType& dataset,
@@ -69,7 +74,8 @@ class RandomForest
                const arma::Row<size_t>& labels,
                const size_t numClasses,
                const size_t numTrees = 50,
-               const size_t minimumLeafSize = 20);
+               const size_t minimumLeafSize = 20,
+               const bool parallel = false);
 
   /**
    * Create a random forest, training on the given weighted labeled training
@@ -82,6 +88,8 @@ class RandomForest
    * @param weights Weights (importances) of each point in the dataset.
    * @param numTrees Number of trees in the forest.
    * @param minimumLeafSize Minimum number of points in each tree's leaf nodes.
+   * @param parallel Whether to also train each tree in parallel with OpenMP
+   *     tasks (see DecisionTree); useful when there are fewer trees than cores.
    */
   template<typename MatType>
   RandomForest(const MatType& dataset,
@@ -89,7 +97,8 @@ class RandomForest
                const size_t numClasses,
                const arma::rowvec& weights,
                const size_t numTrees = 50,
-               const size_t minimumLeafSize = 20);
+               const size_t minimumLeafSize = 20,
+               const bool parallel = false);
 
   /**
    * Create a random forest, training on the given weighted labeled training
@@ -104,6 +113,8 @@ class RandomForest
    * @param weights Weights (importances) of each point in the dataset.
    * @param numTrees Number of trees in the forest.
    * @param minimumLeafSize Minimum number of points in each tree's leaf nodes.
+   * @param parallel Whether to also train each tree in parallel with OpenMP
+   *     tasks (see DecisionTree); useful when there are fewer trees than cores.
    */
   template<typename MatType>
   RandomForest(const MatType& dataset,
@@ -112,7 +123,8 @@ class RandomForest
                const size_t numClasses,
                const arma::rowvec& weights,
                const size_t numTrees = 50,
-               const size_t minimumLeafSize = 20);
+               const size_t minimumLeafSize = 20,
+               const bool parallel = false);
 
   /**
    * Train the random forest on the given labeled training data with the given
@@ -124,13 +136,16 @@ class RandomForest
    * @param numClasses Number of classes in dataset.
    * @param numTrees Number of trees in the forest.
    * @param minimumLeafSize Minimum number of points in each tree's leaf nodes.
+   * @param parallel Whether to also train each tree in parallel with OpenMP
+   *     tasks (see DecisionTree); useful when there are fewer trees than cores.
    */
   template<typename MatType>
   void Train(const MatType& data,
              const arma::Row<size_t>& labels,
              const size_t numClasses,
              const size_t numTrees = 50,
-             const size_t minimumLeafSize = 20);
+             const size_t minimumLeafSize = 20,
+             const bool parallel = false);
 
   /**
    * Train the random forest on the given labeled training data with the given
@@ -144,6 +159,8 @@ class RandomForest
    * @param numClasses Number of classes in dataset.
    * @param numTrees Number of trees in the forest.
    * @param minimumLeafSize Minimum number of points in each tree's leaf nodes.
+   * @param parallel Whether to also train each tree in parallel with OpenMP
+   *     tasks (see DecisionTree); useful when there are fewer trees than cores.
    */
   template<typename MatType>
   void Train(const MatType& data,
@@ -151,7 +168,8 @@ class RandomForest
              const arma::Row<size_t>& labels,
              const size_t numClasses,
              const size_t numTrees = 50,
-             const size_t minimumLeafSize = 20);
+             const size_t minimumLeafSize = 20,
+             const bool parallel = false);
 
   /**
    * Train the random forest on the given weighted labeled training data with
@@ -164,6 +182,8 @@ class RandomForest
    * @param weights Weights (importances) of each point in the dataset.
    * @param numTrees Number of trees in the forest.
    * @param minimumLeafSize Minimum number of points in each tree's leaf nodes.
+   * @param parallel Whether to also train each tree in parallel with OpenMP
+   *     tasks (see DecisionTree); useful when there are fewer trees than cores.
    */
   template<typename MatType>
   void Train(const MatType& data,
@@ -171,7 +191,8 @@ class RandomForest
              const size_t numClasses,
              const arma::rowvec& weights,
              const size_t numTrees = 50,
-             const size_t minimumLeafSize = 20);
+             const size_t minimumLeafSize = 20,
+             const bool parallel = false);
 
   /**
    * Train the random forest on the given weighted labeled training data with
@@ -186,6 +207,8 @@ class RandomForest
    * @param weights Weights (importances) of each point in the dataset.
    * @param numTrees Number of trees in the forest.
    * @param minimumLeafSize Minimum number of points in each tree's leaf nodes.
+   * @param parallel Whether to also train each tree in parallel with OpenMP
+   *     tasks (see DecisionTree); useful when there are fewer trees than cores.
    */
   template<typename MatType>
   void Train(const MatType& data,
@@ -194,7 +217,8 @@ class RandomForest
              const size_t numClasses,
              const arma::rowvec& weights,
              const size_t numTrees = 50,
-             const size_t minimumLeafSize = 20);
+             const size_t minimumLeafSize = 20,
+             const bool parallel = false);
 
   /**
    * Predict the class of the given point.  If the random forest has not been
@@ -271,6 +295,7 @@ class RandomForest
    * @param weights Weights for each point in the dataset (may be ignored).
    * @param numTrees Number of trees in the forest.
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param parallel Whether to also train each tree in parallel.
    * @tparam UseWeights Whether or not to use the weights parameter.
    * @tparam UseDatasetInfo Whether or not to use the datasetInfo parameter.
    * @tparam MatType The type of data matrix (i.e. arma::mat).
@@ -282,7 +307,8 @@ class RandomForest
              const size_t numClasses,
              const arma::rowvec& weights,
              const size_t numTrees,
-             const size_t minimumLeafSize);
+             const size_t minimumLeafSize,
+             const bool parallel);
 
   //! The trees in the forest.
   std::vector<DecisionTreeType> trees;
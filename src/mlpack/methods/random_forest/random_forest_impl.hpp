@@ -31,13 +31,14 @@ RandomForest<
                 const arma::Row<size_t>& labels,
                 const size_t numClasses,
                 const size_t numTrees,
-                const size_t minimumLeafSize)
+                const size_t minimumLeafSize,
+                const bool parallel)
 {
   // Pass off work to the Train() method.
   data::DatasetInfo info; // Ignored.
   arma::rowvec weights; // Fake weights, not used.
   Train<false, false>(dataset, info, labels, numClasses, weights, numTrees,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 template<
@@ -59,12 +60,13 @@ RandomForest<
                 const arma::Row<size_t>& labels,
                 const size_t numClasses,
                 const size_t numTrees,
-                const size_t minimumLeafSize)
+                const size_t minimumLeafSize,
+                const bool parallel)
 {
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
   Train<false, true>(dataset, datasetInfo, labels, numClasses, weights,
-      numTrees, minimumLeafSize);
+      numTrees, minimumLeafSize, parallel);
 }
 
 template<
@@ -86,12 +88,13 @@ RandomForest<
                 const size_t numClasses,
                 const arma::rowvec& weights,
                 const size_t numTrees,
-                const size_t minimumLeafSize)
+                const size_t minimumLeafSize,
+                const bool parallel)
 {
   // Pass off work to the Train() method.
   data::DatasetInfo info; // Ignored by Train().
   Train<true, false>(dataset, info, labels, numClasses, weights, numTrees,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 template<
@@ -114,11 +117,12 @@ RandomForest<
                 const size_t numClasses,
                 const arma::rowvec& weights,
                 const size_t numTrees,
-                const size_t minimumLeafSize)
+                const size_t minimumLeafSize,
+                const bool parallel)
 {
   // Pass off work to the Train() method.
   Train<true, true>(dataset, datasetInfo, labels, numClasses, weights, numTrees,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 template<
@@ -139,13 +143,14 @@ void RandomForest<
          const arma::Row<size_t>& labels,
          const size_t numClasses,
          const size_t numTrees,
-         const size_t minimumLeafSize)
+         const size_t minimumLeafSize,
+         const bool parallel)
 {
   // Pass off to Train().
   data::DatasetInfo info; // Ignored by Train().
   arma::rowvec weights; // Ignored by Train().
   Train<false, false>(dataset, info, labels, numClasses, weights, numTrees,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 template<
@@ -167,12 +172,13 @@ void RandomForest<
          const arma::Row<size_t>& labels,
          const size_t numClasses,
          const size_t numTrees,
-         const size_t minimumLeafSize)
+         const size_t minimumLeafSize,
+         const bool parallel)
 {
   // Pass off to Train().
   arma::rowvec weights; // Ignored by Train().
   Train<false, true>(dataset, datasetInfo, labels, numClasses, weights,
-      numTrees, minimumLeafSize);
+      numTrees, minimumLeafSize, parallel);
 }
 
 template<
@@ -194,12 +200,13 @@ void RandomForest<
          const size_t numClasses,
          const arma::rowvec& weights,
          const size_t numTrees,
-         const size_t minimumLeafSize)
+         const size_t minimumLeafSize,
+         const bool parallel)
 {
   // Pass off to Train().
   data::DatasetInfo info; // Ignored by Train().
   Train<false, true>(dataset, info, labels, numClasses, weights, numTrees,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 template<
@@ -222,11 +229,12 @@ void RandomForest<
          const size_t numClasses,
          const arma::rowvec& weights,
          const size_t numTrees,
-         const size_t minimumLeafSize)
+         const size_t minimumLeafSize,
+         const bool parallel)
 {
   // Pass off to Train().
   Train<true, true>(dataset, datasetInfo, labels, numClasses, weights, numTrees,
-      minimumLeafSize);
+      minimumLeafSize, parallel);
 }
 
 template<
@@ -422,9 +430,12 @@ void RandomForest<
          const size_t numClasses,
          const arma::rowvec& weights,
          const size_t numTrees,
-         const size_t minimumLeafSize)
+         const size_t minimumLeafSize,
+         const bool parallel)
 {
-  // Train each tree individually.
+  // Train each tree individually.  If the trees are trained in parallel too,
+  // their tasks run in the team of the loop over the trees, so the threads that
+  // are left over when there are fewer trees than threads help build them.
   trees.resize(numTrees); // This will fill the vector with untrained trees.
 
   #pragma omp parallel for
@@ -442,11 +453,12 @@ void RandomForest<
       if (UseDatasetInfo)
       {
         trees[i].Train(dataset, datasetInfo, labels, numClasses, weights,
-            minimumLeafSize);
+            minimumLeafSize, parallel);
       }
       else
       {
-        trees[i].Train(dataset, labels, numClasses, weights, minimumLeafSize);
+        trees[i].Train(dataset, labels, numClasses, weights, minimumLeafSize,
+            parallel);
       }
     }
     else
@@ -454,11 +466,12 @@ void RandomForest<
       if (UseDatasetInfo)
       {
         trees[i].Train(dataset, datasetInfo, labels, numClasses,
-            minimumLeafSize);
+            minimumLeafSize, parallel);
       }
       else
       {
-        trees[i].Train(dataset, labels, numClasses, minimumLeafSize);
+        trees[i].Train(dataset, labels, numClasses, minimumLeafSize,
+            parallel);
       }
     }
   }
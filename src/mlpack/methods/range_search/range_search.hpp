@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <boost/preprocessor/punctuation/comma.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include "range_search_stat.hpp"
@@ -192,6 +193,37 @@ class RangeSearch
    */
   void Train(Tree* referenceTree);
 
+  /**
+   * Add the given point to the reference set, without rebuilding the whole
+   * reference tree.  The new point gets the next unused index: the first point
+   * inserted after Train() gets the index n, where n is the number of points
+   * given to Train(), the next one n + 1, and so on.  The indices of the other
+   * points don't change.  With a reference tree, this is only available for
+   * BinarySpaceTrees (such as kd-trees) that were built by this object; see
+   * BinarySpaceTree::Insert().
+   *
+   * @param point Point to add to the reference set.
+   * @param maxLeafSize Maximum number of points held in a leaf of the
+   *     reference tree.
+   * @return The index of the new point.
+   */
+  template<typename VecType>
+  size_t Insert(const VecType& point, const size_t maxLeafSize = 20);
+
+  /**
+   * Remove the point with the given index from the reference set, without
+   * rebuilding the whole reference tree.  The indices of the other points
+   * don't change, and the index of the removed point is not given to another
+   * point.  With a reference tree, this is only available for
+   * BinarySpaceTrees (such as kd-trees) that were built by this object; see
+   * BinarySpaceTree::Remove().
+   *
+   * @param index Index of the point to remove.
+   * @param maxLeafSize Maximum number of points held in a leaf of the
+   *     reference tree.
+   */
+  void Remove(const size_t index, const size_t maxLeafSize = 20);
+
   /**
    * Search for all reference points in the given range for each point in the
    * query set, returning the results in the neighbors and distances objects.
@@ -288,6 +320,10 @@ class RangeSearch
    *
    * - neighbors[i] and distances[i] are not sorted in any particular order.
    *
+   * If points were inserted or removed with Insert() and Remove(), entry i
+   * holds the results of the point with index i, and the entries of removed
+   * points are empty.
+   *
    * @param queryTree Tree built on query points.
    * @param range Range of distances in which to search.
    * @param neighbors Object which will hold the list of neighbors for each
@@ -318,7 +354,8 @@ class RangeSearch
   template<typename Archive>
   void serialize(Archive& ar, const unsigned int version);
 
-  //! Return the reference set.
+  //! Return the reference set.  Once points were inserted or removed, some of
+  //! its columns may hold no reference point.
   const MatType& ReferenceSet() const { return *referenceSet; }
 
   //! Return the reference tree (or NULL if in naive mode).
@@ -326,7 +363,17 @@ class RangeSearch
 
  private:
   //! Mappings to old reference indices (used when this object builds trees).
+  //! Once points were inserted or removed, this holds the index of the point
+  //! held by each column of the reference set, or size_t() - 1 for columns that
+  //! hold no point.
   std::vector<size_t> oldFromNewReferences;
+  //! The column of the reference set that holds each reference point (or
+  //! size_t() - 1 if the point was removed).  This is empty until points are
+  //! inserted or removed.
+  std::vector<size_t> referenceColumns;
+  //! The columns of the reference set that hold no point, in naive mode.  (The
+  //! reference tree keeps track of them otherwise.)
+  std::vector<size_t> freeReferenceColumns;
   //! Reference tree.
   Tree* referenceTree;
   //! Reference set (data should be accessed using this).  In some situations we
@@ -351,6 +398,20 @@ class RangeSearch
   //! The total number of scores during the last search.
   size_t scores;
 
+  //! Return the number of points in the reference set.
+  size_t NumReferences() const;
+
+  //! Return whether the given column of the reference set holds a point.
+  bool HoldsReference(const size_t column) const
+  {
+    return referenceColumns.empty() ||
+        oldFromNewReferences[column] != size_t() - 1;
+  }
+
+  //! Set up the indices of the reference points before the first insertion or
+  //! removal.
+  void InitReferenceColumns();
+
   //! For access to mappings when building models.
   friend class TrainVisitor;
 };
@@ -358,6 +419,16 @@ class RangeSearch
 } // namespace range
 } // namespace mlpack
 
+//! Set the serialization version of the RangeSearch class.
+BOOST_TEMPLATE_CLASS_VERSION(
+    template<typename MetricType BOOST_PP_COMMA()
+             typename MatType BOOST_PP_COMMA()
+             template<typename TreeMetricType BOOST_PP_COMMA()
+                      typename TreeStatType BOOST_PP_COMMA()
+                      typename TreeMatType> class TreeType>,
+    mlpack::range::RangeSearch<MetricType BOOST_PP_COMMA()
+        MatType BOOST_PP_COMMA() TreeType>, 1);
+
 // Include implementation.
 #include "range_search_impl.hpp"
 
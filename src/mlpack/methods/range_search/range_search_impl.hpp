@@ -17,6 +17,7 @@
 
 // The rules for traversal.
 #include "range_search_rules.hpp"
+#include <mlpack/core/tree/parallel_dual_tree_traversal.hpp>
 
 namespace mlpack {
 namespace range {
@@ -150,6 +151,8 @@ template<typename MetricType,
 RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     const RangeSearch& other) :
     oldFromNewReferences(other.oldFromNewReferences),
+    referenceColumns(other.referenceColumns),
+    freeReferenceColumns(other.freeReferenceColumns),
     referenceTree(other.referenceTree ? new Tree(*other.referenceTree) : NULL),
     referenceSet(other.referenceTree ? &referenceTree->Dataset() :
         new MatType(*other.referenceSet)),
@@ -171,6 +174,8 @@ template<typename MetricType,
                   typename TreeMatType> class TreeType>
 RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
     oldFromNewReferences(std::move(other.oldFromNewReferences)),
+    referenceColumns(std::move(other.referenceColumns)),
+    freeReferenceColumns(std::move(other.freeReferenceColumns)),
     referenceTree(other.referenceTree),
     referenceSet(other.referenceSet),
     treeOwner(other.treeOwner),
@@ -210,6 +215,8 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(const RangeSearch& other)
 
   // Copy the other model.
   oldFromNewReferences = other.oldFromNewReferences;
+  referenceColumns = other.referenceColumns;
+  freeReferenceColumns = other.freeReferenceColumns;
   referenceTree = other.referenceTree ? new Tree(*other.referenceTree) : NULL;
   referenceSet = other.referenceTree ? &referenceTree->Dataset() :
       new MatType(*other.referenceSet);
@@ -240,6 +247,8 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
 
   // Move the other model.
   oldFromNewReferences = std::move(other.oldFromNewReferences);
+  referenceColumns = std::move(other.referenceColumns);
+  freeReferenceColumns = std::move(other.freeReferenceColumns);
   referenceTree = other.referenceTree;
   referenceSet = other.referenceSet;
   treeOwner = other.treeOwner;
@@ -290,6 +299,11 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   if (treeOwner && referenceTree)
     delete referenceTree;
 
+  // Forget the indices of the old reference points.
+  oldFromNewReferences.clear();
+  referenceColumns.clear();
+  freeReferenceColumns.clear();
+
   // Rebuild the tree, if necessary.
   if (!naive)
   {
@@ -325,6 +339,11 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   if (treeOwner && referenceTree)
     delete referenceTree;
 
+  // Forget the indices of the old reference points.
+  oldFromNewReferences.clear();
+  referenceColumns.clear();
+  freeReferenceColumns.clear();
+
   // We may need to rebuild the tree.
   if (!naive)
   {
@@ -370,12 +389,149 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   if (setOwner && referenceSet)
     delete this->referenceSet;
 
+  oldFromNewReferences.clear();
+  referenceColumns.clear();
+  freeReferenceColumns.clear();
+
   this->referenceTree = referenceTree;
   this->referenceSet = &referenceTree->Dataset();
   treeOwner = false;
   setOwner = false;
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename VecType>
+size_t RangeSearch<MetricType, MatType, TreeType>::Insert(
+    const VecType& point,
+    const size_t maxLeafSize)
+{
+  if (point.n_elem != referenceSet->n_rows)
+    throw std::invalid_argument("dimensionality of the point does not match "
+        "the reference set");
+
+  // Without the mapping of the points we can't give results in terms of the
+  // original indices.
+  if (!naive && !treeOwner)
+    throw std::invalid_argument("cannot insert into a reference tree that was "
+        "not built by RangeSearch");
+
+  InitReferenceColumns();
+
+  size_t column;
+  if (!naive)
+  {
+    column = referenceTree->Insert(point, maxLeafSize);
+  }
+  else
+  {
+    // Take our own copy of the reference set the first time, and then grow it
+    // geometrically, so that each insertion costs amortized O(d).
+    if (!setOwner)
+    {
+      referenceSet = new MatType(*referenceSet);
+      setOwner = true;
+    }
+
+    MatType& set = const_cast<MatType&>(*referenceSet);
+    if (freeReferenceColumns.empty())
+    {
+      const size_t oldCols = set.n_cols;
+      const size_t newCols = std::max(2 * oldCols, oldCols + 1);
+      set.resize(set.n_rows, newCols);
+      for (size_t i = newCols; i > oldCols; --i)
+        freeReferenceColumns.push_back(i - 1);
+    }
+
+    column = freeReferenceColumns.back();
+    freeReferenceColumns.pop_back();
+    set.col(column) = point;
+  }
+
+  // The reference set may have grown.
+  if (oldFromNewReferences.size() < referenceSet->n_cols)
+    oldFromNewReferences.resize(referenceSet->n_cols, size_t() - 1);
+
+  const size_t index = referenceColumns.size();
+  referenceColumns.push_back(column);
+  oldFromNewReferences[column] = index;
+
+  return index;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Remove(
+    const size_t index,
+    const size_t maxLeafSize)
+{
+  if (!naive && !treeOwner)
+    throw std::invalid_argument("cannot remove from a reference tree that was "
+        "not built by RangeSearch");
+
+  InitReferenceColumns();
+
+  if (index >= referenceColumns.size() ||
+      referenceColumns[index] == size_t() - 1)
+    throw std::invalid_argument("there is no reference point with the given "
+        "index");
+
+  // The column is left in the reference set; it just doesn't hold a point
+  // anymore.
+  const size_t column = referenceColumns[index];
+  if (!naive)
+    referenceTree->Remove(column, maxLeafSize);
+  else
+    freeReferenceColumns.push_back(column);
+
+  referenceColumns[index] = size_t() - 1;
+  oldFromNewReferences[column] = size_t() - 1;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+size_t RangeSearch<MetricType, MatType, TreeType>::NumReferences() const
+{
+  if (referenceColumns.empty())
+    return referenceSet->n_cols;
+  else if (!naive)
+    return referenceTree->NumDescendants();
+  else
+    return referenceSet->n_cols - freeReferenceColumns.size();
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::InitReferenceColumns()
+{
+  if (!referenceColumns.empty())
+    return;
+
+  // Until now, every column held a point.
+  if (oldFromNewReferences.empty())
+  {
+    oldFromNewReferences.resize(referenceSet->n_cols);
+    for (size_t i = 0; i < oldFromNewReferences.size(); ++i)
+      oldFromNewReferences[i] = i;
+  }
+
+  referenceColumns.resize(oldFromNewReferences.size());
+  for (size_t i = 0; i < oldFromNewReferences.size(); ++i)
+    referenceColumns[oldFromNewReferences[i]] = i;
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -397,7 +553,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   }
 
   // If there are no points, there is no search to be done.
-  if (referenceSet->n_cols == 0)
+  if (NumReferences() == 0)
     return;
 
   Timer::Start("range_search/computing_neighbors");
@@ -412,8 +568,10 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
   std::vector<std::vector<double>>* distancePtr = &distances;
 
-  // Mapping is only necessary if the tree rearranges points.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
+  // Mapping is only necessary if the tree rearranges points, or if points were
+  // inserted or removed.
+  if (tree::TreeTraits<Tree>::RearrangesDataset ||
+      !oldFromNewReferences.empty())
   {
     // Query indices only need to be mapped if we are building the query tree
     // ourselves.
@@ -424,8 +582,8 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     }
 
     // Reference indices only need to be mapped if we built the reference tree
-    // ourselves.
-    else if (treeOwner)
+    // ourselves, or if points were inserted or removed.
+    else if (!oldFromNewReferences.empty())
       neighborPtr = new std::vector<std::vector<size_t>>;
   }
 
@@ -450,9 +608,10 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     // The naive brute-force solution.
     for (size_t i = 0; i < querySet.n_cols; ++i)
       for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+        if (HoldsReference(j))
+          rules.BaseCase(i, j);
 
-    baseCases += (querySet.n_cols * referenceSet->n_cols);
+    baseCases += (querySet.n_cols * NumReferences());
   }
   else if (singleMode)
   {
@@ -477,12 +636,13 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     Timer::Stop("range_search/tree_building");
     Timer::Start("range_search/computing_neighbors");
 
-    // Create the traverser.
+    // Create the rules, and traverse, splitting the query tree into parallel
+    // tasks if possible.
     RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
         *distancePtr, metric);
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*queryTree, *referenceTree);
+    tree::ParallelDualTreeTraversal<
+        typename Tree::template DualTreeTraverser<RuleType>>(rules, *queryTree,
+        *referenceTree);
 
     baseCases += rules.BaseCases();
     scores += rules.Scores();
@@ -494,9 +654,10 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   Timer::Stop("range_search/computing_neighbors");
 
   // Map points back to original indices, if necessary.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
+  if (tree::TreeTraits<Tree>::RearrangesDataset ||
+      !oldFromNewReferences.empty())
   {
-    if (!singleMode && !naive && treeOwner)
+    if (!singleMode && !naive && !oldFromNewReferences.empty())
     {
       // We must map both query and reference indices.
       neighbors.clear();
@@ -541,7 +702,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
       delete neighborPtr;
       delete distancePtr;
     }
-    else if (treeOwner)
+    else if (!oldFromNewReferences.empty())
     {
       // We must map reference indices only.
       neighbors.clear();
@@ -572,7 +733,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     std::vector<std::vector<double>>& distances)
 {
   // If there are no points, there is no search to be done.
-  if (referenceSet->n_cols == 0)
+  if (NumReferences() == 0)
     return;
 
   Timer::Start("range_search/computing_neighbors");
@@ -588,7 +749,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   // We won't need to map query indices, but will we need to map distances?
   std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
 
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
     neighborPtr = new std::vector<std::vector<size_t>>;
 
   // Resize each vector.
@@ -602,10 +763,10 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
       distances, metric);
 
-  // Create the traverser.
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-  traverser.Traverse(*queryTree, *referenceTree);
+  // Traverse, splitting the query tree into parallel tasks if possible.
+  tree::ParallelDualTreeTraversal<
+      typename Tree::template DualTreeTraverser<RuleType>>(rules, *queryTree,
+      *referenceTree);
 
   Timer::Stop("range_search/computing_neighbors");
 
@@ -613,7 +774,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   scores = rules.Scores();
 
   // Do we need to map indices?
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
   {
     // We must map reference indices only.
     neighbors.clear();
@@ -642,7 +803,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     std::vector<std::vector<double>>& distances)
 {
   // If there are no points, there is no search to be done.
-  if (referenceSet->n_cols == 0)
+  if (NumReferences() == 0)
     return;
 
   Timer::Start("range_search/computing_neighbors");
@@ -651,7 +812,7 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
   std::vector<std::vector<double>>* distancePtr = &distances;
 
-  if (tree::TreeTraits<Tree>::RearrangesDataset && treeOwner)
+  if (!oldFromNewReferences.empty())
   {
     // We will always need to rearrange in this case.
     distancePtr = new std::vector<std::vector<double>>;
@@ -674,9 +835,10 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     // The naive brute-force solution.
     for (size_t i = 0; i < referenceSet->n_cols; ++i)
       for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+        if (HoldsReference(i) && HoldsReference(j))
+          rules.BaseCase(i, j);
 
-    baseCases = (referenceSet->n_cols * referenceSet->n_cols);
+    baseCases = (NumReferences() * NumReferences());
     scores = 0;
   }
   else if (singleMode)
@@ -686,17 +848,20 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
 
     // Now have it traverse for each point.
     for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+      if (HoldsReference(i))
+        traverser.Traverse(i, *referenceTree);
 
     baseCases = rules.BaseCases();
     scores = rules.Scores();
   }
   else // Dual-tree recursion.
   {
-    // Create the traverser.
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-
-    traverser.Traverse(*referenceTree, *referenceTree);
+    // Traverse, splitting the query tree into parallel tasks if possible.  The
+    // query subtrees of each task are disjoint, so this is safe even though
+    // the query and reference trees are the same.
+    tree::ParallelDualTreeTraversal<
+        typename Tree::template DualTreeTraverser<RuleType>>(rules,
+        *referenceTree, *referenceTree);
 
     baseCases = rules.BaseCases();
     scores = rules.Scores();
@@ -705,15 +870,21 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   Timer::Stop("range_search/computing_neighbors");
 
   // Do we need to map the reference indices?
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
+  if (!oldFromNewReferences.empty())
   {
+    // If points were removed, their entries are left empty.
+    const size_t numIndices = referenceColumns.empty() ?
+        referenceSet->n_cols : referenceColumns.size();
     neighbors.clear();
-    neighbors.resize(referenceSet->n_cols);
+    neighbors.resize(numIndices);
     distances.clear();
-    distances.resize(referenceSet->n_cols);
+    distances.resize(numIndices);
 
-    for (size_t i = 0; i < distances.size(); i++)
+    for (size_t i = 0; i < distancePtr->size(); i++)
     {
+      if (!HoldsReference(i))
+        continue;
+
       // Map distances (copy a column).
       const size_t refMapping = oldFromNewReferences[i];
       distances[refMapping] = (*distancePtr)[i];
@@ -740,7 +911,7 @@ template<typename MetricType,
 template<typename Archive>
 void RangeSearch<MetricType, MatType, TreeType>::serialize(
     Archive& ar,
-    const unsigned int /* version */)
+    const unsigned int version)
 {
   // Serialize preferences for search.
   ar & BOOST_SERIALIZATION_NVP(naive);
@@ -806,6 +977,20 @@ void RangeSearch<MetricType, MatType, TreeType>::serialize(
       setOwner = false;
     }
   }
+
+  // Older models could not have points inserted or removed.
+  if (version > 0)
+  {
+    if (naive)
+      ar & BOOST_SERIALIZATION_NVP(oldFromNewReferences);
+    ar & BOOST_SERIALIZATION_NVP(referenceColumns);
+    ar & BOOST_SERIALIZATION_NVP(freeReferenceColumns);
+  }
+  else if (Archive::is_loading::value)
+  {
+    referenceColumns.clear();
+    freeReferenceColumns.clear();
+  }
 }
 
 } // namespace range
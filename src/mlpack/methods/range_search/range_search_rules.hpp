@@ -13,6 +13,9 @@
 #define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include <mlpack/core/metrics/pairwise_distances.hpp>
+
+#include <memory>
 
 namespace mlpack {
 namespace range {
@@ -41,8 +44,8 @@ class RangeSearchRules
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
    */
-  RangeSearchRules(const arma::mat& referenceSet,
-                   const arma::mat& querySet,
+  RangeSearchRules(const typename TreeType::Mat& referenceSet,
+                   const typename TreeType::Mat& querySet,
                    const math::Range& range,
                    std::vector<std::vector<size_t> >& neighbors,
                    std::vector<std::vector<double> >& distances,
@@ -57,6 +60,18 @@ class RangeSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between each of the given query points and each of
+   * the points held in the given reference node.  The distances are computed
+   * as one block with metric::PairwiseDistances(); pairs that may be in the
+   * range are evaluated again with the metric, so the results are the same as
+   * with BaseCase().
+   *
+   * @param queryIndices Indices of query points.
+   * @param referenceNode Node holding the reference points.
+   */
+  void BaseCase(const arma::uvec& queryIndices, TreeType& referenceNode);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -114,15 +129,19 @@ class RangeSearchRules
 
   //! Get the number of base cases.
   size_t BaseCases() const { return baseCases; }
+  //! Modify the number of base cases.
+  size_t& BaseCases() { return baseCases; }
   //! Get the number of scores (that is, calls to RangeDistance()).
   size_t Scores() const { return scores; }
+  //! Modify the number of scores.
+  size_t& Scores() { return scores; }
 
  private:
   //! The reference set.
-  const arma::mat& referenceSet;
+  const typename TreeType::Mat& referenceSet;
 
   //! The query set.
-  const arma::mat& querySet;
+  const typename TreeType::Mat& querySet;
 
   //! The range of distances for which we are searching.
   const math::Range& range;
@@ -139,6 +158,14 @@ class RangeSearchRules
   //! If true, the query and reference set are taken to be the same.
   bool sameSet;
 
+  //! The element type of the datasets.
+  typedef typename TreeType::Mat::elem_type ElemType;
+
+  //! Per-point values of the datasets reused by the block BaseCase(), computed
+  //! by its first call and shared by copies of the rules; see
+  //! metric::PairwiseDistanceNorms().
+  std::shared_ptr<metric::PairwiseDistanceNormCache<ElemType>> norms;
+
   //! The last query index.
   size_t lastQueryIndex;
   //! The last reference index.
@@ -20,8 +20,8 @@ namespace range {
 
 template<typename MetricType, typename TreeType>
 RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
-    const arma::mat& referenceSet,
-    const arma::mat& querySet,
+    const typename TreeType::Mat& referenceSet,
+    const typename TreeType::Mat& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t> >& neighbors,
     std::vector<std::vector<double> >& distances,
@@ -39,7 +39,9 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
     baseCases(0),
     scores(0)
 {
-  // Nothing to do.
+  // The values reused by the block base cases are only computed if there are
+  // any block base cases.
+  norms.reset(new metric::PairwiseDistanceNormCache<ElemType>());
 }
 
 //! The base case.  Evaluate the distance between the two points and add to the
@@ -75,6 +77,57 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   return distance;
 }
 
+template<typename MetricType, typename TreeType>
+void RangeSearchRules<MetricType, TreeType>::BaseCase(
+    const arma::uvec& queryIndices,
+    TreeType& referenceNode)
+{
+  arma::uvec referenceIndices(referenceNode.NumPoints());
+  for (size_t i = 0; i < referenceIndices.n_elem; ++i)
+    referenceIndices[i] = referenceNode.Point(i);
+
+  if (queryIndices.n_elem == 0 || referenceIndices.n_elem == 0)
+    return;
+
+  norms->Compute(metric, querySet, referenceSet);
+  arma::Mat<ElemType> blockDistances;
+  const double error = metric::PairwiseDistances(metric, querySet,
+      queryIndices, norms->QueryNorms(), referenceSet, referenceIndices,
+      norms->ReferenceNorms(), blockDistances);
+  baseCases += queryIndices.n_elem * referenceIndices.n_elem;
+
+  for (size_t j = 0; j < referenceIndices.n_elem; ++j)
+  {
+    const size_t referenceIndex = referenceIndices[j];
+    for (size_t i = 0; i < queryIndices.n_elem; ++i)
+    {
+      const size_t queryIndex = queryIndices[i];
+
+      // Don't return a point as in its own range.
+      if (sameSet && (queryIndex == referenceIndex))
+        continue;
+
+      double distance = blockDistances(i, j);
+      if (error > 0.0)
+      {
+        // Skip the pair if it is outside the range even with the error taken
+        // into account; otherwise, get the exact distance.
+        if (distance + error < range.Lo() || distance - error > range.Hi())
+          continue;
+
+        distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
+            referenceSet.unsafe_col(referenceIndex));
+      }
+
+      if (range.Contains(distance))
+      {
+        neighbors[queryIndex].push_back(referenceIndex);
+        distances[queryIndex].push_back(distance);
+      }
+    }
+  }
+}
+
 //! Single-tree scoring function.
 template<typename MetricType, typename TreeType>
 double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
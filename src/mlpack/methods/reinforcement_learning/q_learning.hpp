@@ -16,6 +16,7 @@
 #include <mlpack/prereqs.hpp>
 
 #include "replay/random_replay.hpp"
+#include "replay/prioritized_replay.hpp"
 #include "training_config.hpp"
 
 namespace mlpack {
@@ -45,7 +46,8 @@ namespace rl {
  * @tparam NetworkType The network to compute action value.
  * @tparam UpdaterType How to apply gradients when training.
  * @tparam PolicyType Behavior policy of the agent.
- * @tparam ReplayType Experience replay method.
+ * @tparam ReplayType Experience replay method (RandomReplay or
+ *         PrioritizedReplay).
  */
 template <
   typename EnvironmentType,
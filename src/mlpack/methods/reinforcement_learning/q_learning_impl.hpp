@@ -144,12 +144,18 @@ double QLearning<
   // Compute the update target.
   arma::mat target;
   learningNetwork.Forward(sampledStates, target);
+  arma::colvec tdErrors(sampledNextStates.n_cols);
   for (size_t i = 0; i < sampledNextStates.n_cols; ++i)
   {
-    target(sampledActions[i], i) = sampledRewards[i] + config.Discount() *
+    const double value = sampledRewards[i] + config.Discount() *
         (isTerminal[i] ? 0.0 : nextActionValues(bestActions[i], i));
+    tdErrors[i] = value - target(sampledActions[i], i);
+    target(sampledActions[i], i) = value;
   }
 
+  // Let the replay method use the errors, for instance to update priorities.
+  replayMethod.Update(sampledActions, tdErrors, target);
+
   // Learn form experience.
   arma::mat gradients;
   learningNetwork.Backward(target, gradients);
@@ -0,0 +1,256 @@
+/**
+ * @file prioritized_replay.hpp
+ *
+ * This file is an implementation of prioritized experience replay.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+#define MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "sum_tree.hpp"
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of prioritized experience replay.
+ *
+ * Like random experience replay, the transitions are stored in a
+ * First-In-First-Out buffer, but each transition is sampled with probability
+ * proportional to its priority raised to the power alpha, where the priority
+ * is the absolute temporal-difference error of the last update with that
+ * transition.  New transitions get the largest priority seen so far, so that
+ * they are replayed at least once.  Since prioritized sampling changes the
+ * distribution of the updates, each update is weighted by the importance
+ * sampling weight (N * P(i))^-beta, normalized by the largest weight of the
+ * batch.
+ *
+ * The priorities are kept in a sum tree, so sampling a transition and updating
+ * its priority both take O(log n) time.  Each batch is sampled with one
+ * transition from each of batchSize segments of equal total priority.
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @article{schaul2015prioritized,
+ *  title   = {Prioritized Experience Replay},
+ *  author  = {Schaul, Tom and Quan, John and Antonoglou, Ioannis and
+ *             Silver, David},
+ *  journal = {arXiv preprint arXiv:1511.05952},
+ *  year    = {2015}
+ * }
+ * @endcode
+ *
+ * @tparam EnvironmentType Desired task.
+ */
+template <typename EnvironmentType>
+class PrioritizedReplay
+{
+ public:
+  //! Convenient typedef for action.
+  using ActionType = typename EnvironmentType::Action;
+
+  //! Convenient typedef for state.
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Construct an instance of prioritized experience replay class.
+   *
+   * @param batchSize Number of examples returned at each sample.
+   * @param capacity Total memory size in terms of number of examples.
+   * @param alpha How much the priorities matter; 0 is uniform sampling.
+   * @param beta How much the importance sampling weights correct the updates;
+   *        1 is a full correction.
+   * @param dimension The dimension of an encoded state.
+   */
+  PrioritizedReplay(const size_t batchSize,
+                    const size_t capacity,
+                    const double alpha = 0.6,
+                    const double beta = 0.4,
+                    const size_t dimension = StateType::dimension) :
+      batchSize(batchSize),
+      capacity(capacity),
+      alpha(alpha),
+      beta(beta),
+      position(0),
+      states(dimension, capacity),
+      actions(capacity),
+      rewards(capacity),
+      nextStates(dimension, capacity),
+      isTerminal(capacity),
+      full(false),
+      priorities(capacity),
+      maxPriority(1.0)
+  { /* Nothing to do here. */ }
+
+  /**
+   * Store the given experience, with the largest priority seen so far.
+   *
+   * @param state Given state.
+   * @param action Given action.
+   * @param reward Given reward.
+   * @param nextState Given next state.
+   * @param isEnd Whether next state is terminal state.
+   */
+  void Store(const StateType& state,
+             ActionType action,
+             double reward,
+             const StateType& nextState,
+             bool isEnd)
+  {
+    states.col(position) = state.Encode();
+    actions(position) = action;
+    rewards(position) = reward;
+    nextStates.col(position) = nextState.Encode();
+    isTerminal(position) = isEnd;
+    priorities.Set(position, std::pow(maxPriority, alpha));
+    position++;
+    if (position == capacity)
+    {
+      full = true;
+      position = 0;
+    }
+  }
+
+  /**
+   * Sample some experiences according to their priorities.  The indices and
+   * the importance sampling weights of the sample are kept for Update().
+   *
+   * @param sampledStates Sampled encoded states.
+   * @param sampledActions Sampled actions.
+   * @param sampledRewards Sampled rewards.
+   * @param sampledNextStates Sampled encoded next states.
+   * @param isTerminal Indicate whether corresponding next state is terminal
+   *        state.
+   */
+  void Sample(arma::mat& sampledStates,
+              arma::icolvec& sampledActions,
+              arma::colvec& sampledRewards,
+              arma::mat& sampledNextStates,
+              arma::icolvec& isTerminal)
+  {
+    const double total = priorities.Sum();
+    const double segment = total / batchSize;
+    sampledIndices.set_size(batchSize);
+    weights.set_size(batchSize);
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      sampledIndices[i] = priorities.FindPrefixSum((i + math::Random()) *
+          segment);
+
+      // The weights are normalized below, so the constant factors of
+      // (N * P(i))^-beta don't matter.
+      weights[i] = std::pow(priorities.Get(sampledIndices[i]), -beta);
+    }
+    weights /= weights.max();
+
+    sampledStates = states.cols(sampledIndices);
+    sampledActions = actions.elem(sampledIndices);
+    sampledRewards = rewards.elem(sampledIndices);
+    sampledNextStates = nextStates.cols(sampledIndices);
+    isTerminal = this->isTerminal.elem(sampledIndices);
+  }
+
+  /**
+   * Update the priorities of the last sample with the given temporal-difference
+   * errors, and weight the targets of the sample with the importance sampling
+   * weights: the error of each target for its action becomes the weighted
+   * temporal-difference error, so that the squared error loss is weighted.
+   *
+   * @param sampledActions Actions of the last sample.
+   * @param tdErrors Temporal-difference errors of the last sample, the targets
+   *        minus the current action values.
+   * @param target Targets of the last sample, one column per transition.
+   */
+  void Update(const arma::icolvec& sampledActions,
+              const arma::colvec& tdErrors,
+              arma::mat& target)
+  {
+    for (size_t i = 0; i < sampledIndices.n_elem; ++i)
+    {
+      // A small constant keeps every transition reachable.
+      const double priority = std::abs(tdErrors[i]) + 1e-6;
+      priorities.Set(sampledIndices[i], std::pow(priority, alpha));
+      maxPriority = std::max(maxPriority, priority);
+
+      target(sampledActions[i], i) -= (1.0 - weights[i]) * tdErrors[i];
+    }
+  }
+
+  /**
+   * Get the number of transitions in the memory.
+   *
+   * @return Actual used memory size
+   */
+  const size_t& Size()
+  {
+    return full ? capacity : position;
+  }
+
+  //! Get the priority exponent.
+  double Alpha() const { return alpha; }
+
+  //! Get the importance sampling exponent.
+  double Beta() const { return beta; }
+  //! Modify the importance sampling exponent (for instance to anneal it to 1).
+  double& Beta() { return beta; }
+
+  //! Get the importance sampling weights of the last sample.
+  const arma::colvec& Weights() const { return weights; }
+
+ private:
+  //! Locally-stored number of examples of each sample.
+  size_t batchSize;
+
+  //! Locally-stored total memory limit.
+  size_t capacity;
+
+  //! Locally-stored priority exponent.
+  double alpha;
+
+  //! Locally-stored importance sampling exponent.
+  double beta;
+
+  //! Indicate the position to store new transition.
+  size_t position;
+
+  //! Locally-stored encoded previous states.
+  arma::mat states;
+
+  //! Locally-stored previous actions.
+  arma::icolvec actions;
+
+  //! Locally-stored previous rewards.
+  arma::colvec rewards;
+
+  //! Locally-stored encoded previous next states.
+  arma::mat nextStates;
+
+  //! Locally-stored termination information of previous experience.
+  arma::icolvec isTerminal;
+
+  //! Locally-stored indicator that whether the memory is full or not
+  bool full;
+
+  //! Locally-stored priorities of the transitions, raised to the power alpha.
+  SumTree<double> priorities;
+
+  //! The largest priority seen so far.
+  double maxPriority;
+
+  //! The indices of the last sample.
+  arma::uvec sampledIndices;
+
+  //! The importance sampling weights of the last sample.
+  arma::colvec weights;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
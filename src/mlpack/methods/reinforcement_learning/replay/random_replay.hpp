@@ -125,6 +125,19 @@ class RandomReplay
     isTerminal = this->isTerminal.elem(sampledIndices);
   }
 
+  /**
+   * Update the replay memory after learning from the last sample.  Uniform
+   * replay doesn't use the temporal-difference errors, so this does nothing.
+   *
+   * @param sampledActions Actions of the last sample.
+   * @param tdErrors Temporal-difference errors of the last sample.
+   * @param target Targets of the last sample.
+   */
+  void Update(const arma::icolvec& /* sampledActions */,
+              const arma::colvec& /* tdErrors */,
+              arma::mat& /* target */)
+  { /* Nothing to do here. */ }
+
   /**
    * Get the number of transitions in the memory.
    *
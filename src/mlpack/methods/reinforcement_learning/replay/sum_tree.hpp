@@ -0,0 +1,116 @@
+/**
+ * @file sum_tree.hpp
+ *
+ * Definition of the SumTree class, a binary tree of partial sums used to
+ * sample elements with probability proportional to their values.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_SUM_TREE_HPP
+#define MLPACK_METHODS_RL_REPLAY_SUM_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * A sum tree (or segment tree) over a fixed number of non-negative values.
+ * Each inner node holds the sum of its two children, so changing a value and
+ * finding the element at which the prefix sum reaches a given mass both take
+ * O(log n) time.  The tree is stored as an array, with the root at index 1 and
+ * the children of node i at 2i and 2i + 1; the number of leaves is rounded up
+ * to a power of two, and the extra leaves are zero.
+ *
+ * @tparam ElemType Type of the values.
+ */
+template<typename ElemType = double>
+class SumTree
+{
+ public:
+  /**
+   * Create a sum tree with the given number of elements, all zero.
+   *
+   * @param capacity Number of elements.
+   */
+  SumTree(const size_t capacity) : capacity(capacity), leaves(1)
+  {
+    while (leaves < capacity)
+      leaves *= 2;
+
+    tree.zeros(2 * leaves);
+  }
+
+  /**
+   * Set the value of the given element, and update the sums above it.
+   *
+   * @param index Index of the element.
+   * @param value New non-negative value of the element.
+   */
+  void Set(const size_t index, const ElemType value)
+  {
+    size_t node = index + leaves;
+    tree[node] = value;
+
+    // Recompute the sums instead of adding the difference, so that rounding
+    // errors don't accumulate.
+    for (node /= 2; node >= 1; node /= 2)
+      tree[node] = tree[2 * node] + tree[2 * node + 1];
+  }
+
+  //! Get the value of the given element.
+  ElemType Get(const size_t index) const { return tree[index + leaves]; }
+
+  //! Get the sum of all the values.
+  ElemType Sum() const { return tree[1]; }
+
+  //! Get the number of elements.
+  size_t Capacity() const { return capacity; }
+
+  /**
+   * Find the first element at which the prefix sum of the values exceeds the
+   * given mass.  Elements with a zero value are never returned, unless all the
+   * values are zero.
+   *
+   * @param mass The mass, between 0 and Sum().
+   * @return The index of the element.
+   */
+  size_t FindPrefixSum(ElemType mass) const
+  {
+    size_t node = 1;
+    while (node < leaves)
+    {
+      // Only go right if there is something there, in case rounding made the
+      // mass larger than the sum.
+      if (mass < tree[2 * node] || tree[2 * node + 1] <= 0)
+      {
+        node = 2 * node;
+      }
+      else
+      {
+        mass -= tree[2 * node];
+        node = 2 * node + 1;
+      }
+    }
+
+    return std::min(node - leaves, capacity - 1);
+  }
+
+ private:
+  //! The number of elements.
+  size_t capacity;
+
+  //! The number of leaves, a power of two.
+  size_t leaves;
+
+  //! The nodes of the tree.
+  arma::Col<ElemType> tree;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
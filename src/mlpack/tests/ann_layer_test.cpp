@@ -816,6 +816,48 @@ BOOST_AUTO_TEST_CASE(GradientLSTMLayerTest)
   BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
 }
 
+/**
+ * LSTM layer numerical gradient test with a batch of more than one sequence.
+ */
+BOOST_AUTO_TEST_CASE(GradientLSTMLayerBatchTest)
+{
+  // LSTM function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(5, 2);
+      target = arma::ones(5, 2);
+      const size_t rho = 5;
+
+      model = new RNN<NegativeLogLikelihood<> >(input, target, rho);
+      model->Add<IdentityLayer<> >();
+      model->Add<Linear<> >(1, 10);
+      model->Add<LSTM<> >(10, 3, rho);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0, 2);
+      model->Gradient(model->Parameters(), 0, gradient, 2);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    RNN<NegativeLogLikelihood<> >* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
 /**
  * Test the FastLSTM layer with a user defined rho parameter and without.
  */
@@ -1223,4 +1265,129 @@ BOOST_AUTO_TEST_CASE(SimpleMeanSquaredErrorLayerTest)
   BOOST_REQUIRE_EQUAL(output.n_elem, 1);
 }
 
+/**
+ * Test that the im2col convolution layer gives the results of the naive
+ * convolution layer, and processes a batch like its samples one by one.
+ */
+BOOST_AUTO_TEST_CASE(Im2ColConvolutionLayerTest)
+{
+  typedef Convolution<Im2ColConvolution<ValidConvolution>,
+      Im2ColConvolution<FullConvolution>,
+      Im2ColConvolution<ValidConvolution> > Im2ColConvolutionType;
+
+  Convolution<> naive(2, 3, 3, 3, 1, 1, 0, 0, 7, 6);
+  Im2ColConvolutionType im2col(2, 3, 3, 3, 1, 1, 0, 0, 7, 6);
+  naive.Parameters().randu();
+  im2col.Parameters() = naive.Parameters();
+  naive.Reset();
+  im2col.Reset();
+
+  // Test the Forward function.
+  arma::mat input = arma::randu(7 * 6 * 2, 1);
+  arma::mat naiveOutput, output;
+  naive.Forward(std::move(input), std::move(naiveOutput));
+  im2col.Forward(std::move(input), std::move(output));
+  BOOST_REQUIRE_EQUAL(output.n_rows, 5 * 4 * 3);
+  BOOST_REQUIRE_EQUAL(im2col.OutputWidth(), 5);
+  BOOST_REQUIRE_EQUAL(im2col.OutputHeight(), 4);
+  CheckMatrices(naiveOutput, output);
+
+  // Test the Backward function.
+  arma::mat error = arma::randu(output.n_rows, 1);
+  arma::mat naiveDelta, delta;
+  naive.Backward(std::move(input), std::move(error), std::move(naiveDelta));
+  im2col.Backward(std::move(input), std::move(error), std::move(delta));
+  CheckMatrices(naiveDelta, delta);
+
+  // With im2col for the forward pass only, all the passes are naive, so the
+  // backward pass has the input that it needs.
+  Convolution<Im2ColConvolution<ValidConvolution> > mixed(2, 3, 3, 3, 1, 1, 0,
+      0, 7, 6);
+  mixed.Parameters() = naive.Parameters();
+  mixed.Reset();
+  arma::mat mixedOutput, mixedDelta;
+  mixed.Forward(std::move(input), std::move(mixedOutput));
+  mixed.Backward(std::move(input), std::move(error), std::move(mixedDelta));
+  CheckMatrices(naiveOutput, mixedOutput);
+  CheckMatrices(naiveDelta, mixedDelta);
+
+  // A batch gives the results of its samples.
+  arma::mat batch = arma::randu(7 * 6 * 2, 3);
+  arma::mat batchError = arma::randu(5 * 4 * 3, 3);
+  arma::mat batchOutput, batchDelta;
+  arma::mat batchGradient(im2col.Parameters().n_elem, 1);
+  im2col.Forward(std::move(batch), std::move(batchOutput));
+  im2col.Backward(std::move(batch), std::move(batchError),
+      std::move(batchDelta));
+  im2col.Gradient(std::move(batch), std::move(batchError),
+      std::move(batchGradient));
+  BOOST_REQUIRE_EQUAL(batchOutput.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(batchDelta.n_cols, 3);
+
+  arma::mat gradientSum = arma::zeros(im2col.Parameters().n_elem, 1);
+  for (size_t i = 0; i < batch.n_cols; ++i)
+  {
+    arma::mat sample = batch.col(i);
+    arma::mat sampleError = batchError.col(i);
+    arma::mat sampleGradient(im2col.Parameters().n_elem, 1);
+    im2col.Forward(std::move(sample), std::move(output));
+    im2col.Backward(std::move(sample), std::move(sampleError),
+        std::move(delta));
+    im2col.Gradient(std::move(sample), std::move(sampleError),
+        std::move(sampleGradient));
+    gradientSum += sampleGradient;
+
+    CheckMatrices(output, batchOutput.col(i));
+    CheckMatrices(delta, batchDelta.col(i));
+  }
+  CheckMatrices(gradientSum, batchGradient);
+}
+
+/**
+ * Im2col convolution layer numerically gradient test, with stride and
+ * padding.
+ */
+BOOST_AUTO_TEST_CASE(GradientIm2ColConvolutionLayerTest)
+{
+  // Convolution function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(6 * 5 * 2, 1);
+      target = arma::mat("1");
+
+      model = new FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>(
+          input, target);
+      model->Add<IdentityLayer<> >();
+      model->Add<Convolution<Im2ColConvolution<ValidConvolution>,
+          Im2ColConvolution<FullConvolution>,
+          Im2ColConvolution<ValidConvolution> > >(2, 3, 3, 3, 2, 2, 1, 1, 6,
+          5);
+      model->Add<Linear<> >(3 * 3 * 3, 2);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      arma::mat output;
+      double error = model->Evaluate(model->Parameters(), 0, 1);
+      model->Gradient(model->Parameters(), 0, gradient, 1);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -13,6 +13,7 @@
 #include <mlpack/methods/decision_tree/decision_tree.hpp>
 #include <mlpack/methods/decision_tree/information_gain.hpp>
 #include <mlpack/methods/decision_tree/gini_gain.hpp>
+#include <mlpack/methods/decision_tree/histogram_numeric_split.hpp>
 #include <mlpack/methods/decision_tree/random_dimension_select.hpp>
 #include <mlpack/methods/decision_tree/multiple_random_dimension_select.hpp>
 
@@ -367,6 +368,181 @@ BOOST_AUTO_TEST_CASE(BestBinaryNumericSplitNoGainTest)
   BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 0);
 }
 
+/**
+ * Check that the incremental scan of BestBinaryNumericSplit finds the same
+ * split as evaluating the fitness function on each candidate split directly,
+ * with and without weights and with repeated values.
+ */
+template<typename FitnessFunction, bool UseWeights>
+void CheckBestBinaryNumericSplit(const arma::vec& values,
+                                 const arma::Row<size_t>& labels,
+                                 const arma::rowvec& weights,
+                                 const size_t numClasses,
+                                 const size_t minimumLeafSize)
+{
+  const double bestGain = FitnessFunction::template Evaluate<UseWeights>(
+      labels, numClasses, weights);
+
+  // Find the best split by brute force.
+  arma::uvec sortedIndices = arma::sort_index(values);
+  arma::Row<size_t> sortedLabels(labels.n_elem);
+  arma::rowvec sortedWeights(labels.n_elem, arma::fill::ones);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+  {
+    sortedLabels[i] = labels[sortedIndices[i]];
+    if (UseWeights)
+      sortedWeights[i] = weights[sortedIndices[i]];
+  }
+  double expectedGain = bestGain;
+  double expectedSplit = 0.0;
+  for (size_t i = minimumLeafSize; i <= values.n_elem - minimumLeafSize; ++i)
+  {
+    if (values[sortedIndices[i]] == values[sortedIndices[i - 1]])
+      continue;
+
+    const double leftWeight = arma::accu(sortedWeights.subvec(0, i - 1));
+    const double rightWeight = arma::accu(sortedWeights.subvec(i,
+        values.n_elem - 1));
+    const double gain = (leftWeight * FitnessFunction::template
+        Evaluate<true>(sortedLabels.subvec(0, i - 1), numClasses,
+        sortedWeights.subvec(0, i - 1)) + rightWeight * FitnessFunction::
+        template Evaluate<true>(sortedLabels.subvec(i, values.n_elem - 1),
+        numClasses, sortedWeights.subvec(i, values.n_elem - 1))) /
+        (leftWeight + rightWeight);
+    if (gain > expectedGain)
+    {
+      expectedGain = gain;
+      expectedSplit = (values[sortedIndices[i - 1]] +
+          values[sortedIndices[i]]) / 2.0;
+    }
+  }
+
+  arma::vec classProbabilities;
+  typename BestBinaryNumericSplit<FitnessFunction>::template
+      AuxiliarySplitInfo<double> aux;
+  const double gain = BestBinaryNumericSplit<FitnessFunction>::template
+      SplitIfBetter<UseWeights>(bestGain, values, labels, numClasses, weights,
+      minimumLeafSize, classProbabilities, aux);
+
+  BOOST_REQUIRE_CLOSE(gain, expectedGain, 1e-5);
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 1);
+  BOOST_REQUIRE_CLOSE(classProbabilities[0], expectedSplit, 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(BestBinaryNumericSplitIncrementalTest)
+{
+  // Random values with many repeats, and labels that depend on the value.
+  arma::vec values = arma::floor(10.0 * arma::randu<arma::vec>(500));
+  arma::Row<size_t> labels(values.n_elem);
+  for (size_t i = 0; i < values.n_elem; ++i)
+    labels[i] = (values[i] > 6.0 && math::Random() < 0.9) ? 2 :
+        math::RandInt(2);
+  arma::rowvec weights = arma::randu<arma::rowvec>(values.n_elem);
+
+  CheckBestBinaryNumericSplit<GiniGain, false>(values, labels, weights, 3, 5);
+  CheckBestBinaryNumericSplit<GiniGain, true>(values, labels, weights, 3, 5);
+  CheckBestBinaryNumericSplit<InformationGain, false>(values, labels, weights,
+      3, 5);
+  CheckBestBinaryNumericSplit<InformationGain, true>(values, labels, weights,
+      3, 5);
+}
+
+/**
+ * Check that QuantileBinning gives each distinct value its own bin when there
+ * are few of them, and bins of about the same size otherwise.
+ */
+BOOST_AUTO_TEST_CASE(QuantileBinningTest)
+{
+  arma::mat data(2, 1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    data(0, i) = i % 5;
+    data(1, i) = math::Random();
+  }
+
+  QuantileBinning binning(data, 10);
+  BOOST_REQUIRE_EQUAL(binning.Dimensionality(), 2);
+  BOOST_REQUIRE_EQUAL(binning.NumBins(0), 5);
+  BOOST_REQUIRE_EQUAL(binning.NumBins(1), 10);
+
+  arma::Mat<unsigned char> codes;
+  binning.Transform(data, codes);
+  BOOST_REQUIRE_EQUAL(codes.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(codes.n_cols, 1000);
+
+  arma::Col<size_t> binSizes(10, arma::fill::zeros);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    BOOST_REQUIRE_EQUAL((size_t) codes(0, i), i % 5);
+    binSizes[codes(1, i)]++;
+  }
+
+  // Each quantile bin should hold 100 points.
+  for (size_t b = 0; b < 10; ++b)
+    BOOST_REQUIRE_EQUAL(binSizes[b], 100);
+
+  // Too many bins can't be stored in 8 bits.
+  BOOST_REQUIRE_THROW(QuantileBinning(data, 257), std::invalid_argument);
+}
+
+/**
+ * Check that the HistogramNumericSplit finds the same split as the
+ * BestBinaryNumericSplit when each value has its own bin, and that a tree can
+ * be trained on the codes.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitTest)
+{
+  arma::mat data(1, 500);
+  arma::Row<size_t> labels(500);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data(0, i) = math::RandInt(50);
+    labels[i] = (data(0, i) > 30 && math::Random() < 0.9) ? 2 :
+        math::RandInt(2);
+  }
+  arma::rowvec weights = arma::randu<arma::rowvec>(500);
+
+  QuantileBinning binning(data);
+  arma::Mat<unsigned char> codes;
+  binning.Transform(data, codes);
+
+  for (size_t w = 0; w < 2; ++w)
+  {
+    const double bestGain = GiniGain::Evaluate<true>(labels, 3, (w == 0) ?
+        arma::rowvec(500, arma::fill::ones) : weights);
+
+    arma::vec splitInfo, histogramSplitInfo;
+    BestBinaryNumericSplit<GiniGain>::AuxiliarySplitInfo<double> aux;
+    HistogramNumericSplit<GiniGain>::AuxiliarySplitInfo<double> histogramAux;
+    const double gain = (w == 0) ?
+        BestBinaryNumericSplit<GiniGain>::SplitIfBetter<false>(bestGain,
+            data.row(0), labels, 3, weights, 5, splitInfo, aux) :
+        BestBinaryNumericSplit<GiniGain>::SplitIfBetter<true>(bestGain,
+            data.row(0), labels, 3, weights, 5, splitInfo, aux);
+    const double histogramGain = (w == 0) ?
+        HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(bestGain,
+            codes.row(0), labels, 3, weights, 5, histogramSplitInfo,
+            histogramAux) :
+        HistogramNumericSplit<GiniGain>::SplitIfBetter<true>(bestGain,
+            codes.row(0), labels, 3, weights, 5, histogramSplitInfo,
+            histogramAux);
+
+    BOOST_REQUIRE_CLOSE(histogramGain, gain, 1e-5);
+    BOOST_REQUIRE_EQUAL(histogramSplitInfo.n_elem, 1);
+    BOOST_REQUIRE_EQUAL((double) binning.Bin(0, splitInfo[0]),
+        histogramSplitInfo[0]);
+  }
+
+  // A tree trained on the codes should fit the training set as well as a tree
+  // trained on the values.
+  DecisionTree<GiniGain, HistogramNumericSplit> tree(codes, labels, 3, 1);
+  DecisionTree<> exactTree(data, labels, 3, 1);
+  arma::Row<size_t> predictions, exactPredictions;
+  tree.Classify(codes, predictions);
+  exactTree.Classify(data, exactPredictions);
+  BOOST_REQUIRE_EQUAL(arma::accu(predictions == exactPredictions), 500);
+}
+
 /**
  * Check that the AllCategoricalSplit will split when the split is obviously
  * better.
@@ -1082,4 +1258,42 @@ BOOST_AUTO_TEST_CASE(ConstDataTest)
       constWeights);
 }
 
+/**
+ * Make sure that a tree trained in parallel is the same as the tree trained
+ * serially, with and without categorical dimensions.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTrainingTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+  arma::rowvec weights(l.n_elem, arma::fill::randu);
+
+  DecisionTree<> serialTree(d, di, l, 5, weights, 5);
+  DecisionTree<> parallelTree(d, di, l, 5, weights, 5, true);
+
+  arma::Row<size_t> predictions, parallelPredictions;
+  arma::mat probabilities, parallelProbabilities;
+  serialTree.Classify(d, predictions, probabilities);
+  parallelTree.Classify(d, parallelPredictions, parallelProbabilities);
+  for (size_t i = 0; i < d.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], parallelPredictions[i]);
+  CheckMatrices(probabilities, parallelProbabilities);
+
+  // Now use only the numeric dimensions.
+  arma::mat numericData = d.rows(0, 1);
+  DecisionTree<> numericTree;
+  numericTree.Train(numericData, l, 5, 5);
+  DecisionTree<> parallelNumericTree;
+  parallelNumericTree.Train(numericData, l, 5, 5, true);
+
+  numericTree.Classify(numericData, predictions, probabilities);
+  parallelNumericTree.Classify(numericData, parallelPredictions,
+      parallelProbabilities);
+  for (size_t i = 0; i < d.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], parallelPredictions[i]);
+  CheckMatrices(probabilities, parallelProbabilities);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -16,6 +16,7 @@
 #include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/frozen_ffn.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -501,6 +502,206 @@ BOOST_AUTO_TEST_CASE(FFNMiscTest)
   movedModel = std::move(copiedModel);
 }
 
+/**
+ * Test that the batch gradient is the sum of the gradients of its points, and
+ * that repeated calls with the same batch size reuse the memory of the layers
+ * and of the gradient.
+ */
+BOOST_AUTO_TEST_CASE(FFNBatchWorkspaceTest)
+{
+  arma::mat data = arma::randu(10, 20);
+  arma::mat labels = arma::floor(arma::randu(1, 20) * 3) + 1;
+
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model(data, labels);
+  model.Add<Linear<> >(10, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat gradient;
+  model.Gradient(model.Parameters(), 0, gradient, 5);
+  const arma::mat batchGradient = gradient;
+
+  arma::mat pointGradient, gradientSum(arma::size(gradient), arma::fill::zeros);
+  for (size_t i = 0; i < 5; ++i)
+  {
+    model.Gradient(model.Parameters(), i, pointGradient, 1);
+    gradientSum += pointGradient;
+  }
+  CheckMatrices(batchGradient, gradientSum);
+
+  // Warm up with the batch size, then check that nothing moves.
+  model.Gradient(model.Parameters(), 0, gradient, 5);
+  const double* gradientMemory = gradient.memptr();
+  std::vector<const double*> outputMemory;
+  for (size_t i = 0; i < model.NetworkSize(); i += 2)
+  {
+    outputMemory.push_back(
+        model.GetLayer<Linear<>*>(i)->OutputParameter().memptr());
+    outputMemory.push_back(
+        model.GetLayer<Linear<>*>(i)->Delta().memptr());
+  }
+
+  for (size_t begin = 5; begin < 20; begin += 5)
+  {
+    model.Evaluate(model.Parameters(), begin, 5, false);
+    model.Gradient(model.Parameters(), begin, gradient, 5);
+
+    BOOST_REQUIRE_EQUAL(gradient.memptr(), gradientMemory);
+    for (size_t i = 0, j = 0; i < model.NetworkSize(); i += 2, j += 2)
+    {
+      BOOST_REQUIRE_EQUAL(
+          model.GetLayer<Linear<>*>(i)->OutputParameter().memptr(),
+          outputMemory[j]);
+      BOOST_REQUIRE_EQUAL(model.GetLayer<Linear<>*>(i)->Delta().memptr(),
+          outputMemory[j + 1]);
+    }
+  }
+}
+
+/**
+ * Test that the data-parallel gradient is the same as the sequential one.
+ */
+BOOST_AUTO_TEST_CASE(FFNParallelGradientTest)
+{
+  arma::mat data = arma::randu(10, 50);
+  arma::mat labels = arma::floor(arma::randu(1, 50) * 3) + 1;
+
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model(data, labels);
+  model.Add<Linear<> >(10, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  // Try a batch smaller than the number of threads too.
+  const size_t batchSizes[] = { 50, 17, 3 };
+  for (size_t i = 0; i < 3; ++i)
+  {
+    arma::mat gradient, parallelGradient;
+    model.Threads() = 1;
+    model.Gradient(model.Parameters(), 0, gradient, batchSizes[i]);
+
+    model.Threads() = 4;
+    model.Gradient(model.Parameters(), 0, parallelGradient, batchSizes[i]);
+
+    CheckMatrices(gradient, parallelGradient);
+  }
+
+  // The replicas follow changes of the parameters.
+  model.Parameters() *= 2.0;
+  arma::mat gradient, parallelGradient;
+  model.Threads() = 1;
+  model.Gradient(model.Parameters(), 10, gradient, 40);
+  model.Threads() = 4;
+  model.Gradient(model.Parameters(), 10, parallelGradient, 40);
+  CheckMatrices(gradient, parallelGradient);
+}
+
+/**
+ * Test that a frozen network predicts the same as the network, and that it
+ * survives serialization.
+ */
+BOOST_AUTO_TEST_CASE(FrozenFFNTest)
+{
+  arma::mat data = arma::randu(10, 50);
+
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model;
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(10, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Dropout<> >(0.3);
+  model.Add<Linear<> >(8, 6);
+  model.Add<ReLULayer<> >();
+  model.Add<LinearNoBias<> >(6, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  FrozenFFN frozen(model);
+
+  // The activations are fused with the affine steps, and the dropout scale
+  // with the second one.
+  BOOST_REQUIRE_EQUAL(frozen.NumSteps(), 3);
+
+  arma::mat predictions, frozenPredictions;
+  model.Predict(data, predictions);
+  frozen.Predict(data, frozenPredictions);
+
+  // The LogSoftMax layer of the network approximates the exponential.
+  BOOST_REQUIRE_EQUAL(frozenPredictions.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(frozenPredictions.n_cols, 50);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(predictions[i] - frozenPredictions[i], 1e-3);
+
+  FrozenFFN xmlFrozen, textFrozen, binaryFrozen;
+  SerializeObjectAll(frozen, xmlFrozen, textFrozen, binaryFrozen);
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlFrozen.Predict(data, xmlPredictions);
+  textFrozen.Predict(data, textPredictions);
+  binaryFrozen.Predict(data, binaryPredictions);
+  CheckMatrices(frozenPredictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+
+  // A layer that can't be frozen.
+  FFN<NegativeLogLikelihood<>, RandomInitialization> other;
+  other.Add<Linear<> >(10, 8);
+  other.Add<LeakyReLU<> >();
+  BOOST_REQUIRE_THROW(FrozenFFN otherFrozen(other), std::invalid_argument);
+}
+
+/**
+ * Test that a convolutional network frozen with reduced precision predicts
+ * about the same as the network, with less memory.
+ */
+BOOST_AUTO_TEST_CASE(FrozenFFNPrecisionTest)
+{
+  arma::mat data = arma::randu(64, 20);
+
+  FFN<NegativeLogLikelihood<>, RandomInitialization> model(
+      NegativeLogLikelihood<>(), RandomInitialization(-0.2, 0.2));
+  model.Add<Convolution<> >(1, 4, 3, 3, 1, 1, 1, 1, 8, 8);
+  model.Add<ReLULayer<> >();
+  model.Add<Linear<> >(256, 3);
+  model.Add<LogSoftMax<> >();
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+
+  FrozenFFN frozen(model);
+  FrozenFFN floatFrozen(model, FrozenFFN::FLOAT);
+  FrozenFFN int8Frozen(model, FrozenFFN::INT8);
+  BOOST_REQUIRE_EQUAL(frozen.NumSteps(), 2);
+  BOOST_REQUIRE_LT(floatFrozen.WeightBytes(), frozen.WeightBytes() / 1.9);
+  BOOST_REQUIRE_LT(int8Frozen.WeightBytes(), frozen.WeightBytes() / 3);
+
+  arma::mat frozenPredictions, floatPredictions, int8Predictions;
+  frozen.Predict(data, frozenPredictions);
+  floatFrozen.Predict(data, floatPredictions);
+  int8Frozen.Predict(data, int8Predictions);
+
+  BOOST_REQUIRE_EQUAL(int8Predictions.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(int8Predictions.n_cols, 20);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+  {
+    BOOST_REQUIRE_SMALL(predictions[i] - frozenPredictions[i], 1e-3);
+    BOOST_REQUIRE_SMALL(frozenPredictions[i] - floatPredictions[i], 1e-4);
+    BOOST_REQUIRE_SMALL(frozenPredictions[i] - int8Predictions[i], 0.05);
+  }
+
+  // The quantized weights survive serialization.
+  FrozenFFN xmlFrozen, textFrozen, binaryFrozen;
+  SerializeObjectAll(int8Frozen, xmlFrozen, textFrozen, binaryFrozen);
+
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlFrozen.Predict(data, xmlPredictions);
+  textFrozen.Predict(data, textPredictions);
+  binaryFrozen.Predict(data, binaryPredictions);
+  CheckMatrices(int8Predictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+}
+
 /**
  * Test that serialization works ok.
  */
@@ -0,0 +1,122 @@
+/**
+ * @file gradient_boosting_test.cpp
+ *
+ * Tests for the GradientBoosting class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/gradient_boosting/gradient_boosting.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+#include "serialization.hpp"
+#include "mock_categorical_data.hpp"
+
+using namespace mlpack;
+using namespace mlpack::tree;
+
+BOOST_AUTO_TEST_SUITE(GradientBoostingTest);
+
+/**
+ * Make sure that gradient boosting with the squared error loss fits a smooth
+ * nonlinear function much better than the constant model.
+ */
+BOOST_AUTO_TEST_CASE(GradientBoostingRegressionTest)
+{
+  arma::mat data(3, 2000, arma::fill::randu);
+  arma::rowvec responses = arma::sin(6.0 * data.row(0)) +
+      arma::square(data.row(1)) + 0.05 * arma::randn<arma::rowvec>(2000);
+
+  arma::mat trainData = data.cols(0, 1499);
+  arma::rowvec trainResponses = responses.subvec(0, 1499);
+  arma::mat testData = data.cols(1500, 1999);
+  arma::rowvec testResponses = responses.subvec(1500, 1999);
+
+  // Use row and column subsampling too.
+  GradientBoosting<> gbdt(200, 0.1, 4, 10, 1.0, 0.8, 0.8);
+  gbdt.Train(trainData, trainResponses);
+  BOOST_REQUIRE_EQUAL(gbdt.NumOutputs(), 1);
+  BOOST_REQUIRE_EQUAL(gbdt.NumTrees(), 200);
+
+  arma::rowvec predictions;
+  gbdt.Predict(testData, predictions);
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, 500);
+
+  const double error = arma::mean(arma::square(predictions - testResponses));
+  const double variance = arma::var(testResponses);
+  BOOST_REQUIRE_LT(error, 0.1 * variance);
+}
+
+/**
+ * Make sure that gradient boosting with the logistic loss learns a simple
+ * binary problem, and that a serialized model gives the same predictions.
+ */
+BOOST_AUTO_TEST_CASE(GradientBoostingLogisticTest)
+{
+  arma::mat data(2, 2000, arma::fill::randu);
+  arma::Row<size_t> labels(2000);
+  for (size_t i = 0; i < 2000; ++i)
+    labels[i] = (data(0, i) + data(1, i) > 1.0) ? 1 : 0;
+
+  GradientBoosting<LogisticLoss> gbdt(50, 0.3, 3, 5);
+  gbdt.Train(data.cols(0, 1499), labels.subvec(0, 1499), 2);
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  gbdt.Classify(data.cols(1500, 1999), predictions, probabilities);
+  BOOST_REQUIRE_EQUAL(probabilities.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(probabilities.n_cols, 500);
+
+  const size_t correct = arma::accu(predictions == labels.subvec(1500, 1999));
+  BOOST_REQUIRE_GE(correct, 450);
+
+  GradientBoosting<LogisticLoss> xmlGbdt, textGbdt, binaryGbdt;
+  SerializeObjectAll(gbdt, xmlGbdt, textGbdt, binaryGbdt);
+
+  arma::mat scores, xmlScores, textScores, binaryScores;
+  gbdt.Predict(data, scores);
+  xmlGbdt.Predict(data, xmlScores);
+  textGbdt.Predict(data, textScores);
+  binaryGbdt.Predict(data, binaryScores);
+  CheckMatrices(scores, xmlScores, textScores, binaryScores);
+}
+
+/**
+ * Make sure that gradient boosting with the softmax loss learns a multiclass
+ * problem with categorical dimensions.
+ */
+BOOST_AUTO_TEST_CASE(GradientBoostingCategoricalSoftmaxTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  // Split into a training set and a test set.
+  arma::mat trainingData = d.cols(0, 1999);
+  arma::mat testData = d.cols(2000, 3999);
+  arma::Row<size_t> trainingLabels = l.subvec(0, 1999);
+  arma::Row<size_t> testLabels = l.subvec(2000, 3999);
+
+  GradientBoosting<SoftmaxLoss> gbdt(30, 0.2, 4, 10, 1.0, 0.8);
+  gbdt.Train(trainingData, di, trainingLabels, 5);
+  BOOST_REQUIRE_EQUAL(gbdt.NumOutputs(), 5);
+  BOOST_REQUIRE_EQUAL(gbdt.NumTrees(), 150);
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  gbdt.Classify(testData, predictions, probabilities);
+
+  // The probabilities of each point must sum to one.
+  for (size_t i = 0; i < testData.n_cols; ++i)
+    BOOST_REQUIRE_CLOSE(arma::accu(probabilities.col(i)), 1.0, 1e-5);
+
+  const size_t correct = arma::accu(predictions == testLabels);
+  BOOST_REQUIRE_GE(correct, size_t(0.7 * testData.n_cols));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -18,6 +18,8 @@
 #include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
 #include <mlpack/methods/kmeans/sample_initialization.hpp>
 #include <mlpack/methods/kmeans/random_partition.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
+#include <mlpack/methods/kmeans/kmeans_parallel_initialization.hpp>
 
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
@@ -568,6 +570,47 @@ BOOST_AUTO_TEST_CASE(HamerlyTest)
   }
 }
 
+#ifdef HAS_OPENMP
+/**
+ * Make sure that the multithreaded iterations of Elkan's and Hamerly's
+ * algorithms give the same clusters as a single thread.
+ */
+template<template<class, class> class LloydStepType>
+void CheckParallelLloydStep()
+{
+  arma::mat dataset(5, 20000, arma::fill::randu);
+  const size_t k = 40;
+  arma::mat centroids(5, k, arma::fill::randu);
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      LloydStepType> kmeans;
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  arma::Row<size_t> serialAssignments;
+  arma::mat serialCentroids(centroids);
+  kmeans.Cluster(dataset, k, serialAssignments, serialCentroids, false, true);
+  omp_set_num_threads(std::max(prevNumThreads, size_t(4)));
+  arma::Row<size_t> parallelAssignments;
+  arma::mat parallelCentroids(centroids);
+  kmeans.Cluster(dataset, k, parallelAssignments, parallelCentroids, false,
+      true);
+  omp_set_num_threads(prevNumThreads);
+
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(serialAssignments[i], parallelAssignments[i]);
+
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(serialCentroids[i], parallelCentroids[i], 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelElkanHamerlyTest)
+{
+  CheckParallelLloydStep<ElkanKMeans>();
+  CheckParallelLloydStep<HamerlyKMeans>();
+}
+#endif
+
 BOOST_AUTO_TEST_CASE(PellegMooreTest)
 {
   const size_t trials = 5;
@@ -700,4 +743,125 @@ BOOST_AUTO_TEST_CASE(SampleInitializationTest)
   }
 }
 
+/**
+ * Generate points around three centers; each point is in cluster (i % 3).
+ */
+arma::mat MiniBatchTestData(const size_t points, const arma::mat& centers)
+{
+  arma::mat data(2, points, arma::fill::randn);
+  data *= 0.3;
+  for (size_t i = 0; i < points; ++i)
+    data.col(i) += centers.col(i % 3);
+
+  return data;
+}
+
+/**
+ * Make sure that mini-batch k-means finds well-separated clusters.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansTest)
+{
+  const arma::mat centers("0.0 10.0 -10.0; 0.0 10.0 5.0");
+  arma::mat data = MiniBatchTestData(20000, centers);
+
+  KMeans<EuclideanDistance, SampleInitialization, AllowEmptyClusters,
+      MiniBatchKMeans> kmeans(200);
+
+  // Start from rough guesses, so that the result doesn't depend on the
+  // initialization.
+  arma::mat centroids = centers + 2.0;
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(data, 3, assignments, centroids, false, true);
+
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(centroids[i] - centers[i], 0.05);
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], i % 3);
+}
+
+/**
+ * Make sure that KMeans::Update() clusters a dataset given in chunks.
+ */
+BOOST_AUTO_TEST_CASE(KMeansUpdateTest)
+{
+  const arma::mat centers("0.0 10.0 -10.0; 0.0 10.0 5.0");
+  KMeans<> kmeans;
+
+  // The first batch initializes the centroids.
+  arma::mat centroids;
+  arma::Col<size_t> counts;
+  kmeans.Update(MiniBatchTestData(3000, centers), 3, centroids, counts);
+  BOOST_REQUIRE_EQUAL(centroids.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(arma::accu(counts), 3000);
+
+  // Now stream chunks into rough guesses of the centers.
+  centroids = centers + 2.0;
+  counts.zeros(3);
+  for (size_t i = 0; i < 10; ++i)
+    kmeans.Update(MiniBatchTestData(3000, centers), 3, centroids, counts);
+
+  BOOST_REQUIRE_EQUAL(arma::accu(counts), 30000);
+  for (size_t c = 0; c < 3; ++c)
+  {
+    BOOST_REQUIRE_EQUAL(counts[c], 10000);
+    for (size_t d = 0; d < 2; ++d)
+      BOOST_REQUIRE_SMALL(centroids(d, c) - centers(d, c), 0.05);
+  }
+}
+
+/**
+ * Make sure that the k-means|| initialization puts one centroid in each of many
+ * well-separated clusters.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationTest)
+{
+  const size_t clusters = 20;
+  arma::mat centers(2, clusters);
+  for (size_t c = 0; c < clusters; ++c)
+  {
+    centers(0, c) = 10.0 * (c % 5);
+    centers(1, c) = 10.0 * (c / 5);
+  }
+
+  arma::mat dataset(2, 4000, arma::fill::randn);
+  dataset *= 0.1;
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) += centers.col(i % clusters);
+
+  KMeansParallelInitialization init;
+  arma::mat centroids;
+  init.Cluster(dataset, clusters, centroids);
+
+  BOOST_REQUIRE_EQUAL(centroids.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, clusters);
+
+  // Each center must have exactly one centroid close to it.
+  for (size_t c = 0; c < clusters; ++c)
+  {
+    size_t close = 0;
+    for (size_t i = 0; i < clusters; ++i)
+      if (metric::EuclideanDistance::Evaluate(centers.col(c),
+          centroids.col(i)) < 1.0)
+        ++close;
+
+    BOOST_REQUIRE_EQUAL(close, 1);
+  }
+
+  // Now make sure it works as the initial partition policy of KMeans.
+  KMeans<EuclideanDistance, KMeansParallelInitialization> kmeans;
+  arma::Row<size_t> assignments;
+  kmeans.Cluster((arma::mat) trans(kMeansData), 3, assignments);
+
+  BOOST_REQUIRE_NE(assignments[0], assignments[13]);
+  BOOST_REQUIRE_NE(assignments[0], assignments[20]);
+  BOOST_REQUIRE_NE(assignments[13], assignments[20]);
+  for (size_t i = 0; i < 30; ++i)
+  {
+    const size_t first = (i < 13) ? 0 : (i < 20) ? 13 : 20;
+    BOOST_REQUIRE_EQUAL(assignments[i], assignments[first]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -888,6 +888,167 @@ BOOST_AUTO_TEST_CASE(DualBallTreeTest)
   }
 }
 
+/**
+ * Make sure that the query subtrees used for a parallel dual-tree traversal
+ * hold each query point exactly once.
+ */
+BOOST_AUTO_TEST_CASE(QueryTaskFrontierTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 1000);
+
+  KNN::Tree tree(dataset);
+
+  std::vector<KNN::Tree*> frontier;
+  QueryTaskFrontier(tree, 16, 20, frontier);
+
+  BOOST_REQUIRE_GE(frontier.size(), 16);
+
+  arma::Col<size_t> counts(dataset.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < frontier.size(); ++i)
+  {
+    for (size_t j = 0; j < frontier[i]->NumDescendants(); ++j)
+      ++counts[frontier[i]->Descendant(j)];
+
+    // The subtrees should be sorted from largest to smallest.
+    if (i > 0)
+    {
+      BOOST_REQUIRE_GE(frontier[i - 1]->NumDescendants(),
+          frontier[i]->NumDescendants());
+    }
+  }
+
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], 1);
+}
+
+/**
+ * Test the parallel dual-tree traversal with very small tasks against the
+ * naive method, for both the monochromatic and the bichromatic case.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeTraversalTest)
+{
+  arma::mat dataset;
+  data::Load("test_data_3_1000.csv", dataset);
+
+  arma::mat querySet;
+  querySet.randu(3, 500);
+
+  KNN::Tree referenceTree(dataset);
+  KNN::Tree queryTree(querySet);
+
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance,
+      KNN::Tree> RuleType;
+  EuclideanDistance metric;
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    KNN::Tree& qTree = (trial == 0) ? referenceTree : queryTree;
+    const bool sameSet = (trial == 0);
+
+    RuleType rules(referenceTree.Dataset(), qTree.Dataset(), 10, metric, 0,
+        sameSet);
+    ParallelDualTreeTraversal<KNN::Tree::DualTreeTraverser<RuleType>>(rules,
+        qTree, referenceTree, 10);
+
+    RuleType naiveRules(referenceTree.Dataset(), qTree.Dataset(), 10, metric,
+        0, sameSet);
+    for (size_t i = 0; i < qTree.Dataset().n_cols; ++i)
+      for (size_t j = 0; j < referenceTree.Dataset().n_cols; ++j)
+        naiveRules.BaseCase(i, j);
+
+    arma::Mat<size_t> neighbors, naiveNeighbors;
+    arma::mat distances, naiveDistances;
+    rules.GetResults(neighbors, distances);
+    naiveRules.GetResults(naiveNeighbors, naiveDistances);
+
+    BOOST_REQUIRE_GT(rules.BaseCases(), 0);
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors[i], naiveNeighbors[i]);
+      BOOST_REQUIRE_CLOSE(distances[i], naiveDistances[i], 1e-5);
+    }
+
+    // Reset the statistics of the reference tree before the next search.
+    std::stack<KNN::Tree*> nodes;
+    nodes.push(&referenceTree);
+    while (!nodes.empty())
+    {
+      KNN::Tree* node = nodes.top();
+      nodes.pop();
+      node->Stat().Reset();
+      for (size_t i = 0; i < node->NumChildren(); ++i)
+        nodes.push(&node->Child(i));
+    }
+  }
+}
+
+/**
+ * Test the block single-tree search with kd-trees and R trees against the naive
+ * method, for both the monochromatic and the bichromatic case.
+ */
+BOOST_AUTO_TEST_CASE(BlockSingleTreeVsNaive)
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  arma::mat querySet;
+  querySet.randu(3, 300);
+
+  KNN naive(dataset, NAIVE_MODE);
+  KNN knn(dataset, BLOCK_SINGLE_TREE_MODE);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat, RTree>
+      rTreeSearch(dataset, BLOCK_SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighborsNaive, neighborsTree, neighborsRTree;
+  arma::mat distancesNaive, distancesTree, distancesRTree;
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    if (trial == 0)
+    {
+      naive.Search(15, neighborsNaive, distancesNaive);
+      knn.Search(15, neighborsTree, distancesTree);
+      rTreeSearch.Search(15, neighborsRTree, distancesRTree);
+    }
+    else
+    {
+      naive.Search(querySet, 15, neighborsNaive, distancesNaive);
+      knn.Search(querySet, 15, neighborsTree, distancesTree);
+      rTreeSearch.Search(querySet, 15, neighborsRTree, distancesRTree);
+    }
+
+    // The tree search should not compute every base case.
+    BOOST_REQUIRE_LT(knn.BaseCases(), naive.BaseCases());
+
+    for (size_t i = 0; i < neighborsNaive.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(neighborsTree[i], neighborsNaive[i]);
+      BOOST_REQUIRE_CLOSE(distancesTree[i], distancesNaive[i], 1e-5);
+      BOOST_REQUIRE_EQUAL(neighborsRTree[i], neighborsNaive[i]);
+      BOOST_REQUIRE_CLOSE(distancesRTree[i], distancesNaive[i], 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure the block single-tree search refuses trees that it can't traverse.
+ */
+BOOST_AUTO_TEST_CASE(BlockSingleTreeCoverTreeTest)
+{
+  arma::mat dataset;
+  dataset.randu(3, 100);
+
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> coverTreeSearch(dataset, BLOCK_SINGLE_TREE_MODE);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  BOOST_REQUIRE_THROW(coverTreeSearch.Search(5, neighbors, distances),
+      std::invalid_argument);
+}
+
 /**
  * Test the spill tree hybrid sp-tree search (defeatist search on overlapping
  * nodes, and backtracking in non-overlapping nodes) against the naive method.
@@ -1434,4 +1595,184 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   CheckMatrices(distances, distances2);
 }
 
+/**
+ * Make sure that single-precision tree search gives the same results as
+ * single-precision naive search, and results close to double precision.
+ */
+BOOST_AUTO_TEST_CASE(SinglePrecisionKDTreeTest)
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::fmat,
+      KDTree> FloatKNN;
+
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  arma::fmat floatDataset = arma::conv_to<arma::fmat>::from(dataset);
+
+  FloatKNN naive(floatDataset, NAIVE_MODE);
+  FloatKNN dualTree(floatDataset, DUAL_TREE_MODE);
+  FloatKNN singleTree(floatDataset, SINGLE_TREE_MODE);
+  KNN baseline(dataset, NAIVE_MODE);
+
+  arma::Mat<size_t> naiveNeighbors, dualNeighbors, singleNeighbors,
+      baselineNeighbors;
+  arma::mat naiveDistances, dualDistances, singleDistances, baselineDistances;
+
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  dualTree.Search(5, dualNeighbors, dualDistances);
+  singleTree.Search(5, singleNeighbors, singleDistances);
+  baseline.Search(5, baselineNeighbors, baselineDistances);
+
+  CheckMatrices(dualNeighbors, naiveNeighbors);
+  CheckMatrices(dualDistances, naiveDistances);
+  CheckMatrices(singleNeighbors, naiveNeighbors);
+  CheckMatrices(singleDistances, naiveDistances);
+
+  for (size_t i = 0; i < naiveDistances.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(naiveDistances[i], baselineDistances[i], 1e-3);
+}
+
+/**
+ * Build an NSModel in single precision and make sure it gives the right
+ * results for double-precision and single-precision query sets.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelSinglePrecisionTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 200);
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> baselineNeighbors;
+  arma::mat baselineDistances;
+  knn.Search(queryData, 3, baselineNeighbors, baselineDistances);
+
+  KNNModel model(KNNModel::TreeTypes::KD_TREE, false);
+  model.BuildModel(arma::conv_to<arma::fmat>::from(referenceData), 20,
+      DUAL_TREE_MODE);
+
+  BOOST_REQUIRE_EQUAL(model.SinglePrecision(), true);
+  BOOST_REQUIRE_EQUAL(model.Dataset<arma::fmat>().n_cols, 200);
+  BOOST_REQUIRE_THROW(model.Dataset(), std::invalid_argument);
+
+  for (size_t j = 0; j < 2; ++j)
+  {
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    if (j == 0)
+      model.Search(arma::mat(queryData), 3, neighbors, distances);
+    else
+      model.Search(arma::conv_to<arma::fmat>::from(queryData), 3, neighbors,
+          distances);
+
+    BOOST_REQUIRE_EQUAL(neighbors.n_rows, baselineNeighbors.n_rows);
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, baselineNeighbors.n_cols);
+    for (size_t k = 0; k < distances.n_elem; ++k)
+      BOOST_REQUIRE_CLOSE(distances[k], baselineDistances[k], 1e-3);
+  }
+}
+
+/**
+ * Insert points into and remove points from a kd-tree backed KNN (and a naive
+ * KNN), and make sure that the results match a naive search on the remaining
+ * points, with the indices given by Insert().
+ */
+BOOST_AUTO_TEST_CASE(KNNInsertRemoveTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 300);
+  arma::mat queryData = arma::randu<arma::mat>(3, 50);
+
+  KNN knn(referenceData);
+  KNN naiveUpdated(referenceData, NAIVE_MODE);
+
+  // The point with each index, and whether it is still in the reference set.
+  arma::mat points(referenceData);
+  std::vector<bool> present(points.n_cols, true);
+
+  // Insert enough points to force some subtrees to be rebuilt, and remove
+  // points from all over the set.
+  for (size_t i = 0; i < 600; ++i)
+  {
+    arma::vec point = arma::randu<arma::vec>(3);
+    if (i % 3 == 0)
+      point *= 0.1; // Cluster some points in a corner.
+
+    const size_t index = knn.Insert(point, 5);
+    BOOST_REQUIRE_EQUAL(index, points.n_cols);
+    BOOST_REQUIRE_EQUAL(naiveUpdated.Insert(point), index);
+    points.insert_cols(points.n_cols, point);
+    present.push_back(true);
+
+    if (i % 2 == 0)
+    {
+      size_t removed = (7 * i) % points.n_cols;
+      while (!present[removed])
+        removed = (removed + 1) % points.n_cols;
+
+      knn.Remove(removed, 5);
+      naiveUpdated.Remove(removed);
+      present[removed] = false;
+    }
+  }
+
+  // Run a naive search on the remaining points, and map its results to the
+  // indices of the points.
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < present.size(); ++i)
+    if (present[i])
+      indices.push_back(i);
+
+  BOOST_REQUIRE_THROW(knn.Remove(std::find(present.begin(), present.end(),
+      false) - present.begin()), std::invalid_argument);
+
+  arma::mat remaining(3, indices.size());
+  for (size_t i = 0; i < indices.size(); ++i)
+    remaining.col(i) = points.col(indices[i]);
+
+  KNN naive(remaining, NAIVE_MODE);
+
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+  naive.Search(queryData, 5, naiveNeighbors, naiveDistances);
+  for (size_t i = 0; i < naiveNeighbors.n_elem; ++i)
+    naiveNeighbors[i] = indices[naiveNeighbors[i]];
+
+  knn.Search(queryData, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  naiveUpdated.Search(queryData, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  // Single-tree search must see the same tree.
+  knn.SearchMode() = SINGLE_TREE_MODE;
+  knn.Search(queryData, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  // Without a query set, the results of the removed points are empty.
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  knn.SearchMode() = DUAL_TREE_MODE;
+  knn.Search(5, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, points.n_cols);
+  size_t checked = 0;
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    if (!present[i])
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(0, i), size_t() - 1);
+      continue;
+    }
+
+    for (size_t j = 0; j < 5; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, i),
+          indices[naiveNeighbors(j, checked)]);
+      BOOST_REQUIRE_CLOSE(distances(j, i), naiveDistances(j, checked), 1e-5);
+    }
+    ++checked;
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -1994,4 +1994,224 @@ BOOST_AUTO_TEST_CASE(DatasetMapperNonUniqueTest)
   BOOST_REQUIRE_EQUAL(dm.UnmapString(nan, 0, 2), "cheese");
 }
 
+/**
+ * Load a CSV that is large enough to be split into several chunks, with a
+ * categorical dimension and a dimension that only turns out to be categorical
+ * on the last line, and make sure the mappings follow the order of the file.
+ */
+BOOST_AUTO_TEST_CASE(LargeCategoricalCSVLoadTest)
+{
+  const char* names[] = { "red", "green", "blue", "cyan", "magenta" };
+  const size_t numPoints = 200000;
+
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    f << i << ", " << ((i % 1000) * 0.25) << ", " << names[(3 * i) % 5]
+        << ", ";
+    if (i + 1 < numPoints)
+      f << (i % 10) << endl;
+    else
+      f << "x" << endl;
+  }
+  f.close();
+
+  arma::mat matrix;
+  DatasetInfo info;
+  data::Load("test.csv", matrix, info, true);
+
+  BOOST_REQUIRE_EQUAL(matrix.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(matrix.n_cols, numPoints);
+
+  BOOST_REQUIRE(info.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE(info.Type(1) == Datatype::numeric);
+  BOOST_REQUIRE(info.Type(2) == Datatype::categorical);
+  BOOST_REQUIRE(info.Type(3) == Datatype::categorical);
+
+  // The names appear in the order 0, 3, 1, 4, 2.
+  BOOST_REQUIRE_EQUAL(info.NumMappings(2), 5);
+  BOOST_REQUIRE_EQUAL(info.UnmapString(0, 2), "red");
+  BOOST_REQUIRE_EQUAL(info.UnmapString(1, 2), "cyan");
+  BOOST_REQUIRE_EQUAL(info.UnmapString(2, 2), "green");
+  BOOST_REQUIRE_EQUAL(info.UnmapString(3, 2), "magenta");
+  BOOST_REQUIRE_EQUAL(info.UnmapString(4, 2), "blue");
+
+  // The numbers in the last dimension are mapped in the order they appear.
+  BOOST_REQUIRE_EQUAL(info.NumMappings(3), 11);
+  BOOST_REQUIRE_EQUAL(info.UnmapString(10, 3), "x");
+
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(matrix(0, i), double(i));
+    BOOST_REQUIRE_EQUAL(matrix(1, i), (i % 1000) * 0.25);
+    BOOST_REQUIRE_EQUAL(info.UnmapString(matrix(2, i), 2),
+        names[(3 * i) % 5]);
+    BOOST_REQUIRE_EQUAL(matrix(3, i),
+        double((i + 1 < numPoints) ? (i % 10) : 10));
+  }
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure a missing value that looks like a number is still mapped by
+ * MissingPolicy.
+ */
+BOOST_AUTO_TEST_CASE(NumericMissingValueCSVLoadTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  f << "1, 2, 3" << endl;
+  f << "4, -999, 6" << endl;
+  f << "7, 8, 9" << endl;
+  f.close();
+
+  std::set<std::string> missingSet;
+  missingSet.insert("-999");
+  MissingPolicy policy(missingSet);
+  DatasetMapper<MissingPolicy> info(policy);
+
+  arma::mat matrix;
+  data::Load("test.csv", matrix, info, true);
+
+  BOOST_REQUIRE_EQUAL(matrix.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(matrix.n_cols, 3);
+  BOOST_REQUIRE(std::isnan(matrix(1, 1)));
+  BOOST_REQUIRE_EQUAL(matrix(1, 0), 2.0);
+  BOOST_REQUIRE_EQUAL(matrix(1, 2), 8.0);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(1), 1);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure a matrix survives a round trip through an mlpack binary file, both
+ * with values that fit in small integers and with arbitrary values.
+ */
+BOOST_AUTO_TEST_CASE(MLBinRoundTripTest)
+{
+  arma::mat test(5, 100000);
+  test.row(0) = arma::linspace<arma::rowvec>(0, 99999, 100000);
+  test.row(1).randu();
+  test.row(2).fill(3.0);
+  test.row(3).randn();
+  test.row(4) = arma::floor(10 * arma::randu<arma::rowvec>(100000));
+  test(3, 5) = -0.0;
+  test(4, 17) = std::numeric_limits<double>::quiet_NaN();
+
+  BOOST_REQUIRE(data::Save("test_file.mlbin", test) == true);
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test_file.mlbin", loaded) == true);
+
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, test.n_rows);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, test.n_cols);
+  BOOST_REQUIRE(std::signbit(loaded(3, 5)));
+  for (size_t i = 0; i < test.n_elem; ++i)
+  {
+    if (std::isnan(test[i]))
+      BOOST_REQUIRE(std::isnan(loaded[i]));
+    else
+      BOOST_REQUIRE_EQUAL(loaded[i], test[i]);
+  }
+
+  // The values can be loaded into a matrix of another type.
+  arma::fmat floatLoaded;
+  BOOST_REQUIRE(data::Load("test_file.mlbin", floatLoaded) == true);
+  for (size_t i = 0; i < test.n_elem; ++i)
+  {
+    if (std::isnan(test[i]))
+      BOOST_REQUIRE(std::isnan(floatLoaded[i]));
+    else
+      BOOST_REQUIRE_EQUAL(floatLoaded[i], float(test[i]));
+  }
+
+  // Without transposition, the matrix is transposed back and forth.
+  BOOST_REQUIRE(data::Save("test_file.mlbin", test, true, false) == true);
+  BOOST_REQUIRE(data::Load("test_file.mlbin", loaded, true, false) == true);
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, test.n_rows);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, test.n_cols);
+  for (size_t i = 0; i < test.n_elem; ++i)
+  {
+    if (std::isnan(test[i]))
+      BOOST_REQUIRE(std::isnan(loaded[i]));
+    else
+      BOOST_REQUIRE_EQUAL(loaded[i], test[i]);
+  }
+
+  // A file saved on a host with another byte order can't be loaded.  The byte
+  // order follows the magic string, the version and the element type.
+  fstream f("test_file.mlbin", fstream::in | fstream::out | fstream::binary);
+  f.seekg(13);
+  const char byteOrder = f.get();
+  f.seekp(13);
+  f.put(byteOrder == 0 ? 1 : 0);
+  f.close();
+  BOOST_REQUIRE(data::Load("test_file.mlbin", loaded) == false);
+
+  // A file whose header claims far more rows than the file can hold is
+  // rejected before the matrix is allocated.  The number of rows follows the
+  // padding.
+  BOOST_REQUIRE(data::Save("test_file.mlbin", test) == true);
+  f.open("test_file.mlbin", fstream::in | fstream::out | fstream::binary);
+  const uint64_t numRows = uint64_t(1) << 60;
+  f.seekp(16);
+  f.write((const char*) &numRows, sizeof(numRows));
+  f.close();
+  BOOST_REQUIRE(data::Load("test_file.mlbin", loaded) == false);
+
+  remove("test_file.mlbin");
+}
+
+/**
+ * Make sure the mappings of a categorical dataset are stored in an mlpack
+ * binary file.
+ */
+BOOST_AUTO_TEST_CASE(MLBinDatasetMapperTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  f << "1, 2, hello" << endl;
+  f << "3, 4, goodbye" << endl;
+  f << "5, 6, coffee" << endl;
+  f << "7, 8, confusion" << endl;
+  f << "9, 10, hello" << endl;
+  f.close();
+
+  arma::mat matrix;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.csv", matrix, info, true) == true);
+  BOOST_REQUIRE(data::Save("test.mlbin", matrix, info, true) == true);
+
+  arma::mat loaded;
+  DatasetInfo loadedInfo;
+  BOOST_REQUIRE(data::Load("test.mlbin", loaded, loadedInfo, true) == true);
+
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 5);
+  for (size_t i = 0; i < matrix.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(loaded[i], matrix[i]);
+
+  BOOST_REQUIRE_EQUAL(loadedInfo.Dimensionality(), 3);
+  BOOST_REQUIRE(loadedInfo.Type(0) == Datatype::numeric);
+  BOOST_REQUIRE(loadedInfo.Type(1) == Datatype::numeric);
+  BOOST_REQUIRE(loadedInfo.Type(2) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(loadedInfo.NumMappings(2), 4);
+  for (size_t i = 0; i < 4; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(loadedInfo.UnmapString(i, 2),
+        info.UnmapString(i, 2));
+  }
+
+  // A file saved without mappings gives all numeric dimensions.
+  BOOST_REQUIRE(data::Save("test.mlbin", matrix, true) == true);
+  BOOST_REQUIRE(data::Load("test.mlbin", loaded, loadedInfo, true) == true);
+  BOOST_REQUIRE_EQUAL(loadedInfo.Dimensionality(), 3);
+  BOOST_REQUIRE(loadedInfo.Type(2) == Datatype::numeric);
+
+  remove("test.csv");
+  remove("test.mlbin");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
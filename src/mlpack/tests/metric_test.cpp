@@ -10,6 +10,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/metrics/pairwise_distances.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -87,4 +88,64 @@ BOOST_AUTO_TEST_CASE(LINFMetricTest)
                       lMetric.Evaluate(a2, b2), 1e-5);
 }
 
+/**
+ * Make sure that the block distances of the Euclidean and squared Euclidean
+ * distances are within the returned error bound of Evaluate(), with and without
+ * precomputed norms, and that the generic version is exact.
+ */
+BOOST_AUTO_TEST_CASE(PairwiseDistancesTest)
+{
+  // Put the points away from the origin so that the error bound matters.
+  arma::mat a = arma::randu<arma::mat>(5, 30) + 10.0;
+  arma::mat b = arma::randu<arma::mat>(5, 40) + 10.0;
+  arma::uvec aIndices = arma::linspace<arma::uvec>(0, 28, 15);
+  arma::uvec bIndices = arma::linspace<arma::uvec>(39, 1, 20);
+
+  EuclideanDistance euclidean;
+  SquaredEuclideanDistance squaredEuclidean;
+  ManhattanDistance manhattan;
+
+  arma::vec aNorms, bNorms;
+  PairwiseDistanceNorms(euclidean, a, aNorms);
+  PairwiseDistanceNorms(euclidean, b, bNorms);
+  BOOST_REQUIRE_EQUAL(aNorms.n_elem, a.n_cols);
+
+  arma::mat distances, normDistances, squaredDistances, manhattanDistances;
+  const double error = PairwiseDistances(euclidean, a, aIndices, b, bIndices,
+      distances);
+  const double normError = PairwiseDistances(euclidean, a, aIndices, aNorms, b,
+      bIndices, bNorms, normDistances);
+  const double squaredError = PairwiseDistances(squaredEuclidean, a, aIndices,
+      b, bIndices, squaredDistances);
+  const double manhattanError = PairwiseDistances(manhattan, a, aIndices, b,
+      bIndices, manhattanDistances);
+
+  BOOST_REQUIRE_GT(error, 0.0);
+  BOOST_REQUIRE_EQUAL(manhattanError, 0.0);
+  BOOST_REQUIRE_EQUAL(distances.n_rows, aIndices.n_elem);
+  BOOST_REQUIRE_EQUAL(distances.n_cols, bIndices.n_elem);
+
+  for (size_t j = 0; j < bIndices.n_elem; ++j)
+  {
+    for (size_t i = 0; i < aIndices.n_elem; ++i)
+    {
+      const arma::vec x = a.col(aIndices[i]);
+      const arma::vec y = b.col(bIndices[j]);
+
+      BOOST_REQUIRE_LE(std::abs(distances(i, j) - euclidean.Evaluate(x, y)),
+          error);
+      BOOST_REQUIRE_LE(std::abs(normDistances(i, j) -
+          euclidean.Evaluate(x, y)), normError);
+      BOOST_REQUIRE_LE(std::abs(squaredDistances(i, j) -
+          squaredEuclidean.Evaluate(x, y)), squaredError);
+      BOOST_REQUIRE_CLOSE(manhattanDistances(i, j), manhattan.Evaluate(x, y),
+          1e-10);
+    }
+  }
+
+  // The norms of other metrics are empty.
+  PairwiseDistanceNorms(manhattan, a, aNorms);
+  BOOST_REQUIRE_EQUAL(aNorms.n_elem, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -170,4 +170,86 @@ BOOST_AUTO_TEST_CASE(CartPoleWithDoubleDQN)
   BOOST_REQUIRE(converged);
 }
 
+//! Test DQN with prioritized replay in Cart Pole task.
+BOOST_AUTO_TEST_CASE(CartPoleWithDQNPrioritizedReplay)
+{
+  // It isn't guaranteed that the network will converge in the specified number
+  // of iterations using random weights. If this works 1 of 4 times, I'm fine
+  // with that.
+  size_t episodes = 0;
+  bool converged = false;
+  for (size_t trial = 0; trial < 4; ++trial)
+  {
+    // Set up the network.
+    FFN<MeanSquaredError<>, GaussianInitialization> model(MeanSquaredError<>(),
+        GaussianInitialization(0, 0.001));
+    model.Add<Linear<>>(4, 20);
+    model.Add<ReLULayer<>>();
+    model.Add<Linear<>>(20, 20);
+    model.Add<ReLULayer<>>();
+    model.Add<Linear<>>(20, 2);
+
+    // Set up the policy and replay method.
+    GreedyPolicy<CartPole> policy(1.0, 1000, 0.1);
+    PrioritizedReplay<CartPole> replayMethod(10, 10000, 0.6, 0.4);
+
+    TrainingConfig config;
+    config.StepSize() = 0.01;
+    config.Discount() = 0.9;
+    config.TargetNetworkSyncInterval() = 100;
+    config.ExplorationSteps() = 100;
+    config.DoubleQLearning() = false;
+    config.StepLimit() = 200;
+
+    // Set up the DQN agent.
+    QLearning<CartPole, decltype(model), AdamUpdate, decltype(policy),
+        decltype(replayMethod)> agent(std::move(config), std::move(model),
+        std::move(policy), std::move(replayMethod));
+
+    arma::running_stat<double> averageReturn;
+
+    for (episodes = 0; episodes <= 1000; ++episodes)
+    {
+      double episodeReturn = agent.Episode();
+      averageReturn(episodeReturn);
+
+      Log::Debug << "Average return: " << averageReturn.mean()
+          << " Episode return: " << episodeReturn << std::endl;
+      if (averageReturn.mean() > 35)
+        break;
+    }
+
+    if (episodes < 1000)
+    {
+      converged = true;
+      break;
+    }
+  }
+
+  BOOST_REQUIRE(converged);
+}
+
+//! Test that the sum tree samples elements in proportion to their values.
+BOOST_AUTO_TEST_CASE(SumTreeTest)
+{
+  SumTree<double> tree(5);
+  const double values[] = { 1.0, 0.0, 2.0, 3.0, 4.0 };
+  for (size_t i = 0; i < 5; ++i)
+    tree.Set(i, values[i]);
+
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 10.0, 1e-10);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(0.5), 0);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(1.0), 2);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(5.5), 3);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(9.9), 4);
+
+  // A mass past the sum still gives an element with a nonzero value.
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(12.0), 4);
+
+  tree.Set(4, 0.0);
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 6.0, 1e-10);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(5.9), 3);
+  BOOST_REQUIRE_EQUAL(tree.FindPrefixSum(7.0), 3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
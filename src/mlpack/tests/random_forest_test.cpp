@@ -11,7 +11,9 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/random_forest/random_forest.hpp>
+#include <mlpack/methods/random_forest/flat_forest.hpp>
 #include <mlpack/methods/decision_tree/random_dimension_select.hpp>
+#include <mlpack/methods/decision_tree/histogram_numeric_split.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -153,6 +155,141 @@ BOOST_AUTO_TEST_CASE(UnweightedNumericLearningTest)
   BOOST_REQUIRE_GE(rfCorrect, size_t(0.7 * testDataset.n_cols));
 }
 
+/**
+ * Make sure a random forest trained on 8-bit bin codes with the
+ * HistogramNumericSplit still learns the dataset.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericLearningTest)
+{
+  // Load the vc2 dataset.
+  arma::mat dataset;
+  data::Load("vc2.csv", dataset);
+  arma::Row<size_t> labels;
+  data::Load("vc2_labels.txt", labels);
+
+  // Bin the dataset, using few bins so that the split points are approximate.
+  QuantileBinning binning(dataset, 32);
+  arma::Mat<unsigned char> codes;
+  binning.Transform(dataset, codes);
+
+  RandomForest<GiniGain, RandomDimensionSelect, HistogramNumericSplit> rf(
+      codes, labels, 3, 10 /* 10 trees */, 5);
+
+  // Get performance statistics on test data, binned in the same way.
+  arma::mat testDataset;
+  data::Load("vc2_test.csv", testDataset);
+  arma::Row<size_t> testLabels;
+  data::Load("vc2_test_labels.txt", testLabels);
+  arma::Mat<unsigned char> testCodes;
+  binning.Transform(testDataset, testCodes);
+
+  arma::Row<size_t> predictions;
+  rf.Classify(testCodes, predictions);
+
+  const size_t correct = arma::accu(predictions == testLabels);
+  BOOST_REQUIRE_GE(correct, size_t(0.7 * testDataset.n_cols));
+}
+
+/**
+ * Make sure that a FlatForest gives the same predictions and probabilities as
+ * the random forest and the decision tree it was built from, on numeric and
+ * categorical data.
+ */
+BOOST_AUTO_TEST_CASE(FlatForestTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  arma::mat trainingData = d.cols(0, 1999);
+  arma::mat testData = d.cols(2000, 3999);
+  arma::Row<size_t> trainingLabels = l.subvec(0, 1999);
+  arma::mat numericTrainingData = trainingData.rows(0, 1);
+  arma::mat numericTestData = testData.rows(0, 1);
+
+  RandomForest<> rf(trainingData, di, trainingLabels, 5, 20, 5);
+  RandomForest<> numericRf(numericTrainingData, trainingLabels, 5, 20, 5);
+  DecisionTree<> dt(trainingData, di, trainingLabels, 5, 5);
+
+  FlatForest flatRf(rf);
+  FlatForest flatNumericRf(numericRf);
+  FlatForest flatDt(dt);
+  BOOST_REQUIRE_EQUAL(flatRf.NumTrees(), 20);
+  BOOST_REQUIRE_EQUAL(flatDt.NumTrees(), 1);
+  BOOST_REQUIRE_EQUAL(flatRf.NumClasses(), 5);
+
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::mat probabilities, flatProbabilities;
+
+  rf.Classify(testData, predictions, probabilities);
+  flatRf.Classify(testData, flatPredictions, flatProbabilities);
+  BOOST_REQUIRE_EQUAL(arma::accu(predictions != flatPredictions), 0);
+  BOOST_REQUIRE_SMALL(arma::abs(probabilities - flatProbabilities).max(),
+      1e-12);
+
+  numericRf.Classify(numericTestData, predictions, probabilities);
+  flatNumericRf.Classify(numericTestData, flatPredictions, flatProbabilities);
+  BOOST_REQUIRE_EQUAL(arma::accu(predictions != flatPredictions), 0);
+  BOOST_REQUIRE_SMALL(arma::abs(probabilities - flatProbabilities).max(),
+      1e-12);
+
+  dt.Classify(testData, predictions);
+  flatDt.Classify(testData, flatPredictions);
+  BOOST_REQUIRE_EQUAL(arma::accu(predictions != flatPredictions), 0);
+  for (size_t i = 0; i < 100; ++i)
+    BOOST_REQUIRE_EQUAL(flatDt.Classify(testData.col(i)), predictions[i]);
+
+  // Categories without a child go to the first child, like category 0.
+  const double unseen[] = { 1000.0, -1.0, std::nan("") };
+  for (size_t i = 0; i < 100; ++i)
+  {
+    arma::vec point = testData.col(i);
+    point[2] = 0.0;
+    const size_t prediction = flatRf.Classify(point);
+    for (size_t j = 0; j < 3; ++j)
+    {
+      point[2] = unseen[j];
+      BOOST_REQUIRE_EQUAL(flatRf.Classify(point), prediction);
+    }
+  }
+}
+
+/**
+ * Make sure that a forest whose trees are also trained in parallel gives the
+ * same results as a forest trained serially, with fewer trees than there are
+ * likely to be cores.  With AllDimensionSelect, the trees don't depend on the
+ * order in which random numbers are drawn.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTreeTrainingTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+  arma::mat numericData = d.rows(0, 1);
+
+  RandomForest<> rf(d, di, l, 5, 3, 5);
+  RandomForest<> parallelRf(d, di, l, 5, 3, 5, true);
+  RandomForest<> numericRf;
+  numericRf.Train(numericData, l, 5, 3, 5);
+  RandomForest<> parallelNumericRf;
+  parallelNumericRf.Train(numericData, l, 5, 3, 5, true);
+
+  arma::Row<size_t> predictions, parallelPredictions;
+  arma::mat probabilities, parallelProbabilities;
+  rf.Classify(d, predictions, probabilities);
+  parallelRf.Classify(d, parallelPredictions, parallelProbabilities);
+  BOOST_REQUIRE_EQUAL(arma::accu(predictions != parallelPredictions), 0);
+  CheckMatrices(probabilities, parallelProbabilities);
+
+  numericRf.Classify(numericData, predictions, probabilities);
+  parallelNumericRf.Classify(numericData, parallelPredictions,
+      parallelProbabilities);
+  BOOST_REQUIRE_EQUAL(arma::accu(predictions != parallelPredictions), 0);
+  CheckMatrices(probabilities, parallelProbabilities);
+}
+
 /**
  * Test weighted numeric learning, making sure that we get better performance
  * than a single decision tree.
@@ -1696,4 +1696,115 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   }
 }
 
+/**
+ * Insert points into and remove points from a kd-tree backed range search (and
+ * a naive one), and make sure that the results match a naive search on the
+ * remaining points, with the indices given by Insert().
+ */
+BOOST_AUTO_TEST_CASE(RangeSearchInsertRemoveTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 200);
+  arma::mat queryData = arma::randu<arma::mat>(3, 30);
+
+  RangeSearch<> rs(referenceData);
+  RangeSearch<> naiveUpdated(referenceData, true);
+
+  // The point with each index, and whether it is still in the reference set.
+  arma::mat points(referenceData);
+  vector<bool> present(points.n_cols, true);
+
+  for (size_t i = 0; i < 300; ++i)
+  {
+    arma::vec point = arma::randu<arma::vec>(3);
+    const size_t index = rs.Insert(point, 5);
+    BOOST_REQUIRE_EQUAL(index, points.n_cols);
+    BOOST_REQUIRE_EQUAL(naiveUpdated.Insert(point), index);
+    points.insert_cols(points.n_cols, point);
+    present.push_back(true);
+
+    if (i % 3 != 2)
+    {
+      size_t removed = (11 * i) % points.n_cols;
+      while (!present[removed])
+        removed = (removed + 1) % points.n_cols;
+
+      rs.Remove(removed, 5);
+      naiveUpdated.Remove(removed);
+      present[removed] = false;
+    }
+  }
+
+  // Run a naive search on the remaining points, and map its results to the
+  // indices of the points.
+  vector<size_t> indices;
+  for (size_t i = 0; i < present.size(); ++i)
+    if (present[i])
+      indices.push_back(i);
+
+  arma::mat remaining(3, indices.size());
+  for (size_t i = 0; i < indices.size(); ++i)
+    remaining.col(i) = points.col(indices[i]);
+
+  RangeSearch<> naive(remaining, true);
+
+  vector<vector<size_t>> neighborsNaive;
+  vector<vector<double>> distancesNaive;
+  naive.Search(queryData, Range(0.1, 0.4), neighborsNaive, distancesNaive);
+  for (size_t i = 0; i < neighborsNaive.size(); ++i)
+    for (size_t j = 0; j < neighborsNaive[i].size(); ++j)
+      neighborsNaive[i][j] = indices[neighborsNaive[i][j]];
+
+  vector<vector<pair<double, size_t>>> sortedNaive;
+  SortResults(neighborsNaive, distancesNaive, sortedNaive);
+
+  for (size_t run = 0; run < 3; ++run)
+  {
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    if (run == 0)
+    {
+      rs.Search(queryData, Range(0.1, 0.4), neighbors, distances);
+    }
+    else if (run == 1)
+    {
+      rs.SingleMode() = true;
+      rs.Search(queryData, Range(0.1, 0.4), neighbors, distances);
+    }
+    else
+    {
+      naiveUpdated.Search(queryData, Range(0.1, 0.4), neighbors, distances);
+    }
+
+    vector<vector<pair<double, size_t>>> sorted;
+    SortResults(neighbors, distances, sorted);
+
+    BOOST_REQUIRE_EQUAL(sorted.size(), sortedNaive.size());
+    for (size_t i = 0; i < sorted.size(); i++)
+    {
+      BOOST_REQUIRE_EQUAL(sorted[i].size(), sortedNaive[i].size());
+
+      for (size_t j = 0; j < sorted[i].size(); j++)
+      {
+        BOOST_REQUIRE_EQUAL(sorted[i][j].second, sortedNaive[i][j].second);
+        BOOST_REQUIRE_CLOSE(sorted[i][j].first, sortedNaive[i][j].first,
+            1e-5);
+      }
+    }
+  }
+
+  // Without a query set, the results of the removed points are empty.
+  vector<vector<size_t>> neighbors;
+  vector<vector<double>> distances;
+  rs.SingleMode() = false;
+  rs.Search(Range(0.1, 0.4), neighbors, distances);
+  BOOST_REQUIRE_EQUAL(neighbors.size(), points.n_cols);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    if (!present[i])
+      BOOST_REQUIRE_EQUAL(neighbors[i].size(), 0);
+
+  naive.Search(Range(0.1, 0.4), neighborsNaive, distancesNaive);
+  for (size_t i = 0; i < indices.size(); ++i)
+    BOOST_REQUIRE_EQUAL(neighbors[indices[i]].size(), neighborsNaive[i].size());
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,172 @@
+/**
+ * @file streaming_function_test.cpp
+ *
+ * Tests for StreamingFunction and BinaryFileSource.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/data/binary_file_source.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/streaming/streaming_function.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace mlpack;
+using namespace mlpack::data;
+using namespace mlpack::optimization;
+using namespace mlpack::regression;
+
+BOOST_AUTO_TEST_SUITE(StreamingFunctionTest);
+
+// Create a labelled dataset of two Gaussian blobs and save it with the labels
+// in the last row.
+static void CreateStreamingDataset(const std::string& filename,
+                                   arma::mat& data,
+                                   arma::Row<size_t>& labels)
+{
+  data = arma::randn<arma::mat>(3, 1000);
+  labels.set_size(1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    labels[i] = i % 2;
+    if (labels[i] == 1)
+      data.col(i) += 3.0;
+  }
+
+  arma::mat file = arma::join_cols(data,
+      arma::conv_to<arma::rowvec>::from(labels));
+  data::Save(filename, file, true);
+}
+
+/**
+ * Make sure BinaryFileSource reads the right points and labels.
+ */
+BOOST_AUTO_TEST_CASE(BinaryFileSourceReadTest)
+{
+  arma::mat data;
+  arma::Row<size_t> labels;
+  CreateStreamingDataset("streaming_test.bin", data, labels);
+
+  BinaryFileSource source("streaming_test.bin", true);
+  BOOST_REQUIRE_EQUAL(source.NumPoints(), 1000);
+  BOOST_REQUIRE_EQUAL(source.Dimensionality(), 3);
+
+  arma::mat chunk;
+  arma::Row<size_t> chunkLabels;
+  source.Read(990, 10, chunk, chunkLabels);
+  CheckMatrices(chunk, data.cols(990, 999));
+  CheckMatrices(chunkLabels, labels.subvec(990, 999));
+
+  source.Read(5, 7, chunk, chunkLabels);
+  CheckMatrices(chunk, data.cols(5, 11));
+  CheckMatrices(chunkLabels, labels.subvec(5, 11));
+
+  BOOST_REQUIRE_THROW(source.Read(995, 10, chunk, chunkLabels),
+      std::runtime_error);
+
+  remove("streaming_test.bin");
+}
+
+/**
+ * Make sure that the objective and gradient of batches of a streamed,
+ * L2-regularized logistic regression function are the same as when the data
+ * is held in memory, when the regularization parameter of each window is
+ * scaled by the fraction of the points that the window holds.  Some of the
+ * batches straddle two windows.
+ */
+BOOST_AUTO_TEST_CASE(StreamingLogisticRegressionRegularizationTest)
+{
+  arma::mat data;
+  arma::Row<size_t> labels;
+  CreateStreamingDataset("streaming_test.bin", data, labels);
+
+  const double lambda = 0.5;
+  BinaryFileSource source("streaming_test.bin", true);
+  auto function = MakeStreamingFunction(source,
+      [&source, lambda](arma::mat& windowData, arma::Row<size_t>& windowLabels)
+      {
+        return LogisticRegressionFunction<>(windowData, windowLabels,
+            lambda * windowData.n_cols / source.NumPoints());
+      }, 128);
+
+  LogisticRegressionFunction<> memoryFunction(data, labels, lambda);
+
+  const arma::mat parameters = arma::randu<arma::mat>(1, 4);
+  const size_t begins[] = { 0, 120, 250, 500, 990 };
+  const size_t batchSizes[] = { 10, 20, 300, 1, 10 };
+  for (size_t b = 0; b < 5; ++b)
+  {
+    const double streamingObjective = function.Evaluate(parameters,
+        begins[b], batchSizes[b]);
+    const double memoryObjective = memoryFunction.Evaluate(parameters,
+        begins[b], batchSizes[b]);
+    BOOST_REQUIRE_CLOSE(streamingObjective, memoryObjective, 1e-7);
+
+    arma::mat streamingGradient, memoryGradient;
+    function.Gradient(parameters, begins[b], streamingGradient, batchSizes[b]);
+    memoryFunction.Gradient(parameters, begins[b], memoryGradient,
+        batchSizes[b]);
+    BOOST_REQUIRE_EQUAL(streamingGradient.n_elem, memoryGradient.n_elem);
+    for (size_t i = 0; i < memoryGradient.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(streamingGradient[i], memoryGradient[i], 1e-7);
+  }
+
+  remove("streaming_test.bin");
+}
+
+/**
+ * Train logistic regression with SGD on a streamed file, with windows that
+ * batches straddle, and make sure the result is the same as when the data is
+ * held in memory.
+ */
+BOOST_AUTO_TEST_CASE(StreamingLogisticRegressionSGDTest)
+{
+  arma::mat data;
+  arma::Row<size_t> labels;
+  CreateStreamingDataset("streaming_test.bin", data, labels);
+
+  BinaryFileSource source("streaming_test.bin", true);
+  auto function = MakeStreamingFunction(source,
+      [](arma::mat& windowData, arma::Row<size_t>& windowLabels)
+      {
+        return LogisticRegressionFunction<>(windowData, windowLabels, 0.0);
+      }, 128);
+
+  LogisticRegressionFunction<> memoryFunction(data, labels, 0.0);
+
+  // Without shuffling, the batches are the same.
+  SGD<> sgd(0.01, 10, false, VanillaUpdate(), NoDecay(),
+      DefaultTermination(5000, 1e-10));
+
+  arma::mat streamingParameters(1, 4, arma::fill::zeros);
+  arma::mat memoryParameters(1, 4, arma::fill::zeros);
+  const double streamingObjective = sgd.Optimize(function,
+      streamingParameters);
+  const double memoryObjective = sgd.Optimize(memoryFunction,
+      memoryParameters);
+
+  BOOST_REQUIRE_CLOSE(streamingObjective, memoryObjective, 1e-5);
+  for (size_t i = 0; i < 4; ++i)
+    BOOST_REQUIRE_CLOSE(streamingParameters[i], memoryParameters[i], 1e-5);
+
+  // With shuffling inside the windows, the model should still separate the
+  // two blobs.
+  SGD<> shuffledSGD(0.01, 10, true, VanillaUpdate(), NoDecay(),
+      DefaultTermination(5000, 1e-10));
+  LogisticRegression<> lr(3, 0.0);
+  shuffledSGD.Optimize(function, lr.Parameters());
+
+  arma::Row<size_t> predictions;
+  lr.Classify(data, predictions);
+  BOOST_REQUIRE_GE(arma::accu(predictions == labels), 950);
+
+  remove("streaming_test.bin");
+}
+
+BOOST_AUTO_TEST_SUITE_END();
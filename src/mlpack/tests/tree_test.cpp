@@ -1359,6 +1359,94 @@ BOOST_AUTO_TEST_CASE(KdTreeTest)
   TreeType root(dataset);
 }
 
+/**
+ * Make sure that ParallelPerformSplit() rearranges the points in exactly the
+ * same way as the serial PerformSplit().
+ */
+BOOST_AUTO_TEST_CASE(ParallelPerformSplitTest)
+{
+  typedef MidpointSplit<HRectBound<EuclideanDistance>, arma::mat> SplitType;
+
+  for (size_t trial = 0; trial < 5; ++trial)
+  {
+    arma::mat dataset(4, 5000, arma::fill::randu);
+    HRectBound<EuclideanDistance> bound(dataset.n_rows);
+    bound |= dataset;
+
+    SplitType::SplitInfo splitInfo;
+    BOOST_REQUIRE(SplitType::SplitNode(bound, dataset, 0, dataset.n_cols,
+        splitInfo));
+
+    arma::mat serialData(dataset), parallelData(dataset);
+    std::vector<size_t> serialMap(dataset.n_cols), parallelMap(dataset.n_cols);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      serialMap[i] = parallelMap[i] = i;
+
+    // Split only part of the dataset, so that begin is not zero.
+    const size_t serialCol = split::PerformSplit<arma::mat, SplitType>(
+        serialData, 100, 4800, splitInfo, serialMap);
+    const size_t parallelCol = split::ParallelPerformSplit<arma::mat,
+        SplitType>(parallelData, 100, 4800, splitInfo, &parallelMap);
+
+    BOOST_REQUIRE_EQUAL(serialCol, parallelCol);
+    CheckMatrices(serialData, parallelData);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(serialMap[i], parallelMap[i]);
+  }
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Make sure that a kd-tree built with many threads is the same as one built
+ * with a single thread.  The dataset is large enough that the parallel
+ * partitioning is used too.
+ */
+BOOST_AUTO_TEST_CASE(ParallelKdTreeBuildTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset(5, 40000, arma::fill::randu);
+
+  std::vector<size_t> parallelMap;
+  TreeType parallelTree(dataset, parallelMap);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  std::vector<size_t> serialMap;
+  TreeType serialTree(dataset, serialMap);
+  omp_set_num_threads(prevNumThreads);
+
+  CheckMatrices(parallelTree.Dataset(), serialTree.Dataset());
+  for (size_t i = 0; i < parallelMap.size(); ++i)
+    BOOST_REQUIRE_EQUAL(parallelMap[i], serialMap[i]);
+
+  // Now check that the nodes are the same.
+  std::stack<TreeType*> parallelStack, serialStack;
+  parallelStack.push(&parallelTree);
+  serialStack.push(&serialTree);
+  while (!parallelStack.empty())
+  {
+    TreeType* parallelNode = parallelStack.top();
+    TreeType* serialNode = serialStack.top();
+    parallelStack.pop();
+    serialStack.pop();
+
+    BOOST_REQUIRE_EQUAL(parallelNode->Begin(), serialNode->Begin());
+    BOOST_REQUIRE_EQUAL(parallelNode->Count(), serialNode->Count());
+    BOOST_REQUIRE_EQUAL(parallelNode->NumChildren(),
+        serialNode->NumChildren());
+    BOOST_REQUIRE_CLOSE(parallelNode->ParentDistance(),
+        serialNode->ParentDistance(), 1e-5);
+
+    for (size_t i = 0; i < parallelNode->NumChildren(); ++i)
+    {
+      parallelStack.push(&parallelNode->Child(i));
+      serialStack.push(&serialNode->Child(i));
+    }
+  }
+}
+#endif
+
 BOOST_AUTO_TEST_CASE(MaxRPTreeTest)
 {
   typedef MaxRPTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
@@ -1778,6 +1866,301 @@ BOOST_AUTO_TEST_CASE(BinarySpaceTreeMoveConstructorTest)
   BOOST_REQUIRE_EQUAL(tree2.NumChildren(), 2);
 }
 
+//! Make sure that the two given nodes and their descendants are the same.
+template<typename TreeType>
+void CheckSameBinarySpaceTree(const TreeType& node, const TreeType& other)
+{
+  BOOST_REQUIRE_EQUAL(node.Begin(), other.Begin());
+  BOOST_REQUIRE_EQUAL(node.Count(), other.Count());
+  BOOST_REQUIRE_EQUAL(node.NumChildren(), other.NumChildren());
+  BOOST_REQUIRE_EQUAL(node.ParentDistance(), other.ParentDistance());
+  BOOST_REQUIRE_EQUAL(node.FurthestDescendantDistance(),
+      other.FurthestDescendantDistance());
+  BOOST_REQUIRE_EQUAL(node.MinimumBoundDistance(),
+      other.MinimumBoundDistance());
+  BOOST_REQUIRE_EQUAL(node.Bound().Dim(), other.Bound().Dim());
+
+  arma::vec center, otherCenter;
+  node.Center(center);
+  other.Center(otherCenter);
+  CheckMatrices(center, otherCenter);
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(other.Child(i).Parent(), &other);
+    CheckSameBinarySpaceTree(node.Child(i), other.Child(i));
+  }
+}
+
+/**
+ * Save a kd-tree and a ball tree as flat tree files and make sure that the
+ * trees loaded from the mapped files are the same, with the dataset used in
+ * place.
+ */
+BOOST_AUTO_TEST_CASE(FlatTreeSaveLoadTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> KDTreeType;
+  typedef BallTree<EuclideanDistance, EmptyStatistic, arma::mat> BallTreeType;
+
+  arma::mat dataset(5, 2000, arma::fill::randu);
+
+  std::vector<size_t> oldFromNew;
+  KDTreeType kdTree(dataset, oldFromNew);
+  FlatTree<KDTreeType>::Save("flat_kd_tree.bin", kdTree, oldFromNew);
+
+  BallTreeType ballTree(dataset);
+  FlatTree<BallTreeType>::Save("flat_ball_tree.bin", ballTree);
+
+  {
+    data::MappedFile file("flat_kd_tree.bin");
+    std::vector<size_t> loadedOldFromNew;
+    KDTreeType* loadedTree = FlatTree<KDTreeType>::Load(file,
+        loadedOldFromNew);
+
+    CheckMatrices(kdTree.Dataset(), loadedTree->Dataset());
+    BOOST_REQUIRE_EQUAL(loadedOldFromNew.size(), oldFromNew.size());
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+      BOOST_REQUIRE_EQUAL(loadedOldFromNew[i], oldFromNew[i]);
+    CheckSameBinarySpaceTree(kdTree, *loadedTree);
+
+    // The dataset should be stored in the mapped file.
+    const char* data = (const char*) loadedTree->Dataset().memptr();
+    BOOST_REQUIRE(data >= file.Data());
+    BOOST_REQUIRE(data < file.Data() + file.Size());
+
+    delete loadedTree;
+  }
+
+  {
+    data::MappedFile file("flat_ball_tree.bin");
+    std::vector<size_t> loadedOldFromNew;
+    BallTreeType* loadedTree = FlatTree<BallTreeType>::Load(file,
+        loadedOldFromNew);
+
+    BOOST_REQUIRE_EQUAL(loadedOldFromNew.size(), 0);
+    CheckMatrices(ballTree.Dataset(), loadedTree->Dataset());
+    CheckSameBinarySpaceTree(ballTree, *loadedTree);
+
+    delete loadedTree;
+
+    // A ball tree file can't be loaded as a kd-tree.
+    BOOST_REQUIRE_THROW(FlatTree<KDTreeType>::Load(file, loadedOldFromNew),
+        std::runtime_error);
+  }
+
+  remove("flat_kd_tree.bin");
+  remove("flat_ball_tree.bin");
+}
+
+/**
+ * Make sure that flat tree files whose nodes share a child, whose children
+ * don't split the points of their parent, whose sizes overflow, or whose
+ * mapping isn't a permutation, are rejected.
+ */
+BOOST_AUTO_TEST_CASE(FlatTreeCorruptFileTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> KDTreeType;
+
+  arma::mat dataset(3, 500, arma::fill::randu);
+  KDTreeType kdTree(dataset);
+  FlatTree<KDTreeType>::Save("flat_corrupt_tree.bin", kdTree);
+
+  FlatTreeHeader header;
+  std::fstream stream("flat_corrupt_tree.bin",
+      std::ios::in | std::ios::out | std::ios::binary);
+  stream.read((char*) &header, sizeof(FlatTreeHeader));
+
+  // Make the right child of the root the same as its left child.
+  FlatTreeNode root;
+  stream.seekg(header.nodesOffset);
+  stream.read((char*) &root, sizeof(FlatTreeNode));
+  BOOST_REQUIRE_NE(root.left, 0);
+  FlatTreeNode corruptRoot = root;
+  corruptRoot.right = corruptRoot.left;
+  stream.seekp(header.nodesOffset);
+  stream.write((const char*) &corruptRoot, sizeof(FlatTreeNode));
+  stream.flush();
+
+  {
+    data::MappedFile file("flat_corrupt_tree.bin");
+    std::vector<size_t> oldFromNew;
+    BOOST_REQUIRE_THROW(FlatTree<KDTreeType>::Load(file, oldFromNew),
+        std::runtime_error);
+  }
+
+  // Restore the root, and move the first point of the right child of the root
+  // into its left child, without changing the right child.
+  stream.seekp(header.nodesOffset);
+  stream.write((const char*) &root, sizeof(FlatTreeNode));
+  FlatTreeNode left;
+  stream.seekg(header.nodesOffset + root.left * sizeof(FlatTreeNode));
+  stream.read((char*) &left, sizeof(FlatTreeNode));
+  FlatTreeNode corruptLeft = left;
+  ++corruptLeft.count;
+  stream.seekp(header.nodesOffset + root.left * sizeof(FlatTreeNode));
+  stream.write((const char*) &corruptLeft, sizeof(FlatTreeNode));
+  stream.flush();
+
+  {
+    data::MappedFile file("flat_corrupt_tree.bin");
+    std::vector<size_t> oldFromNew;
+    BOOST_REQUIRE_THROW(FlatTree<KDTreeType>::Load(file, oldFromNew),
+        std::runtime_error);
+  }
+
+  // Restore the left child, and use a number of nodes whose block size
+  // overflows.
+  stream.seekp(header.nodesOffset + root.left * sizeof(FlatTreeNode));
+  stream.write((const char*) &left, sizeof(FlatTreeNode));
+  FlatTreeHeader corruptHeader = header;
+  corruptHeader.numNodes = (uint64_t(1) << 60) + 1;
+  stream.seekp(0);
+  stream.write((const char*) &corruptHeader, sizeof(FlatTreeHeader));
+  stream.close();
+
+  {
+    data::MappedFile file("flat_corrupt_tree.bin");
+    std::vector<size_t> oldFromNew;
+    BOOST_REQUIRE_THROW(FlatTree<KDTreeType>::Load(file, oldFromNew),
+        std::runtime_error);
+  }
+
+  // Save the tree with its mapping, and point two entries of the mapping to
+  // the same point.
+  std::vector<size_t> treeOldFromNew;
+  KDTreeType mappedTree(dataset, treeOldFromNew);
+  FlatTree<KDTreeType>::Save("flat_corrupt_tree.bin", mappedTree,
+      treeOldFromNew);
+  stream.open("flat_corrupt_tree.bin",
+      std::ios::in | std::ios::out | std::ios::binary);
+  stream.read((char*) &header, sizeof(FlatTreeHeader));
+  uint64_t entry;
+  stream.seekg(header.mappingOffset);
+  stream.read((char*) &entry, sizeof(uint64_t));
+  stream.seekp(header.mappingOffset + sizeof(uint64_t));
+  stream.write((const char*) &entry, sizeof(uint64_t));
+  stream.close();
+
+  {
+    data::MappedFile file("flat_corrupt_tree.bin");
+    std::vector<size_t> oldFromNew;
+    BOOST_REQUIRE_THROW(FlatTree<KDTreeType>::Load(file, oldFromNew),
+        std::runtime_error);
+  }
+
+  remove("flat_corrupt_tree.bin");
+}
+
+// Collect the points held by the leaves of an updated tree, and check the
+// bounds, the number of points and the parents of the nodes.
+template<typename TreeType>
+void CheckUpdatedTree(const TreeType& node,
+                      const size_t maxLeafSize,
+                      std::vector<size_t>& points)
+{
+  for (size_t i = 0; i < node.NumDescendants(); ++i)
+  {
+    BOOST_REQUIRE(node.Bound().Contains(
+        node.Dataset().col(node.Descendant(i))));
+  }
+
+  if (node.IsLeaf())
+  {
+    BOOST_REQUIRE_LE(node.NumPoints(), maxLeafSize);
+    for (size_t i = 0; i < node.NumPoints(); ++i)
+      points.push_back(node.Point(i));
+    return;
+  }
+
+  BOOST_REQUIRE_EQUAL(node.NumDescendants(), node.Left()->NumDescendants() +
+      node.Right()->NumDescendants());
+  BOOST_REQUIRE_EQUAL(node.Left()->Parent(), &node);
+  BOOST_REQUIRE_EQUAL(node.Right()->Parent(), &node);
+  CheckUpdatedTree(*node.Left(), maxLeafSize, points);
+  CheckUpdatedTree(*node.Right(), maxLeafSize, points);
+}
+
+/**
+ * Insert many points into a kd-tree and remove many points from it, and make
+ * sure that the columns of the dataset are never moved and that the tree holds
+ * exactly the remaining points.
+ */
+BOOST_AUTO_TEST_CASE(BinarySpaceTreeInsertRemoveTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset(3, 500, arma::fill::randu);
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew, 10);
+
+  // The point that should be in each column, and whether the tree holds it.
+  arma::mat points(tree.Dataset());
+  std::vector<bool> held(points.n_cols, true);
+
+  for (size_t i = 0; i < 1500; ++i)
+  {
+    if (i % 3 == 2)
+    {
+      size_t column = math::RandInt(held.size());
+      while (!held[column])
+        column = (column + 1) % held.size();
+
+      tree.Remove(column, 10);
+      held[column] = false;
+    }
+    else
+    {
+      arma::vec point(3, arma::fill::randu);
+      if (i % 5 == 0)
+        point *= 0.05; // Cluster some points in a corner.
+
+      const size_t column = tree.Insert(point, 10);
+      if (column >= held.size())
+      {
+        held.resize(column + 1, false);
+        points.resize(3, column + 1);
+      }
+
+      BOOST_REQUIRE(!held[column]);
+      held[column] = true;
+      points.col(column) = point;
+    }
+  }
+
+  std::vector<size_t> treePoints;
+  CheckUpdatedTree(tree, 10, treePoints);
+  std::sort(treePoints.begin(), treePoints.end());
+
+  std::vector<size_t> heldPoints;
+  for (size_t i = 0; i < held.size(); ++i)
+    if (held[i])
+      heldPoints.push_back(i);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), heldPoints.size());
+  BOOST_REQUIRE_EQUAL(treePoints.size(), heldPoints.size());
+  for (size_t i = 0; i < heldPoints.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(treePoints[i], heldPoints[i]);
+    for (size_t d = 0; d < 3; ++d)
+    {
+      BOOST_REQUIRE_EQUAL(tree.Dataset()(d, heldPoints[i]),
+          points(d, heldPoints[i]));
+    }
+  }
+
+  // Every other column of the dataset is free.
+  BOOST_REQUIRE_EQUAL(tree.FreeColumns().size() + heldPoints.size(),
+      tree.Dataset().n_cols);
+  BOOST_REQUIRE_THROW(tree.Remove(tree.FreeColumns()[0], 10),
+      std::invalid_argument);
+
+  // The points of the tree aren't contiguous anymore, so it can't be saved as
+  // a flat tree file.
+  BOOST_REQUIRE(!tree.IsContiguous());
+  BOOST_REQUIRE_THROW(FlatTree<TreeType>::Save("flat_updated_tree.bin", tree),
+      std::invalid_argument);
+}
+
 template<typename TreeType>
 void RecurseTreeCountLeaves(const TreeType& node, arma::vec& counts)
 {